@@ -0,0 +1,182 @@
+/**
+ * @file bob/core/parallel.h
+ * @date Mon Oct 19 09:12:44 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Simple range-splitting helpers to run loops on multiple threads.
+ * These are a generalization of the helpers available in bob::visioner that
+ * can be used by any other package.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_CORE_PARALLEL_H
+#define BOB_CORE_PARALLEL_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <stdint.h>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+
+namespace bob { namespace core {
+/**
+ * @ingroup CORE
+ * @{
+ */
+
+  /**
+   * @brief Returns the number of threads to use if the user passes 0 as the
+   * number of threads to any of the functions below. This is the value set
+   * with set_default_threads() or, if that was never called, the number of
+   * hardware threads available on the machine (at least 1).
+   */
+  size_t default_threads();
+
+  /**
+   * @brief Sets the default number of threads (0 resets it to the number of
+   * hardware threads available).
+   */
+  void set_default_threads(size_t n);
+
+  /**
+   * @brief Splits the range [0, size) into (at most) n_threads contiguous
+   * sub-ranges of approximately equal size. The number of sub-ranges
+   * returned is never larger than size, so no empty ranges are produced.
+   */
+  void split_range(uint64_t size, size_t n_threads,
+      std::vector<std::pair<uint64_t,uint64_t> >& ranges);
+
+  namespace detail {
+
+    template <typename TOp> void run_range(TOp& op, size_t index,
+        std::pair<uint64_t,uint64_t> range, boost::exception_ptr& error) {
+      try {
+        op(index, range.first, range.second);
+      }
+      catch (...) {
+        error = boost::current_exception();
+      }
+    }
+
+  }
+
+  /**
+   * @brief Splits a loop of the given size over n_threads threads and calls
+   * op(thread_index, begin, end) on each of the sub-ranges. If n_threads is
+   * 0, default_threads() is used. If a single sub-range results, the
+   * operator is called on the current thread. Exceptions raised by any of
+   * the workers are re-thrown on the calling thread after all workers are
+   * joined.
+   *
+   * @return The number of sub-ranges (and therefore of thread indexes) used.
+   * This can be used to size per-thread accumulators, which should be at
+   * least as large as the requested number of threads.
+   */
+  template <typename TOp>
+  size_t parallel_for(uint64_t size, TOp op, size_t n_threads=0) {
+    if (!n_threads) n_threads = default_threads();
+    std::vector<std::pair<uint64_t,uint64_t> > ranges;
+    split_range(size, n_threads, ranges);
+
+    if (ranges.size() <= 1) {
+      if (ranges.size()) op(0, ranges[0].first, ranges[0].second);
+      return ranges.size();
+    }
+
+    std::vector<boost::exception_ptr> errors(ranges.size());
+    boost::thread_group threads;
+    for (size_t i=0; i<ranges.size(); ++i) {
+      threads.create_thread(boost::bind(&detail::run_range<TOp>,
+            boost::ref(op), i, ranges[i], boost::ref(errors[i])));
+    }
+    threads.join_all();
+
+    for (size_t i=0; i<errors.size(); ++i)
+      if (errors[i]) boost::rethrow_exception(errors[i]);
+
+    return ranges.size();
+  }
+
+  namespace detail {
+
+    template <typename T, typename Compare> struct SortChunks {
+      std::vector<T>& v;
+      Compare comp;
+      SortChunks(std::vector<T>& v_, Compare comp_): v(v_), comp(comp_) {}
+      void operator()(size_t, uint64_t begin, uint64_t end) const {
+        std::sort(v.begin() + begin, v.begin() + end, comp);
+      }
+    };
+
+    template <typename T, typename Compare> struct MergeChunks {
+      std::vector<T>& v;
+      const std::vector<uint64_t>& bounds;
+      Compare comp;
+      MergeChunks(std::vector<T>& v_, const std::vector<uint64_t>& b_,
+          Compare comp_): v(v_), bounds(b_), comp(comp_) {}
+      void operator()(size_t, uint64_t begin, uint64_t end) const {
+        for (uint64_t k=begin; k<end; ++k)
+          std::inplace_merge(v.begin() + bounds[2*k],
+              v.begin() + bounds[2*k+1], v.begin() + bounds[2*k+2], comp);
+      }
+    };
+
+  }
+
+  /**
+   * @brief Sorts a vector using n_threads threads (0 means
+   * default_threads()). Chunks of the vector are sorted concurrently and
+   * then merged pair-wise, also concurrently. Small vectors are sorted with
+   * std::sort on the calling thread. Like std::sort, the sort is not stable.
+   */
+  template <typename T, typename Compare>
+  void parallel_sort(std::vector<T>& v, Compare comp, size_t n_threads=0) {
+    static const uint64_t MIN_CHUNK = 65536;
+    if (!n_threads) n_threads = default_threads();
+    if (n_threads > v.size() / MIN_CHUNK) n_threads = v.size() / MIN_CHUNK;
+    if (n_threads <= 1) {
+      std::sort(v.begin(), v.end(), comp);
+      return;
+    }
+
+    std::vector<std::pair<uint64_t,uint64_t> > ranges;
+    split_range(v.size(), n_threads, ranges);
+    parallel_for(v.size(), detail::SortChunks<T,Compare>(v, comp), n_threads);
+
+    std::vector<uint64_t> bounds;
+    for (size_t i=0; i<ranges.size(); ++i) bounds.push_back(ranges[i].first);
+    bounds.push_back(v.size());
+
+    while (bounds.size() > 2) {
+      const uint64_t pairs = (bounds.size() - 1) / 2;
+      parallel_for(pairs, detail::MergeChunks<T,Compare>(v, bounds, comp),
+          n_threads);
+      std::vector<uint64_t> merged;
+      for (size_t i=0; i<bounds.size(); i+=2) merged.push_back(bounds[i]);
+      if (merged.back() != v.size()) merged.push_back(v.size());
+      bounds.swap(merged);
+    }
+  }
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_CORE_PARALLEL_H */
@@ -0,0 +1,209 @@
+/**
+ * @file bob/io/ArrayContainer.h
+ * @date Mon Oct 19 23:12:48 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief An append-only container of arrays that is memory-mapped for
+ * reading
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_IO_ARRAYCONTAINER_H
+#define BOB_IO_ARRAYCONTAINER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <bob/core/blitz_array.h>
+#include <bob/io/File.h>
+
+namespace bob { namespace io {
+/**
+ * @ingroup IO
+ * @{
+ */
+
+/**
+ * @brief A file of arrays (e.g. the features of a whole database) of any
+ * type and shape, that can only be appended to and is memory-mapped for
+ * reading.
+ *
+ * Each array is stored, aligned to 64 bytes, after a small record giving
+ * its type and shape. The index of the records is built from the mapping
+ * when the file is opened, so that reading an array is a single copy from
+ * the mapping or, with view(), no copy at all.
+ *
+ * Arrays are appended at the end of the file, after which the number of
+ * arrays in the header of the file is updated. Other processes reading the
+ * file therefore only see complete arrays, once they call refresh(). The
+ * const methods of this class may be called by concurrent threads, as long
+ * as no array is appended at the same time.
+ */
+class ArrayContainer {
+
+  public:
+
+    /**
+     * @brief Opens a container for reading ('r'), creates it, truncating
+     * existing files ('w'), or opens it for appending arrays, creating it
+     * if needed ('a').
+     */
+    ArrayContainer(const std::string& filename, char mode='r');
+
+    /**
+     * @brief Destructor. Views on the arrays remain valid.
+     */
+    virtual ~ArrayContainer();
+
+    /**
+     * @brief The path to the file
+     */
+    const std::string& getFilename() const { return m_filename; }
+
+    /**
+     * @brief The number of arrays in the container
+     */
+    size_t size() const { return m_index.size(); }
+
+    /**
+     * @brief The type of an array
+     */
+    const bob::core::array::typeinfo& type(size_t index) const;
+
+    /**
+     * @brief Returns a read-only buffer that refers to the memory of an
+     * array in the mapping (the mapping lives as long as the buffer, as
+     * given by its owner()). The data must not be written to.
+     */
+    boost::shared_ptr<bob::core::array::interface> view(size_t index) const;
+
+    /**
+     * @brief Returns a blitz::Array that refers to the memory of an array in
+     * the mapping, without copying it. The data must not be written to.
+     *
+     * @warning The returned array does not keep the mapping alive: it is
+     * only valid as long as this container (or a view() on the same array)
+     * exists and does not map the file again, i.e., until an array appended
+     * after it was mapped is read.
+     */
+    template <typename T, int N> const blitz::Array<T,N> view(size_t index)
+      const {
+      bob::core::array::blitz_array tmp(const_cast<char*>(data(index)),
+          type(index));
+      return tmp.get<T,N>(true);
+    }
+
+    /**
+     * @brief Copies an array into the buffer, which is reset to the type of
+     * the array if it is not compatible with it
+     */
+    void read(size_t index, bob::core::array::interface& buffer) const;
+
+    /**
+     * @brief Returns a copy of an array
+     */
+    template <typename T, int N> blitz::Array<T,N> read(size_t index) const {
+      bob::core::array::blitz_array tmp(type(index));
+      read(index, tmp);
+      return tmp.get<T,N>();
+    }
+
+    /**
+     * @brief Appends an array at the end of the container and returns its
+     * index
+     */
+    size_t append(const bob::core::array::interface& buffer);
+
+    /**
+     * @brief Appends a blitz::Array at the end of the container
+     */
+    template <typename T, int N> size_t append(const blitz::Array<T,N>& bz) {
+      return append(bob::core::array::blitz_array(bz));
+    }
+
+    /**
+     * @brief Appends all arrays of a file (e.g. an HDF5 or tensor file) at
+     * the end of the container and returns the number of arrays appended.
+     * The file is only committed once, at the end.
+     */
+    size_t extend(bob::io::File& file);
+
+    /**
+     * @brief Maps the file again, to see the arrays appended since it was
+     * opened by other processes. Returns the number of arrays.
+     */
+    size_t refresh();
+
+  private: //not implemented
+
+    ArrayContainer(const ArrayContainer& other);
+
+    ArrayContainer& operator=(const ArrayContainer& other);
+
+  private: //methods
+
+    /**
+     * @brief The data of an array in the mapping
+     */
+    const char* data(size_t index) const;
+
+    /**
+     * @brief Writes an array after the last one, without committing it
+     */
+    void write_entry(const bob::core::array::interface& buffer);
+
+    /**
+     * @brief Writes the number of arrays and the end of the data in the
+     * header and adds the arrays written to the index. The file is only
+     * mapped again when one of them is read.
+     */
+    void commit();
+
+    /**
+     * @brief Drops the arrays written since the last commit
+     */
+    void rollback();
+
+    /**
+     * @brief Maps the file and reads the index of the arrays committed
+     */
+    void map();
+
+  private: //representation
+
+    struct Entry {
+      uint64_t offset; ///< of the data, from the start of the file
+      bob::core::array::typeinfo type;
+    };
+
+    std::string m_filename;
+    boost::shared_ptr<std::FILE> m_out; ///< set if arrays can be appended
+    mutable boost::shared_ptr<boost::iostreams::mapped_file_source> m_map;
+    std::vector<Entry> m_index; ///< committed arrays
+    std::vector<Entry> m_pending; ///< written, but not committed yet
+    uint64_t m_end; ///< end of the data of the last array written
+
+};
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_IO_ARRAYCONTAINER_H */
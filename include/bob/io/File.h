@@ -46,6 +46,43 @@ namespace io {
    * @{
    */
       
+  /**
+   * @brief Options to decode images at a lower cost than a full decoding
+   * followed by bob::ip::scale() or a crop, see File::setDecodeOptions().
+   */
+  struct DecodeOptions {
+
+    DecodeOptions(): scale_denom(1), gray(false), roi_y(0), roi_x(0),
+      roi_height(0), roi_width(0) {}
+
+    /**
+     * @brief Returns true if these options decode the full image as is
+     */
+    bool is_default() const;
+
+    /**
+     * @brief Computes the region of interest of an image of the given size
+     * (after scaling), where a height or width of 0 extends the region to
+     * the border. Raises if the region does not fit in the image.
+     */
+    void roi(size_t height, size_t width, size_t& y, size_t& x, size_t& h,
+        size_t& w) const;
+
+    /**
+     * @brief Size of a dimension of length n after scaling, as computed by
+     * libjpeg: ceil(n / scale_denom)
+     */
+    size_t scaled(size_t n) const { return (n + scale_denom - 1) / scale_denom; }
+
+    size_t scale_denom; ///< decodes at 1/scale_denom of the size (JPEG: 1, 2, 4 or 8)
+    bool gray; ///< decodes color images as a single gray plane
+    size_t roi_y; ///< top of the region of interest (after scaling)
+    size_t roi_x; ///< left of the region of interest (after scaling)
+    size_t roi_height; ///< height of the region of interest (0: to the bottom)
+    size_t roi_width; ///< width of the region of interest (0: to the right)
+
+  };
+
   /**
    * @brief Files deal with reading and writing multiple (homogeneous) array
    * data to and from files.
@@ -123,6 +160,14 @@ namespace io {
        */
       virtual void write (const bob::core::array::interface& buffer) =0;
 
+      /**
+       * Sets the options used to decode the images of this file, which
+       * change its type() and type_all() accordingly. Only the JPEG and PNG
+       * codecs support them: the default implementation raises unless the
+       * options are the default ones.
+       */
+      virtual void setDecodeOptions(const DecodeOptions& options);
+
     public: //blitz::Array specific API
 
       /**
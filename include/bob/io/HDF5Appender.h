@@ -0,0 +1,211 @@
+/**
+ * @file bob/io/HDF5Appender.h
+ * @date Mon Oct 19 19:12:48 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Buffered, asynchronous appends to an HDF5 dataset
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_IO_HDF5APPENDER_H
+#define BOB_IO_HDF5APPENDER_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/exception_ptr.hpp>
+#include <bob/core/array.h>
+#include <bob/core/array_copy.h>
+#include <bob/core/check.h>
+#include <bob/io/HDF5File.h>
+
+namespace bob { namespace io {
+/**
+ * @ingroup IO
+ * @{
+ */
+
+/**
+ * @brief Appends entries (scalars or arrays) to a dataset of an HDF5 file,
+ * as bob::io::HDF5File::append() and appendArray() do, but in blocks.
+ *
+ * The entries are copied into a block of block_size entries. Full blocks are
+ * queued and written by a background thread, which extends the dataset and
+ * writes the whole block at once, instead of once per entry. At most
+ * queue_size full blocks wait to be written: append() blocks when the queue
+ * is full. flush() writes the entries appended so far and waits for them to
+ * be written; the destructor does the same.
+ *
+ * The background thread is only used if the HDF5 library is thread-safe;
+ * otherwise, full blocks are written right away by append(), which still
+ * extends the dataset once per block.
+ *
+ * The appender works on a (shallow) copy of the given file, so that the
+ * current directory of the latter can be changed. The file itself should not
+ * be used while entries are being written (i.e., before flush() returns),
+ * since bob::io::HDF5File is not thread-safe. An error raised by the
+ * background thread is re-thrown by flush(), or by the next append() that
+ * fills a block, and the entries not written yet are dropped.
+ */
+class HDF5Appender {
+
+  public:
+
+    /**
+     * @brief Appends to the dataset at the given path of the file (relative
+     * to its current directory). The dataset is created, with the given
+     * compression level, on the first append() if it does not exist.
+     */
+    HDF5Appender(const bob::io::HDF5File& file, const std::string& path,
+        size_t block_size=1024, size_t queue_size=2, size_t compression=0);
+
+    /**
+     * @brief Destructor. Writes the remaining entries; errors are only
+     * reported as warnings.
+     */
+    virtual ~HDF5Appender();
+
+    /**
+     * @brief The path of the dataset, relative to the current directory of
+     * the file when the appender was created
+     */
+    const std::string& getPath() const { return m_path; }
+
+    /**
+     * @brief The number of entries written at once
+     */
+    size_t getBlockSize() const { return m_block_size; }
+
+    /**
+     * @brief The maximum number of full blocks waiting to be written
+     */
+    size_t getQueueSize() const { return m_queue_size; }
+
+    /**
+     * @brief The number of entries appended so far
+     */
+    size_t size() const { return m_appended; }
+
+    /**
+     * @brief Appends an entry of the given type, stored in the buffer
+     */
+    void append_buffer(const bob::io::HDF5Type& type, const void* buffer);
+
+    /**
+     * @brief Appends an array, which is considered to be a C-style contiguous
+     * buffer
+     */
+    void appendArray(const bob::core::array::interface& entry) {
+      append_buffer(bob::io::HDF5Type(entry.type()), entry.ptr());
+    }
+
+    /**
+     * @brief Appends a scalar
+     */
+    template <typename T> void append(const T& value) {
+      append_buffer(bob::io::HDF5Type(value),
+          reinterpret_cast<const void*>(&value));
+    }
+
+    /**
+     * @brief Appends an array
+     */
+    template <typename T, int N>
+      void appendArray(const blitz::Array<T,N>& value) {
+        if (!bob::core::array::isCZeroBaseContiguous(value)) {
+          blitz::Array<T,N> tmp = bob::core::array::ccopy(value);
+          append_buffer(bob::io::HDF5Type(tmp),
+              reinterpret_cast<const void*>(tmp.data()));
+        }
+        else {
+          append_buffer(bob::io::HDF5Type(value),
+              reinterpret_cast<const void*>(value.data()));
+        }
+      }
+
+    /**
+     * @brief Writes the entries appended so far and waits for them to be
+     * written
+     */
+    void flush();
+
+  private: //not implemented
+
+    HDF5Appender(const HDF5Appender& other);
+
+    HDF5Appender& operator=(const HDF5Appender& other);
+
+  private: //types
+
+    /**
+     * @brief Entries written at once
+     */
+    struct Block {
+      std::vector<char> data;
+      size_t count;
+    };
+
+  private: //methods
+
+    /**
+     * @brief Queues the current block, waiting for room in the queue
+     */
+    void push(boost::unique_lock<boost::mutex>& lock);
+
+    /**
+     * @brief Re-throws an error raised by the writer thread, dropping the
+     * current block
+     */
+    void check_error(boost::unique_lock<boost::mutex>& lock);
+
+    /**
+     * @brief The body of the writer thread
+     */
+    void write_blocks();
+
+  private: //representation
+
+    bob::io::HDF5File m_file; ///< shallow copy, with its own directory
+    std::string m_path; ///< of the dataset
+    size_t m_block_size;
+    size_t m_queue_size;
+    size_t m_compression; ///< if the dataset is created
+    bob::io::HDF5Type m_type; ///< of every entry (set on the first append)
+    size_t m_entry_size; ///< in bytes
+    size_t m_appended; ///< entries appended so far
+    boost::shared_ptr<Block> m_block; ///< being filled
+
+    // writer state, protected by m_mutex
+    boost::scoped_ptr<boost::thread> m_thread; ///< the writer
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    std::deque<boost::shared_ptr<Block> > m_queue; ///< full blocks
+    bool m_writing; ///< the writer is writing a block
+    boost::exception_ptr m_error; ///< raised by the writer
+    bool m_error_raised; ///< m_error was re-thrown to the caller
+    bool m_stop; ///< asks the writer to stop, once the queue is empty
+
+};
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_IO_HDF5APPENDER_H */
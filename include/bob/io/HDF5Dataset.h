@@ -408,6 +408,13 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
        */
       void extend_buffer (const bob::io::HDF5Type& dest, const void* buffer);
 
+      /**
+       * Extend the dataset with count extra variables, stored one after the
+       * other in the buffer. The dataset is extended and written only once.
+       */
+      void extend_buffer (const bob::io::HDF5Type& dest, size_t count,
+          const void* buffer);
+
     public: //attribute support
 
       /**
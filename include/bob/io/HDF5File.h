@@ -394,6 +394,13 @@ namespace bob { namespace io {
       void extend_buffer (const std::string& path,
           const HDF5Type& type, const void* buffer);
 
+      /**
+       * extend the dataset with count extra variables, stored one after the
+       * other in the buffer, at once.
+       */
+      void extend_buffer (const std::string& path,
+          const HDF5Type& type, size_t count, const void* buffer);
+
       /**
        * Copy construct an already opened HDF5File; just creates a shallow copy
        * of the file
@@ -0,0 +1,320 @@
+/**
+ * @file bob/io/HDF5VirtualDataset.h
+ * @date Mon Oct 19 17:41:05 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief A view of the same dataset in many HDF5 files as a single array
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_IO_HDF5VIRTUALDATASET_H
+#define BOB_IO_HDF5VIRTUALDATASET_H
+
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/exception_ptr.hpp>
+#include <bob/core/blitz_array.h>
+#include <bob/io/HDF5File.h>
+
+namespace bob { namespace io {
+/**
+ * @ingroup IO
+ * @{
+ */
+
+/**
+ * @brief Views a dataset of the same path in many HDF5 files (e.g. the
+ * features of each sample of a database, stored one file per sample) as a
+ * single N x D array, of which the rows are the arrays of the datasets, one
+ * file after the other.
+ *
+ * The files are scanned once, when the view is created, to find the number
+ * of rows of each one. This index can be saved to an HDF5 file and loaded
+ * back, so that the files are only opened again to read their rows. Only
+ * the datasets are opened (not the whole tree of groups of the files, as
+ * with bob::io::HDF5File), and at most max_open of them are kept open, the
+ * least recently used being closed first.
+ *
+ * Rows are read in parallel by n_threads threads, and consecutive rows of
+ * the same file are read at once. If the HDF5 library is not thread-safe,
+ * the rows are read by the calling thread. Batches of rows can also be prefetched in the
+ * background: after start(), next() returns them in order. The prefetcher
+ * only runs if the HDF5 library is thread-safe, since the caller may use
+ * other HDF5 files in the meantime: otherwise, next() reads each batch
+ * itself.
+ */
+class HDF5VirtualDataset {
+
+  public:
+
+    /**
+     * @brief Scans the dataset at the given path of each of the files.
+     * All datasets must contain arrays (rows) of the same type. If n_threads
+     * is 0, bob::core::default_threads() threads are used.
+     */
+    HDF5VirtualDataset(const std::vector<std::string>& filenames,
+        const std::string& path, size_t max_open=64, size_t n_threads=0);
+
+    /**
+     * @brief Loads an index saved with save(), without opening the files
+     */
+    HDF5VirtualDataset(bob::io::HDF5File& index, size_t max_open=64,
+        size_t n_threads=0);
+
+    /**
+     * @brief Destructor. Stops the prefetcher, if running, and closes the
+     * files.
+     */
+    virtual ~HDF5VirtualDataset();
+
+    /**
+     * @brief Saves the index (files, path, type and number of rows of each
+     * file) in the current directory of the given file
+     */
+    void save(bob::io::HDF5File& index) const;
+
+    /**
+     * @brief The list of files
+     */
+    const std::vector<std::string>& getFilenames() const
+    { return m_filenames; }
+
+    /**
+     * @brief The path of the dataset in each file
+     */
+    const std::string& getPath() const { return m_path; }
+
+    /**
+     * @brief The number of rows of all files
+     */
+    size_t size() const { return m_offsets.back(); }
+
+    /**
+     * @brief The number of rows of a file
+     */
+    size_t size(size_t file) const;
+
+    /**
+     * @brief The index of the first row of a file
+     */
+    size_t offset(size_t file) const;
+
+    /**
+     * @brief The index of the file holding a row
+     */
+    size_t file(size_t row) const;
+
+    /**
+     * @brief The type of every row
+     */
+    const bob::core::array::typeinfo& type() const { return m_type; }
+
+    /**
+     * @brief The type of an array of count rows
+     */
+    bob::core::array::typeinfo type(size_t count) const;
+
+    /**
+     * @brief The type of the array of all rows
+     */
+    bob::core::array::typeinfo type_all() const { return type(size()); }
+
+    /**
+     * @brief The maximum number of files kept open
+     */
+    size_t getMaxOpen() const { return m_max_open; }
+    void setMaxOpen(size_t n);
+
+    /**
+     * @brief The number of files currently open
+     */
+    size_t getOpen() const;
+
+    /**
+     * @brief The number of threads reading rows
+     */
+    size_t getNThreads() const { return m_n_threads; }
+    void setNThreads(size_t n) { m_n_threads = n; }
+
+    /**
+     * @brief Reads a row into the buffer, which is reset to type() if it is
+     * not compatible with it
+     */
+    void read(size_t row, bob::core::array::interface& buffer);
+
+    /**
+     * @brief Reads the count rows starting at the given one into the buffer,
+     * which is reset to type(count) if it is not compatible with it
+     */
+    void read(size_t start, size_t count, bob::core::array::interface& buffer);
+
+    /**
+     * @brief Reads the given rows, in this order, into the buffer, which is
+     * reset to type(rows.size()) if it is not compatible with it
+     */
+    void read(const std::vector<size_t>& rows,
+        bob::core::array::interface& buffer);
+
+    /**
+     * @brief Returns a row
+     */
+    template <typename T, int N> blitz::Array<T,N> read(size_t row) {
+      bob::core::array::blitz_array tmp(m_type);
+      read(row, tmp);
+      return tmp.get<T,N>();
+    }
+
+    /**
+     * @brief Returns the count rows starting at the given one
+     */
+    template <typename T, int N> blitz::Array<T,N> read(size_t start,
+        size_t count) {
+      bob::core::array::blitz_array tmp(type(count));
+      read(start, count, tmp);
+      return tmp.get<T,N>();
+    }
+
+    /**
+     * @brief Returns the given rows, in this order
+     */
+    template <typename T, int N> blitz::Array<T,N> read
+      (const std::vector<size_t>& rows) {
+      bob::core::array::blitz_array tmp(type(rows.size()));
+      read(rows, tmp);
+      return tmp.get<T,N>();
+    }
+
+    /**
+     * @brief Starts prefetching the given rows (all rows, in order, if
+     * empty) in batches of batch_size rows (the last one may be smaller),
+     * keeping at most queue_size batches ahead of the consumer. Restarts if
+     * the prefetcher was already running.
+     */
+    void start(size_t batch_size, size_t queue_size=2,
+        const std::vector<size_t>& rows=std::vector<size_t>());
+
+    /**
+     * @brief Returns the next prefetched batch, waiting for it to be read if
+     * needed, or an empty pointer once all batches were returned. Errors
+     * raised while reading the batch are re-thrown here.
+     */
+    boost::shared_ptr<bob::core::array::blitz_array> next();
+
+    /**
+     * @brief Stops the prefetcher and drops the batches not returned yet
+     */
+    void stop();
+
+  private: //not implemented
+
+    HDF5VirtualDataset(const HDF5VirtualDataset& other);
+
+    HDF5VirtualDataset& operator=(const HDF5VirtualDataset& other);
+
+  private: //types
+
+    struct Handle; ///< an open file and dataset
+
+    /**
+     * @brief Consecutive rows of a file, read at once
+     */
+    struct Segment {
+      size_t file;
+      uint64_t first; ///< in the file
+      uint64_t count;
+      uint64_t position; ///< in the output
+    };
+
+  private: //methods
+
+    /**
+     * @brief Scans the files [begin, end) for their number of rows and
+     * their row type
+     */
+    void scan(std::vector<bob::core::array::typeinfo>& types, size_t,
+        uint64_t begin, uint64_t end);
+
+    /**
+     * @brief Returns an open handle to a file, opening it if needed
+     */
+    boost::shared_ptr<Handle> handle(size_t file);
+
+    /**
+     * @brief Reads the segments [begin, end) into the output data
+     */
+    void read_segments(const std::vector<Segment>& segments, void* data,
+        size_t, uint64_t begin, uint64_t end);
+
+    /**
+     * @brief Reads the segments in parallel into the output buffer
+     */
+    void read_parallel(const std::vector<Segment>& segments, size_t count,
+        bob::core::array::interface& buffer);
+
+    /**
+     * @brief Reads the batch b of the rows to prefetch
+     */
+    boost::shared_ptr<bob::core::array::blitz_array> read_batch(size_t b);
+
+    /**
+     * @brief The body of the prefetcher thread
+     */
+    void prefetch();
+
+  private: //representation
+
+    std::vector<std::string> m_filenames; ///< files of the dataset
+    std::string m_path; ///< of the dataset in each file
+    std::vector<uint64_t> m_offsets; ///< first row of each file, then size()
+    bob::core::array::typeinfo m_type; ///< type of every row
+    size_t m_max_open; ///< files kept open
+    size_t m_n_threads; ///< threads reading rows
+
+    // open files, the most recently used first, protected by m_open_mutex
+    typedef std::list<std::pair<size_t, boost::shared_ptr<Handle> > > lru_t;
+    lru_t m_lru;
+    std::map<size_t, lru_t::iterator> m_open;
+    mutable boost::mutex m_open_mutex;
+
+    // prefetcher state, protected by m_mutex
+    boost::scoped_ptr<boost::thread> m_thread; ///< the prefetcher
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    std::deque<boost::shared_ptr<bob::core::array::blitz_array> > m_queue;
+    boost::exception_ptr m_error; ///< raised by the prefetcher
+    std::vector<size_t> m_rows; ///< rows to prefetch (all, if empty)
+    size_t m_batch_size;
+    size_t m_queue_size;
+    size_t m_produced; ///< batches read (or failed) by the prefetcher
+    size_t m_n_batches;
+    bool m_started; ///< start() was called, but not stop()
+    bool m_stop; ///< asks the prefetcher to stop
+
+};
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_IO_HDF5VIRTUALDATASET_H */
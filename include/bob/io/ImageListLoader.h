@@ -0,0 +1,223 @@
+/**
+ * @file bob/io/ImageListLoader.h
+ * @date Mon Oct 19 22:05:37 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Parallel loading of lists of images into a single array, with an
+ * optional background prefetcher of batches
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_IO_IMAGELISTLOADER_H
+#define BOB_IO_IMAGELISTLOADER_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/exception_ptr.hpp>
+#include <bob/core/blitz_array.h>
+#include <bob/io/File.h>
+
+namespace bob { namespace io {
+/**
+ * @ingroup IO
+ * @{
+ */
+
+/**
+ * @brief Loads a list of images of the same type and shape (e.g. the
+ * cropped faces of a database) into a single N x H x W (gray) or
+ * N x C x H x W (color) array.
+ *
+ * Images are decoded concurrently by n_threads threads, through the codecs
+ * of the bob::io::CodecRegistry, straight into the memory of the output
+ * array. The type of the images is given by the first one of the list.
+ *
+ * Batches of consecutive images can also be prefetched: after start(),
+ * a background thread decodes the following batches while the previous
+ * ones are being used, keeping (at most) queue_size of them ready. next()
+ * returns them in order.
+ *
+ * Files read by the codecs based on HDF5 (.hdf5, .h5, .hdf and .mat) are
+ * only decoded concurrently if the HDF5 library serializes its calls itself
+ * (i.e., if it was built thread-safe), since the caller may use other HDF5
+ * files in the meantime. Otherwise, if the list has such files, all images
+ * are decoded by the calling thread and next() decodes each batch when it is
+ * called (see serialized()).
+ */
+class ImageListLoader {
+
+  public:
+
+    /**
+     * @brief Creates a loader for the given files, of which the first one
+     * is peeked to get the type of all images. If n_threads is 0,
+     * bob::core::default_threads() threads are used. All images are
+     * decoded with the given options (see File::setDecodeOptions()).
+     */
+    ImageListLoader(const std::vector<std::string>& filenames,
+        size_t n_threads=0, const DecodeOptions& options=DecodeOptions());
+
+    /**
+     * @brief Destructor. Stops the prefetcher, if running.
+     */
+    virtual ~ImageListLoader();
+
+    /**
+     * @brief The list of files
+     */
+    const std::vector<std::string>& getFilenames() const
+    { return m_filenames; }
+
+    /**
+     * @brief The number of images in the list
+     */
+    size_t size() const { return m_filenames.size(); }
+
+    /**
+     * @brief The type of every image
+     */
+    const bob::core::array::typeinfo& type() const { return m_type; }
+
+    /**
+     * @brief The type of an array of count images
+     */
+    bob::core::array::typeinfo type(size_t count) const;
+
+    /**
+     * @brief The type of the array of all images
+     */
+    bob::core::array::typeinfo type_all() const { return type(size()); }
+
+    /**
+     * @brief The options used to decode the images
+     */
+    const DecodeOptions& getDecodeOptions() const { return m_options; }
+
+    /**
+     * @brief The number of threads decoding images
+     */
+    size_t getNThreads() const { return m_n_threads; }
+    void setNThreads(size_t n) { m_n_threads = n; }
+
+    /**
+     * @brief Tells if all images are decoded by the calling thread, because
+     * some of the files are read through HDF5, which is not thread-safe
+     */
+    bool serialized() const { return m_serialized; }
+
+    /**
+     * @brief Decodes the count images starting at index start into the
+     * buffer, which is reset to type(count) if it is not compatible with
+     * it. Raises if an image does not have the type of the list.
+     */
+    void read(size_t start, size_t count, bob::core::array::interface& buffer);
+
+    /**
+     * @brief Decodes all images into the buffer
+     */
+    void read_all(bob::core::array::interface& buffer) {
+      read(0, size(), buffer);
+    }
+
+    /**
+     * @brief Returns the count images starting at index start
+     */
+    template <typename T, int N> blitz::Array<T,N> read(size_t start,
+        size_t count) {
+      bob::core::array::blitz_array tmp(type(count));
+      read(start, count, tmp);
+      return tmp.get<T,N>();
+    }
+
+    /**
+     * @brief Returns all images
+     */
+    template <typename T, int N> blitz::Array<T,N> read_all() {
+      return read<T,N>(0, size());
+    }
+
+    /**
+     * @brief Starts prefetching the list in batches of batch_size images
+     * (the last one may be smaller), keeping at most queue_size decoded
+     * batches ahead of the consumer. Restarts from the first image if the
+     * prefetcher was already running.
+     */
+    void start(size_t batch_size, size_t queue_size=2);
+
+    /**
+     * @brief Returns the next prefetched batch, waiting for it to be decoded
+     * if needed (or decoding it, if serialized()), or an empty pointer once
+     * all batches were returned. Errors raised while decoding the batch are
+     * re-thrown here.
+     */
+    boost::shared_ptr<bob::core::array::blitz_array> next();
+
+    /**
+     * @brief Stops the prefetcher and drops the batches not returned yet
+     */
+    void stop();
+
+  private: //not implemented
+
+    ImageListLoader(const ImageListLoader& other);
+
+    ImageListLoader& operator=(const ImageListLoader& other);
+
+  private: //methods
+
+    /**
+     * @brief The body of the prefetcher thread
+     */
+    void prefetch();
+
+    /**
+     * @brief Decodes the batch b of the images to prefetch
+     */
+    boost::shared_ptr<bob::core::array::blitz_array> read_batch(size_t b);
+
+  private: //representation
+
+    std::vector<std::string> m_filenames; ///< the images to load
+    bob::core::array::typeinfo m_type; ///< type of every image
+    size_t m_n_threads; ///< threads decoding the images of a read
+    DecodeOptions m_options; ///< used to decode every image
+    bool m_serialized; ///< decodes on the calling thread only
+
+    // prefetcher state, protected by m_mutex
+    boost::scoped_ptr<boost::thread> m_thread; ///< the prefetcher
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    std::deque<boost::shared_ptr<bob::core::array::blitz_array> > m_queue;
+    boost::exception_ptr m_error; ///< raised by the prefetcher
+    size_t m_batch_size;
+    size_t m_queue_size;
+    size_t m_produced; ///< batches decoded (or failed) by the prefetcher
+    size_t m_n_batches;
+    bool m_started; ///< start() was called, but not stop()
+    bool m_stop; ///< asks the prefetcher to stop
+
+};
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_IO_IMAGELISTLOADER_H */
@@ -24,9 +24,14 @@
 #ifndef BOB_IO_VIDEOREADER_H
 #define BOB_IO_VIDEOREADER_H
 
+#include <list>
+#include <map>
 #include <string>
+#include <vector>
 #include <blitz/array.h>
 #include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <bob/core/array.h>
 #include <bob/io/VideoUtilities.h>
@@ -179,6 +184,52 @@ namespace bob { namespace io {
       size_t load(bob::core::array::interface& b, 
           bool throw_on_error=false, void (*check)(void)=0) const;
 
+      /**
+       * Builds the index of the keyframes of the video stream, by reading
+       * (but not decoding) all of its packets. Once the index is built,
+       * numberOfFrames() is the exact number of frames of the stream and
+       * iterators jump to a frame by seeking to the keyframe before it,
+       * instead of decoding all frames in between.
+       *
+       * If 'index_file' is given, the index is loaded from this HDF5 file if
+       * it was saved for the current version of the video file (same size
+       * and modification time), or built and saved there otherwise.
+       *
+       * Seeking is only used for streams of which the frames are stored in
+       * presentation order (e.g., without B-frames). Iterators on other
+       * streams still decode frames to move forward.
+       */
+      void buildIndex(const std::string& index_file="");
+
+      /**
+       * Tells if the index of the keyframes was built
+       */
+      inline bool hasIndex() const { return m_index.get() != 0; }
+
+      /**
+       * The numbers of the keyframes of the video stream (empty if the index
+       * was not built)
+       */
+      std::vector<uint64_t> keyframes() const;
+
+      /**
+       * Sets the maximum number of decoded frames kept in memory. The cache
+       * is shared by all iterators of this reader: frames read once are not
+       * decoded again while they are in the cache, the least recently read
+       * ones being dropped first. 0 (the default) disables the cache.
+       */
+      void setCacheSize(size_t frames);
+
+      /**
+       * The maximum number of decoded frames kept in memory
+       */
+      size_t getCacheSize() const;
+
+      /**
+       * The number of decoded frames currently kept in memory
+       */
+      size_t cachedFrames() const;
+
     private: //methods
 
       /**
@@ -186,6 +237,19 @@ namespace bob { namespace io {
        */
       void open(const std::string& filename, bool check);
 
+      /**
+       * Copies a frame from the cache into 'data', if it is there
+       *
+       * @return true if the frame was in the cache or false otherwise.
+       */
+      bool cached(size_t frame, bob::core::array::interface& data) const;
+
+      /**
+       * Keeps a copy of a decoded frame, organized as (height, width,
+       * color-bands), in the cache
+       */
+      void cache(size_t frame, const blitz::Array<uint8_t,3>& rgb) const;
+
     public: //iterators
 
       /**
@@ -234,13 +298,20 @@ namespace bob { namespace io {
           //const_iterator operator++ (int); //too inefficient!
 
           /**
-           * Fast-forward the video readout by N frames, return self. This
-           * implementation is slow because of ffmpeg limitations. It has no
-           * precise frame lookup function. What we have to do is to read
-           * frame-by-frame and stop when you want to.
+           * Fast-forward the video readout by N frames, return self. Frames
+           * are only decoded by the next read(), which seeks to the keyframe
+           * before the pointed frame if the parent's index was built (see
+           * VideoReader::buildIndex()) or decodes all frames in between
+           * otherwise.
            */
           const_iterator& operator+= (size_t frames);
 
+          /**
+           * Points to the given frame (forward or backward), return self. If
+           * the frame is past the end of the video, we will point to "end".
+           */
+          const_iterator& seek (size_t frame);
+
           /**
            * Compares two iterators for equality
            */
@@ -336,6 +407,19 @@ namespace bob { namespace io {
            */
           void init();
 
+          /**
+           * Sets up the ffmpeg infrastructure, at the beginning of the stream
+           */
+          void open();
+
+          /**
+           * Moves the decoder so that the next decoded frame is the currently
+           * pointed one, seeking to a keyframe if possible.
+           *
+           * @return true if it manages to do so or false otherwise.
+           */
+          bool seek_decoder(bool throw_on_error);
+
         private: //representation
           const VideoReader* m_parent; ///< who generated me
           boost::shared_ptr<AVFormatContext> m_format_context; ///< format context
@@ -347,6 +431,7 @@ namespace bob { namespace io {
           blitz::Array<uint8_t,3> m_rgb_array; ///< temporary
           boost::shared_ptr<SwsContext> m_swscaler; ///< software scaler
           size_t m_current_frame; ///< the current frame to be read
+          size_t m_decoded_frame; ///< the next frame the decoder will return
 
         public: //friendship
 
@@ -380,6 +465,30 @@ namespace bob { namespace io {
       std::string m_formatted_info; ///< printable information about the video
       bob::core::array::typeinfo m_typeinfo_video; ///< read whole video type
       bob::core::array::typeinfo m_typeinfo_frame; ///< read single frame type
+
+      /**
+       * The index of the keyframes of the video stream
+       */
+      struct Index {
+        uint64_t frames; ///< number of frames (packets) of the stream
+        std::vector<uint64_t> keyframes; ///< frame numbers
+        std::vector<int64_t> timestamps; ///< in the stream time base
+        bool seekable; ///< frames are stored in presentation order
+      };
+
+      boost::shared_ptr<const Index> m_index; ///< not built if empty
+
+      /**
+       * Decoded frames, organized as (color-bands, height, width), with their
+       * position in the least recently used order
+       */
+      typedef std::map<size_t, std::pair<blitz::Array<uint8_t,3>,
+              std::list<size_t>::iterator> > cache_type;
+
+      mutable boost::mutex m_cache_mutex; ///< the cache is shared
+      size_t m_cache_size; ///< maximum number of frames in the cache
+      mutable cache_type m_cache; ///< decoded frames
+      mutable std::list<size_t> m_cache_lru; ///< most recently read first
   };
 
 }}
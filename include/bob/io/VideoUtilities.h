@@ -214,6 +214,31 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
       boost::shared_ptr<AVCodecContext> codec_context,
       boost::shared_ptr<AVFrame> context_frame, bool throw_on_error);
 
+  /**
+   * Reads all packets of the video stream, without decoding them. The
+   * number of the frame and the timestamp (in the stream time base) of every
+   * keyframe are appended to 'keyframes' and 'timestamps'. 'ordered' is set
+   * to true if the timestamps of the packets never decrease, i.e., if the
+   * frames are stored in presentation order and one can seek to a keyframe.
+   *
+   * @return the number of frames (packets) of the video stream
+   */
+  uint64_t scan_video_packets (const std::string& filename,
+      int stream_index, boost::shared_ptr<AVFormatContext> format_context,
+      std::vector<uint64_t>& keyframes, std::vector<int64_t>& timestamps,
+      bool& ordered);
+
+  /**
+   * Seeks the video stream to the keyframe with the given timestamp (in the
+   * stream time base) and flushes the decoder, so that the next frame read
+   * is that keyframe.
+   *
+   * @return true if it manages to seek or false otherwise.
+   */
+  bool seek_video_keyframe (int stream_index, int64_t timestamp,
+      boost::shared_ptr<AVFormatContext> format_context,
+      boost::shared_ptr<AVCodecContext> codec_context);
+
   /************************************************************************
    * Video writing specific utilities
    ************************************************************************/
@@ -239,7 +264,9 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
 
   /**
    * Creates a new AVStream on the output file given by the format context
-   * pointer, with the given configurations.
+   * pointer, with the given configurations. If threads is not zero, the
+   * encoder is set to use that many threads, with frame or slice threading,
+   * depending on what the codec supports.
    *
    * @note The returned object knows how to correctly delete itself, freeing
    * all acquired resources. Nonetheless, when this object is used in
@@ -249,7 +276,7 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
   boost::shared_ptr<AVStream> make_stream(const std::string& filename,
       boost::shared_ptr<AVFormatContext> fmtctxt, const std::string& codecname,
       size_t height, size_t width, float framerate, float bitrate, size_t gop,
-      AVCodec* codec);
+      AVCodec* codec, size_t threads=0);
 
   /**
    * Allocates a video buffer (useful for ffmpeg < 0.11)
@@ -298,6 +325,30 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
     boost::shared_array<uint8_t> buffer,
     size_t buffer_size);
 
+  /**
+   * Converts a (C-style contiguous) planar RGB frame into the pixel format
+   * of the encoder, in context_frame. This is the first half of
+   * write_video_frame(). Converting frames concurrently requires one scaler
+   * (and one tmp_frame, if used) per thread.
+   */
+  void convert_video_frame (const blitz::Array<uint8_t,3>& data,
+    boost::shared_ptr<AVStream> stream,
+    boost::shared_ptr<AVFrame> context_frame,
+    boost::shared_ptr<AVFrame> tmp_frame,
+    boost::shared_ptr<SwsContext> swscaler);
+
+  /**
+   * Encodes a frame that was converted with convert_video_frame() and
+   * increments its presentation timestamp. This is the second half of
+   * write_video_frame(). Frames must be encoded in order, by one thread at
+   * a time.
+   */
+  void encode_video_frame (const std::string& filename,
+    boost::shared_ptr<AVFormatContext> format_context,
+    boost::shared_ptr<AVStream> stream,
+    boost::shared_ptr<AVFrame> context_frame,
+    boost::shared_array<uint8_t> buffer,
+    size_t buffer_size);
 
 }}}}
 
@@ -24,6 +24,10 @@
 #ifndef BOB_IO_VIDEOWRITER_H
 #define BOB_IO_VIDEOWRITER_H
 
+#include <deque>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/exception_ptr.hpp>
 #include <bob/core/array.h>
 #include <bob/io/VideoUtilities.h>
 
@@ -31,6 +35,14 @@ namespace bob { namespace io {
 
   /**
    * Use objects of this class to create and write video files.
+   *
+   * By default, frames are converted to the pixel format of the codec and
+   * encoded by the thread calling append(). If threads is set, append()
+   * only copies the frame into a queue of (at most) queue_size frames and
+   * returns: the frames are converted by a pool of threads, then encoded in
+   * order by another thread, with FFmpeg's frame or slice threading. If the
+   * queue is full, append() waits for a frame to be encoded. close() waits
+   * for all frames to be encoded before writing the end of the file.
    */
   class VideoWriter {
 
@@ -58,11 +70,17 @@ namespace bob { namespace io {
        * and codec are known to work and have been tested, otherwise an
        * exception is raised. If you set 'check' to 'false', though, we will
        * ignore this check.
+       * @param threads If not zero, the number of threads converting frames
+       * (and used by the encoder), in which case frames are written
+       * asynchronously.
+       * @param queue_size The maximum number of frames waiting to be
+       * converted or encoded when writing asynchronously. If zero, uses
+       * twice the number of threads.
        */
       VideoWriter(const std::string& filename, size_t height, size_t width,
           double framerate=25., double bitrate=1500000., size_t gop=12,
           const std::string& codec="", const std::string& format="",
-          bool check=true);
+          bool check=true, size_t threads=0, size_t queue_size=0);
 
       /**
        * Destructor virtualization
@@ -71,7 +89,9 @@ namespace bob { namespace io {
 
       /**
        * Closes the current video stream and forces writing the trailer. After
-       * this point the video becomes invalid.
+       * this point the video becomes invalid. Frames still queued are encoded
+       * first, and errors raised while encoding them (that append() did not
+       * raise yet) are re-thrown here.
        */
       void close();
 
@@ -105,6 +125,18 @@ namespace bob { namespace io {
        */
       inline size_t gop() const { return m_gop; }
 
+      /**
+       * Returns the number of threads converting frames (0 if frames are
+       * written synchronously)
+       */
+      inline size_t threads() const { return m_threads; }
+
+      /**
+       * Returns the maximum number of frames queued when writing
+       * asynchronously
+       */
+      inline size_t queueSize() const { return m_slots.size(); }
+
       /**
        * Duration of the video stream, in seconds
        */
@@ -162,7 +194,8 @@ namespace bob { namespace io {
        *
        * \warning At present time we only support arrays that have C-style
        * storages (if you pass reversed arrays or arrays with Fortran-style
-       * storage, the result is undefined).
+       * storage, the result is undefined), unless frames are written
+       * asynchronously, in which case they are copied.
        */
       void append(const blitz::Array<uint8_t,4>& data);
     
@@ -190,6 +223,34 @@ namespace bob { namespace io {
 
       VideoWriter& operator= (const VideoWriter& other);
 
+    private: //methods
+
+      /**
+       * Writes (or queues) a frame that was already checked
+       */
+      void write(const blitz::Array<uint8_t,3>& data);
+
+      /**
+       * Starts the threads converting and encoding queued frames
+       */
+      void start(size_t queue_size);
+
+      /**
+       * Waits for the queued frames to be encoded and stops the threads.
+       * Returns the error raised by them, if not raised by append() already.
+       */
+      boost::exception_ptr stop();
+
+      /**
+       * The body of the threads converting frames
+       */
+      void convert_frames();
+
+      /**
+       * The body of the thread encoding frames
+       */
+      void encode_frames();
+
     private: //representation
       
       std::string m_filename; ///< file being written
@@ -213,6 +274,20 @@ namespace bob { namespace io {
       bob::core::array::typeinfo m_typeinfo_frame;
       size_t m_current_frame;
 
+      // asynchronous writing state, protected by m_mutex
+      struct Slot; ///< a queued frame
+      size_t m_threads; ///< threads converting frames
+      std::vector<boost::shared_ptr<Slot> > m_slots; ///< ring of queued frames
+      boost::thread_group m_pool; ///< converting and encoding threads
+      boost::mutex m_mutex;
+      boost::condition_variable m_cond;
+      std::deque<size_t> m_to_convert; ///< frames waiting for a converter
+      size_t m_queued; ///< frames appended to the queue
+      size_t m_encoded; ///< frames encoded
+      boost::exception_ptr m_error; ///< raised by the threads
+      bool m_error_raised; ///< was m_error raised by append()?
+      bool m_stop; ///< asks the threads to stop
+
   };
 
 }}
@@ -24,6 +24,7 @@
 
 #include <string>
 #include <boost/shared_ptr.hpp>
+#include <blitz/array.h>
 #include "bob/io/HDF5File.h"
 
 namespace bob { namespace machine {
@@ -57,6 +58,23 @@ namespace bob { namespace machine {
        */
       virtual double f_prime_from_f (double a) const =0;
 
+      /**
+       * Replaces every element of z by its activated value. The default
+       * implementation calls f() above for each element. Derived classes
+       * override it with a single array expression, which avoids a virtual
+       * call per element when activating a whole batch of samples.
+       */
+      virtual void f (blitz::Array<double,2>& z) const;
+
+      /**
+       * Computes the derivative of the activation for every element of a,
+       * given the activated values (the output of f()), into d, which must
+       * have the same shape as a. The default implementation calls
+       * f_prime_from_f() above for each element.
+       */
+      virtual void f_prime_from_f (const blitz::Array<double,2>& a,
+          blitz::Array<double,2>& d) const;
+
       /**
        * Saves itself to an HDF5File
        */
@@ -109,6 +127,9 @@ namespace bob { namespace machine {
       virtual double f (double z) const;
       virtual double f_prime (double z) const;
       virtual double f_prime_from_f (double a) const;
+      virtual void f (blitz::Array<double,2>& z) const;
+      virtual void f_prime_from_f (const blitz::Array<double,2>& a,
+          blitz::Array<double,2>& d) const;
       virtual void save(bob::io::HDF5File&) const;
       virtual void load(bob::io::HDF5File&);
       virtual std::string unique_identifier() const;
@@ -128,6 +149,9 @@ namespace bob { namespace machine {
       virtual double f (double z) const;
       virtual double f_prime (double z) const;
       virtual double f_prime_from_f (double a) const;
+      virtual void f (blitz::Array<double,2>& z) const;
+      virtual void f_prime_from_f (const blitz::Array<double,2>& a,
+          blitz::Array<double,2>& d) const;
       double C() const;
       virtual void save(bob::io::HDF5File& f) const;
       virtual void load(bob::io::HDF5File&);
@@ -150,6 +174,9 @@ namespace bob { namespace machine {
       virtual double f (double z) const;
       virtual double f_prime (double z) const;
       virtual double f_prime_from_f (double a) const;
+      virtual void f (blitz::Array<double,2>& z) const;
+      virtual void f_prime_from_f (const blitz::Array<double,2>& a,
+          blitz::Array<double,2>& d) const;
       virtual void save(bob::io::HDF5File& f) const;
       virtual void load(bob::io::HDF5File&);
       virtual std::string unique_identifier() const;
@@ -169,6 +196,9 @@ namespace bob { namespace machine {
       virtual double f (double z) const;
       virtual double f_prime (double z) const;
       virtual double f_prime_from_f (double a) const;
+      virtual void f (blitz::Array<double,2>& z) const;
+      virtual void f_prime_from_f (const blitz::Array<double,2>& a,
+          blitz::Array<double,2>& d) const;
       double C() const;
       double M() const;
       virtual void save(bob::io::HDF5File& f) const;
@@ -193,6 +223,9 @@ namespace bob { namespace machine {
       virtual double f (double z) const;
       virtual double f_prime (double z) const;
       virtual double f_prime_from_f (double a) const;
+      virtual void f (blitz::Array<double,2>& z) const;
+      virtual void f_prime_from_f (const blitz::Array<double,2>& a,
+          blitz::Array<double,2>& d) const;
       virtual void save(bob::io::HDF5File& f) const;
       virtual void load(bob::io::HDF5File&);
       virtual std::string unique_identifier() const;
@@ -378,7 +378,6 @@ class GMMMachine: public Machine<blitz::Array<double,1>, double>
     mutable blitz::Array<double,1> m_cache_log_weights;
     mutable blitz::Array<double,1> m_cache_log_weighted_gaussian_likelihoods;
     mutable blitz::Array<double,1> m_cache_P;
-    mutable blitz::Array<double,2> m_cache_Px;
 
     mutable blitz::Array<double,1> m_cache_mean_supervector;
     mutable blitz::Array<double,1> m_cache_variance_supervector;
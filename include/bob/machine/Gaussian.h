@@ -232,7 +232,7 @@ class Gaussian: public Machine<blitz::Array<double,1>, double>
     void preComputeNLog2Pi();
 
     /**
-     * Computes and stores the value of g_norm,
+     * Computes and stores the value of g_norm and the precision,
      * to later speed up evaluation of logLikelihood()
      * Note: g_norm is defined as follows:
      * log(Gaussian pdf) = log(1/((2pi)^(k/2)(det)^(1/2)) * exp(...))
@@ -258,6 +258,13 @@ class Gaussian: public Machine<blitz::Array<double,1>, double>
      */
     blitz::Array<double,1> m_variance_thresholds;
 
+    /**
+     * The inverse of the variance, which turns the divisions of
+     * logLikelihood() into multiplications
+     * @see bool preComputeConstants()
+     */
+    blitz::Array<double,1> m_precision;
+
     /**
      * A constant that depends only on the feature dimensionality
      * m_n_log2pi = n_inputs * log(2*pi) (used to compute m_gnorm)
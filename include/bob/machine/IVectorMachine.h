@@ -26,6 +26,7 @@
 #include "GMMMachine.h"
 #include "GMMStats.h"
 #include <bob/io/HDF5File.h>
+#include <bob/math/LapackWorkspace.h>
 
 namespace bob { namespace machine {
 /**
@@ -285,6 +286,7 @@ class IVectorMachine: public bob::machine::Machine<bob::machine::GMMStats, blitz
     mutable blitz::Array<double,1> m_tmp_t1;
     mutable blitz::Array<double,1> m_tmp_t2;
     mutable blitz::Array<double,2> m_tmp_tt;
+    mutable bob::math::LapackWorkspace m_workspace;
 };
 
 /**
@@ -110,6 +110,129 @@ double linearScoring(const blitz::Array<double,1>& model,
                    const blitz::Array<double,1>& test_channelOffset,
                    const bool frame_length_normalisation);
 
+/**
+ * Linear scoring engine for a fixed set of enrolled models.
+ *
+ * The UBM-normalised model matrix, <tt>(model - ubm_mean) / ubm_variance</tt>,
+ * is computed once at construction and kept in memory, so that batches of
+ * test statistics can be scored without recomputing it. Scores are computed
+ * with a cache-blocked matrix product, split over several threads, in
+ * double or (optionally) single precision.
+ *
+ * The linearScoring() functions above produce the same scores as this
+ * class, in double precision.
+ */
+class LinearScoring {
+
+  public:
+
+    /**
+     * Builds the engine from mean supervectors
+     *
+     * @param models        list of mean supervector for the client models
+     * @param ubm_mean      mean supervector of the world model
+     * @param ubm_variance  variance supervector of the world model
+     * @param single_precision if true, compute scores in single precision
+     * @param n_threads     number of threads (0 means the number of
+     *                      hardware threads)
+     */
+    LinearScoring(const std::vector<blitz::Array<double,1> >& models,
+                  const blitz::Array<double,1>& ubm_mean,
+                  const blitz::Array<double,1>& ubm_variance,
+                  const bool single_precision=false,
+                  const size_t n_threads=0);
+
+    /**
+     * Builds the engine from GMMMachines
+     *
+     * @param models        list of client models as GMMMachines
+     * @param ubm           world model as a GMMMachine
+     * @param single_precision if true, compute scores in single precision
+     * @param n_threads     number of threads (0 means the number of
+     *                      hardware threads)
+     */
+    LinearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMachine> >& models,
+                  const bob::machine::GMMMachine& ubm,
+                  const bool single_precision=false,
+                  const size_t n_threads=0);
+
+    /**
+     * Replaces the enrolled models and world model
+     */
+    void setModels(const std::vector<blitz::Array<double,1> >& models,
+                   const blitz::Array<double,1>& ubm_mean,
+                   const blitz::Array<double,1>& ubm_variance);
+
+    /**
+     * Scores a batch of test statistics against all models.
+     *
+     * @param test_stats    list of accumulate statistics for each test trial
+     * @param frame_length_normalisation   perform a normalisation by the number of feature vectors
+     * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+     * @warning the output scores matrix should have the correct size (number of models x number of test_stats)
+     */
+    void operator()(const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
+                    const bool frame_length_normalisation,
+                    blitz::Array<double,2>& scores) const;
+
+    /**
+     * Scores a batch of test statistics against all models, removing the
+     * given channel offsets.
+     *
+     * @param test_stats    list of accumulate statistics for each test trial
+     * @param test_channelOffset  list of channel offset (for JFA/ISA for instance)
+     * @param frame_length_normalisation   perform a normalisation by the number of feature vectors
+     * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+     * @warning the output scores matrix should have the correct size (number of models x number of test_stats)
+     */
+    void operator()(const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
+                    const std::vector<blitz::Array<double,1> >& test_channelOffset,
+                    const bool frame_length_normalisation,
+                    blitz::Array<double,2>& scores) const;
+
+    /**
+     * Returns the number of enrolled models
+     */
+    size_t getNModels() const { return m_A.extent(0); }
+
+    /**
+     * Returns the length of the supervectors
+     */
+    size_t getSupervectorLength() const { return m_ubm_mean.extent(0); }
+
+    /**
+     * Returns the cached, UBM-normalised, model matrix (models x CD)
+     */
+    const blitz::Array<double,2>& getModelMatrix() const { return m_A; }
+
+    /**
+     * Gets/Sets if scores are computed in single precision
+     */
+    bool getSinglePrecision() const { return m_single_precision; }
+    void setSinglePrecision(const bool single_precision);
+
+    /**
+     * Gets/Sets the number of threads (0 means the number of hardware threads)
+     */
+    size_t getNThreads() const { return m_n_threads; }
+    void setNThreads(const size_t n_threads) { m_n_threads = n_threads; }
+
+  private:
+
+    template <typename T>
+    void score_(const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
+                const std::vector<blitz::Array<double,1> >* test_channelOffset,
+                const bool frame_length_normalisation,
+                const blitz::Array<T,2>& A,
+                blitz::Array<double,2>& scores) const;
+
+    blitz::Array<double,2> m_A; ///< normalised models (double precision)
+    blitz::Array<float,2> m_A_single; ///< normalised models (single precision)
+    blitz::Array<double,1> m_ubm_mean;
+    bool m_single_precision;
+    size_t m_n_threads;
+};
+
 /**
  * @}
  */
@@ -171,7 +171,9 @@ namespace bob { namespace machine {
        * Forwards data through the network, outputs the values of each output
        * neuron. This variant will take a number of inputs in one single input
        * matrix with inputs arranged row-wise (i.e., every row contains an
-       * individual input).
+       * individual input). Each layer is computed for all inputs at once,
+       * with a single matrix-matrix product and a single (array-level) call
+       * to the activation function.
        *
        * The input and output are NOT checked for compatibility each time. It
        * is your responsibility to do it.
@@ -386,6 +388,7 @@ namespace bob { namespace machine {
       boost::shared_ptr<Activation> m_hidden_activation; ///< currently set activation type
       boost::shared_ptr<Activation> m_output_activation; ///< currently set activation type
       mutable std::vector<blitz::Array<double, 1> > m_buffer; ///< buffer for the outputs of each layer
+      mutable std::vector<blitz::Array<double, 2> > m_batch_buffer; ///< same, for batches of inputs (resized on demand)
   
   };
 
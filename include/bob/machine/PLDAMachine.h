@@ -27,6 +27,7 @@
 #include "Machine.h"
 #include <blitz/array.h>
 #include <bob/io/HDF5File.h>
+#include <bob/math/LapackWorkspace.h>
 #include <map>
 #include <iostream>
 
@@ -418,6 +419,7 @@ class PLDABase
     mutable blitz::Array<double,2> m_tmp_d_ng_1; ///< Cache matrix of size dim_d x dim_g
     mutable blitz::Array<double,2> m_tmp_nf_nf_1; ///< Cache matrix of size dim_f x dim_f
     mutable blitz::Array<double,2> m_tmp_ng_ng_1; ///< Cache matrix of size dim_g x dim_g
+    mutable bob::math::LapackWorkspace m_workspace; ///< Scratch memory of the inversions
 
     // private methods
     void resizeNoInit(const size_t dim_d, const size_t dim_f, const size_t dim_g);
@@ -316,8 +316,8 @@ namespace bob { namespace machine {
       /**
        * Predicts class and scores output for each class on this SVM,
        *
-       * Note: The output array must be lying on contiguous memory. This is
-       * also checked.
+       * Note: Outputs that are not lying on contiguous memory (e.g. slices)
+       * are filled through a contiguous buffer.
        */
       int predictClassAndScores
         (const blitz::Array<double,1>& input,
@@ -335,8 +335,8 @@ namespace bob { namespace machine {
        * but only if the model supports it. Otherwise, throws a run-time
        * exception.
        *
-       * Note: The output array must be lying on contiguous memory. This is
-       * also checked.
+       * Note: Outputs that are not lying on contiguous memory (e.g. slices)
+       * are filled through a contiguous buffer.
        */
       int predictClassAndProbabilities
         (const blitz::Array<double,1>& input, 
@@ -350,6 +350,56 @@ namespace bob { namespace machine {
         (const blitz::Array<double,1>& input,
          blitz::Array<double,1>& probabilities) const;
 
+      /**
+       * Predicts the classes of all rows of the input matrix, one sample per
+       * row. The rows are split over n_threads threads (0 means
+       * bob::core::default_threads()) and each thread converts its samples
+       * into its own node buffer, so this method can be called concurrently
+       * with itself. For machines with a LINEAR kernel, libsvm is bypassed:
+       * the support vectors and the input scaling are collapsed into a
+       * single weight vector per decision function and each sample costs a
+       * single matrix-vector product (see getLinearWeights()). The decision
+       * values computed in this way may differ from the ones of libsvm by
+       * rounding errors.
+       */
+      void predictClasses(const blitz::Array<double,2>& input,
+          blitz::Array<int,1>& labels, size_t n_threads=0) const;
+
+      /**
+       * Same as above, but does not check the input and output sizes
+       */
+      void predictClasses_(const blitz::Array<double,2>& input,
+          blitz::Array<int,1>& labels, size_t n_threads=0) const;
+
+      /**
+       * Predicts the classes and scores of all rows of the input matrix, as
+       * predictClasses() does. Row k of scores receives the scores of input
+       * row k, as in predictClassAndScores().
+       */
+      void predictClassesAndScores(const blitz::Array<double,2>& input,
+          blitz::Array<int,1>& labels, blitz::Array<double,2>& scores,
+          size_t n_threads=0) const;
+
+      /**
+       * Same as above, but does not check the input and output sizes
+       */
+      void predictClassesAndScores_(const blitz::Array<double,2>& input,
+          blitz::Array<int,1>& labels, blitz::Array<double,2>& scores,
+          size_t n_threads=0) const;
+
+      /**
+       * For machines with a LINEAR kernel, returns the weights of each of the
+       * decision functions of the machine, one per row (a single row for
+       * regression, one-class and two-class machines, one row per pair of
+       * classes otherwise, in the libsvm order). The decision value of row p
+       * for a (scaled) input x is dot(getLinearWeights()(p,:), x) +
+       * getLinearBiases()(p). For other kernels, these arrays are empty.
+       */
+      inline const blitz::Array<double,2>& getLinearWeights() const
+      { return m_linear_weights; }
+      inline const blitz::Array<double,1>& getLinearBiases() const
+      { return m_linear_biases; }
+
       /**
        * Saves the current model state to a file. With this variant, the model
        * is saved on simpler libsvm model file that does not include the
@@ -377,6 +427,12 @@ namespace bob { namespace machine {
        */
       void reset();
 
+      /**
+       * Collapses the support vectors of a linear machine into
+       * m_linear_weights and m_linear_biases
+       */
+      void collapseLinear();
+
     private: //representation
 
       boost::shared_ptr<svm_model> m_model; ///< libsvm model pointer
@@ -384,6 +440,8 @@ namespace bob { namespace machine {
       size_t m_input_size; ///< vector size expected as input for the SVM's
       blitz::Array<double,1> m_input_sub; ///< scaling: subtraction
       blitz::Array<double,1> m_input_div; ///< scaling: division
+      blitz::Array<double,2> m_linear_weights; ///< linear kernels only
+      blitz::Array<double,1> m_linear_biases; ///< linear kernels only
 
   };
 
@@ -22,6 +22,7 @@
 #ifndef BOB_MACHINE_ZTNORM_H
 #define BOB_MACHINE_ZTNORM_H
 
+#include <cstddef>
 #include <blitz/array.h>
 
 namespace bob { namespace machine {
@@ -101,6 +102,132 @@ void zNorm(const blitz::Array<double,2>& rawscores_probes_vs_models,
            const blitz::Array<double,2>& rawscores_zprobes_vs_models,
            blitz::Array<double,2>& normalizedscores);
 
+/**
+ * Block-wise ZT-Norm engine. The T-Norm statistics (mean and standard
+ * deviation of the, possibly Z-normalised, T-Norm scores of each enrolled
+ * model) are computed once, after which blocks of probe rows can be
+ * normalised independently. This allows to process score matrices that do
+ * not fit in memory (e.g. read block by block from HDF5 files) and uses
+ * several threads without allocating any full-size temporary.
+ *
+ * The functions ztNorm(), tNorm() and zNorm() are implemented on top of
+ * this class and produce identical results.
+ */
+class ZTNorm {
+
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param n_threads the number of threads to use (0 means the number of
+     * hardware threads available)
+     */
+    ZTNorm(const size_t n_threads=0);
+
+    /**
+     * Disables T-Norm: only Z-Norm (if Z-Norm scores are given to
+     * normalize()) is applied.
+     */
+    void resetTNorm();
+
+    /**
+     * Sets the T-Norm statistics from the raw T-Norm scores, without
+     * Z-normalising them first.
+     *
+     * @param rawscores_probes_vs_tmodels T-Norm scores (tmodels x models)
+     */
+    void setTNormScores(const blitz::Array<double,2>& rawscores_probes_vs_tmodels);
+
+    /**
+     * Sets the T-Norm statistics from the raw T-Norm scores, Z-normalised
+     * using the scores of the Z-Norm probes against the T-Norm models.
+     * Assume that znorm and tnorm have no common subject id.
+     *
+     * @exception std::runtime_error matrix sizes are not consistent
+     *
+     * @param rawscores_probes_vs_tmodels T-Norm scores (tmodels x models)
+     * @param rawscores_zprobes_vs_tmodels (tmodels x zprobes)
+     */
+    void setTNormScores(const blitz::Array<double,2>& rawscores_probes_vs_tmodels,
+                        const blitz::Array<double,2>& rawscores_zprobes_vs_tmodels);
+
+    /**
+     * Sets the T-Norm statistics from the raw T-Norm scores, Z-normalised
+     * using the impostor scores of the Z-Norm probes against the T-Norm
+     * models.
+     *
+     * @exception std::runtime_error matrix sizes are not consistent
+     *
+     * @param rawscores_probes_vs_tmodels T-Norm scores (tmodels x models)
+     * @param rawscores_zprobes_vs_tmodels (tmodels x zprobes)
+     * @param mask_zprobes_vs_tmodels_istruetrial true for genuine trials,
+     *        which are discarded (tmodels x zprobes)
+     */
+    void setTNormScores(const blitz::Array<double,2>& rawscores_probes_vs_tmodels,
+                        const blitz::Array<double,2>& rawscores_zprobes_vs_tmodels,
+                        const blitz::Array<bool,2>& mask_zprobes_vs_tmodels_istruetrial);
+
+    /**
+     * Normalises a block of probes. Z-Norm is applied if
+     * rawscores_zprobes_vs_models has at least one column, T-Norm if the
+     * T-Norm statistics were set.
+     *
+     * @exception std::runtime_error matrix sizes are not consistent
+     *
+     * @param rawscores_probes_vs_models (probes x models)
+     * @param rawscores_zprobes_vs_models Z-Norm scores of the same probes
+     *        (probes x zprobes)
+     * @param[out] normalizedscores normalized scores (probes x models). This
+     *        may refer to the same data as rawscores_probes_vs_models, in
+     *        which case the scores are normalised in place.
+     */
+    void normalize(const blitz::Array<double,2>& rawscores_probes_vs_models,
+                   const blitz::Array<double,2>& rawscores_zprobes_vs_models,
+                   blitz::Array<double,2>& normalizedscores) const;
+
+    /**
+     * Normalises a block of probes using T-Norm only.
+     *
+     * @exception std::runtime_error matrix sizes are not consistent
+     */
+    void normalize(const blitz::Array<double,2>& rawscores_probes_vs_models,
+                   blitz::Array<double,2>& normalizedscores) const;
+
+    /**
+     * Tells if T-Norm statistics are set
+     */
+    bool hasTNorm() const { return m_has_tnorm; }
+
+    /**
+     * Returns the mean of the (Z-normalised) T-Norm scores for each model
+     */
+    const blitz::Array<double,1>& getTNormMean() const { return m_tnorm_mean; }
+
+    /**
+     * Returns the standard deviation of the (Z-normalised) T-Norm scores for
+     * each model
+     */
+    const blitz::Array<double,1>& getTNormStd() const { return m_tnorm_std; }
+
+    /**
+     * Gets/Sets the number of threads (0 means the number of hardware threads)
+     */
+    size_t getNThreads() const { return m_n_threads; }
+    void setNThreads(const size_t n_threads) { m_n_threads = n_threads; }
+
+  private:
+
+    void setTNormScores_(const blitz::Array<double,2>& C,
+                         const blitz::Array<double,2>* D,
+                         const blitz::Array<bool,2>* mask);
+
+    size_t m_n_threads;
+    bool m_has_tnorm;
+    blitz::Array<double,1> m_tnorm_mean;
+    blitz::Array<double,1> m_tnorm_std;
+};
+
 /**
  * @}
  */
@@ -0,0 +1,142 @@
+/**
+ * @file bob/math/LapackWorkspace.h
+ * @date Mon Oct 19 20:03:51 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Scratch memory reused by the LAPACK wrappers across calls
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_MATH_LAPACK_WORKSPACE_H
+#define BOB_MATH_LAPACK_WORKSPACE_H
+
+#include <string>
+#include <vector>
+#include <blitz/array.h>
+
+namespace bob { namespace math {
+/**
+ * @ingroup MATH
+ * @{
+ */
+
+/**
+ * @brief Scratch memory for the LAPACK wrappers of bob::math (inv_(),
+ * linsolve_(), linsolveSympos_(), eigSym_(), svd_(), chol_(), cholSolve_()
+ * and cholInv_()), which accept it as their last parameter.
+ *
+ * The column-major copies of the inputs, the pivots and the LAPACK work
+ * arrays are kept between calls and only grow, and the optimal size of the
+ * work arrays is only queried once per routine and problem size. Calling
+ * these functions repeatedly with the same workspace (e.g. once per sample
+ * in a training loop) therefore does not allocate memory after the first
+ * call.
+ *
+ * A workspace must not be used by two threads at the same time: keep one
+ * per thread.
+ */
+class LapackWorkspace
+{
+  public:
+
+    /**
+     * @brief Creates an empty workspace
+     */
+    LapackWorkspace();
+
+    /**
+     * @brief Copy constructor. Scratch memory is not copied.
+     */
+    LapackWorkspace(const LapackWorkspace& other);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~LapackWorkspace();
+
+    /**
+     * @brief Assignment operator. Scratch memory is not copied.
+     */
+    LapackWorkspace& operator=(const LapackWorkspace& other);
+
+    /**
+     * @brief Scratch of (at least) n doubles (slots 0 to 4) or ints (slots 0
+     * and 1). The memory of a slot is only valid until the next request for
+     * the same slot.
+     */
+    double* doubles(size_t slot, size_t n);
+    int* ints(size_t slot, size_t n);
+
+    /**
+     * @brief Copies A in column-major (Fortran) order into the given slot
+     * of doubles and returns a pointer to it
+     */
+    double* columnMajor(size_t slot, const blitz::Array<double,2>& A);
+
+    /**
+     * @brief Copies a into the given slot of doubles and returns a pointer
+     * to it
+     */
+    double* vector(size_t slot, const blitz::Array<double,1>& a);
+
+    /**
+     * @brief Copies a column-major matrix (e.g. the result of a LAPACK
+     * function) into A
+     */
+    static void fromColumnMajor(const double* data, blitz::Array<double,2>& A);
+
+    /**
+     * @brief Copies a vector into a
+     */
+    static void fromVector(const double* data, blitz::Array<double,1>& a);
+
+    /**
+     * @brief The optimal size of the work arrays of a LAPACK routine for a
+     * given problem size, as cached by setWorkSize(). Returns false if it
+     * was not cached yet.
+     */
+    bool getWorkSize(const char* routine, int M, int N, int& lwork,
+        int& liwork) const;
+
+    /**
+     * @brief Caches the optimal size of the work arrays of a LAPACK routine
+     * for a given problem size
+     */
+    void setWorkSize(const char* routine, int M, int N, int lwork,
+        int liwork);
+
+  private:
+
+    struct WorkSize {
+      std::string routine;
+      int M;
+      int N;
+      int lwork;
+      int liwork;
+    };
+
+    std::vector<double> m_doubles[5]; ///< scratch doubles
+    std::vector<int> m_ints[2]; ///< scratch ints
+    std::vector<WorkSize> m_work_sizes; ///< cached work array sizes
+
+};
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_MATH_LAPACK_WORKSPACE_H */
@@ -0,0 +1,198 @@
+/**
+ * @file bob/math/ScatterAccumulator.h
+ * @date Mon Oct 19 18:05:12 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Blocked, multi-threaded accumulation of the (within- and between-
+ * class) scatter matrices of data given in chunks
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_MATH_SCATTER_ACCUMULATOR_H
+#define BOB_MATH_SCATTER_ACCUMULATOR_H
+
+#include <vector>
+#include <stdint.h>
+#include <blitz/array.h>
+
+namespace bob { namespace math {
+/**
+ * @ingroup MATH
+ * @{
+ */
+
+/**
+ * @brief Accumulates the within-class scatter matrix Sw, the class means and
+ * the class counts of samples (one per row) given in chunks, so that Sw, the
+ * between-class scatter Sb and the total scatter St = Sw + Sb can be
+ * computed without keeping the samples in memory. With a single class, Sw
+ * is the scatter matrix of the data, as given by bob::math::scatter().
+ *
+ * Each chunk is centered on its own mean in blocks of rows, whose products
+ * \f$B^T B\f$ (symmetric rank-k updates) are added to the upper triangle of
+ * Sw by several threads, each owning a different set of tiles of Sw and
+ * multiplying the columns of its tiles with bob::math::prod_() (the BLAS). The
+ * shift between the chunk mean and the current class mean is accounted for
+ * by one extra (rank-1) row per chunk. Only Sw is a F x F matrix: the memory
+ * usage does not depend on the number of classes or samples.
+ *
+ * Results are deterministic and do not depend on the number of threads.
+ */
+class ScatterAccumulator
+{
+  public:
+
+    /**
+     * @brief Creates an empty accumulator
+     *
+     * @param n_features The number of features (columns) of the samples
+     * @param n_classes The number of classes
+     * @param n_threads The number of threads to use (0 means
+     * bob::core::default_threads())
+     *
+     * @exception std::runtime_error if n_features or n_classes is 0
+     */
+    ScatterAccumulator(size_t n_features, size_t n_classes=1,
+        size_t n_threads=0);
+
+    /**
+     * @brief Copy constructor
+     */
+    ScatterAccumulator(const ScatterAccumulator& other);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~ScatterAccumulator();
+
+    /**
+     * @brief Assignment operator
+     */
+    ScatterAccumulator& operator=(const ScatterAccumulator& other);
+
+    /**
+     * @brief Accumulates a chunk of samples (one per row) of a given class
+     *
+     * @exception std::runtime_error if the number of columns is not
+     * getNFeatures() or the class index is out of range
+     */
+    void add(const blitz::Array<double,2>& X, size_t k=0);
+
+    /**
+     * @brief Accumulates data given as one 2D array per class, in a single
+     * pass over the samples
+     *
+     * @exception std::runtime_error if the number of arrays is not
+     * getNClasses() or their number of columns is not getNFeatures()
+     */
+    void add(const std::vector<blitz::Array<double,2> >& data);
+
+    /**
+     * @brief Accumulates all samples accumulated by another accumulator
+     *
+     * @exception std::runtime_error if the number of features or classes
+     * differs
+     */
+    void merge(const ScatterAccumulator& other);
+
+    /**
+     * @brief Forgets all samples
+     */
+    void reset();
+
+    /**
+     * @brief The within-class scatter matrix Sw
+     */
+    void getWithinScatter(blitz::Array<double,2>& Sw) const;
+
+    /**
+     * @brief The between-class scatter matrix Sb
+     */
+    void getBetweenScatter(blitz::Array<double,2>& Sb) const;
+
+    /**
+     * @brief The total scatter matrix St = Sw + Sb
+     */
+    void getTotalScatter(blitz::Array<double,2>& St) const;
+
+    /**
+     * @brief The overall mean of all samples
+     */
+    void getMean(blitz::Array<double,1>& m) const;
+
+    /**
+     * @brief The mean of each class (one per column)
+     */
+    const blitz::Array<double,2>& getClassMeans() const { return m_means; }
+
+    /**
+     * @brief The number of samples of each class
+     */
+    const blitz::Array<uint64_t,1>& getClassCounts() const
+    { return m_counts; }
+
+    /**
+     * @brief The total number of samples
+     */
+    uint64_t getNSamples() const;
+
+    size_t getNFeatures() const { return m_sw.extent(0); }
+    size_t getNClasses() const { return m_counts.extent(0); }
+
+    /**
+     * @brief The number of threads (0 means bob::core::default_threads())
+     */
+    size_t getNThreads() const { return m_n_threads; }
+    void setNThreads(size_t n) { m_n_threads = n; }
+
+    /**
+     * @brief The number of rows that are centered and accumulated at once
+     * (defaults to 256)
+     *
+     * @exception std::runtime_error if set to 0
+     */
+    size_t getBlockSize() const { return m_block_size; }
+    void setBlockSize(size_t n);
+
+  private:
+
+    /**
+     * @brief Adds the product of the first n_rows of m_block with themselves
+     * to the upper triangle of m_sw
+     */
+    void accumulate(size_t n_rows);
+
+    /**
+     * @brief Updates the mean and count of class k and adds the rank-1
+     * correction for the shift of the mean to the upper triangle of m_sw
+     */
+    void shift(size_t k, uint64_t n, const blitz::Array<double,1>& mean);
+
+    blitz::Array<double,2> m_sw; ///< within-class scatter (upper triangle)
+    blitz::Array<double,2> m_means; ///< class means (one per column)
+    blitz::Array<uint64_t,1> m_counts; ///< class counts
+    size_t m_n_threads; ///< number of threads
+    size_t m_block_size; ///< number of rows per block
+    blitz::Array<double,2> m_block; ///< scratch: a block of centered rows
+
+};
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_MATH_SCATTER_ACCUMULATOR_H */
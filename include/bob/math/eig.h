@@ -27,6 +27,7 @@
 
 #include <blitz/array.h>
 #include <complex>
+#include <bob/math/LapackWorkspace.h>
 
 namespace bob { namespace math {
 
@@ -101,6 +102,13 @@ namespace bob { namespace math {
   void eigSym_(const blitz::Array<double,2>& A, blitz::Array<double,2>& V, 
       blitz::Array<double,1>& D);
 
+  /**
+   * @brief Same as eigSym_(), but reuses the scratch memory of the given
+   * workspace, which avoids allocations when called repeatedly.
+   */
+  void eigSym_(const blitz::Array<double,2>& A, blitz::Array<double,2>& V,
+      blitz::Array<double,1>& D, LapackWorkspace& ws);
+
   /**
    * @brief Computes all the eigenvalues and the eigenvectors of a real
    * generalized symmetric-definite eigenproblem, of the form:
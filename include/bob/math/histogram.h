@@ -25,6 +25,7 @@
 #define BOB_MATH_HISTOGRAM_H
 
 #include <bob/core/assert.h>
+#include <bob/core/array_copy.h>
 #include <blitz/array.h>
 #include <numeric>
 #include <functional>
@@ -62,6 +63,9 @@ namespace bob{ namespace math{
     template <class T>
       //! Fast implementation of the histogram intersection measure
       inline T histogram_intersection(const blitz::Array<T,1>& h1, const blitz::Array<T,1>& h2){
+        // strided histograms (e.g. slices) are copied to contiguous memory first
+        if (!bob::core::array::isCContiguous(h1) || !bob::core::array::isCContiguous(h2))
+          return histogram_intersection<T>(bob::core::array::ccopy(h1), bob::core::array::ccopy(h2));
         bob::core::array::assertCContiguous(h1);
         bob::core::array::assertCContiguous(h2);
         bob::core::array::assertSameShape(h1,h2);
@@ -102,6 +106,9 @@ namespace bob{ namespace math{
     template <class T>
       //! Fast implementation of the chi square histogram distance measure
       inline T chi_square(const blitz::Array<T,1>& h1, const blitz::Array<T,1>& h2){
+        // strided histograms (e.g. slices) are copied to contiguous memory first
+        if (!bob::core::array::isCContiguous(h1) || !bob::core::array::isCContiguous(h2))
+          return chi_square<T>(bob::core::array::ccopy(h1), bob::core::array::ccopy(h2));
         bob::core::array::assertCContiguous(h1);
         bob::core::array::assertCContiguous(h2);
         bob::core::array::assertSameShape(h1,h2);
@@ -149,6 +156,9 @@ namespace bob{ namespace math{
     template <class T>
       //! Fast implementation of the symmetric Kullback-Leibler histogram divergence measure (a distance measure)
       inline double kullback_leibler(const blitz::Array<T,1>& h1, const blitz::Array<T,1>& h2){
+        // strided histograms (e.g. slices) are copied to contiguous memory first
+        if (!bob::core::array::isCContiguous(h1) || !bob::core::array::isCContiguous(h2))
+          return kullback_leibler<T>(bob::core::array::ccopy(h1), bob::core::array::ccopy(h2));
         bob::core::array::assertCContiguous(h1);
         bob::core::array::assertCContiguous(h2);
         bob::core::array::assertSameShape(h1,h2);
@@ -24,6 +24,7 @@
 #define BOB_MATH_INV_H
 
 #include <blitz/array.h>
+#include <bob/math/LapackWorkspace.h>
 
 namespace bob { namespace math {
 /**
@@ -40,6 +41,13 @@ namespace bob { namespace math {
 void inv(const blitz::Array<double,2>& A, blitz::Array<double,2>& B);
 void inv_(const blitz::Array<double,2>& A, blitz::Array<double,2>& B);
 
+/**
+ * @brief Same as inv_(), but reuses the scratch memory of the given
+ *   workspace, which avoids allocations when called repeatedly.
+ */
+void inv_(const blitz::Array<double,2>& A, blitz::Array<double,2>& B,
+  LapackWorkspace& ws);
+
 /**
  * @}
  */
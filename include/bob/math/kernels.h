@@ -0,0 +1,80 @@
+/**
+ * @file bob/math/kernels.h
+ * @date Mon Oct 19 21:14:02 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Vectorisable kernels on contiguous arrays of doubles, used in the
+ * innermost loops of the statistical machines (e.g. Gaussian mixtures)
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_MATH_KERNELS_H
+#define BOB_MATH_KERNELS_H
+
+#include <cstddef>
+#include <blitz/array.h>
+
+namespace bob { namespace math {
+/**
+ * @ingroup MATH
+ * @{
+ */
+
+/**
+ * @brief Computes the Mahalanobis distance of x to a mean, for a diagonal
+ * covariance given by its precision (the inverse of the variance):
+ * sum_i (x_i - mean_i)^2 * precision_i. The n elements of each input must
+ * be contiguous in memory.
+ */
+double mahalanobisDiag(const double* x, const double* mean,
+  const double* precision, size_t n);
+
+/**
+ * @brief Same as above, for blitz arrays. The mean and precision must be
+ * contiguous, x may be strided.
+ * @warning The dimensions of the inputs are not checked
+ */
+double mahalanobisDiag_(const blitz::Array<double,1>& x,
+  const blitz::Array<double,1>& mean, const blitz::Array<double,1>& precision);
+
+/**
+ * @brief Computes y_i = exp(x_i) for the n (contiguous) elements of x,
+ * with a relative error below 1e-15. Inputs smaller than -708 (of which
+ * the exponential is not a normal double) give 0. x and y may be the same
+ * array.
+ */
+void fastExp(const double* x, double* y, size_t n);
+
+/**
+ * @brief Computes y_i = log(x_i) for the n (contiguous) elements of x,
+ * with a relative error below 1e-15. x and y may be the same array.
+ */
+void fastLog(const double* x, double* y, size_t n);
+
+/**
+ * @brief Computes the exponential (resp. the logarithm) of the elements of
+ * x into y.
+ * @warning The dimensions of the inputs are not checked
+ */
+void fastExp_(const blitz::Array<double,1>& x, blitz::Array<double,1>& y);
+void fastLog_(const blitz::Array<double,1>& x, blitz::Array<double,1>& y);
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_MATH_KERNELS_H */
@@ -27,6 +27,7 @@
 #include <blitz/array.h>
 #include <bob/core/assert.h>
 #include <algorithm>
+#include <stdint.h>
 
 /**
  * @addtogroup MATH math
@@ -42,6 +43,97 @@ namespace math {
    * @{
    */
 
+  /**
+   * @brief Enables or disables the use of the BLAS by the double precision
+   * variants of prod_() and prod() (enabled by default)
+   */
+  void set_use_blas(bool use);
+
+  /**
+   * @brief Tells if the double precision variants of prod_() and prod() use
+   * the BLAS
+   */
+  bool use_blas();
+
+  /**
+   * @brief Sets the minimum number of multiply-adds a product should require
+   * to be computed by the BLAS. Smaller products are computed with blitz
+   * expressions, which avoid the call overhead. The bob_math_benchmark_prod
+   * program shows the crossover point on a given machine.
+   */
+  void set_blas_threshold(uint64_t n);
+
+  /**
+   * @brief The minimum number of multiply-adds a product should require to
+   * be computed by the BLAS
+   */
+  uint64_t blas_threshold();
+
+  namespace detail {
+
+    /**
+     * @brief Products computed with blitz expressions, for any type and
+     * memory layout
+     */
+    template<typename T1, typename T2, typename T3>
+      void prod_blitz_(const blitz::Array<T1,2>& A,
+          const blitz::Array<T2,2>& B, blitz::Array<T3,2>& C) {
+        blitz::firstIndex i;
+        blitz::secondIndex j;
+        blitz::thirdIndex k;
+        C = blitz::sum(A(i,k) * B(k,j), k);
+      }
+
+    template<typename T1, typename T2, typename T3>
+      void prod_blitz_(const blitz::Array<T1,2>& A,
+          const blitz::Array<T2,1>& b, blitz::Array<T3,1>& c) {
+        blitz::firstIndex i;
+        blitz::secondIndex j;
+        c = blitz::sum(A(i,j) * b(j), j);
+      }
+
+    template<typename T1, typename T2, typename T3>
+      void prod_blitz_(const blitz::Array<T1,1>& a,
+          const blitz::Array<T2,2>& B, blitz::Array<T3,1>& c) {
+        blitz::firstIndex i;
+        blitz::secondIndex j;
+        c = blitz::sum(a(j) * B(j,i), j);
+      }
+
+    template<typename T1, typename T2, typename T3>
+      void prod_blitz_(const blitz::Array<T1,1>& a,
+          const blitz::Array<T2,1>& b, blitz::Array<T3,2>& C) {
+        blitz::firstIndex i;
+        blitz::secondIndex j;
+        C = a(i) * b(j);
+      }
+
+  }
+
+  /**
+   * @brief Double precision matrix multiplication C=A*B, matrix-vector
+   * multiplication c=A*b, vector-matrix multiplication c=a*B and outer
+   * product C=a*b'.
+   *
+   * These call the BLAS (dgemm, dgemv and dger) when all arrays are laid out
+   * as the BLAS expects, i.e., C or Fortran ordered matrices with unit stride
+   * along one dimension and vectors with positive strides. Slices of such
+   * matrices (e.g. a range of rows or columns) qualify. Other arrays, and
+   * products smaller than blas_threshold(), are computed with blitz
+   * expressions.
+   *
+   * @warning No checks are performed on the array sizes. The output should
+   * not overlap the inputs.
+   */
+  void prod_(const blitz::Array<double,2>& A, const blitz::Array<double,2>& B,
+      blitz::Array<double,2>& C);
+  void prod_(const blitz::Array<double,2>& A, const blitz::Array<double,1>& b,
+      blitz::Array<double,1>& c);
+  void prod_(const blitz::Array<double,1>& a, const blitz::Array<double,2>& B,
+      blitz::Array<double,1>& c);
+  void prod_(const blitz::Array<double,1>& a, const blitz::Array<double,1>& b,
+      blitz::Array<double,2>& C);
+
   /**
    * @brief Performs the matrix multiplication C=A*B
    *
@@ -56,10 +148,7 @@ namespace math {
   template<typename T1, typename T2, typename T3>
     void prod_(const blitz::Array<T1,2>& A, const blitz::Array<T2,2>& B,
         blitz::Array<T3,2>& C) {
-      blitz::firstIndex i;
-      blitz::secondIndex j;
-      blitz::thirdIndex k;
-      C = blitz::sum(A(i,k) * B(k,j), k);
+      detail::prod_blitz_(A, B, C);
     }
 
   /**
@@ -103,9 +192,7 @@ namespace math {
   template<typename T1, typename T2, typename T3>
     void prod_(const blitz::Array<T1,2>& A, const blitz::Array<T2,1>& b,
         blitz::Array<T3,1>& c) {
-      blitz::firstIndex i;
-      blitz::secondIndex j;
-      c = blitz::sum(A(i,j) * b(j), j);
+      detail::prod_blitz_(A, b, c);
     }
 
   /**
@@ -148,9 +235,7 @@ namespace math {
   template<typename T1, typename T2, typename T3>
     void prod_(const blitz::Array<T1,1>& a, const blitz::Array<T2,2>& B,
         blitz::Array<T3,1>& c) {
-      blitz::firstIndex i;
-      blitz::secondIndex j;
-      c = blitz::sum(a(j) * B(j,i), j);
+      detail::prod_blitz_(a, B, c);
     }
 
   /**
@@ -193,9 +278,7 @@ namespace math {
   template<typename T1, typename T2, typename T3>
     void prod_(const blitz::Array<T1,1>& a, const blitz::Array<T2,1>& b,
         blitz::Array<T3,2>& C) {
-      blitz::firstIndex i;
-      blitz::secondIndex j;
-      C = a(i) * b(j);
+      detail::prod_blitz_(a, b, C);
     }
 
   /**
@@ -25,6 +25,7 @@
 #define BOB_MATH_LINSOLVE_H
 
 #include <blitz/array.h>
+#include <bob/math/LapackWorkspace.h>
 
 namespace bob { namespace math {
 
@@ -45,6 +46,8 @@ namespace bob { namespace math {
       const blitz::Array<double,1>& b);
     void linsolve_(const blitz::Array<double,2>& A, blitz::Array<double,1>& x,
       const blitz::Array<double,1>& b);
+    void linsolve_(const blitz::Array<double,2>& A, blitz::Array<double,1>& x,
+      const blitz::Array<double,1>& b, LapackWorkspace& ws);
 
     /**
      * @brief Function which solves a linear system of equation using the
@@ -58,6 +61,8 @@ namespace bob { namespace math {
       const blitz::Array<double,2>& B);
     void linsolve_(const blitz::Array<double,2>& A, blitz::Array<double,2>& X,
       const blitz::Array<double,2>& B);
+    void linsolve_(const blitz::Array<double,2>& A, blitz::Array<double,2>& X,
+      const blitz::Array<double,2>& B, LapackWorkspace& ws);
 
     /**
      * @brief Function which solves a symmetric positive definite linear 
@@ -74,6 +79,9 @@ namespace bob { namespace math {
       blitz::Array<double,1>& x, const blitz::Array<double,1>& b); 
     void linsolveSympos_(const blitz::Array<double,2>& A, 
       blitz::Array<double,1>& x, const blitz::Array<double,1>& b); 
+    void linsolveSympos_(const blitz::Array<double,2>& A,
+      blitz::Array<double,1>& x, const blitz::Array<double,1>& b,
+      LapackWorkspace& ws);
 
     /**
      * @brief Function which solves a symmetric positive definite linear 
@@ -90,6 +98,9 @@ namespace bob { namespace math {
       blitz::Array<double,2>& X, const blitz::Array<double,2>& B); 
     void linsolveSympos_(const blitz::Array<double,2>& A, 
       blitz::Array<double,2>& X, const blitz::Array<double,2>& B); 
+    void linsolveSympos_(const blitz::Array<double,2>& A,
+      blitz::Array<double,2>& X, const blitz::Array<double,2>& B,
+      LapackWorkspace& ws);
 
 
     /**
@@ -23,6 +23,8 @@
 
 #include <cmath>
 #include <limits>
+#include <cstddef>
+#include <blitz/array.h>
 
 namespace bob { namespace math {
 
@@ -43,6 +45,14 @@ namespace Log
   
   double logAdd(double log_a, double log_b);
   double logSub(double log_a, double log_b);
+
+  /**
+   * Computes log(sum_i exp(log_a_i)) from the n (contiguous) values log_a_i
+   * in one pass, which is faster and more accurate than repeated calls to
+   * logAdd(). Returns LogZero if n is 0 or if all values are LogZero.
+   */
+  double logSumExp(const double* log_a, size_t n);
+  double logSumExp(const blitz::Array<double,1>& log_a);
 }
 
 }}
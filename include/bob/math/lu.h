@@ -22,6 +22,7 @@
 #define BOB_MATH_LU_H
 
 #include <blitz/array.h>
+#include <bob/math/LapackWorkspace.h>
 
 namespace bob { namespace math {
 /**
@@ -54,6 +55,52 @@ namespace bob { namespace math {
    */
   void chol(const blitz::Array<double,2>& A, blitz::Array<double,2>& L);
   void chol_(const blitz::Array<double,2>& A, blitz::Array<double,2>& L);
+  void chol_(const blitz::Array<double,2>& A, blitz::Array<double,2>& L,
+    LapackWorkspace& ws);
+
+  /**
+   * @brief Solves the system A*x=b, given the Cholesky factor L of the
+   *   symmetric positive-definite matrix A = L*L^{T} (as computed by
+   *   chol()), using the dpotrs LAPACK function. Once A is factorized, this
+   *   costs O(N^2) per right-hand side.
+   * @param L The lower-triangular Cholesky factor of A (size NxN)
+   * @param x The solution of the system (size N)
+   * @param b The right-hand side of the system (size N)
+   */
+  void cholSolve(const blitz::Array<double,2>& L, blitz::Array<double,1>& x,
+    const blitz::Array<double,1>& b);
+  void cholSolve_(const blitz::Array<double,2>& L, blitz::Array<double,1>& x,
+    const blitz::Array<double,1>& b);
+  void cholSolve_(const blitz::Array<double,2>& L, blitz::Array<double,1>& x,
+    const blitz::Array<double,1>& b, LapackWorkspace& ws);
+
+  /**
+   * @brief Solves the system A*X=B, given the Cholesky factor L of the
+   *   symmetric positive-definite matrix A = L*L^{T} (as computed by
+   *   chol()), using the dpotrs LAPACK function.
+   * @param L The lower-triangular Cholesky factor of A (size NxN)
+   * @param X The solution of the system (size NxP)
+   * @param B The right-hand sides of the system (size NxP)
+   */
+  void cholSolve(const blitz::Array<double,2>& L, blitz::Array<double,2>& X,
+    const blitz::Array<double,2>& B);
+  void cholSolve_(const blitz::Array<double,2>& L, blitz::Array<double,2>& X,
+    const blitz::Array<double,2>& B);
+  void cholSolve_(const blitz::Array<double,2>& L, blitz::Array<double,2>& X,
+    const blitz::Array<double,2>& B, LapackWorkspace& ws);
+
+  /**
+   * @brief Computes the inverse of a symmetric positive-definite matrix from
+   *   its Cholesky decomposition, using the dpotrf and dpotri LAPACK
+   *   functions. This is about twice as fast as the LU-based inv() and
+   *   the result is exactly symmetric.
+   * @param A The symmetric positive-definite matrix to invert (size NxN)
+   * @param B The B=inverse(A) matrix (size NxN)
+   */
+  void cholInv(const blitz::Array<double,2>& A, blitz::Array<double,2>& B);
+  void cholInv_(const blitz::Array<double,2>& A, blitz::Array<double,2>& B);
+  void cholInv_(const blitz::Array<double,2>& A, blitz::Array<double,2>& B,
+    LapackWorkspace& ws);
 /**
  * @}
  */
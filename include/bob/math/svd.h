@@ -25,6 +25,7 @@
 #define BOB_MATH_SVD_H
 
 #include <blitz/array.h>
+#include <bob/math/LapackWorkspace.h>
 
 namespace bob { namespace math {
 /**
@@ -89,6 +90,13 @@ namespace bob { namespace math {
     void svd_(const blitz::Array<double,2>& A, blitz::Array<double,2>& U, 
       blitz::Array<double,1>& sigma);
 
+    /**
+     * @brief Same as the 'partial' svd_(), but reuses the scratch memory of
+     *   the given workspace, which avoids allocations when called repeatedly.
+     */
+    void svd_(const blitz::Array<double,2>& A, blitz::Array<double,2>& U,
+      blitz::Array<double,1>& sigma, LapackWorkspace& ws);
+
 
     /**
      * @brief Function which performs a 'partial' Singular Value Decomposition
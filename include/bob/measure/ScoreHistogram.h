@@ -0,0 +1,230 @@
+/**
+ * @file bob/measure/ScoreHistogram.h
+ * @date Mon Oct 19 14:37:08 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief A bounded-memory accumulator of negative and positive scores, from
+ * which approximate error rates, curves and operating points can be
+ * computed, together with bounds on their error.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_MEASURE_SCOREHISTOGRAM_H
+#define BOB_MEASURE_SCOREHISTOGRAM_H
+
+#include <blitz/array.h>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+namespace bob { namespace measure {
+
+  /**
+   * Accumulates negative and positive scores, in chunks, into two histograms
+   * that share the same bins. Memory usage is fixed by the number of bins
+   * and does not depend on the number of scores.
+   *
+   * The bins have a width that is a power of two and their edges are
+   * multiples of that width. When a score falls outside the current range,
+   * the width is doubled (merging pairs of bins) as many times as needed.
+   * Because all bin grids are nested, two accumulators with the same number
+   * of bins (e.g. filled by parallel jobs on parts of the scores) can be
+   * merged without any additional loss of resolution.
+   *
+   * Error rates follow the conventions of bob::measure::farfrr(). At a bin
+   * edge they are exact. Inside a bin, scores are assumed to be uniformly
+   * distributed; the true values lie between the values at the two edges of
+   * the bin, which are returned by farBounds() and frrBounds(). The largest
+   * possible error of any FAR (FRR) estimate is the largest fraction of
+   * negatives (positives) that fall into a single bin, returned by
+   * farError() (frrError()).
+   */
+  class ScoreHistogram {
+
+    public:
+
+      /**
+       * Creates an empty accumulator with the given number of bins
+       *
+       * @exception std::runtime_error if n_bins < 2
+       */
+      ScoreHistogram(size_t n_bins=65536);
+
+      /**
+       * Restores an accumulator from its counts per bin, the lower edge of
+       * its first bin, the width of its bins and the minimum and maximum
+       * scores, as returned by the getters of another accumulator (e.g. to
+       * load one from a file)
+       *
+       * @exception std::runtime_error if the number of bins differs or is
+       * smaller than 2, or if the width is neither 0 (no scores) nor a power
+       * of two
+       */
+      ScoreHistogram(const blitz::Array<uint64_t,1>& negatives,
+          const blitz::Array<uint64_t,1>& positives, double lower,
+          double width, double min, double max);
+
+      /**
+       * Copy constructor (the counts are copied)
+       */
+      ScoreHistogram(const ScoreHistogram& other);
+
+      /**
+       * Assignment (the counts are copied)
+       */
+      ScoreHistogram& operator=(const ScoreHistogram& other);
+
+      /**
+       * Accumulates a chunk of negative (positive) scores
+       *
+       * @exception std::runtime_error if any of the scores is not finite
+       */
+      void addNegatives(const blitz::Array<double,1>& negatives);
+      void addPositives(const blitz::Array<double,1>& positives);
+
+      /**
+       * Accumulates all scores accumulated by another accumulator
+       *
+       * @exception std::runtime_error if the number of bins differs
+       */
+      void merge(const ScoreHistogram& other);
+
+      /**
+       * Removes all scores (the number of bins is kept)
+       */
+      void reset();
+
+      /**
+       * The estimated FA and FR ratios at the given threshold
+       */
+      std::pair<double, double> farfrr(double threshold) const;
+
+      /**
+       * The lowest and highest possible FA (FR) ratio at the given threshold
+       */
+      std::pair<double, double> farBounds(double threshold) const;
+      std::pair<double, double> frrBounds(double threshold) const;
+
+      /**
+       * The largest possible absolute error of any FA (FR) ratio estimate
+       */
+      double farError() const;
+      double frrError() const;
+
+      /**
+       * The estimated ROC curve at points thresholds uniformly distributed in
+       * [getMin(), getMax()], as in bob::measure::roc(). Row 0 holds the FRR
+       * and row 1 the FAR.
+       */
+      blitz::Array<double,2> roc(size_t points) const;
+
+      /**
+       * The estimated DET curve, as in bob::measure::det().
+       */
+      blitz::Array<double,2> det(size_t points) const;
+
+      /**
+       * The threshold at which the estimated FAR and FRR are equal
+       */
+      double eerThreshold() const;
+
+      /**
+       * The estimated equal-error-rate. The exact value (as computed by
+       * bob::measure::SortedScores::eer()) is within
+       * max(farError(), frrError()) of this estimate.
+       */
+      double eer() const;
+
+      /**
+       * The threshold minimizing the estimated cost * FAR + (1-cost) * FRR.
+       * The cost is clipped to the interval [0, 1].
+       */
+      double minWeightedErrorRateThreshold(double cost) const;
+
+      /**
+       * The threshold minimizing the estimated HTER
+       */
+      double minHterThreshold() const {
+        return minWeightedErrorRateThreshold(0.5);
+      }
+
+      /**
+       * The number of bins
+       */
+      size_t getNBins() const { return m_negatives.extent(0); }
+
+      /**
+       * The number of negatives and positives accumulated so far
+       */
+      uint64_t getNNegatives() const { return m_n_negatives; }
+      uint64_t getNPositives() const { return m_n_positives; }
+
+      /**
+       * The minimum and maximum over all scores accumulated so far
+       */
+      double getMin() const;
+      double getMax() const;
+
+      /**
+       * The lower edge of the first bin and the width of the bins
+       */
+      double getLowerBound() const { return m_lower; }
+      double getBinWidth() const { return m_width; }
+
+      /**
+       * The number of negatives and positives in each bin
+       */
+      const blitz::Array<uint64_t,1>& getNegativeCounts() const
+      { return m_negatives; }
+      const blitz::Array<uint64_t,1>& getPositiveCounts() const
+      { return m_positives; }
+
+    private:
+
+      /**
+       * Makes sure the bins cover [min, max] and are at least min_width
+       * wide, widening them if required
+       */
+      void cover(double min, double max, double min_width);
+
+      void add(const blitz::Array<double,1>& scores,
+          blitz::Array<uint64_t,1>& counts, uint64_t& total);
+
+      /**
+       * The FA and FR ratios at the lower edge of each bin (and at the upper
+       * edge of the last bin), which are exact
+       */
+      void edgeRates(std::vector<double>& far, std::vector<double>& frr) const;
+
+      /**
+       * The position of the threshold in bin units, clipped to [0, n_bins]
+       */
+      double position(double threshold) const;
+
+      blitz::Array<uint64_t,1> m_negatives; ///< negatives per bin
+      blitz::Array<uint64_t,1> m_positives; ///< positives per bin
+      uint64_t m_n_negatives; ///< total number of negatives
+      uint64_t m_n_positives; ///< total number of positives
+      double m_lower; ///< lower edge of the first bin
+      double m_width; ///< width of the bins (a power of two)
+      double m_min; ///< minimum score
+      double m_max; ///< maximum score
+
+  };
+
+}}
+
+#endif /* BOB_MEASURE_SCOREHISTOGRAM_H */
@@ -0,0 +1,268 @@
+/**
+ * @file bob/measure/SortedScores.h
+ * @date Mon Oct 19 11:02:15 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief A set of negative and positive scores sorted once, from which
+ * error rates, curves and operating points can be computed without scanning
+ * all scores at every threshold.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_MEASURE_SORTEDSCORES_H
+#define BOB_MEASURE_SORTEDSCORES_H
+
+#include <blitz/array.h>
+#include <utility>
+#include <vector>
+#include <cmath>
+#include <limits>
+
+namespace bob { namespace measure {
+
+  /**
+   * Holds copies of the negative and positive scores, sorted in ascending
+   * order, and (optionally) the cumulative sum of the weights of each score.
+   * The conventions of bob::measure::farfrr() apply: negatives on or above
+   * the threshold are false-accepts and positives below the threshold are
+   * false-rejections.
+   *
+   * Sorting costs O(N log N) and can be split over several threads. After
+   * that, farfrr() costs O(log N), a curve of P points costs O(N + P) and
+   * the optimal thresholds (EER, minimum weighted error rate) are found
+   * exactly with a single sweep over all distinct scores, instead of the
+   * recursive grid search used by bob::measure::minimizingThreshold().
+   *
+   * When weights are given, error rates are ratios of the sum of the weights
+   * of the misclassified scores to the sum of the weights of all scores of
+   * that class.
+   */
+  class SortedScores {
+
+    public:
+
+      /**
+       * Sorts the given scores, using n_threads threads (0 means the number
+       * of hardware threads available).
+       */
+      SortedScores(const blitz::Array<double,1>& negatives,
+          const blitz::Array<double,1>& positives, size_t n_threads=1);
+
+      /**
+       * Sorts the given weighted scores, using n_threads threads (0 means
+       * the number of hardware threads available).
+       *
+       * @exception std::runtime_error if the weights and scores have
+       * different lengths or if any weight is negative
+       */
+      SortedScores(const blitz::Array<double,1>& negatives,
+          const blitz::Array<double,1>& positives,
+          const blitz::Array<double,1>& negative_weights,
+          const blitz::Array<double,1>& positive_weights,
+          size_t n_threads=1);
+
+      /**
+       * The FA and FR ratios at the given threshold, as in
+       * bob::measure::farfrr(). O(log N).
+       */
+      std::pair<double, double> farfrr(double threshold) const;
+
+      /**
+       * The ROC curve at points thresholds uniformly distributed in
+       * [min(negatives, positives), max(negatives, positives)], as in
+       * bob::measure::roc(). Row 0 holds the FRR and row 1 the FAR.
+       */
+      blitz::Array<double,2> roc(size_t points) const;
+
+      /**
+       * The DET curve, as in bob::measure::det().
+       */
+      blitz::Array<double,2> det(size_t points) const;
+
+      /**
+       * The threshold minimizing the given predicate, which is called as
+       * predicate(far, frr). All distinct operating points are visited,
+       * so the minimum is exact for any predicate. If the minimum is
+       * reached at several operating points, the center one is chosen. The
+       * returned threshold lies in the middle of the interval of thresholds
+       * that produce the chosen operating point.
+       */
+      template <typename T> double minimizingThreshold(T& predicate) const;
+
+      /**
+       * The threshold at the equal-error-rate, i.e., minimizing |FAR - FRR|
+       */
+      double eerThreshold() const;
+
+      /**
+       * The equal-error-rate: the average of FAR and FRR at eerThreshold()
+       */
+      double eer() const;
+
+      /**
+       * The threshold minimizing cost * FAR + (1-cost) * FRR. The cost is
+       * clipped to the interval [0, 1].
+       */
+      double minWeightedErrorRateThreshold(double cost) const;
+
+      /**
+       * The threshold minimizing the HTER
+       */
+      double minHterThreshold() const {
+        return minWeightedErrorRateThreshold(0.5);
+      }
+
+      /**
+       * The sorted negative and positive scores
+       */
+      const std::vector<double>& getNegatives() const { return m_negatives; }
+      const std::vector<double>& getPositives() const { return m_positives; }
+
+      /**
+       * The minimum and maximum over all scores
+       */
+      double getMin() const;
+      double getMax() const;
+
+    private:
+
+      void init(const blitz::Array<double,1>& negatives,
+          const blitz::Array<double,1>& positives,
+          const blitz::Array<double,1>* negative_weights,
+          const blitz::Array<double,1>* positive_weights,
+          size_t n_threads);
+
+      /// sum of the weights of the first i negatives
+      double negativeWeight(size_t i) const {
+        return m_negative_cumsum.empty() ? (double)i : m_negative_cumsum[i];
+      }
+
+      /// sum of the weights of the first i positives
+      double positiveWeight(size_t i) const {
+        return m_positive_cumsum.empty() ? (double)i : m_positive_cumsum[i];
+      }
+
+      /**
+       * Visits all distinct operating points, calling
+       * visitor(far, frr, lower, upper) for each of them. Any threshold in
+       * the interval (lower, upper] produces this operating point. For the
+       * first point, lower equals upper, for the last one (FAR = 0), upper
+       * is infinite.
+       */
+      template <typename T> void sweep(T& visitor) const;
+
+      std::vector<double> m_negatives; ///< sorted negatives
+      std::vector<double> m_positives; ///< sorted positives
+      std::vector<double> m_negative_cumsum; ///< empty if not weighted
+      std::vector<double> m_positive_cumsum; ///< empty if not weighted
+      double m_total_negatives; ///< total weight of the negatives (> 0)
+      double m_total_positives; ///< total weight of the positives (> 0)
+
+  };
+
+  /**
+   * Calculates the EPC curve as bob::measure::epc(), but using the exact
+   * minimum weighted error rate threshold on the development set.
+   */
+  blitz::Array<double,2> epc(const SortedScores& dev, const SortedScores& test,
+      size_t points);
+
+  namespace detail {
+
+    template <typename T> struct MinimumVisitor {
+      T& predicate;
+      double minimum;
+      MinimumVisitor(T& p): predicate(p),
+        minimum(std::numeric_limits<double>::infinity()) {}
+      void operator()(double far, double frr, double, double) {
+        double cost = predicate(far, frr);
+        if (cost < minimum) minimum = cost;
+      }
+    };
+
+    template <typename T> struct CountVisitor {
+      T& predicate;
+      double minimum;
+      size_t count;
+      CountVisitor(T& p, double m): predicate(p), minimum(m), count(0) {}
+      void operator()(double far, double frr, double, double) {
+        if (std::abs(predicate(far, frr) - minimum) < 1e-16) ++count;
+      }
+    };
+
+    template <typename T> struct SelectVisitor {
+      T& predicate;
+      double minimum;
+      size_t target;
+      size_t count;
+      double threshold;
+      SelectVisitor(T& p, double m, size_t t): predicate(p), minimum(m),
+        target(t), count(0), threshold(0.) {}
+      void operator()(double far, double frr, double lower, double upper) {
+        if (std::abs(predicate(far, frr) - minimum) < 1e-16) {
+          if (count == target) {
+            if (lower == upper) threshold = upper;
+            else if (std::isinf(upper))
+              threshold = std::nextafter(lower,
+                  std::numeric_limits<double>::infinity());
+            else threshold = lower + 0.5 * (upper - lower);
+          }
+          ++count;
+        }
+      }
+    };
+
+  }
+
+  template <typename T> void SortedScores::sweep(T& visitor) const {
+    const size_t Nn = m_negatives.size();
+    const size_t Np = m_positives.size();
+    size_t i = 0, j = 0;
+    bool first = true;
+    double previous = 0.;
+    while (i < Nn || j < Np) {
+      double t;
+      if (i == Nn) t = m_positives[j];
+      else if (j == Np) t = m_negatives[i];
+      else t = std::min(m_negatives[i], m_positives[j]);
+      // i negatives and j positives are strictly below t
+      const double far = (negativeWeight(m_negatives.size()) - negativeWeight(i)) / m_total_negatives;
+      const double frr = positiveWeight(j) / m_total_positives;
+      visitor(far, frr, first ? t : previous, t);
+      while (i < Nn && m_negatives[i] == t) ++i;
+      while (j < Np && m_positives[j] == t) ++j;
+      previous = t;
+      first = false;
+    }
+    // above all scores
+    visitor((negativeWeight(m_negatives.size()) - negativeWeight(Nn)) / m_total_negatives,
+        positiveWeight(Np) / m_total_positives, previous,
+        std::numeric_limits<double>::infinity());
+  }
+
+  template <typename T> double SortedScores::minimizingThreshold(T& predicate) const {
+    detail::MinimumVisitor<T> minimum(predicate);
+    sweep(minimum);
+    detail::CountVisitor<T> count(predicate, minimum.minimum);
+    sweep(count);
+    detail::SelectVisitor<T> select(predicate, minimum.minimum, count.count/2);
+    sweep(select);
+    return select.threshold;
+  }
+
+}}
+
+#endif /* BOB_MEASURE_SORTEDSCORES_H */
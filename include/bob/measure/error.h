@@ -26,6 +26,7 @@
 #include <blitz/array.h>
 #include <utility>
 #include <vector>
+#include <bob/measure/SortedScores.h>
 
 namespace bob { namespace measure {
 
@@ -120,14 +121,44 @@ namespace bob { namespace measure {
       return blitz::Array<bool,1>(negatives < threshold);
     }
 
+  namespace detail {
+
+    /**
+     * Gives recursive_minimization() the error rates of unsorted negatives
+     * and positives, computed in O(N) per threshold with farfrr().
+     */
+    class ScoreArrays {
+
+      public:
+
+        ScoreArrays(const blitz::Array<double,1>& negatives,
+            const blitz::Array<double,1>& positives):
+          m_negatives(negatives), m_positives(positives) {}
+
+        std::pair<double, double> farfrr(double threshold) const {
+          return bob::measure::farfrr(m_negatives, m_positives, threshold);
+        }
+
+      private:
+
+        const blitz::Array<double,1>& m_negatives;
+        const blitz::Array<double,1>& m_positives;
+
+    };
+
+  }
+
   /**
    * Recursively minimizes w.r.t. to the given predicate method. Please refer
    * to minimizingThreshold() for a full explanation. This method is only
    * supposed to be used through that method.
+   *
+   * The error rates are taken from scores.farfrr(threshold), so the scores
+   * may be a bob::measure::SortedScores (O(log N) per step) or the negatives
+   * and positives themselves (O(N) per step, see the overload below).
    */
-  template <typename T>
-  static double recursive_minimization(const blitz::Array<double,1>& negatives,
-      const blitz::Array<double,1>& positives, T& predicate,
+  template <typename S, typename T>
+  static double recursive_minimization(const S& scores, T& predicate,
       double min, double max, size_t steps) {
     static const double QUIT_THRESHOLD = 1e-10;
     const double diff = max - min;
@@ -147,8 +178,7 @@ namespace bob { namespace measure {
     for (size_t i=0; i<steps; ++i) {
       double threshold = ((double)i * step_size) + min;
 
-      std::pair<double, double> ratios =
-        farfrr(negatives, positives, threshold);
+      std::pair<double, double> ratios = scores.farfrr(threshold);
 
       double current_cost = predicate(ratios.first, ratios.second);
 
@@ -166,7 +196,7 @@ namespace bob { namespace measure {
     //we stop when it doesn't matter anymore to threshold.
     if (accumulator.size() != steps) {
       //still needs some refinement: pick-up the middle of the range and go
-      return recursive_minimization(negatives, positives, predicate,
+      return recursive_minimization(scores, predicate,
           accumulator[accumulator.size()/2]-step_size,
           accumulator[accumulator.size()/2]+step_size,
           steps);
@@ -175,6 +205,18 @@ namespace bob { namespace measure {
     return accumulator[accumulator.size()/2];
   }
 
+  /**
+   * Recursively minimizes w.r.t. to the given predicate method, computing
+   * the error rates directly from the (unsorted) negatives and positives.
+   */
+  template <typename T>
+  static double recursive_minimization(const blitz::Array<double,1>& negatives,
+      const blitz::Array<double,1>& positives, T& predicate,
+      double min, double max, size_t steps) {
+    return recursive_minimization(detail::ScoreArrays(negatives, positives),
+        predicate, min, max, steps);
+  }
+
   /**
    * This method can calculate a threshold based on a set of scores (positives
    * and negatives) given a certain minimization criteria, input as a
@@ -204,15 +246,18 @@ namespace bob { namespace measure {
    * The procedure continues until all calculated predicates in a given round
    * give the same minimum. At this point, the center threshold is picked up and
    * returned.
+   *
+   * The scores are sorted once, so that the error rates at each step are
+   * computed in O(log N). Use bob::measure::SortedScores to find the exact
+   * minimum instead.
    */
   template <typename T> double
     minimizingThreshold(const blitz::Array<double,1>& negatives,
         const blitz::Array<double,1>& positives, T& predicate) {
       const size_t N = 100; ///< number of steps in each iteration
-      double min = std::min(blitz::min(negatives), blitz::min(positives));
-      double max = std::max(blitz::max(negatives), blitz::max(positives));
-      return recursive_minimization(negatives, positives, predicate, min,
-          max, N);
+      SortedScores scores(negatives, positives);
+      return recursive_minimization(scores, predicate, scores.getMin(),
+          scores.getMax(), N);
     }
 
   /**
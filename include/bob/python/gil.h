@@ -41,15 +41,38 @@ namespace bob { namespace python {
 
   /**
    * @brief Unlocks the Python GIL
+   *
+   * Bindings release the GIL around calls to C++ code that do not touch
+   * Python objects (e.g. training, filtering or decoding), so that other
+   * Python threads can run meanwhile. Arguments are converted (and output
+   * arrays allocated) before the lock is released, and results are returned
+   * after it was acquired again:
+   *
+   * @code
+   * static object filter(Op& op, bob::python::const_ndarray src) {
+   *   bob::python::ndarray dst(src.type());
+   *   blitz::Array<double,2> dst_ = dst.bz<double,2>();
+   *   {
+   *     bob::python::no_gil unlock;
+   *     op(src.bz<double,2>(), dst_);
+   *   }
+   *   return dst.self();
+   * }
+   * @endcode
+   *
+   * Objects used in such calls must not be used by other threads at the same
+   * time, unless they are documented as thread-safe.
    */
   class no_gil {
 
     public:
 
       /**
-       * @brief Releases the Python GIL lock until the end of the current scope
+       * @brief Releases the Python GIL lock until the end of the current
+       * scope, unless release is false (e.g. if the code to run is not
+       * thread-safe in some configurations)
        */
-      no_gil ();
+      explicit no_gil (bool release=true);
 
       /**
        * @brief Re-acquires the GIL lock
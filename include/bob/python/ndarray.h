@@ -228,6 +228,42 @@ namespace bob { namespace python {
   convert_t convertible_to (boost::python::object array_like,
       bool writeable=true, bool behaved=true);
 
+  /**
+   * @brief Tells if the array-like object is a NumPy ndarray that can be
+   * wrapped by a blitz::Array<> of the same type without copying it: its
+   * data has to be aligned and in native byte order, and its strides have to
+   * be positive multiples of the item size. If "contiguous" is set, the array
+   * must also be C-style contiguous.
+   *
+   * Slices (e.g. "a[:,::2]") and transposes of well-behaved arrays are
+   * referable. Arrays with negative strides (e.g. "a[::-1]") are not.
+   */
+  bool referable (boost::python::object array_like, bool contiguous=false);
+
+  /**
+   * @brief Records that an array of the given size (in bytes) was copied
+   * while crossing the boundary between Python and C++. The counters are
+   * protected by the GIL, that must be held by the caller.
+   */
+  void record_copy (size_t bytes);
+
+  /**
+   * @brief The number of arrays copied while crossing the boundary between
+   * Python and C++, since the start or the last reset_copies().
+   */
+  size_t copied_arrays ();
+
+  /**
+   * @brief The number of bytes copied while crossing the boundary between
+   * Python and C++, since the start or the last reset_copies().
+   */
+  size_t copied_bytes ();
+
+  /**
+   * @brief Resets the copy counters
+   */
+  void reset_copies ();
+
   class dtype {
 
     public: //api
@@ -331,9 +367,14 @@ namespace bob { namespace python {
        * to copy the data. Otherwise, we just refer.
        *
        * @param dtype_like Anything that can be cast to a description type.
+       *
+       * @param contiguous If set (the default), the data is copied unless the
+       * array is C-style contiguous, so that ptr() can be used as a C-style
+       * buffer. Otherwise, arrays with other strides are referred to, if
+       * referable(), and type() has their strides.
        */
       py_array(boost::python::object array_like,
-              boost::python::object dtype_like);
+              boost::python::object dtype_like, bool contiguous=true);
 
       /**
        * @brief Builds a new array copying the data of an existing buffer.
@@ -385,6 +426,10 @@ namespace bob { namespace python {
 
       /**
        * @brief Copies the data from another buffer.
+       *
+       * The methods that reset this buffer acquire the Python GIL, so that
+       * C++ code called with the GIL released (see bob::python::no_gil) can
+       * use it as its output.
        */
       virtual void set(const bob::core::array::interface& buffer);
 
@@ -522,6 +567,10 @@ namespace bob { namespace python {
       /**
        * @brief Returns a temporary blitz::Array<> skin over this ndarray.
        *
+       * The skin has the strides of the NumPy array, that is not copied if it
+       * is referable() (e.g. a slice or a transpose): the blitz::Array<> is
+       * then not necessarily C-style contiguous.
+       *
        * Attention: If you use this method, you have to make sure that this
        * ndarray outlives the blitz::Array<> and that such blitz::Array<> will
        * not be re-allocated or have any other changes made to it, except for
@@ -617,6 +666,7 @@ namespace bob { namespace python {
         }
 
         // if we got here, we have to copy-cast
+        record_copy(info.size() * sizeof(T));
         // call the correct version of the cast function
         switch(info.dtype){
           // boolean types
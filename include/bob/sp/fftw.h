@@ -0,0 +1,66 @@
+/**
+ * @file bob/sp/fftw.h
+ * @date Mon Oct 19 09:41:27 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Serializes the calls to the FFTW planner
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_SP_FFTW_H
+#define BOB_SP_FFTW_H
+
+namespace bob { namespace sp {
+/**
+ * @ingroup SP
+ * @{
+ */
+
+/**
+ * @brief Holds a process-wide lock until the end of the current scope.
+ *
+ * Only fftw_execute() is thread-safe in FFTW: plans must be created and
+ * destroyed while holding this lock, so that transforms can be computed by
+ * concurrent threads (e.g. from Python, with the GIL released).
+ */
+class fftw_lock {
+
+  public:
+
+    /**
+     * @brief Acquires the lock
+     */
+    fftw_lock();
+
+    /**
+     * @brief Releases the lock
+     */
+    ~fftw_lock();
+
+  private: //not implemented
+
+    fftw_lock(const fftw_lock& other);
+
+    fftw_lock& operator=(const fftw_lock& other);
+
+};
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_SP_FFTW_H */
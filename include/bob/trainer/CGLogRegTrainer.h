@@ -25,6 +25,7 @@
 #define BOB_TRAINER_CGLOGREGTRAINER_H
 
 #include <bob/machine/LinearMachine.h>
+#include <bob/io/File.h>
 #include <boost/format.hpp>
 
 namespace bob { namespace trainer {
@@ -44,11 +45,26 @@ namespace bob { namespace trainer {
    *   T. Minka, Unpublished draft, 2003 (revision in 2007), 
    *   http://research.microsoft.com/en-us/um/people/minka/papers/logreg/
    *   2/ FoCal, http://www.dsp.sun.ac.za/~nbrummer/focal/
+   *
+   * The objective function and its derivatives are evaluated directly on
+   * the input arrays, in chunks of rows (see setBlockSize()) which are
+   * spread over several threads (see setNThreads()). The partial sums of
+   * the chunks are always added in the same order, so the result does not
+   * depend on the number of threads.
    */
   class CGLogRegTrainer 
   {
     public: //api
 
+      /**
+       * @brief The optimizer used to maximize the objective function
+       */
+      typedef enum {
+        CONJUGATE_GRADIENT=0, ///< conjugate gradient with a Newton step
+        LBFGS ///< limited-memory BFGS, using the bundled libLBFGS
+      }
+      Solver;
+
       /**
        * Default constructor.
        * @param prior The synthetic prior. It should be in the range ]0.,1.[
@@ -93,6 +109,17 @@ namespace bob { namespace trainer {
       double getConvergenceThreshold() const { return m_convergence_threshold; }
       size_t getMaxIterations() const { return m_max_iterations; }
       double getLambda() const { return m_lambda; }
+      Solver getSolver() const { return m_solver; }
+      /**
+       * @brief The number of threads used to evaluate the objective function
+       * (0, the default, means bob::core::default_threads())
+       */
+      size_t getNThreads() const { return m_n_threads; }
+      /**
+       * @brief The number of rows (samples) in each of the chunks the
+       * objective function is evaluated on
+       */
+      size_t getBlockSize() const { return m_block_size; }
 
       /**
        * Setters
@@ -111,6 +138,19 @@ namespace bob { namespace trainer {
       { m_max_iterations = max_iterations; }
       void setLambda(const double lambda) 
       { m_lambda = lambda; }
+      /**
+       * @brief Sets the optimizer. With LBFGS, the convergence threshold
+       * applies to the norm of the gradient (relative to the norm of the
+       * weights) instead of to the change of the weights.
+       */
+      void setSolver(const Solver solver)
+      { m_solver = solver; }
+      void setNThreads(const size_t n_threads)
+      { m_n_threads = n_threads; }
+      void setBlockSize(const size_t block_size)
+      { if(block_size == 0)
+          throw std::runtime_error("The block size must be at least 1.");
+        m_block_size = block_size; }
 
       /**
        * Trains the LinearMachine to perform Linear Logistic Regression
@@ -118,12 +158,25 @@ namespace bob { namespace trainer {
       virtual void train(bob::machine::LinearMachine& machine, 
           const blitz::Array<double,2>& negatives, const blitz::Array<double,2>& positives) const;
 
+      /**
+       * Trains the LinearMachine to perform Linear Logistic Regression,
+       * reading the samples from files, in which each array is a sample (1D
+       * array), instead of from memory. Samples are read again, block by
+       * block, each time the objective function is evaluated, so that only
+       * a few blocks of each class are in memory at any time.
+       */
+      virtual void train(bob::machine::LinearMachine& machine, 
+          bob::io::File& negatives, bob::io::File& positives) const;
+
     private: 
       // Attributes
       double m_prior;
       double m_convergence_threshold;
       size_t m_max_iterations;
       double m_lambda;
+      Solver m_solver;
+      size_t m_n_threads;
+      size_t m_block_size;
   };
 
   /**
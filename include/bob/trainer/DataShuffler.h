@@ -28,6 +28,8 @@
 #include <blitz/array.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/random.hpp>
+#include <boost/thread.hpp>
+#include <boost/exception_ptr.hpp>
 
 namespace bob { namespace trainer {
   /**
@@ -42,6 +44,12 @@ namespace bob { namespace trainer {
    * different classes, filling up user containers.
    *
    * Data shufflers are particular useful for training neural networks.
+   *
+   * The class data may be referenced instead of copied (e.g. to use data
+   * that lives in memory-mapped files) and batches can be assembled on a
+   * background thread while the caller works on the previous batch (see
+   * startPrefetch()). Standard normalization is applied while batches are
+   * assembled, so the class data is never modified.
    */
   class DataShuffler {
 
@@ -56,12 +64,22 @@ namespace bob { namespace trainer {
           const std::vector<blitz::Array<double,1> >& target);
 
       /**
-       * Copy constructor
+       * Initializes the shuffler with some data classes and corresponding
+       * targets. If copy is false, the data arrays are only referenced: they
+       * must outlive the shuffler and should not be modified while it is in
+       * use. Targets are always copied.
+       */
+      DataShuffler(const std::vector<blitz::Array<double,2> >& data,
+          const std::vector<blitz::Array<double,1> >& target, bool copy);
+
+      /**
+       * Copy constructor. The data is always copied. A shuffler that is
+       * prefetching batches should be stopped before it is copied.
        */
       DataShuffler(const DataShuffler& other);
 
       /**
-       * D'tor virtualization
+       * D'tor virtualization. Stops prefetching, if required.
        */
       virtual ~DataShuffler();
 
@@ -78,7 +96,7 @@ namespace bob { namespace trainer {
           blitz::Array<double,1>& stddev) const;
 
       /**
-       * Set automatic standard normalization.
+       * Set automatic standard normalization. Stops prefetching.
        */
       void setAutoStdNorm(bool s);
 
@@ -87,6 +105,20 @@ namespace bob { namespace trainer {
        */
       inline bool getAutoStdNorm() const { return m_do_stdnorm; }
 
+      /**
+       * Sets epoch-based shuffling (off by default). When set, the examples
+       * of each class are drawn without replacement, following a random
+       * permutation of the class that is renewed every time all its examples
+       * have been drawn. Otherwise, each example is drawn independently
+       * (with replacement). Stops prefetching.
+       */
+      void setEpochShuffling(bool s);
+
+      /**
+       * Gets current epoch-based shuffling settings
+       */
+      inline bool getEpochShuffling() const { return m_epoch; }
+
       /**
        * The data shape
        */
@@ -107,7 +139,7 @@ namespace bob { namespace trainer {
        * responsibility to do so.
        *
        * Note this operation is non-const - we do alter the state of our ranges
-       * internally.
+       * internally. Stops prefetching.
        */
       void operator() (boost::mt19937& rng, blitz::Array<double,2>& data,
           blitz::Array<double,2>& target);
@@ -130,6 +162,70 @@ namespace bob { namespace trainer {
       void operator() (blitz::Array<double,2>& data,
           blitz::Array<double,2>& target);
 
+      /**
+       * Starts assembling batches of N examples on a background thread,
+       * using a copy of the given random number generator. The batches
+       * returned by next() are exactly those that consecutive calls to
+       * operator() would draw with that generator. Stops any previous
+       * prefetching.
+       */
+      void startPrefetch(const boost::mt19937& rng, size_t N);
+
+      /**
+       * Waits for the batch being assembled on the background thread, copies
+       * it to 'data' and 'target' (which must have N rows and the right
+       * number of columns) and starts assembling the following batch.
+       *
+       * @exception std::runtime_error if not prefetching or if the outputs
+       * have the wrong shape
+       */
+      void next(blitz::Array<double,2>& data, blitz::Array<double,2>& target);
+
+      /**
+       * Stops prefetching (this is a no-op if not prefetching)
+       */
+      void stopPrefetch();
+
+      /**
+       * Tells if batches are being prefetched
+       */
+      inline bool isPrefetching() const { return m_prefetch_size > 0; }
+
+      /**
+       * The number of examples in prefetched batches (0 if not prefetching)
+       */
+      inline size_t getPrefetchSize() const { return m_prefetch_size; }
+
+    private: //api
+
+      /**
+       * Checks and sets the data and targets
+       */
+      void init(const std::vector<blitz::Array<double,2> >& data,
+          const std::vector<blitz::Array<double,1> >& target, bool copy);
+
+      /**
+       * Draws the index of the next example of a given class
+       */
+      size_t draw(boost::mt19937& rng, size_t i);
+
+      /**
+       * Assembles a batch, without any checks
+       */
+      void fill(boost::mt19937& rng, blitz::Array<double,2>& data,
+          blitz::Array<double,2>& target);
+
+      /**
+       * Assembles the next batch into the prefetch buffers (runs on the
+       * background thread)
+       */
+      void prefetch();
+
+      /**
+       * Waits for the background thread to finish its current batch
+       */
+      void wait();
+
     private: //representation
 
       std::vector<blitz::Array<double,2> > m_data;
@@ -139,6 +235,17 @@ namespace bob { namespace trainer {
       blitz::Array<double,1> m_mean; ///< mean to be used for std. norm.
       blitz::Array<double,1> m_stddev; ///< std.dev for std. norm.
 
+      bool m_epoch; ///< should we draw without replacement
+      std::vector<std::vector<size_t> > m_order; ///< permutation per class
+      std::vector<size_t> m_position; ///< next position in m_order per class
+
+      size_t m_prefetch_size; ///< batch size when prefetching (0 if not)
+      boost::mt19937 m_rng; ///< generator used when prefetching
+      blitz::Array<double,2> m_prefetch_data; ///< batch being assembled
+      blitz::Array<double,2> m_prefetch_target; ///< targets being assembled
+      boost::shared_ptr<boost::thread> m_thread; ///< background thread
+      boost::exception_ptr m_error; ///< error raised on the background thread
+
   };
 
   /**
@@ -25,6 +25,7 @@
 #include "EMTrainer.h"
 #include <bob/machine/IVectorMachine.h>
 #include <bob/machine/GMMStats.h>
+#include <bob/math/LapackWorkspace.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/random.hpp>
 #include <vector>
@@ -170,6 +171,7 @@ class IVectorTrainer: public bob::trainer::EMTrainer<bob::machine::IVectorMachin
     mutable blitz::Array<double,2> m_tmp_dt1;
     mutable blitz::Array<double,2> m_tmp_tt1;
     mutable blitz::Array<double,2> m_tmp_tt2;
+    mutable bob::math::LapackWorkspace m_workspace;
 };
 
 /**
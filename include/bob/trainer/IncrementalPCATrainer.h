@@ -0,0 +1,182 @@
+/**
+ * @file bob/trainer/IncrementalPCATrainer.h
+ * @date Mon Oct 19 17:21:40 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Principal Component Analysis updated chunk by chunk, for data sets
+ * that do not fit in memory.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_TRAINER_INCREMENTAL_PCA_TRAINER_H
+#define BOB_TRAINER_INCREMENTAL_PCA_TRAINER_H
+
+#include <blitz/array.h>
+#include <stdint.h>
+#include <bob/machine/LinearMachine.h>
+
+namespace bob { namespace trainer {
+
+  /**
+   * @ingroup TRAINER
+   * @{
+   */
+
+  /**
+   * @brief Computes the first K principal components of a data set that is
+   * given in chunks of samples (e.g. read one file at a time), keeping only
+   * the mean, the K components and their singular values in memory.
+   *
+   * At each update, the SVD of the current components (scaled by their
+   * singular values), the centered chunk and a column correcting for the shift
+   * of the mean is computed and the first K left singular vectors are kept.
+   * If K is at least the rank of the data, the result is that of
+   * bob::trainer::PCATrainer. Otherwise, it is an approximation whose
+   * quality depends on how fast the eigen values decay.
+   *
+   * References:
+   * 1. Incremental Learning for Robust Visual Tracking, Ross, Lim, Lin &
+   *    Yang, International Journal of Computer Vision (2008) Volume: 77,
+   *    Issue: 1-3, Pages: 125-141
+   */
+  class IncrementalPCATrainer {
+
+    public: //api
+
+      /**
+       * @brief Initializes a new trainer that keeps (at most) K components
+       *
+       * @exception std::runtime_error if K is 0
+       */
+      IncrementalPCATrainer(size_t K);
+
+      /**
+       * @brief Copy constructor
+       */
+      IncrementalPCATrainer(const IncrementalPCATrainer& other);
+
+      /**
+       * @brief Destructor
+       */
+      virtual ~IncrementalPCATrainer();
+
+      /**
+       * @brief Assignment operator
+       */
+      IncrementalPCATrainer& operator=(const IncrementalPCATrainer& other);
+
+      /**
+       * @brief Equal to
+       */
+      bool operator==(const IncrementalPCATrainer& other) const;
+
+      /**
+       * @brief Not equal to
+       */
+      bool operator!=(const IncrementalPCATrainer& other) const;
+
+      /**
+       * @brief Similar to
+       */
+      bool is_similar_to(const IncrementalPCATrainer& other,
+          const double r_epsilon=1e-5, const double a_epsilon=1e-8) const;
+
+      /**
+       * @brief Updates the mean and the components with a chunk of samples
+       * (one per row). All chunks must have the same number of features.
+       *
+       * @exception std::runtime_error if the number of features differs from
+       * that of the previous chunks
+       */
+      void update(const blitz::Array<double,2>& X);
+
+      /**
+       * @brief Forgets all samples
+       */
+      void reset();
+
+      /**
+       * @brief Sets the LinearMachine with the current mean and components,
+       * arranged by decreasing eigen value, and returns the eigen values of
+       * the covariance matrix. The machine must have as many outputs as
+       * getNComponents().
+       *
+       * @exception std::runtime_error if less than two samples were given or
+       * if the machine or eigen_values have the wrong size
+       */
+      void train(bob::machine::LinearMachine& machine,
+          blitz::Array<double,1>& eigen_values) const;
+
+      /**
+       * @brief The maximum number of components K
+       */
+      size_t getK() const { return m_K; }
+
+      /**
+       * @brief The current number of components, i.e., K or less if less
+       * samples or features were given
+       */
+      size_t getNComponents() const { return m_sigma.extent(0); }
+
+      /**
+       * @brief The number of samples given so far
+       */
+      uint64_t getNSamples() const { return m_n_samples; }
+
+      /**
+       * @brief The mean of the samples given so far
+       */
+      const blitz::Array<double,1>& getMean() const { return m_mean; }
+
+      /**
+       * @brief The current components (one per column)
+       */
+      const blitz::Array<double,2>& getComponents() const
+      { return m_components; }
+
+      /**
+       * @brief The current eigen values of the covariance matrix
+       */
+      blitz::Array<double,1> getEigenValues() const;
+
+      /**
+       * @brief The total variance of the samples given so far, i.e., the sum
+       * of all eigen values of their covariance matrix
+       */
+      double getTotalVariance() const;
+
+      /**
+       * @brief The ratio of the total variance explained by each component
+       */
+      blitz::Array<double,1> getExplainedVarianceRatio() const;
+
+    private: //representation
+
+      size_t m_K; ///< maximum number of components
+      uint64_t m_n_samples; ///< number of samples so far
+      blitz::Array<double,1> m_mean; ///< mean of the samples so far
+      blitz::Array<double,1> m_scatter; ///< squared deviations per feature
+      blitz::Array<double,2> m_components; ///< components, one per column
+      blitz::Array<double,1> m_sigma; ///< singular values of the components
+
+  };
+
+  /**
+   * @}
+   */
+}}
+
+#endif /* BOB_TRAINER_INCREMENTAL_PCA_TRAINER_H */
@@ -27,6 +27,7 @@
 #include "EMTrainer.h"
 #include <bob/machine/GMMStats.h>
 #include <bob/machine/JFAMachine.h>
+#include <bob/math/LapackWorkspace.h>
 #include <vector>
 
 #include <map>
@@ -350,6 +351,7 @@ class FABaseTrainer
     mutable blitz::Array<double,2> m_tmp_ruru;
     mutable blitz::Array<double,2> m_tmp_ruD;
     mutable blitz::Array<double,2> m_tmp_rvrv;
+    mutable bob::math::LapackWorkspace m_workspace;
     mutable blitz::Array<double,2> m_tmp_rvD;
     mutable blitz::Array<double,1> m_tmp_rv;
     mutable blitz::Array<double,1> m_tmp_ru;
@@ -23,6 +23,8 @@
 #define BOB_TRAINER_MLPBASETRAINER_H
 
 #include <vector>
+#include <utility>
+#include <stdint.h>
 #include <boost/shared_ptr.hpp>
 
 #include <bob/machine/MLP.h>
@@ -177,6 +179,37 @@ namespace bob { namespace trainer {
        */
       inline void setTrainBiases(bool v) { m_train_bias = v; }
 
+      /**
+       * @brief Gets the number of shards each batch is split into by
+       * forward_backward_step() (defaults to 1, no splitting)
+       */
+      inline size_t getShards() const { return m_shards; }
+
+      /**
+       * @brief Sets the number of shards each batch is split into by
+       * forward_backward_step(). Shards are processed concurrently, each one
+       * into its own buffers, and their derivatives are summed up in shard
+       * order. The derivatives therefore only depend on the batch size and
+       * on the number of shards, never on the number of threads. With a
+       * single shard, the results are those of forward_step() followed by
+       * backward_step().
+       *
+       * @exception std::runtime_error if shards is 0
+       */
+      void setShards(size_t shards);
+
+      /**
+       * @brief Gets the number of threads used to process the shards (0, the
+       * default, means bob::core::default_threads())
+       */
+      inline size_t getNThreads() const { return m_n_threads; }
+
+      /**
+       * @brief Sets the number of threads used to process the shards (0 means
+       * bob::core::default_threads())
+       */
+      inline void setNThreads(size_t n_threads) { m_n_threads = n_threads; }
+
       /**
        * @brief Checks if a given machine is compatible with my inner settings.
        */
@@ -214,6 +247,17 @@ namespace bob { namespace trainer {
         const blitz::Array<double,2>& input,
         const blitz::Array<double,2>& target);
 
+      /**
+       * @brief Forward and backward steps in one go. If more than one shard
+       * is set (see setShards()), the batch is split into that many
+       * contiguous shards of examples, which are processed concurrently.
+       * Outputs, errors and derivatives are available after this call, as
+       * after backward_step().
+       */
+      void forward_backward_step(const bob::machine::MLP& machine,
+        const blitz::Array<double,2>& input,
+        const blitz::Array<double,2>& target);
+
       /**
        * @brief Calculates the cost for a given target. 
        *
@@ -303,11 +347,32 @@ namespace bob { namespace trainer {
        */
       void reset();
 
+      /**
+       * @brief Buffers of one shard of the batch
+       */
+      struct Shard {
+        blitz::Array<double,2> input; ///< examples of this shard
+        blitz::Array<double,2> target; ///< targets of this shard
+        std::vector<blitz::Array<double,2> > output; ///< layer output
+        std::vector<blitz::Array<double,2> > error; ///< error (+deltas)
+        std::vector<blitz::Array<double,2> > fprime; ///< activation derivatives
+        std::vector<blitz::Array<double,2> > deriv; ///< sum of the derivatives (weights)
+        std::vector<blitz::Array<double,1> > deriv_bias; ///< sum of the derivatives (biases)
+      };
+
+      /**
+       * @brief Allocates the shard buffers for the given example ranges
+       */
+      void prepare_shards(const std::vector<std::pair<uint64_t,uint64_t> >& ranges,
+          int input_width, int target_width);
+
       /// training parameters:
       size_t m_batch_size; ///< the batch size
       boost::shared_ptr<bob::trainer::Cost> m_cost; ///< cost function to be minimized
       bool m_train_bias; ///< shall we be training biases? (default: true)
       size_t m_H; ///< number of hidden layers on the target machine
+      size_t m_shards; ///< number of shards per batch (default: 1)
+      size_t m_n_threads; ///< number of threads for the shards (0: default)
 
       std::vector<blitz::Array<double,2> > m_deriv; ///< derivatives of the cost wrt. the weights
       std::vector<blitz::Array<double,1> > m_deriv_bias; ///< derivatives of the cost wrt. the biases
@@ -315,6 +380,10 @@ namespace bob { namespace trainer {
       /// buffers that are dependent on the batch_size
       std::vector<blitz::Array<double,2> > m_error; ///< error (+deltas)
       std::vector<blitz::Array<double,2> > m_output; ///< layer output
+      std::vector<blitz::Array<double,2> > m_fprime; ///< activation derivatives
+
+      /// scratch buffers for forward_backward_step(), never copied
+      std::vector<Shard> m_shard;
   };
 
   /**
@@ -162,7 +162,8 @@ namespace bob { namespace trainer {
        * Note: In RProp, training is done in batches. The number of rows in the
        * input (and target) determines the batch size. If the batch size
        * currently set is incompatible with the given data an exception is
-       * raised.
+       * raised. The batch may be split into shards processed on several
+       * threads (see MLPBaseTrainer::setShards()).
        *       
        * Note2: The machine is not initialized randomly at each train() call.
        * It is your task to call MLP::randomize() once on the machine you
@@ -27,6 +27,8 @@
 #define BOB_TRAINER_PCA_TRAINER_H
 
 #include <blitz/array.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/random.hpp>
 #include <bob/machine/LinearMachine.h>
 
 namespace bob { namespace trainer {
@@ -47,6 +49,9 @@ namespace bob { namespace trainer {
    *    Pages: 71-86
    * 2. http://en.wikipedia.org/wiki/Singular_value_decomposition
    * 3. http://en.wikipedia.org/wiki/Principal_component_analysis
+   * 4. Finding structure with randomness: Probabilistic algorithms for
+   *    constructing approximate matrix decompositions, Halko, Martinsson &
+   *    Tropp, SIAM Review (2011) Volume: 53, Issue: 2, Pages: 217-288
    */
   class PCATrainer {
 
@@ -100,6 +105,43 @@ namespace bob { namespace trainer {
        */
       void setUseSVD (bool value) { m_use_svd = value; }
 
+      /**
+       * @brief Gets the number of extra random directions sampled by
+       * train_randomized() (defaults to 10)
+       */
+      size_t getOversampling () const { return m_oversampling; }
+
+      /**
+       * @brief Sets the number of extra random directions sampled by
+       * train_randomized()
+       */
+      void setOversampling (size_t value) { m_oversampling = value; }
+
+      /**
+       * @brief Gets the number of power iterations of train_randomized()
+       * (defaults to 2)
+       */
+      size_t getPowerIterations () const { return m_power_iterations; }
+
+      /**
+       * @brief Sets the number of power iterations of train_randomized().
+       * More iterations increase the precision when the eigen values decay
+       * slowly, each one costing two passes over the data.
+       */
+      void setPowerIterations (size_t value) { m_power_iterations = value; }
+
+      /**
+       * @brief Sets the random number generator used by train_randomized()
+       */
+      void setRng(const boost::shared_ptr<boost::mt19937> rng)
+      { m_rng = rng; }
+
+      /**
+       * @brief Gets the random number generator used by train_randomized()
+       */
+      const boost::shared_ptr<boost::mt19937> getRng() const
+      { return m_rng; }
+
       /**
        * @brief Similar to
        */
@@ -125,6 +167,29 @@ namespace bob { namespace trainer {
           blitz::Array<double,1>& eigen_values,
           const blitz::Array<double,2>& X) const;
 
+      /**
+       * @brief Trains the LinearMachine with the first K principal
+       * components only, where K is the number of outputs of the machine,
+       * using the randomized truncated SVD of Halko, Martinsson & Tropp. The
+       * data is neither copied nor centered explicitly, and neither the
+       * covariance matrix nor the full SVD are computed: the cost is
+       * O(N.F.(K+p)) per pass over the data, where p is the oversampling.
+       * Also returns the K largest eigen values of the covariance matrix.
+       *
+       * @exception std::runtime_error if K exceeds output_size(X) or if K
+       * plus the oversampling exceeds the number of samples or features
+       */
+      void train_randomized(bob::machine::LinearMachine& machine,
+          blitz::Array<double,1>& eigen_values,
+          const blitz::Array<double,2>& X) const;
+
+      /**
+       * @brief Calculates the total variance of X, i.e., the sum of all eigen
+       * values of its covariance matrix, without computing it. Dividing
+       * eigen values by this gives the ratio of the variance they explain.
+       */
+      double total_variance(const blitz::Array<double,2>& X) const;
+
       /**
        * @brief Calculates the maximum possible rank for the covariance matrix
        * of X, given X.
@@ -138,6 +203,9 @@ namespace bob { namespace trainer {
     private: //representation
 
       bool m_use_svd; ///< if this trainer should be using SVD or Covariance
+      size_t m_oversampling; ///< extra random directions (randomized SVD)
+      size_t m_power_iterations; ///< number of power iterations (randomized SVD)
+      boost::shared_ptr<boost::mt19937> m_rng; ///< generator (randomized SVD)
 
   };
 
@@ -26,6 +26,7 @@
 
 #include "EMTrainer.h"
 #include <bob/machine/PLDAMachine.h>
+#include <bob/math/LapackWorkspace.h>
 #include <blitz/array.h>
 #include <map>
 #include <vector>
@@ -283,6 +284,7 @@ class PLDATrainer: public EMTrainer<bob::machine::PLDABase,
     mutable blitz::Array<double,2> m_tmp_nfng_nfng; ///< matrix of dimension (dim_f+dim_g)x(dim_f+dim_g)
     mutable blitz::Array<double,2> m_tmp_D_nfng_1; ///< matrix of dimension (dim_d)x(dim_f+dim_g)
     mutable blitz::Array<double,2> m_tmp_D_nfng_2; ///< matrix of dimension (dim_d)x(dim_f+dim_g)
+    mutable bob::math::LapackWorkspace m_workspace; ///< scratch memory of the inversions
 
     // internal methods
     void computeMeanVariance(bob::machine::PLDABase& machine,
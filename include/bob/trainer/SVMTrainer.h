@@ -41,6 +41,21 @@ namespace bob { namespace trainer {
    * * Different weights for every label (-wi option in svm-train)
    *
    * Fell free to implement those and remove these remarks.
+   *
+   * Two things are done differently than in svm-train, to speed up training
+   * without changing the resulting machine:
+   *
+   * * If the kernel matrix of the training data fits in
+   *   getKernelMatrixLimitInMB(), it is computed once, in parallel, from a
+   *   dense copy of the data, and handed to the libsvm solver as a
+   *   precomputed kernel shared by all subproblems. The kernel values are
+   *   computed exactly as libsvm does, so the solver takes the same path.
+   *
+   * * Multi-class problems are decomposed in one-vs-one binary subproblems
+   *   (as libsvm does) which are trained concurrently (see setNThreads()),
+   *   and then assembled into a single libsvm model. With probability
+   *   estimates, the subproblems are trained one after the other, as libsvm
+   *   uses the (global) random number generator for those.
    */
   class SVMTrainer {
 
@@ -131,9 +146,28 @@ namespace bob { namespace trainer {
       void setProbabilityEstimates(bool v) 
       { m_param.probability = v; }
 
+      /**
+       * @brief The number of threads used to compute the kernel matrix and
+       * to train the one-vs-one subproblems (0, the default, means
+       * bob::core::default_threads()). Each concurrent subproblem uses its
+       * own libsvm cache of getCacheSizeInMB().
+       */
+      size_t getNThreads() const { return m_n_threads; }
+      void setNThreads(size_t v) { m_n_threads = v; }
+
+      /**
+       * @brief The maximum size of a precomputed kernel matrix, in MB (0
+       * disables it). libsvm stores it as 16 bytes per entry, so 512 MB
+       * (the default) covers problems of up to about 5800 samples.
+       */
+      double getKernelMatrixLimitInMB() const { return m_kernel_matrix_limit; }
+      void setKernelMatrixLimitInMB(double v) { m_kernel_matrix_limit = v; }
+
     private: //representation
 
       svm_parameter m_param; ///< training parametrization for libsvm
+      size_t m_n_threads; ///< number of threads (0: default)
+      double m_kernel_matrix_limit; ///< max. size of a precomputed kernel (MB)
       
   };
 
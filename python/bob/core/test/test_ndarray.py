@@ -0,0 +1,92 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# agent <agent@local>
+# Mon Oct 19 15:21:09 2026 +0200
+#
+# Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+# 
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+# 
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# 
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Tests the copies made by the C++-Python array bridge.
+"""
+
+import unittest
+import bob
+import numpy
+
+class NdarrayCopyTest(unittest.TestCase):
+  """Performs various tests on the copies of arrays."""
+
+  def convert(self, array):
+    return bob.core.convert(array, numpy.uint8, source_range=(0.,1.))
+
+  def test01_contiguous(self):
+
+    a = numpy.random.rand(20, 30)
+    bob.core.reset_copies()
+    x = self.convert(a)
+    # only the output is copied, on its way back to python
+    self.assertEqual(bob.core.copied_arrays(), 1)
+    self.assertEqual(bob.core.copied_bytes(), x.nbytes)
+
+  def test02_strided(self):
+
+    a = numpy.random.rand(20, 30)
+    for view in (a[:,::2], a.T, a[::3,1::2].T, a[5:6,:]):
+      bob.core.reset_copies()
+      x = self.convert(view)
+      self.assertEqual(bob.core.copied_arrays(), 1)
+      self.assertEqual(bob.core.copied_bytes(), x.nbytes)
+      self.assertTrue(numpy.array_equal(x, self.convert(view.copy())))
+
+  def test03_copied(self):
+
+    a = numpy.random.rand(20, 30)
+    # negative strides and byte-swapped data are copied
+    for view in (a[::-1], a.byteswap().newbyteorder()):
+      bob.core.reset_copies()
+      x = self.convert(view)
+      self.assertEqual(bob.core.copied_arrays(), 2)
+      self.assertTrue(numpy.array_equal(x, self.convert(numpy.array(view, 'float64'))))
+
+  def test04_strided_output(self):
+
+    # results are written in place on strided outputs
+    src = numpy.random.rand(8, 4)
+    t = bob.sp.FFT2D(8, 4)
+    out = numpy.zeros((8, 8), 'complex128')
+    t(src.astype('complex128'), out[:,::2])
+    self.assertTrue(numpy.allclose(out[:,::2], numpy.fft.fft2(src)))
+
+  def test05_strided_contiguous_callees(self):
+
+    # C++ functions that need contiguous memory accept strided arguments
+    jets = numpy.random.rand(2, 80) + 0.1
+    strided = jets[:,::2]
+    contiguous = strided.copy()
+    for t in (bob.machine.gabor_jet_similarity_type.SCALAR_PRODUCT,
+        bob.machine.gabor_jet_similarity_type.CANBERRA,
+        bob.machine.gabor_jet_similarity_type.DISPARITY,
+        bob.machine.gabor_jet_similarity_type.PHASE_DIFF):
+      similarity = bob.machine.GaborJetSimilarity(t)
+      self.assertAlmostEqual(similarity(strided, jets[:,1::2]),
+          similarity(contiguous, jets[:,1::2].copy()))
+      if t < bob.machine.gabor_jet_similarity_type.DISPARITY:
+        self.assertAlmostEqual(similarity(strided[0], jets[1,::2]),
+            similarity(contiguous[0], jets[1,::2].copy()))
+
+    h = numpy.random.random_integers(0, 99, size=(2, 100)).astype('float64')
+    for measure in (bob.math.histogram_intersection, bob.math.chi_square,
+        bob.math.kullback_leibler):
+      self.assertAlmostEqual(measure(h[:,0], h[:,1]),
+          measure(h[:,0].copy(), h[:,1].copy()))
@@ -42,7 +42,7 @@ def create_directories_save(directory, dryrun=False):
       raise
 
 
-def load(inputs):
+def load(inputs, scale_denom=1, gray=False, roi=None):
   """Loads the contents of a file, an iterable of files, or an iterable of
   :py:class:`bob.io.File`'s into a :py:class:`numpy.ndarray`.
 
@@ -66,18 +66,31 @@ def load(inputs):
     4. An iterable with mixed filenames and :py:class:`bob.io.File`. In this
        case, this would returned a 2D :py:class:`numpy.ndarray`, as described
        by points 2 and 3 above.
+
+  scale_denom, gray, roi
+
+    Options to decode JPEG and PNG images at a lower cost than loading them
+    fully and then scaling, converting or cropping the result: the images
+    are decoded at 1/scale_denom of their size, as a single gray plane if
+    gray is set and only within the region of interest roi = (y, x, height,
+    width) of the scaled image, if given. See
+    :py:meth:`bob.io.File.set_decode_options`. Files given as
+    :py:class:`bob.io.File` are read as they are.
   """
 
   from collections import Iterable
   import numpy
   from .utils import is_string
   if is_string(inputs):
-    return File(inputs, 'r').read()
+    f = File(inputs, 'r')
+    if scale_denom != 1 or gray or roi is not None:
+      f.set_decode_options(scale_denom, gray, roi)
+    return f.read()
   elif isinstance(inputs, Iterable):
     retval = []
     for obj in inputs:
       if is_string(obj):
-        retval.append(load(obj))
+        retval.append(load(obj, scale_denom, gray, roi))
       elif isinstance(obj, File):
         retval.append(obj.read())
       else:
@@ -231,6 +231,48 @@ def test_tensorfile():
   # complete transcoding test
   transcode(testutils.datafile('torch.tensor', __name__))
 
+def test_array_container():
+
+  # array and arrayset writing tests
+  a1 = numpy.random.normal(size=(3,4)).astype('float32')
+  a2 = numpy.random.normal(size=(3,4,5)).astype('float64')
+  a3 = (100*numpy.random.normal(size=(2,3,4,5))).astype('int32')
+
+  array_readwrite('.arrays', a1)
+  array_readwrite('.arrays', a2)
+  array_readwrite('.arrays', a3)
+  arrayset_readwrite('.arrays', [a1, a2, a3, a1]) #any type and shape
+
+  # conversion from other formats, arrays are read without copies
+  from .. import ArrayContainer
+  tmpname = testutils.temporary_filename(suffix='.arrays')
+  hdf5name = testutils.temporary_filename(suffix='.hdf5')
+  try:
+    original = File(hdf5name, 'w')
+    for k in range(5): original.append(a2 + k)
+    del original
+    original = File(hdf5name, 'r')
+    c = ArrayContainer(tmpname, 'w')
+    assert c.extend(original) == len(original)
+    reader = ArrayContainer(tmpname)
+    assert len(reader) == len(original)
+    for k in range(len(original)):
+      assert numpy.array_equal(reader[k], original.read(k))
+    view = reader.read(0)
+    assert not view.flags.writeable
+    assert numpy.array_equal(load(tmpname), original.read())
+
+    # readers only see new arrays after a refresh
+    c.append(a2)
+    assert len(reader) == len(original)
+    assert reader.refresh() == len(original) + 1
+    assert numpy.array_equal(reader[-1], a2)
+    del c, reader
+    assert numpy.array_equal(view, original.read(0)) #keeps the mapping
+  finally:
+    if os.path.exists(tmpname): os.unlink(tmpname)
+    if os.path.exists(hdf5name): os.unlink(hdf5name)
+
 @testutils.extension_available('.pgm')
 @testutils.extension_available('.pbm')
 @testutils.extension_available('.ppm')
@@ -284,3 +326,40 @@ def test_csv():
   arrayset_readwrite('.csv', a1, close=True)
   arrayset_readwrite(".csv", a2, close=True)
   arrayset_readwrite('.csv', a3, close=True)
+
+@testutils.extension_available('.csv')
+def test_csv_format():
+
+  tmpname = testutils.temporary_filename(suffix='.csv')
+
+  try:
+    # values are written as printf("%.10e") would and parsed back exactly
+    a = numpy.random.normal(size=(2000,20)) * \
+        10.**numpy.random.randint(-30, 30, size=(2000,20))
+    a[0,:3] = (0., -0., 1e300)
+    write(a, tmpname)
+    lines = open(tmpname).read().split('\n')
+    assert lines[-1] == ''
+    assert lines[0].split(',')[0] == '%.10e' % a[0,0]
+    assert lines[10] == ','.join(['%.10e' % k for k in a[10]])
+    b = load(tmpname)
+    assert numpy.array_equal(b, [[float('%.10e' % k) for k in row] for row in a])
+
+    # hand-written files: blanks, quotes, empty lines and no final new line
+    f = open(tmpname, 'wt')
+    f.write('1, 2.5 ,"3"\r\n\n4e2,-5,.5')
+    f.close()
+    f = File(tmpname, 'a')
+    assert len(f) == 2
+    f.append(numpy.array([7., 8., 9.]))
+    del f
+    assert numpy.array_equal(load(tmpname),
+        [[1., 2.5, 3.], [400., -5., .5], [7., 8., 9.]])
+
+    f = open(tmpname, 'wt')
+    f.write('1,2\n3,x\n')
+    f.close()
+    nose.tools.assert_raises(RuntimeError, load, tmpname)
+
+  finally:
+    if os.path.exists(tmpname): os.unlink(tmpname)
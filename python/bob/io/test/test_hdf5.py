@@ -26,7 +26,7 @@ import numpy
 import random
 import nose.tools
 
-from .. import HDF5File, load, save, peek_all
+from .. import HDF5File, HDF5Appender, HDF5VirtualDataset, load, save, peek_all
 from ...test import utils as testutils
 
 def read_write_check(outfile, dname, data, dtype=None):
@@ -420,3 +420,86 @@ def test_append_compression():
   finally:
 
     os.unlink(tmpname)
+
+def test_appender():
+
+  try:
+
+    tmpname = testutils.temporary_filename()
+    outfile = HDF5File(tmpname, 'w')
+    data = numpy.random.random((50,7))
+    rows = HDF5Appender(outfile, 'rows', block_size=8, queue_size=1)
+    values = HDF5Appender(outfile, 'values', block_size=8)
+    for k in range(len(data)):
+      rows.append(data[k])
+      values.append(float(k))
+    values.extend([50., 51.])
+    nose.tools.eq_(len(rows), 50)
+    nose.tools.assert_raises(RuntimeError, rows.append, data[0,:3])
+    rows.flush()
+    values.flush()
+    assert numpy.array_equal(outfile.read('rows'), data)
+    assert numpy.array_equal(outfile.read('values'), numpy.arange(52.))
+
+    # the remaining entries are written when the appender is deleted
+    rows.append(data[0])
+    del rows
+    assert numpy.array_equal(outfile.lread('rows', 50), data[0])
+
+  finally:
+
+    os.unlink(tmpname)
+
+def test_virtual_dataset():
+
+  data = numpy.random.random((7,5))
+  sizes = (3, 1, 3)
+  filenames = [testutils.temporary_filename() for k in sizes]
+  indexname = testutils.temporary_filename()
+
+  try:
+
+    start = 0
+    for filename, size in zip(filenames, sizes):
+      outfile = HDF5File(filename, 'w')
+      outfile.create_group('/data')
+      outfile.cd('/data')
+      for k in range(start, start+size):
+        outfile.append('features', data[k])
+      start += size
+      del outfile
+
+    v = HDF5VirtualDataset(filenames, '/data/features', max_open=2)
+    nose.tools.eq_(len(v), 7)
+    nose.tools.eq_(v.filenames, tuple(filenames))
+    nose.tools.eq_(v.type_all.shape, (7,5))
+    assert v.open_files == 0
+    assert numpy.array_equal(v.read(4), data[4])
+    assert numpy.array_equal(v.read(2, 3), data[2:5])
+    rows = [6, 0, 1, 5, 2]
+    assert numpy.array_equal(v.read_rows(rows), data[rows])
+    assert v.open_files <= 2
+
+    # prefetches batches of shuffled rows
+    random.shuffle(rows)
+    v.start(2, rows=rows)
+    batches = [v.next() for k in range(3)]
+    assert v.next() is None
+    assert numpy.array_equal(numpy.vstack(batches), data[rows])
+
+    # the index is loaded back without scanning the files
+    index = HDF5File(indexname, 'w')
+    v.save(index)
+    del index
+    w = HDF5VirtualDataset(HDF5File(indexname, 'r'))
+    nose.tools.eq_(w.path, '/data/features')
+    nose.tools.eq_(len(w), 7)
+    assert w.open_files == 0
+    assert numpy.array_equal(w.read(0, 7), data)
+
+    nose.tools.assert_raises(RuntimeError, v.read, 7)
+
+  finally:
+
+    for filename in filenames + [indexname]:
+      if os.path.exists(filename): os.unlink(filename)
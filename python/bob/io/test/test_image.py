@@ -37,3 +37,118 @@ def test_png_indexed_color():
   assert img.shape == (3,22,32)
   assert img[0,0,0] == 255
   assert img[0,17,17] == 117
+
+def test_image_list_loader():
+
+  # Decodes a list of color images in parallel and in prefetched batches
+  import shutil
+  import tempfile
+  from .. import save, load, ImageListLoader
+  tmpdir = tempfile.mkdtemp()
+  try:
+    numpy.random.seed(0)
+    filenames = []
+    for k in range(7):
+      filenames.append(os.path.join(tmpdir, 'img%d.png' % k))
+      save(numpy.random.randint(0, 256, (3,11,13)).astype('uint8'), filenames[-1])
+    images = numpy.array([load(f) for f in filenames])
+
+    loader = ImageListLoader(filenames, n_threads=3)
+    assert len(loader) == 7
+    assert loader.type_all.shape == (7,3,11,13)
+    assert numpy.array_equal(loader.read(), images)
+    assert numpy.array_equal(loader.read(2, 4), images[2:6])
+
+    loader.start(batch_size=3, queue_size=1)
+    batches = []
+    batch = loader.next()
+    while batch is not None:
+      batches.append(batch)
+      batch = loader.next()
+    assert [len(b) for b in batches] == [3, 3, 1]
+    assert numpy.array_equal(numpy.vstack(batches), images)
+    assert not loader.serialized
+
+    # arrays read through HDF5 give the same results, whether or not the
+    # HDF5 library allows them to be decoded concurrently
+    arrays = []
+    for k in range(5):
+      arrays.append(os.path.join(tmpdir, 'arr%d.hdf5' % k))
+      save(images[k], arrays[-1])
+    loader = ImageListLoader(arrays, n_threads=3)
+    assert numpy.array_equal(loader.read(), images[:5])
+    loader.start(batch_size=2)
+    batches = []
+    batch = loader.next()
+    while batch is not None:
+      batches.append(batch)
+      batch = loader.next()
+    assert [len(b) for b in batches] == [2, 2, 1]
+    assert numpy.array_equal(numpy.vstack(batches), images[:5])
+    loader.stop()
+    try:
+      loader.next()
+      assert False, "next() did not raise after stop()"
+    except RuntimeError:
+      pass
+
+    # images of another shape are rejected
+    save(numpy.zeros((3,5,5), 'uint8'), filenames[4])
+    try:
+      loader.read()
+      assert False, "loading images of different shapes did not raise"
+    except RuntimeError:
+      pass
+  finally:
+    shutil.rmtree(tmpdir)
+
+def test_decode_options():
+
+  # Decodes scaled, gray and cropped versions of PNG and JPEG images
+  import shutil
+  import tempfile
+  from .. import save, load, File, ImageListLoader
+  tmpdir = tempfile.mkdtemp()
+  try:
+    numpy.random.seed(0)
+    gray = numpy.random.randint(0, 256, (37,53)).astype('uint8')
+    png = os.path.join(tmpdir, 'gray.png')
+    save(gray, png)
+
+    # regions of interest are exact crops
+    assert numpy.array_equal(load(png, roi=(5,7,20,30)), gray[5:25,7:37])
+    assert numpy.array_equal(load(png, roi=(5,7,0,0)), gray[5:,7:])
+
+    # scaled PNG images are averaged over blocks (smaller on the borders)
+    scaled = load(png, scale_denom=4)
+    assert scaled.shape == (10,14)
+    assert scaled[0,0] == int(gray[:4,:4].mean() + 0.5)
+    assert scaled[9,13] == int(gray[36:,52:].mean() + 0.5)
+    assert numpy.array_equal(load(png, scale_denom=4, roi=(2,3,5,6)), scaled[2:7,3:9])
+
+    # JPEG images are scaled by the decoder, to ceil(size / scale_denom)
+    color = numpy.random.randint(0, 256, (3,37,53)).astype('uint8')
+    jpg = os.path.join(tmpdir, 'color.jpg')
+    save(color, jpg)
+    full = load(jpg)
+    assert load(jpg, gray=True).shape == (37,53)
+    assert load(jpg, scale_denom=2).shape == (3,19,27)
+    assert load(jpg, scale_denom=8, gray=True).shape == (5,7)
+    assert numpy.array_equal(load(jpg, roi=(9,17,10,20)), full[:,9:19,17:37])
+
+    f = File(jpg, 'r')
+    f.set_decode_options(scale_denom=2, roi=(1,2,10,0))
+    assert f.type.shape == (3,10,25)
+    assert f.read().shape == (3,10,25)
+    for options in ({'scale_denom': 3}, {'roi': (30,0,10,0)}):
+      try:
+        f.set_decode_options(**options)
+        assert False, "invalid decoding options did not raise"
+      except RuntimeError:
+        pass
+
+    # the options also apply to lists of images
+    loader = ImageListLoader([jpg, jpg], scale_denom=4, gray=True)
+    assert loader.read().shape == (2,10,14)
+  finally:
+    shutil.rmtree(tmpdir)
@@ -61,6 +61,66 @@ def test_can_iterate():
 
   assert counter == len(video) #we have gone through all frames
 
+@testutils.ffmpeg_found()
+def test_keyframe_index():
+
+  # Random access after building the index of the keyframes gives the same
+  # frames as decoding the whole video, and the index can be saved
+  from .. import VideoReader
+  video = VideoReader(INPUT_VIDEO)
+  assert not video.has_index
+  assert video.keyframes == ()
+  array = video.load()
+
+  fname = testutils.temporary_filename(suffix='.hdf5')
+
+  try:
+
+    video.build_index(fname)
+    assert video.has_index
+    assert len(video.keyframes) > 0
+    assert video.keyframes[0] == 0
+    assert len(video) >= len(video.keyframes)
+
+    for k in (len(array)-1, 3, 0, len(array)//2, 4):
+      assert numpy.array_equal(video[k], array[k])
+
+    # loaded back from the file, without reading the video
+    other = VideoReader(INPUT_VIDEO)
+    other.build_index(fname)
+    assert other.keyframes == video.keyframes
+    assert len(other) == len(video)
+
+  finally:
+
+    if os.path.exists(fname): os.unlink(fname)
+
+@testutils.ffmpeg_found()
+def test_frame_cache():
+
+  # Frames read once are kept in memory, up to cache_size frames, and are
+  # shared by all iterators of a reader
+  from .. import VideoReader
+  video = VideoReader(INPUT_VIDEO)
+  array = video[:10]
+  assert video.cache_size == 0
+  assert video.cached_frames == 0
+
+  video.cache_size = 5
+  for k, frame in enumerate(video):
+    if k == 10: break
+  assert video.cached_frames == 5
+
+  # sliding window over frames in the cache or not
+  for k in (9, 5, 8, 2, 9):
+    assert numpy.array_equal(video[k], array[k])
+  assert video.cached_frames == 5
+
+  video.cache_size = 2
+  assert video.cached_frames == 2
+  video.cache_size = 0
+  assert video.cached_frames == 0
+
 @testutils.ffmpeg_found()
 def check_format_codec(function, shape, framerate, format, codec, maxdist):
 
@@ -229,3 +289,41 @@ def test_user_video():
       check_user_video.description = "%s.test_user_video_format_%s_codec_%s" % (__name__, format, codec)
       distortion = distortions.get(codec, distortions['default'])
       yield check_user_video, format, codec, distortion
+
+@testutils.ffmpeg_found()
+def test_threaded_writer():
+
+  # Writing frames asynchronously, on several threads, gives the same video
+  # as writing them on the calling thread (up to the encoding distortion)
+  from .. import VideoReader, VideoWriter
+  MAXLENTH = 10 #use only the first 10 frames
+
+  orig_vreader = VideoReader(INPUT_VIDEO)
+  orig = orig_vreader[:MAXLENTH]
+  (olength, _, oheight, owidth) = orig.shape
+
+  fname = testutils.temporary_filename(suffix='.avi')
+
+  try:
+
+    # frames one by one, then a 4D array, with a queue smaller than the video
+    outv = VideoWriter(fname, oheight, owidth, orig_vreader.frame_rate,
+        threads=2, queue_size=3)
+    assert outv.threads == 2
+    assert outv.queue_size == 3
+    for k in orig[:5]: outv.append(k)
+    outv.append(orig[5:])
+    assert len(outv) == MAXLENTH
+    outv.close()
+
+    reloaded = VideoReader(fname).load()
+    assert len(reloaded) == MAXLENTH, "original length %d != %d reloaded" % (MAXLENTH, len(reloaded))
+
+    dist = []
+    for k, of in enumerate(orig):
+      dist.append(abs(of.astype('float64')-reloaded[k].astype('float64')).mean())
+    assert max(dist) <= 2.3, "max(distortion) %g > %g allowed" % (max(dist), 2.3)
+
+  finally:
+
+    if os.path.exists(fname): os.unlink(fname)
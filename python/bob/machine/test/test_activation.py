@@ -256,3 +256,22 @@ def test_4d_ndarray():
     assert is_close(op.f(x), Y_f.flat[k])
     assert is_close(op.f_prime(x), Y_f_prime.flat[k])
     assert is_close(op.f_prime_from_f(x), Y_f_prime_from_f.flat[k])
+
+def test_2d_ndarray_all_activations():
+
+  # 2D arrays go through the array-level implementations
+  X = numpy.random.rand(5, 7) - 0.5
+  ops = [
+      IdentityActivation(),
+      LinearActivation(numpy.random.rand()),
+      HyperbolicTangentActivation(),
+      MultipliedHyperbolicTangentActivation(numpy.random.rand(), numpy.random.rand()),
+      LogisticActivation(),
+      ]
+
+  for op in ops:
+    Y_f = op.f(X)
+    Y_f_prime_from_f = op.f_prime_from_f(Y_f)
+    for k,x in enumerate(X.flat):
+      assert is_close(op.f(x), Y_f.flat[k]), '%s: array-level f() does not match' % op
+      assert is_close(op.f_prime_from_f(op.f(x)), Y_f_prime_from_f.flat[k]), '%s: array-level f_prime_from_f() does not match' % op
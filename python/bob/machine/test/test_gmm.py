@@ -229,3 +229,35 @@ class GMMMachineTest(unittest.TestCase):
     # implementation
     matlab_ll_ref = -2.361583051672024e+02
     self.assertTrue( abs(gmm(data) - matlab_ll_ref) < 1e-10)
+
+  def test05_GMMMachine(self):
+    """Test a GMMMachine against a direct evaluation of the mixture"""
+
+    numpy.random.seed(7)
+    weights = numpy.array([0.2, 0.5, 0.3], 'float64')
+    means = numpy.random.randn(3, 5)
+    variances = numpy.random.rand(3, 5) + 0.1
+    gmm = bob.machine.GMMMachine(3, 5)
+    gmm.weights = weights
+    gmm.means = means
+    gmm.variances = variances
+
+    # samples as the columns of a C-ordered array, i.e. not contiguous
+    data = numpy.random.randn(5, 20).T
+    stats = bob.machine.GMMStats(3, 5)
+    gmm.acc_statistics(data, stats)
+
+    ll = numpy.ndarray((20,), 'float64')
+    post = numpy.ndarray((20, 3), 'float64')
+    for i, x in enumerate(data):
+      l = numpy.log(weights) - 0.5 * (5 * numpy.log(2 * numpy.pi) + \
+          numpy.log(variances).sum(axis=1) + \
+          (((x - means) ** 2) / variances).sum(axis=1))
+      ll[i] = numpy.logaddexp.reduce(l)
+      post[i] = numpy.exp(l - ll[i])
+      self.assertTrue( abs(gmm.log_likelihood(x) - ll[i]) < 1e-10 )
+
+    self.assertTrue( abs(stats.log_likelihood - ll.sum()) < 1e-10 )
+    self.assertTrue( numpy.allclose(stats.n, post.sum(axis=0), atol=1e-10) )
+    self.assertTrue( numpy.allclose(stats.sum_px, numpy.dot(post.T, data), atol=1e-10) )
+    self.assertTrue( numpy.allclose(stats.sum_pxx, numpy.dot(post.T, data ** 2), atol=1e-10) )
@@ -138,3 +138,19 @@ class LinearScoringTest(unittest.TestCase):
     self.assertTrue(abs(score - ref_scores_11[1,1]) < 1e-7)
     score = bob.machine.linear_scoring(model2.mean_supervector, ubm.mean_supervector, ubm.variance_supervector, stats3, test_channeloffset[2], True)
     self.assertTrue(abs(score - ref_scores_11[1,2]) < 1e-7)
+
+    # 4/ Use the persistent scoring engine
+    engine = bob.machine.LinearScoring([model1, model2], ubm)
+    self.assertEqual(engine.n_models, 2)
+    scores = engine([stats1, stats2, stats3])
+    self.assertTrue((abs(scores - ref_scores_00) < 1e-7).all())
+    scores = engine([stats1, stats2, stats3], test_channeloffset, True)
+    self.assertTrue((abs(scores - ref_scores_11) < 1e-7).all())
+    engine = bob.machine.LinearScoring([model1.mean_supervector, model2.mean_supervector], ubm.mean_supervector, ubm.variance_supervector, n_threads=2)
+    scores = engine([stats1, stats2, stats3], [], True)
+    self.assertTrue((abs(scores - ref_scores_01) < 1e-7).all())
+
+    # 4/a/ Single precision
+    engine.single_precision = True
+    scores = engine([stats1, stats2, stats3], test_channeloffset)
+    self.assertTrue((abs(scores - ref_scores_10) / ref_scores_10 < 1e-5).all())
@@ -279,3 +279,32 @@ class SvmTest(unittest.TestCase):
     self.assertEqual(pred_labels, real_labels)
     self.assertTrue( numpy.all(abs(numpy.vstack(pred_probs) -
       numpy.vstack(real_probs)) < 1e-6) )
+
+  @utils.libsvm_available
+  def test07_strided_outputs(self):
+
+    #outputs that are slices of larger arrays are filled element by element
+    machine = bob.machine.SupportVector(IRIS_MACHINE)
+    labels, data = bob.machine.SVMFile(IRIS_DATA).read_all()
+
+    for k in data[:5]:
+      label, scores = machine.predict_class_and_scores(k)
+      n = len(scores)
+      out = numpy.zeros((n, 2), 'float64')
+      self.assertEqual(machine.predict_class_and_scores(k, out[:,0]), label)
+      self.assertTrue( numpy.array_equal(out[:,0], scores) )
+      self.assertTrue( numpy.all(out[:,1] == 0.) )
+      out = numpy.zeros((n, 2), 'float64')
+      self.assertEqual(machine.predict_class_and_scores_(k, out[:,1]), label)
+      self.assertTrue( numpy.array_equal(out[:,1], scores) )
+      self.assertTrue( numpy.all(out[:,0] == 0.) )
+
+      label, probs = machine.predict_class_and_probabilities(k)
+      n = len(probs)
+      out = numpy.zeros((2*n,), 'float64')
+      self.assertEqual(machine.predict_class_and_probabilities(k, out[::2]), label)
+      self.assertTrue( numpy.array_equal(out[::2], probs) )
+      self.assertTrue( numpy.all(out[1::2] == 0.) )
+      out = numpy.zeros((2*n,), 'float64')
+      self.assertEqual(machine.predict_class_and_probabilities_(k, out[::2]), label)
+      self.assertTrue( numpy.array_equal(out[::2], probs) )
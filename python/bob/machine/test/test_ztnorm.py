@@ -136,3 +136,33 @@ class ZTNormTest(unittest.TestCase):
     empty = numpy.zeros(shape=(0,0), dtype=numpy.float64)
     zA = bob.machine.ztnorm(my_A, my_B, empty, empty)
     self.assertTrue((abs(zA - zA_py) < 1e-7).all())
+
+  def test05_ztnorm_blocks(self):
+    my_A = bob.io.load(F("ztnorm_eval_eval.mat"))
+    my_B = bob.io.load(F("ztnorm_znorm_eval.mat"))
+    my_C = bob.io.load(F("ztnorm_eval_tnorm.mat"))
+    my_D = bob.io.load(F("ztnorm_znorm_tnorm.mat"))
+    ref_scores = bob.io.load(F("ztnorm_result.mat"))
+
+    # normalise the scores by blocks of probes, using several threads
+    ztnorm = bob.machine.ZTNorm(4)
+    ztnorm.set_tnorm_scores(my_C, my_D)
+    self.assertTrue(ztnorm.has_tnorm)
+    block = 7
+    for k in range(0, my_A.shape[0], block):
+      scores = ztnorm.normalize(my_A[k:k+block,:], my_B[k:k+block,:])
+      self.assertTrue((abs(scores - ref_scores[k:k+block,:]) < 1e-7).all())
+
+    # in place
+    scores = my_A.copy()
+    ztnorm.normalize_inplace(scores, my_B)
+    self.assertTrue((abs(scores - ref_scores) < 1e-7).all())
+
+    # T-Norm only
+    ztnorm.set_tnorm_scores(my_C)
+    self.assertTrue((abs(ztnorm.normalize(my_A) - tnorm(my_A, my_C)) < 1e-7).all())
+
+    # Z-Norm only
+    ztnorm.reset_tnorm()
+    self.assertFalse(ztnorm.has_tnorm)
+    self.assertTrue((abs(ztnorm.normalize(my_A, my_B) - znorm(my_A, my_B)) < 1e-7).all())
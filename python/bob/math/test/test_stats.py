@@ -103,3 +103,32 @@ class StatsTest(unittest.TestCase):
     # 3.c comparison
     self.assertTrue(numpy.allclose(Sw, Sw_) )
     self.assertTrue(numpy.allclose(Sb, Sb_) )
+
+  def test03_scatter_accumulator(self):
+
+    Sw_, Sb_, m_ = scatters(self.data)
+
+    # single pass over the data
+    acc = bob.math.ScatterAccumulator(self.data[0].shape[1], len(self.data))
+    acc.add_classes(self.data)
+    self.assertEqual(acc.n_samples, sum(len(k) for k in self.data))
+    self.assertTrue(numpy.allclose(acc.sw, Sw_))
+    self.assertTrue(numpy.allclose(acc.sb, Sb_))
+    self.assertTrue(numpy.allclose(acc.st, Sw_ + Sb_))
+    self.assertTrue(numpy.allclose(acc.mean, m_))
+
+    # streaming, in small chunks and with several threads
+    acc2 = bob.math.ScatterAccumulator(self.data[0].shape[1], len(self.data), 3)
+    acc2.block_size = 4
+    for k, X in enumerate(self.data):
+      for chunk in numpy.array_split(X, 5):
+        acc2.add(chunk, k)
+    self.assertTrue(numpy.allclose(acc2.sw, Sw_))
+    self.assertTrue(numpy.allclose(acc2.sb, Sb_))
+
+    # one class is the plain scatter matrix
+    S, M = bob.math.scatter(self.data_c0)
+    acc3 = bob.math.ScatterAccumulator(self.data_c0.shape[1])
+    acc3.add(self.data_c0)
+    self.assertTrue(numpy.allclose(acc3.sw, S))
+    self.assertTrue(numpy.allclose(acc3.mean, M))
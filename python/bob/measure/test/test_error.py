@@ -21,6 +21,7 @@
 """
 
 import os, sys
+import tempfile
 import unittest
 import numpy
 import bob
@@ -308,3 +309,122 @@ class ErrorTest(unittest.TestCase):
     self.assertAlmostEqual(min_cllr, 0.337364136)
 
 
+
+  def test08_sorted_scores(self):
+
+    # This test set is not separable.
+    positives = bob.io.load(F('nonsep-positives.hdf5'))
+    negatives = bob.io.load(F('nonsep-negatives.hdf5'))
+    scores = bob.measure.SortedScores(negatives, positives, n_threads=2)
+
+    # error rates and curves are the same as without sorting
+    for t in (-1., 0., 0.5, 3.):
+      self.assertEqual(scores.farfrr(t), bob.measure.farfrr(negatives, positives, t))
+    xyref = bob.io.load(F('nonsep-roc.hdf5'))
+    self.assertTrue( numpy.array_equal(scores.roc(100), xyref) )
+    det_xyzw_ref = bob.io.load(F('nonsep-det.hdf5'))
+    self.assertTrue( numpy.allclose(scores.det(100), det_xyzw_ref, atol=1e-15) )
+
+    # the exact EER threshold is at least as good as the grid search one
+    threshold = scores.eer_threshold()
+    far, frr = scores.farfrr(threshold)
+    far2, frr2 = scores.farfrr(bob.measure.eer_threshold(negatives, positives))
+    self.assertTrue( abs(far - frr) <= abs(far2 - frr2) )
+    self.assertAlmostEqual(scores.eer(), (far + frr) / 2.)
+
+    # same for the minimum HTER
+    far, frr = scores.farfrr(scores.min_hter_threshold())
+    far2, frr2 = scores.farfrr(bob.measure.min_hter_threshold(negatives, positives))
+    self.assertTrue( far + frr <= far2 + frr2 )
+
+    # unit weights give the same results
+    weighted = bob.measure.SortedScores(negatives, positives,
+        numpy.ones(negatives.shape), numpy.ones(positives.shape))
+    self.assertEqual(weighted.eer_threshold(), threshold)
+    self.assertEqual(weighted.farfrr(threshold), scores.farfrr(threshold))
+
+    # doubling the weight of the negatives
+    weighted = bob.measure.SortedScores(negatives, positives,
+        2 * numpy.ones(negatives.shape))
+    self.assertEqual(weighted.farfrr(threshold), scores.farfrr(threshold))
+
+    # the separable set has a zero EER
+    positives = bob.io.load(F('linsep-positives.hdf5'))
+    negatives = bob.io.load(F('linsep-negatives.hdf5'))
+    scores = bob.measure.SortedScores(negatives, positives)
+    self.assertEqual(scores.eer(), 0.)
+    self.assertEqual(scores.farfrr(scores.min_hter_threshold()), (0., 0.))
+
+  def test09_score_histogram(self):
+
+    # This test set is not separable.
+    positives = bob.io.load(F('nonsep-positives.hdf5'))
+    negatives = bob.io.load(F('nonsep-negatives.hdf5'))
+    exact = bob.measure.SortedScores(negatives, positives)
+
+    # accumulates the scores in chunks
+    histogram = bob.measure.ScoreHistogram(1024)
+    for chunk in numpy.array_split(negatives, 7):
+      histogram.add_negatives(chunk)
+    for chunk in numpy.array_split(positives, 3):
+      histogram.add_positives(chunk)
+    self.assertEqual(histogram.n_negatives, len(negatives))
+    self.assertEqual(histogram.n_positives, len(positives))
+    self.assertEqual(histogram.min, min(negatives.min(), positives.min()))
+    self.assertEqual(histogram.max, max(negatives.max(), positives.max()))
+    self.assertEqual(histogram.negative_counts.sum(), len(negatives))
+
+    # the exact error rates lie within the reported bounds
+    for t in numpy.linspace(histogram.min - 1., histogram.max + 1., 57):
+      far, frr = exact.farfrr(t)
+      far_lower, far_upper = histogram.far_bounds(t)
+      frr_lower, frr_upper = histogram.frr_bounds(t)
+      self.assertTrue(far_lower <= far <= far_upper)
+      self.assertTrue(frr_lower <= frr <= frr_upper)
+      est_far, est_frr = histogram.farfrr(t)
+      self.assertTrue(abs(est_far - far) <= histogram.far_error())
+      self.assertTrue(abs(est_frr - frr) <= histogram.frr_error())
+
+    # so do the EER and the curves
+    bound = max(histogram.far_error(), histogram.frr_error())
+    self.assertTrue(abs(histogram.eer() - exact.eer()) <= bound)
+    self.assertTrue(numpy.allclose(histogram.roc(100), exact.roc(100), atol=bound))
+    self.assertEqual(histogram.det(100).shape, (2,100))
+
+    # merging accumulators filled with parts of the scores
+    part1 = bob.measure.ScoreHistogram(1024)
+    part1.add_negatives(negatives[:len(negatives)//2])
+    part1.add_positives(positives[len(positives)//2:])
+    part2 = bob.measure.ScoreHistogram(1024)
+    part2.add_negatives(negatives[len(negatives)//2:])
+    part2.add_positives(positives[:len(positives)//2])
+    part1.merge(part2)
+    self.assertEqual(part1.n_negatives, len(negatives))
+    self.assertEqual(part1.n_positives, len(positives))
+    self.assertEqual(part1.positive_counts.sum(), len(positives))
+    bound = max(part1.far_error(), part1.frr_error())
+    self.assertTrue(abs(part1.eer() - exact.eer()) <= bound)
+    self.assertRaises(RuntimeError, part1.merge, bob.measure.ScoreHistogram(16))
+
+    # saving and loading
+    filename = str(tempfile.mkstemp(".hdf5")[1])
+    histogram.save(bob.io.HDF5File(filename, 'w'))
+    loaded = bob.measure.ScoreHistogram(bob.io.HDF5File(filename))
+    os.unlink(filename)
+    self.assertEqual(loaded.n_bins, 1024)
+    self.assertEqual(loaded.n_negatives, histogram.n_negatives)
+    self.assertEqual(loaded.n_positives, histogram.n_positives)
+    self.assertEqual(loaded.eer_threshold(), histogram.eer_threshold())
+    self.assertEqual(loaded.min_hter_threshold(), histogram.min_hter_threshold())
+
+    # empty accumulators can be saved, too
+    filename = str(tempfile.mkstemp(".hdf5")[1])
+    bob.measure.ScoreHistogram(16).save(bob.io.HDF5File(filename, 'w'))
+    loaded.load(bob.io.HDF5File(filename))
+    os.unlink(filename)
+    self.assertEqual(loaded.n_bins, 16)
+    self.assertEqual(loaded.n_negatives, 0)
+    self.assertEqual(loaded.n_positives, 0)
+    loaded.add_negatives(negatives)
+    loaded.add_positives(positives)
+    self.assertEqual(loaded.n_negatives, len(negatives))
@@ -0,0 +1,117 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# agent <agent@local>
+# Mon Oct 19 14:02:37 2026 +0200
+#
+# Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Measures how the throughput of some of the bindings of Bob scales with the
+number of Python threads calling them.
+
+Each thread creates its own objects (filter, transform or machine) and calls
+them on its own data, for a fixed number of iterations. Since the bindings
+release the Global Interpreter Lock while running the C++ code, the throughput
+should grow with the number of threads, up to the number of cores.
+"""
+
+import sys
+import time
+import argparse
+import threading
+import numpy
+
+def fft_job(size):
+  """A 2D FFT of a complex image"""
+
+  from .. import sp
+  op = sp.FFT2D(size, size)
+  data = numpy.random.rand(size, size).astype('complex128')
+  return lambda: op(data)
+
+def gaussian_job(size):
+  """A Gaussian smoothing of a gray image"""
+
+  from .. import ip
+  op = ip.Gaussian(radius_y=5, radius_x=5, sigma_y=2., sigma_x=2.)
+  data = numpy.random.rand(size, size)
+  return lambda: op(data)
+
+def gmm_job(size):
+  """The accumulation of GMM statistics for a set of feature vectors"""
+
+  from .. import machine
+  n_gaussians, n_inputs = 64, 40
+  m = machine.GMMMachine(n_gaussians, n_inputs)
+  m.means = numpy.random.rand(n_gaussians, n_inputs)
+  stats = machine.GMMStats(n_gaussians, n_inputs)
+  data = numpy.random.rand(size, n_inputs)
+  return lambda: m.acc_statistics(data, stats)
+
+JOBS = {
+    'fft': (fft_job, 512),
+    'gaussian': (gaussian_job, 1024),
+    'gmm': (gmm_job, 2000),
+    }
+
+def run(job, size, threads, iterations):
+  """Runs the job on a number of threads and returns the number of calls per
+  second, for all threads together."""
+
+  # objects are created before the clock starts, one set per thread
+  calls = [job(size) for k in range(threads)]
+
+  def worker(call):
+    for i in range(iterations): call()
+
+  pool = [threading.Thread(target=worker, args=(c,)) for c in calls]
+  start = time.time()
+  for t in pool: t.start()
+  for t in pool: t.join()
+  return (threads * iterations) / (time.time() - start)
+
+def main(user_input=None):
+
+  parser = argparse.ArgumentParser(description=__doc__,
+      formatter_class=argparse.RawDescriptionHelpFormatter)
+
+  parser.add_argument("job", metavar='JOB', type=str, nargs='*',
+      default=sorted(JOBS.keys()), choices=sorted(JOBS.keys()),
+      help="The name of the jobs to run. Choose between `%s'. If none given, run through all." % ('|'.join(sorted(JOBS.keys()))))
+  parser.add_argument("-t", "--threads", metavar="INT", type=int,
+      default=4, help="The maximum number of threads to use (defaults to %(default)s)")
+  parser.add_argument("-i", "--iterations", metavar="INT", type=int,
+      default=50, help="The number of calls per thread (defaults to %(default)s)")
+  parser.add_argument("-s", "--size", metavar="INT", type=int,
+      default=0, help="The size of the data for each job (defaults to a size that depends on the job)")
+
+  args = parser.parse_args(args=user_input)
+
+  if args.threads < 1:
+    parser.error("the number of threads should be at least 1")
+
+  for name in args.job:
+    job, size = JOBS[name]
+    if args.size: size = args.size
+    print("%s (size = %d): %s" % (name, size, job.__doc__))
+    print("  %-8s  %-12s  %s" % ("threads", "calls/s", "speed-up"))
+    reference = None
+    for threads in range(1, args.threads+1):
+      throughput = run(job, size, threads, args.iterations)
+      if reference is None: reference = throughput
+      print("  %-8d  %-12.2f  %.2f" % (threads, throughput,
+        throughput/reference))
+    sys.stdout.flush()
+
+  return 0
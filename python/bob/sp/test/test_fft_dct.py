@@ -219,3 +219,21 @@ class TransformTest(unittest.TestCase):
 
       # call the test function
       _fft2D(M, N, t, 1e-3, self)
+
+  def test_fft2D_threads(self):
+    # Transforms planned and computed from concurrent threads (without the
+    # GIL) give the same results as in a single thread
+    import threading
+    data = [numpy.random.rand(M, M).astype('complex128') for M in range(8,40)]
+    reference = [FFT2D(d.shape[0], d.shape[1])(d) for d in data]
+    results = [None] * len(data)
+
+    def worker(k):
+      for i in range(k, len(data), 4):
+        results[i] = FFT2D(data[i].shape[0], data[i].shape[1])(data[i])
+
+    pool = [threading.Thread(target=worker, args=(k,)) for k in range(4)]
+    for t in pool: t.start()
+    for t in pool: t.join()
+    for r, s in zip(results, reference):
+      self.assertTrue(numpy.allclose(r, s))
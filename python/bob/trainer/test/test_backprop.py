@@ -197,3 +197,30 @@ def test_20in_10_5_3out_with_momentum():
 
   for k in range(10):
     check_training(machine, cost, True, BATCH_SIZE, 0.1, 0.1)
+
+def test_20in_10_5_3out_sharded():
+
+  machine = MLP((20, 10, 5, 3))
+  machine.randomize()
+  machine.hidden_activation = HyperbolicTangentActivation()
+  machine.output_activation = HyperbolicTangentActivation()
+
+  BATCH_SIZE = 40
+  cost = SquareError(machine.output_activation)
+  X = numpy.random.rand(BATCH_SIZE, 20)
+  T = numpy.random.rand(BATCH_SIZE, 3)
+
+  # the same number of shards on 1 or 4 threads leads to the same machine
+  machines = []
+  for n_threads in (1, 4):
+    m = MLP(machine)
+    trainer = MLPBackPropTrainer(BATCH_SIZE, cost, m)
+    trainer.momentum = 0.1
+    trainer.shards = 4
+    trainer.n_threads = n_threads
+    for k in range(10): trainer.train(m, X, T)
+    machines.append(m)
+
+  for k in range(len(machine.weights)):
+    assert numpy.array_equal(machines[0].weights[k], machines[1].weights[k])
+    assert numpy.array_equal(machines[0].biases[k], machines[1].biases[k])
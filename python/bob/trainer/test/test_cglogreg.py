@@ -100,3 +100,71 @@ class CGLogRegTest(unittest.TestCase):
     # Makes sure results are good
     self.assertTrue( (abs(machine1.weights - weights_ref) < 2e-4).all() )
     self.assertTrue( (abs(machine1.biases - bias_ref) < 2e-4).all() )
+
+  def test02_cglogreg_threads(self):
+
+    # The result does not depend on the number of threads
+    numpy.random.seed(3)
+    positives = numpy.random.normal(1., 1., (2000, 4))
+    negatives = numpy.random.normal(-1., 1.5, (3000, 4))
+
+    T = bob.trainer.CGLogRegTrainer(0.3, 1e-8, 100, 0.5)
+    T.block_size = 128
+    T.n_threads = 1
+    machine1 = T.train(negatives, positives)
+    T.n_threads = 4
+    machine2 = T.train(negatives, positives)
+    self.assertTrue( (machine1.weights == machine2.weights).all() )
+    self.assertTrue( (machine1.biases == machine2.biases).all() )
+
+    # Non-contiguous inputs are supported
+    machine3 = T.train(negatives[:,::-1][:,::-1], numpy.asfortranarray(positives))
+    self.assertTrue( numpy.allclose(machine1.weights, machine3.weights) )
+    self.assertTrue( numpy.allclose(machine1.biases, machine3.biases) )
+
+  def test03_cglogreg_lbfgs(self):
+
+    numpy.random.seed(5)
+    positives = numpy.random.normal(1., 1., (500, 3))
+    negatives = numpy.random.normal(-1., 1.5, (800, 3))
+
+    # Both solvers find the same optimum of the regularized problem
+    T = bob.trainer.CGLogRegTrainer(0.5, 1e-10, 0, 1.)
+    machine1 = T.train(negatives, positives)
+    T.solver = bob.trainer.CGLogRegTrainer.LBFGS
+    T.convergence_threshold = 1e-8
+    self.assertEqual(T.solver, bob.trainer.CGLogRegTrainer.LBFGS)
+    machine2 = T.train(negatives, positives)
+    self.assertTrue( (abs(machine1.weights - machine2.weights) < 1e-4).all() )
+    self.assertTrue( (abs(machine1.biases - machine2.biases) < 1e-4).all() )
+
+    T2 = bob.trainer.CGLogRegTrainer(T)
+    self.assertTrue( T2 == T )
+    T2.solver = bob.trainer.CGLogRegTrainer.CONJUGATE_GRADIENT
+    self.assertFalse( T2 == T )
+
+  def test04_cglogreg_files(self):
+
+    import tempfile
+    numpy.random.seed(7)
+    positives = numpy.random.normal(1., 1., (300, 3))
+    negatives = numpy.random.normal(-1., 1.5, (400, 3))
+
+    filenames = []
+    for data in (negatives, positives):
+      (fd, filename) = tempfile.mkstemp(".hdf5")
+      os.close(fd)
+      f = bob.io.File(filename, 'w')
+      for sample in data: f.append(sample)
+      del f
+      filenames.append(filename)
+
+    try:
+      T = bob.trainer.CGLogRegTrainer(0.5, 1e-5, 30, 0.1)
+      T.block_size = 2 # several blocks are read from each file
+      machine1 = T.train(negatives, positives)
+      machine2 = T.train_files(bob.io.File(filenames[0], 'r'), bob.io.File(filenames[1], 'r'))
+      self.assertTrue( numpy.allclose(machine1.weights, machine2.weights, rtol=1e-10, atol=1e-12) )
+      self.assertTrue( numpy.allclose(machine1.biases, machine2.biases, rtol=1e-10, atol=1e-12) )
+    finally:
+      for filename in filenames: os.unlink(filename)
@@ -20,10 +20,14 @@
 """Test trainers for the LinearMachine
 """
 
+import os
 import numpy
+import tempfile
 
 from ...machine import LinearMachine
-from .. import PCATrainer, FisherLDATrainer, WhiteningTrainer, EMPCATrainer, WCCNTrainer
+from ...io import HDF5File
+from ...core.random import mt19937
+from .. import PCATrainer, IncrementalPCATrainer, FisherLDATrainer, WhiteningTrainer, EMPCATrainer, WCCNTrainer
 
 def test_pca_settings():
 
@@ -151,6 +155,92 @@ def test_pca_svd_vs_cov_random_2():
   assert numpy.allclose(machine_svd.input_divide, machine_cov.input_divide)
   assert numpy.allclose(abs(machine_svd.weights/machine_cov.weights), 1.0)
 
+def structured_data(n_samples, n_features, scales):
+  # data with a few dominant (rotated) directions and a non-zero mean
+  rng = numpy.random.RandomState(0)
+  scales = numpy.hstack((scales, 0.1*numpy.ones(n_features-len(scales))))
+  data = rng.randn(n_samples, n_features) * scales
+  rotation = numpy.linalg.qr(rng.randn(n_features, n_features))[0]
+  return data.dot(rotation) + 3.
+
+def test_pca_randomized():
+
+  data = structured_data(300, 40, [10., 6., 4.])
+  T = PCATrainer()
+  assert T.oversampling == 10
+  assert T.power_iterations == 2
+  machine, eig_vals = T.train(data)
+
+  T.rng = mt19937(5)
+  machine_rnd, eig_vals_rnd = T.train_randomized(data, 3)
+  assert machine_rnd.weights.shape == (40,3)
+  assert numpy.allclose(eig_vals_rnd, eig_vals[:3])
+  assert numpy.allclose(machine_rnd.input_subtract, machine.input_subtract)
+  assert numpy.allclose(abs(machine_rnd.weights), abs(machine.weights[:,:3]), atol=1e-6)
+
+  # explained variance
+  total = T.total_variance(data)
+  assert numpy.allclose(total, eig_vals.sum())
+  assert (eig_vals_rnd / total).sum() > 0.99
+
+  # K plus the oversampling must not exceed the data size
+  T.oversampling = 40
+  try:
+    T.train_randomized(data, 3)
+    raise AssertionError("randomized PCA should not accept K + oversampling > #features")
+  except RuntimeError:
+    pass
+
+def test_pca_incremental_from_files():
+
+  data = structured_data(300, 40, [10., 6., 4.])
+  T = PCATrainer()
+  machine, eig_vals = T.train(data)
+
+  # saves the data in chunks, as for data sets that do not fit in memory
+  filenames = []
+  for k, chunk in enumerate(numpy.array_split(data, 7)):
+    (fd, filename) = tempfile.mkstemp(".hdf5")
+    os.close(fd)
+    HDF5File(filename, 'w').set('data', chunk)
+    filenames.append(filename)
+
+  try:
+    # with as many components as features, results are exact
+    full = IncrementalPCATrainer(40)
+    first = IncrementalPCATrainer(3)
+    for filename in filenames:
+      chunk = HDF5File(filename).read('data')
+      full.update(chunk)
+      first.update(chunk)
+
+    assert full.n_samples == 300
+    machine_inc, eig_vals_inc = full.train()
+    assert numpy.allclose(eig_vals_inc, eig_vals)
+    assert numpy.allclose(machine_inc.input_subtract, machine.input_subtract)
+    assert numpy.allclose(abs(machine_inc.weights), abs(machine.weights), atol=1e-6)
+    assert numpy.allclose(full.total_variance, T.total_variance(data))
+    assert numpy.allclose(full.explained_variance_ratio.sum(), 1.)
+
+    # with fewer components, the dominant ones are well approximated
+    assert first.n_components == 3
+    machine_inc = LinearMachine(40, 3)
+    eig_vals_inc = first.train(machine_inc)
+    assert numpy.allclose(eig_vals_inc, eig_vals[:3], rtol=1e-4)
+    assert numpy.allclose(abs(machine_inc.weights), abs(machine.weights[:,:3]), atol=1e-4)
+    assert first.explained_variance_ratio.sum() > 0.99
+
+    # copies and comparisons
+    copy = IncrementalPCATrainer(first)
+    assert copy == first
+    assert copy.is_similar_to(first)
+    copy.reset()
+    assert copy.n_samples == 0
+    assert copy != first
+
+  finally:
+    for filename in filenames: os.unlink(filename)
+
 def test_fisher_lda_settings():
 
   t = FisherLDATrainer()
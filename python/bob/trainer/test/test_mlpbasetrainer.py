@@ -254,3 +254,47 @@ def test_bias_training():
 
   assert not trainer_copy.train_biases
   
+
+def test_sharded_derivatives():
+
+  machine = MLP((20, 10, 5, 3))
+  machine.hidden_activation = HyperbolicTangentActivation()
+  machine.output_activation = HyperbolicTangentActivation()
+  machine.randomize()
+
+  BATCH_SIZE = 23
+  cost = SquareError(machine.output_activation)
+  X = numpy.random.rand(BATCH_SIZE, 20)
+  T = numpy.random.rand(BATCH_SIZE, 3)
+
+  # the reference: a single pass over the whole batch
+  reference = MLPBaseTrainer(BATCH_SIZE, cost, machine)
+  assert reference.shards == 1
+  reference.forward_backward_step(machine, X, T)
+
+  # shards only change rounding
+  trainer = MLPBaseTrainer(BATCH_SIZE, cost, machine)
+  trainer.shards = 4
+  trainer.n_threads = 1
+  trainer.forward_backward_step(machine, X, T)
+  for k in range(len(machine.weights)):
+    assert numpy.allclose(trainer.derivatives[k], reference.derivatives[k])
+    assert numpy.allclose(trainer.bias_derivatives[k], reference.bias_derivatives[k])
+    assert numpy.allclose(trainer.output[k], reference.output[k])
+    assert numpy.allclose(trainer.error[k], reference.error[k])
+  assert abs(trainer.cost(T) - reference.cost(T)) < 1e-10
+
+  # for a fixed number of shards, the number of threads changes nothing
+  for n_threads in (2, 3, 4, 0):
+    threaded = MLPBaseTrainer(trainer)
+    threaded.n_threads = n_threads
+    threaded.forward_backward_step(machine, X, T)
+    for k in range(len(machine.weights)):
+      assert numpy.array_equal(threaded.derivatives[k], trainer.derivatives[k])
+      assert numpy.array_equal(threaded.bias_derivatives[k], trainer.bias_derivatives[k])
+
+  # more shards than examples
+  trainer.shards = 100
+  trainer.forward_backward_step(machine, X, T)
+  for k in range(len(machine.weights)):
+    assert numpy.allclose(trainer.derivatives[k], reference.derivatives[k])
@@ -232,3 +232,90 @@ class DataShufflerTest(unittest.TestCase):
     back_mean, back_stddev = shuffle.stdnorm()
     self.assertTrue( abs( (back_mean   - prev_mean  ).sum() ) < 1e-10)
     self.assertTrue( abs( (back_stddev - prev_stddev).sum() ) < 1e-10)
+
+  def test06_EpochShuffling(self):
+
+    # Tests that, within an epoch, all examples are drawn exactly once
+    shuffle = bob.trainer.DataShuffler([self.set1, self.set2, self.set3],
+        [self.target1, self.target2, self.target3])
+    self.assertFalse( shuffle.epoch_shuffling )
+    shuffle.epoch_shuffling = True
+    self.assertTrue( shuffle.epoch_shuffling )
+
+    rng = bob.core.random.mt19937(32)
+    orders = []
+    for epoch in range(5):
+      [data, target] = shuffle(rng, 9)
+      rows = sorted([tuple(k) for k in data])
+      expected = sorted([tuple(k) for k in 
+        numpy.vstack((self.set1, self.set2, self.set3))])
+      self.assertEqual(rows, expected)
+      orders.append(data)
+
+    # permutations are renewed at every epoch
+    self.assertFalse( all([(k == orders[0]).all() for k in orders[1:]]) )
+
+  def test07_Prefetch(self):
+
+    # Tests that prefetched batches are those drawn by consecutive calls
+    shuffle = bob.trainer.DataShuffler([self.set1, self.set2, self.set3],
+        [self.target1, self.target2, self.target3])
+    shuffle.auto_stdnorm = True
+    self.assertFalse( shuffle.prefetching )
+
+    rng = bob.core.random.mt19937(32)
+    shuffle.start_prefetch(rng, 7)
+    self.assertTrue( shuffle.prefetching )
+    self.assertEqual( shuffle.prefetch_size, 7 )
+    prefetched = [shuffle.next() for k in range(5)]
+    data = numpy.ndarray((7, shuffle.data_width), 'float64')
+    target = numpy.ndarray((7, shuffle.target_width), 'float64')
+    shuffle.next(data, target)
+    prefetched.append((data, target))
+
+    # changing the settings stops prefetching
+    shuffle.epoch_shuffling = False
+    self.assertFalse( shuffle.prefetching )
+    self.assertRaises(RuntimeError, shuffle.next)
+
+    reference = bob.trainer.DataShuffler([self.set1, self.set2, self.set3],
+        [self.target1, self.target2, self.target3])
+    reference.auto_stdnorm = True
+    for k in range(len(prefetched)):
+      [data, target] = reference(rng, 7)
+      self.assertTrue( (data == prefetched[k][0]).all() )
+      self.assertTrue( (target == prefetched[k][1]).all() )
+
+  def test08_NoCopy(self):
+
+    # Tests that data can be referred to, e.g. from a memory-mapped file
+    import tempfile
+    (fd, filename) = tempfile.mkstemp('.npy')
+    os.close(fd)
+    os.unlink(filename)
+
+    try:
+      numpy.save(filename, self.set1)
+      set1 = numpy.load(filename, mmap_mode='r')
+
+      shuffle = bob.trainer.DataShuffler([set1, self.set2, self.set3],
+          [self.target1, self.target2, self.target3], copy=False)
+      reference = bob.trainer.DataShuffler([self.set1, self.set2, self.set3],
+          [self.target1, self.target2, self.target3])
+      shuffle.auto_stdnorm = True
+      reference.auto_stdnorm = True
+      self.assertTrue( (shuffle.stdnorm()[0] == reference.stdnorm()[0]).all() )
+
+      rng1 = bob.core.random.mt19937(32)
+      rng2 = bob.core.random.mt19937(32)
+      [data1, target1] = shuffle(rng1, 50)
+      [data2, target2] = reference(rng2, 50)
+      self.assertTrue( (data1 == data2).all() )
+      self.assertTrue( (target1 == target2).all() )
+
+      # the data referred to is not normalized in place
+      self.assertTrue( (set1 == self.set1).all() )
+      del shuffle, set1
+
+    finally:
+      os.unlink(filename)
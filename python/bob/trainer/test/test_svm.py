@@ -49,6 +49,38 @@ HEART_DATA = F('heart.svmdata', 'machine') #13 inputs
 HEART_MACHINE = F('heart.svmmodel', 'machine') #supports probabilities
 HEART_EXPECTED = F('heart.out', 'machine') #expected probabilities
 
+IRIS_DATA = F('iris.svmdata', 'machine')
+IRIS_MACHINE = F('iris.svmmodel', 'machine') #trained by libsvm's svm-train
+
+def read_model(filename):
+  """Reads the header entries, the coefficients (one column per decision
+  function the vector takes part in) and the support vectors of a libsvm
+  model file"""
+  retval = {}
+  coefs, vectors = [], []
+  f = open(filename, 'rt')
+  for line in f:
+    if line.strip() == 'SV': break
+    fields = line.split()
+    if fields[0] in ('svm_type', 'kernel_type'): values = fields[1]
+    elif fields[0] in ('nr_class', 'total_sv'): values = int(fields[1])
+    elif fields[0] in ('label', 'nr_sv'): values = [int(v) for v in fields[1:]]
+    else: values = [float(v) for v in fields[1:]]
+    retval[fields[0]] = values
+  for line in f:
+    fields = line.split()
+    coefs.append([float(v) for v in fields if ':' not in v])
+    vector = numpy.zeros((4,), 'float64')
+    for v in fields:
+      if ':' in v:
+        index, value = v.split(':')
+        vector[int(index)-1] = float(value)
+    vectors.append(vector)
+  f.close()
+  retval['sv_coef'] = numpy.array(coefs)
+  retval['SV'] = numpy.array(vectors)
+  return retval
+
 class SvmTrainingTest(unittest.TestCase):
   """Performs various SVM training tests."""
 
@@ -148,3 +180,113 @@ class SvmTrainingTest(unittest.TestCase):
     curr_scores = numpy.array(curr_scores)
     prev_scores = numpy.array(prev_scores)
     #self.assertTrue( numpy.all(abs(curr_scores-prev_scores) < 1e-8) )
+
+  @utils.libsvm_available
+  def test04_linear_batch_prediction(self):
+
+    # two-class problem
+    f = bob.machine.SVMFile(HEART_DATA)
+    labels, data = f.read_all()
+    data = numpy.vstack(data)
+    neg = numpy.vstack([k for i,k in enumerate(data) if labels[i] < 0])
+    pos = numpy.vstack([k for i,k in enumerate(data) if labels[i] > 0])
+
+    trainer = bob.trainer.SVMTrainer(kernel_type=bob.machine.svm_kernel_type.LINEAR)
+    machine = trainer.train((pos, neg))
+    self.assertEqual(machine.linear_weights.shape, (1, data.shape[1]))
+    self.assertEqual(machine.linear_biases.shape, (1,))
+
+    # the collapsed weights give the same results as libsvm
+    single = [machine.predict_class_and_scores(k) for k in data]
+    batch_labels, batch_scores = machine.predict_classes_and_scores(data, 3)
+    self.assertEqual(tuple([k[0] for k in single]), batch_labels)
+    self.assertTrue( numpy.allclose(numpy.vstack([k[1] for k in single]),
+      numpy.vstack(batch_scores)) )
+    self.assertEqual(machine.predict_classes(data, 1),
+        machine.predict_classes(data, 4))
+
+    # scaling is folded into the weights
+    machine.input_subtract = data.mean(axis=0)
+    machine.input_divide = data.std(axis=0) + 1.
+    single = [machine.predict_class(k) for k in data]
+    self.assertEqual(tuple(single), machine.predict_classes(data))
+
+    # three-class problem, with one decision function per pair of classes
+    f = bob.machine.SVMFile(F('iris.svmdata', 'machine'))
+    labels, data = f.read_all()
+    data = numpy.vstack(data)
+    classes = [numpy.vstack([k for i,k in enumerate(data) if labels[i] == l])
+        for l in (1, 2, 3)]
+    machine = trainer.train(classes)
+    self.assertEqual(machine.linear_weights.shape, (3, data.shape[1]))
+    single = [machine.predict_class_and_scores(k) for k in data]
+    batch_labels, batch_scores = machine.predict_classes_and_scores(data)
+    self.assertEqual(tuple([k[0] for k in single]), batch_labels)
+    self.assertTrue( numpy.allclose(numpy.vstack([k[1] for k in single]),
+      numpy.vstack(batch_scores)) )
+
+    # kernels other than linear go through libsvm
+    machine = bob.machine.SupportVector(HEART_MACHINE)
+    self.assertEqual(machine.linear_weights.size, 0)
+
+  @utils.libsvm_available
+  def test05_parallel_training(self):
+
+    f = bob.machine.SVMFile(IRIS_DATA)
+    labels, data = f.read_all()
+    data = numpy.vstack(data)
+    classes = [numpy.vstack([k for i,k in enumerate(data) if labels[i] == l])
+        for l in (1, 2, 3)]
+
+    def train(n_threads, kernel_matrix_limit, probability=False):
+      trainer = bob.trainer.SVMTrainer(probability=probability)
+      trainer.n_threads = n_threads
+      trainer.kernel_matrix_limit = kernel_matrix_limit
+      return trainer.train(classes)
+
+    # the reference is the model trained by libsvm's own svm_train() on the
+    # same data, with the same parameters: neither the precomputed kernel
+    # matrix nor the concurrent one-vs-one subproblems (and their assembly
+    # into a single model) change the machine
+    reference = bob.machine.SupportVector(IRIS_MACHINE)
+    reference_model = read_model(IRIS_MACHINE)
+    reference_labels, reference_scores = \
+        reference.predict_classes_and_scores(data)
+    for n_threads, limit in ((1, 0), (4, 0), (1, 512), (4, 512)):
+      machine = train(n_threads, limit)
+      self.assertEqual(machine.shape, reference.shape)
+      self.assertEqual(machine.labels, reference.labels)
+      curr_labels, curr_scores = machine.predict_classes_and_scores(data)
+      self.assertEqual(curr_labels, reference_labels)
+      self.assertTrue( numpy.all(abs(numpy.array(curr_scores) - \
+        numpy.array(reference_scores)) < 1e-5) )
+
+      filename = tempname('.svmmodel')
+      machine.save(filename)
+      model = read_model(filename)
+      os.unlink(filename)
+      for key in ('nr_class', 'total_sv', 'label', 'nr_sv'):
+        self.assertEqual(model[key], reference_model[key])
+      self.assertTrue( numpy.allclose(model['rho'], reference_model['rho'],
+        atol=1e-5) )
+      self.assertTrue( numpy.allclose(model['sv_coef'],
+        reference_model['sv_coef'], atol=1e-6) )
+      self.assertTrue( numpy.allclose(model['SV'], reference_model['SV'],
+        atol=1e-6) )
+
+    # two-class problem, with the precomputed kernel matrix
+    f = bob.machine.SVMFile(HEART_DATA)
+    labels, data = f.read_all()
+    data = numpy.vstack(data)
+    neg = numpy.vstack([k for i,k in enumerate(data) if labels[i] < 0])
+    pos = numpy.vstack([k for i,k in enumerate(data) if labels[i] > 0])
+    trainer = bob.trainer.SVMTrainer()
+    trainer.kernel_matrix_limit = 0
+    reference = trainer.train((pos, neg))
+    trainer.kernel_matrix_limit = 512
+    trainer.n_threads = 3
+    machine = trainer.train((pos, neg))
+    self.assertEqual(machine.kernel_type, reference.kernel_type)
+    self.assertEqual(machine.gamma, reference.gamma)
+    self.assertEqual(machine.predict_classes(data),
+        reference.predict_classes(data))
@@ -239,6 +239,7 @@ def setup_extension(ext_name, pc_file):
 
 CONSOLE_SCRIPTS = [
   'bob_config.py = bob.script.config:main',
+  'bob_threads_benchmark.py = bob.script.threads_benchmark:main',
   'bob_dbmanage.py = bob.db.script.dbmanage:main',
   'bob_compute_perf.py = bob.measure.script.compute_perf:main',
   'bob_eval_threshold.py = bob.measure.script.eval_threshold:main',
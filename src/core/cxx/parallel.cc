@@ -0,0 +1,52 @@
+/**
+ * @file core/cxx/parallel.cc
+ * @date Mon Oct 19 09:12:44 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Implementation of the range-splitting helpers
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/core/parallel.h>
+
+static size_t s_default_threads = 0;
+
+size_t bob::core::default_threads() {
+  if (s_default_threads) return s_default_threads;
+  size_t n = boost::thread::hardware_concurrency();
+  return n ? n : 1;
+}
+
+void bob::core::set_default_threads(size_t n) {
+  s_default_threads = n;
+}
+
+void bob::core::split_range(uint64_t size, size_t n_threads,
+    std::vector<std::pair<uint64_t,uint64_t> >& ranges) {
+  ranges.clear();
+  if (!size) return;
+  if (!n_threads) n_threads = 1;
+  if (n_threads > size) n_threads = size;
+
+  const uint64_t chunk = size / n_threads;
+  const uint64_t remainder = size % n_threads;
+  ranges.reserve(n_threads);
+  for (uint64_t i=0, begin=0; i<n_threads; ++i) {
+    uint64_t end = begin + chunk + (i < remainder ? 1 : 0);
+    ranges.push_back(std::make_pair(begin, end));
+    begin = end;
+  }
+}
@@ -0,0 +1,85 @@
+/**
+ * @file core/cxx/test/parallel.cc
+ * @date Mon Oct 19 09:12:44 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Tests the range-splitting multi-threading helpers
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Core-parallel Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <stdexcept>
+#include <cstdlib>
+#include <bob/core/parallel.h>
+
+struct Fill {
+  std::vector<int>& v;
+  Fill(std::vector<int>& v_): v(v_) {}
+  void operator()(size_t, uint64_t begin, uint64_t end) const {
+    for (uint64_t i=begin; i<end; ++i) v[i] = (int)i;
+  }
+};
+
+struct Thrower {
+  void operator()(size_t index, uint64_t, uint64_t) const {
+    if (index == 1) throw std::runtime_error("worker failed");
+  }
+};
+
+BOOST_AUTO_TEST_CASE( test_split_range )
+{
+  std::vector<std::pair<uint64_t,uint64_t> > ranges;
+  bob::core::split_range(10, 3, ranges);
+  BOOST_REQUIRE_EQUAL(ranges.size(), 3);
+  BOOST_CHECK_EQUAL(ranges[0].first, 0);
+  BOOST_CHECK_EQUAL(ranges[0].second, 4);
+  BOOST_CHECK_EQUAL(ranges[1].second, 7);
+  BOOST_CHECK_EQUAL(ranges[2].second, 10);
+
+  bob::core::split_range(2, 8, ranges);
+  BOOST_CHECK_EQUAL(ranges.size(), 2);
+
+  bob::core::split_range(0, 8, ranges);
+  BOOST_CHECK_EQUAL(ranges.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_for )
+{
+  std::vector<int> v(1000, -1);
+  size_t used = bob::core::parallel_for(v.size(), Fill(v), 4);
+  BOOST_CHECK_EQUAL(used, 4);
+  for (size_t i=0; i<v.size(); ++i) BOOST_CHECK_EQUAL(v[i], (int)i);
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_for_exception )
+{
+  BOOST_CHECK_THROW(bob::core::parallel_for(100, Thrower(), 4),
+      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_sort )
+{
+  std::srand(0);
+  std::vector<double> v(1000003);
+  for (size_t i=0; i<v.size(); ++i) v[i] = std::rand() / (double)RAND_MAX;
+  std::vector<double> ref(v);
+  std::sort(ref.begin(), ref.end());
+  bob::core::parallel_sort(v, std::less<double>(), 7);
+  BOOST_CHECK(v == ref);
+}
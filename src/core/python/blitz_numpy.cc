@@ -98,12 +98,15 @@ template <typename T, int N> struct bz_from_npy {
     // we cannot afford copying, only referencing.
     if (result == bob::python::BYREFERENCE) return obj_ptr;
 
-    // but, if the user passed an array of the right type, but we still need to
-    // copy, warn the user as this is a tricky case to debug.
+    // arrays of the right type that are not C-style contiguous (e.g. slices
+    // or transposes) are referred to with their strides, if possible
     PyArrayObject* arr = reinterpret_cast<PyArrayObject*>(obj_ptr);
     if (result == bob::python::WITHARRAYCOPY && 
         bob::python::ctype_to_num<T>() == PyArray_DESCR(arr)->type_num) {
-      PYTHON_ERROR(RuntimeError, "The bindings you are trying to use to this C++ method require a numpy.ndarray -> blitz::Array<%s,%d> conversion, but the array you passed, despite the correct type, is not C-style contiguous and/or properly aligned, so I cannot automatically wrap it. You can check this by yourself by printing the flags on such a variable with the command 'print(<varname>.flags)'. The only way to circumvent this problem, from python, is to create a copy the variable by issuing '<varname>.copy()' before calling the bound method. Otherwise, if you wish the copy to be executed automatically, you have to re-bind the method to use our custom 'const_ndarray' type.", bob::core::array::stringize<T>(), N);
+      if (bob::python::referable(obj)) return obj_ptr;
+
+      // otherwise, warn the user as this is a tricky case to debug.
+      PYTHON_ERROR(RuntimeError, "The bindings you are trying to use to this C++ method require a numpy.ndarray -> blitz::Array<%s,%d> conversion, but the array you passed, despite the correct type, is not properly aligned, is byte-swapped or has negative strides, so I cannot automatically wrap it. You can check this by yourself by printing the flags and strides on such a variable with the commands 'print(<varname>.flags)' and 'print(<varname>.strides)'. The only way to circumvent this problem, from python, is to create a copy the variable by issuing '<varname>.copy()' before calling the bound method. Otherwise, if you wish the copy to be executed automatically, you have to re-bind the method to use our custom 'const_ndarray' type.", bob::core::array::stringize<T>(), N);
     }
 
     return 0;
@@ -167,6 +170,7 @@ template <typename T, int N> struct bz_to_npy {
     for (int k=0; k<PyArray_NDIM(retval); ++k) stride[k] = (PyArray_STRIDES(retval)[k]/sizeof(T));
     array_type bzdest((T*)PyArray_DATA(retval), shape, stride, blitz::neverDeleteData);
     bzdest = tv;
+    bob::python::record_copy(PyArray_NBYTES(retval));
 
     return reinterpret_cast<PyObject*>(retval);
   }
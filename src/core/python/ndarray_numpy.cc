@@ -172,4 +172,8 @@ void bind_core_ndarray_numpy () {
    register_ndarray_to_npy();
    const_ndarray_from_npy();
    register_const_ndarray_to_npy();
+
+   boost::python::def("copied_arrays", &bob::python::copied_arrays, "Returns the number of arrays copied while crossing the boundary between Python and C++ (in either direction), since the start or the last call to reset_copies(). Arrays of the right type that are aligned and have positive strides (including slices and transposes) are not copied on their way to C++.");
+   boost::python::def("copied_bytes", &bob::python::copied_bytes, "Returns the number of bytes copied while crossing the boundary between Python and C++ (in either direction), since the start or the last call to reset_copies().");
+   boost::python::def("reset_copies", &bob::python::reset_copies, "Resets the counters of copied_arrays() and copied_bytes().");
 }
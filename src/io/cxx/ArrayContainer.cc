@@ -0,0 +1,370 @@
+/**
+ * @file io/cxx/ArrayContainer.cc
+ * @date Mon Oct 19 23:12:48 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief An append-only container of arrays that is memory-mapped for
+ * reading. Implementation.
+ *
+ * The file starts with a header of 64 bytes (see FileHeader), which is
+ * followed by the arrays. Each one starts at a multiple of 64 bytes with a
+ * record of 64 bytes (see RecordHeader) and its data, in C order and in the
+ * byte order of the machine that wrote it.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/static_assert.hpp>
+#include <bob/io/ArrayContainer.h>
+
+namespace {
+
+  static const char MAGIC[8] = {'B', 'O', 'B', 'A', 'R', 'R', 'A', 'Y'};
+  static const uint32_t VERSION = 1;
+  static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+  static const uint64_t ALIGNMENT = 64;
+  static const size_t MAX_DIM = 4; ///< of the format, not of this build
+
+  struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order; ///< BYTE_ORDER_MARK, as written by the machine
+    uint64_t n_entries; ///< number of arrays committed
+    uint64_t end; ///< end of the data of the last array committed
+    uint8_t reserved[32];
+  };
+
+  struct RecordHeader {
+    uint32_t dtype; ///< a bob::core::array::ElementType
+    uint32_t nd;
+    uint64_t shape[MAX_DIM];
+    uint64_t nbytes; ///< of the data
+    uint8_t reserved[16];
+  };
+
+  BOOST_STATIC_ASSERT(sizeof(FileHeader) == ALIGNMENT);
+  BOOST_STATIC_ASSERT(sizeof(RecordHeader) == ALIGNMENT);
+  BOOST_STATIC_ASSERT(BOB_MAX_DIM <= MAX_DIM);
+
+  static uint64_t align(uint64_t n) {
+    return (n + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+
+  /**
+   * A read-only array in the mapping, which it keeps alive
+   */
+  class MappedArray: public bob::core::array::interface {
+
+    public:
+
+      MappedArray(boost::shared_ptr<boost::iostreams::mapped_file_source> map,
+          const char* data, const bob::core::array::typeinfo& type):
+        m_map(map), m_data(data), m_type(type) {}
+
+      virtual ~MappedArray() {}
+
+      virtual void set(const bob::core::array::interface&) { readonly(); }
+      virtual void set(boost::shared_ptr<bob::core::array::interface>)
+      { readonly(); }
+      virtual void set(const bob::core::array::typeinfo&) { readonly(); }
+
+      virtual const bob::core::array::typeinfo& type() const { return m_type; }
+
+      virtual void* ptr() { return const_cast<char*>(m_data); }
+      virtual const void* ptr() const { return m_data; }
+
+      virtual boost::shared_ptr<void> owner() {
+        return boost::const_pointer_cast<boost::iostreams::mapped_file_source>(m_map);
+      }
+      virtual boost::shared_ptr<const void> owner() const { return m_map; }
+
+    private:
+
+      void readonly() const {
+        throw std::runtime_error("arrays mapped from an array container are read-only");
+      }
+
+      boost::shared_ptr<boost::iostreams::mapped_file_source> m_map;
+      const char* m_data;
+      bob::core::array::typeinfo m_type;
+
+  };
+
+  static boost::shared_ptr<std::FILE> open_cfile(const std::string& filename,
+      const char* flags) {
+    std::FILE* fp = std::fopen(filename.c_str(), flags);
+    if (!fp) {
+      boost::format m("the array container `%s' could not be opened for writing - verify permissions and availability");
+      m % filename;
+      throw std::runtime_error(m.str());
+    }
+    return boost::shared_ptr<std::FILE>(fp, std::fclose);
+  }
+
+  static void write_at(const std::string& filename, std::FILE* fp,
+      uint64_t offset, const void* data, size_t size) {
+    if (std::fseek(fp, offset, SEEK_SET) != 0 ||
+        std::fwrite(data, 1, size, fp) != size) {
+      boost::format m("error while writing %u bytes at offset %u of array container `%s'");
+      m % size % offset % filename;
+      throw std::runtime_error(m.str());
+    }
+  }
+
+}
+
+bob::io::ArrayContainer::ArrayContainer(const std::string& filename,
+    char mode):
+  m_filename(filename),
+  m_end(ALIGNMENT)
+{
+  if (mode == 'w' || (mode == 'a' && !boost::filesystem::exists(filename))) {
+    m_out = open_cfile(filename, "w+b");
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.end = m_end;
+    write_at(m_filename, m_out.get(), 0, &header, sizeof(header));
+    std::fflush(m_out.get());
+  }
+  else if (mode == 'a') {
+    m_out = open_cfile(filename, "r+b");
+  }
+  else if (mode != 'r') {
+    boost::format m("unsupported opening mode `%c' for array container `%s'");
+    m % mode % filename;
+    throw std::runtime_error(m.str());
+  }
+
+  map();
+}
+
+bob::io::ArrayContainer::~ArrayContainer() {
+}
+
+void bob::io::ArrayContainer::map() {
+  if (!boost::filesystem::exists(m_filename)) {
+    boost::format m("array container `%s' does not exist");
+    m % m_filename;
+    throw std::runtime_error(m.str());
+  }
+
+  boost::shared_ptr<boost::iostreams::mapped_file_source> map =
+    boost::make_shared<boost::iostreams::mapped_file_source>(m_filename);
+  const char* base = map->data();
+
+  FileHeader header;
+  if (map->size() < sizeof(header)) {
+    boost::format m("file `%s' is too small to be an array container");
+    m % m_filename;
+    throw std::runtime_error(m.str());
+  }
+  std::memcpy(&header, base, sizeof(header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+    boost::format m("file `%s' is not an array container");
+    m % m_filename;
+    throw std::runtime_error(m.str());
+  }
+  if (header.version != VERSION) {
+    boost::format m("array container `%s' is of version %u, but only version %u is supported");
+    m % m_filename % header.version % VERSION;
+    throw std::runtime_error(m.str());
+  }
+  if (header.byte_order != BYTE_ORDER_MARK) {
+    boost::format m("array container `%s' was written on a machine of another byte order");
+    m % m_filename;
+    throw std::runtime_error(m.str());
+  }
+  if (header.end > map->size()) {
+    boost::format m("array container `%s' is truncated: its arrays end at byte %u, but the file only has %u bytes");
+    m % m_filename % header.end % map->size();
+    throw std::runtime_error(m.str());
+  }
+
+  // the index of the arrays already known is kept
+  std::vector<Entry> index(m_index);
+  uint64_t offset = index.size() ?
+    align(index.back().offset + index.back().type.buffer_size()) : ALIGNMENT;
+  index.reserve(header.n_entries);
+  while (index.size() < header.n_entries) {
+    RecordHeader record;
+    if (offset + sizeof(record) > header.end) {
+      boost::format m("array container `%s' is corrupted: array %u of %u is beyond the end of the data");
+      m % m_filename % index.size() % header.n_entries;
+      throw std::runtime_error(m.str());
+    }
+    std::memcpy(&record, base + offset, sizeof(record));
+    if (record.nd == 0 || record.nd > BOB_MAX_DIM) {
+      boost::format m("array %u of container `%s' has %u dimensions, but only up to %d are supported");
+      m % index.size() % m_filename % record.nd % BOB_MAX_DIM;
+      throw std::runtime_error(m.str());
+    }
+    if (record.dtype == bob::core::array::t_unknown ||
+        record.dtype > bob::core::array::t_complex256) {
+      boost::format m("array %u of container `%s' has an unknown data type (%u)");
+      m % index.size() % m_filename % record.dtype;
+      throw std::runtime_error(m.str());
+    }
+    Entry entry;
+    entry.offset = offset + sizeof(record);
+    size_t shape[BOB_MAX_DIM];
+    for (size_t k=0; k<record.nd; ++k) shape[k] = record.shape[k];
+    entry.type.set(static_cast<bob::core::array::ElementType>(record.dtype),
+        static_cast<size_t>(record.nd), shape);
+    if (entry.type.buffer_size() != record.nbytes ||
+        entry.offset + record.nbytes > header.end) {
+      boost::format m("array container `%s' is corrupted: the size of array %u does not match its type (%s)");
+      m % m_filename % index.size() % entry.type.str();
+      throw std::runtime_error(m.str());
+    }
+    index.push_back(entry);
+    offset = align(entry.offset + record.nbytes);
+  }
+
+  m_map = map;
+  m_index.swap(index);
+  m_end = header.end;
+}
+
+size_t bob::io::ArrayContainer::refresh() {
+  map();
+  return size();
+}
+
+const bob::core::array::typeinfo& bob::io::ArrayContainer::type(size_t index)
+  const {
+  if (index >= m_index.size()) {
+    boost::format m("array %u does not exist in container `%s', which has %u arrays");
+    m % index % m_filename % m_index.size();
+    throw std::runtime_error(m.str());
+  }
+  return m_index[index].type;
+}
+
+const char* bob::io::ArrayContainer::data(size_t index) const {
+  const bob::core::array::typeinfo& info = type(index); //checks the index
+  // arrays committed since the file was mapped are mapped on the first read
+  if (m_index[index].offset + info.buffer_size() > m_map->size())
+    m_map = boost::make_shared<boost::iostreams::mapped_file_source>(m_filename);
+  return m_map->data() + m_index[index].offset;
+}
+
+boost::shared_ptr<bob::core::array::interface>
+bob::io::ArrayContainer::view(size_t index) const {
+  return boost::make_shared<MappedArray>(m_map, data(index), type(index));
+}
+
+void bob::io::ArrayContainer::read(size_t index,
+    bob::core::array::interface& buffer) const {
+  const bob::core::array::typeinfo& info = type(index);
+  if (!buffer.type().is_compatible(info)) buffer.set(info);
+  std::memcpy(buffer.ptr(), data(index), info.buffer_size());
+}
+
+void bob::io::ArrayContainer::write_entry
+(const bob::core::array::interface& buffer) {
+  if (!m_out) {
+    boost::format m("array container `%s' was opened for reading only");
+    m % m_filename;
+    throw std::runtime_error(m.str());
+  }
+
+  const bob::core::array::typeinfo& info = buffer.type();
+  if (info.nd == 0 || info.nd > BOB_MAX_DIM) {
+    boost::format m("cannot append array of type %s to container `%s'");
+    m % info.str() % m_filename;
+    throw std::runtime_error(m.str());
+  }
+
+  RecordHeader record;
+  std::memset(&record, 0, sizeof(record));
+  record.dtype = info.dtype;
+  record.nd = info.nd;
+  for (size_t k=0; k<info.nd; ++k) record.shape[k] = info.shape[k];
+  record.nbytes = info.buffer_size();
+
+  const uint64_t offset = align(m_end);
+  write_at(m_filename, m_out.get(), offset, &record, sizeof(record));
+  write_at(m_filename, m_out.get(), offset + sizeof(record), buffer.ptr(),
+      record.nbytes);
+
+  // pads the data, so that the file always covers the aligned end
+  static const char zeros[ALIGNMENT] = {0};
+  const uint64_t end = offset + sizeof(record) + record.nbytes;
+  write_at(m_filename, m_out.get(), end, zeros, align(end) - end);
+
+  Entry entry;
+  entry.offset = offset + sizeof(record);
+  entry.type = info;
+  m_pending.push_back(entry);
+  m_end = end;
+}
+
+void bob::io::ArrayContainer::commit() {
+  // the data must reach the file before the header refers to it
+  std::fflush(m_out.get());
+  const uint64_t counts[2] = {m_index.size() + m_pending.size(), m_end};
+  write_at(m_filename, m_out.get(), offsetof(FileHeader, n_entries), counts,
+      sizeof(counts));
+  std::fflush(m_out.get());
+  m_index.insert(m_index.end(), m_pending.begin(), m_pending.end());
+  m_pending.clear();
+}
+
+void bob::io::ArrayContainer::rollback() {
+  // the arrays written after the last commit are overwritten by the next
+  // ones, as the end of the data is reset to the one in the header
+  m_pending.clear();
+  map();
+}
+
+size_t bob::io::ArrayContainer::append
+(const bob::core::array::interface& buffer) {
+  try {
+    write_entry(buffer);
+    commit();
+  }
+  catch (...) {
+    rollback();
+    throw;
+  }
+  return size() - 1;
+}
+
+size_t bob::io::ArrayContainer::extend(bob::io::File& file) {
+  size_t retval = 0;
+  try {
+    bob::core::array::blitz_array buffer(file.type());
+    for (size_t k=0; k<file.size(); ++k) {
+      file.read(buffer, k);
+      write_entry(buffer);
+    }
+    retval = m_pending.size();
+    commit();
+  }
+  catch (...) {
+    rollback();
+    throw;
+  }
+  return retval;
+}
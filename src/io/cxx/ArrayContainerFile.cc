@@ -0,0 +1,221 @@
+/**
+ * @file io/cxx/ArrayContainerFile.cc
+ * @date Mon Oct 19 23:12:48 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Implements the codec of memory-mapped array containers
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+
+#include <bob/io/ArrayContainer.h>
+#include <bob/io/CodecRegistry.h>
+
+class ArrayContainerFile: public bob::io::File {
+
+  public: //api
+
+    ArrayContainerFile(const std::string& path, char mode):
+      m_file(path, mode),
+      m_filename(path),
+      m_homogeneous(true) {
+        update_types();
+      }
+
+    virtual ~ArrayContainerFile() { }
+
+    virtual const std::string& filename() const {
+      return m_filename;
+    }
+
+    virtual const bob::core::array::typeinfo& type_all () const {
+      return m_type_all;
+    }
+
+    virtual const bob::core::array::typeinfo& type () const {
+      return m_type;
+    }
+
+    virtual size_t size() const {
+      return m_file.size();
+    }
+
+    virtual const std::string& name() const {
+      return s_codecname;
+    }
+
+    virtual void read_all(bob::core::array::interface& buffer) {
+
+      if (!size()) {
+        boost::format m("empty array container `%s' cannot be read");
+        m % m_filename;
+        throw std::runtime_error(m.str());
+      }
+
+      if (size() == 1) {
+        m_file.read(0, buffer);
+        return;
+      }
+
+      if (!m_homogeneous) {
+        boost::format m("the arrays of container `%s' are of different types and cannot be read at once");
+        m % m_filename;
+        throw std::runtime_error(m.str());
+      }
+
+      if(!buffer.type().is_compatible(m_type_all)) buffer.set(m_type_all);
+
+      // one copy per array, straight from the mapping
+      const size_t bytes = m_type.buffer_size();
+      char* data = static_cast<char*>(buffer.ptr());
+      for (size_t k=0; k<size(); ++k) {
+        boost::shared_ptr<bob::core::array::interface> view = m_file.view(k);
+        std::memcpy(data + k*bytes, view->ptr(), bytes);
+      }
+
+    }
+
+    virtual void read(bob::core::array::interface& buffer, size_t index) {
+
+      m_file.read(index, buffer);
+
+    }
+
+    virtual size_t append (const bob::core::array::interface& buffer) {
+
+      const size_t retval = m_file.append(buffer);
+      append_type(retval);
+      return retval;
+
+    }
+
+    virtual void write (const bob::core::array::interface& buffer) {
+
+      //we don't have a special way to treat write()'s like in HDF5.
+      append(buffer);
+
+    }
+
+  private: //methods
+
+    /**
+     * The type of the arrays is the one of the first array. If all arrays
+     * are of the same type, they can be read at once as a single array.
+     */
+    void update_types() {
+      if (!size()) return;
+      m_type = m_file.type(0);
+      m_homogeneous = true;
+      for (size_t k=1; k<size() && m_homogeneous; ++k)
+        m_homogeneous = m_file.type(k).is_compatible(m_type);
+      m_type_all = m_type;
+      if (size() > 1 && m_homogeneous && m_type.nd < BOB_MAX_DIM) {
+        size_t shape[BOB_MAX_DIM];
+        shape[0] = size();
+        for (size_t k=0; k<m_type.nd; ++k) shape[k+1] = m_type.shape[k];
+        m_type_all.set(m_type.dtype, m_type.nd + 1, shape);
+      }
+      else if (size() > 1) m_homogeneous = false;
+    }
+
+    /**
+     * Updates the types after the array at the given index was appended,
+     * comparing only its type with the one of the first array
+     */
+    void append_type(size_t index) {
+      if (index == 0) { //the first array
+        update_types();
+        return;
+      }
+      if (!m_homogeneous) return;
+      if (index == 1) { //the types are set for the first time
+        update_types();
+        return;
+      }
+      if (!m_file.type(index).is_compatible(m_type)) {
+        m_homogeneous = false;
+        m_type_all = m_type;
+        return;
+      }
+      m_type_all.shape[0] = size();
+      m_type_all.update_strides();
+    }
+
+  private: //representation
+
+    bob::io::ArrayContainer m_file;
+    std::string m_filename;
+    bob::core::array::typeinfo m_type;
+    bob::core::array::typeinfo m_type_all;
+    bool m_homogeneous;
+
+    static std::string s_codecname;
+
+};
+
+std::string ArrayContainerFile::s_codecname = "bob.array_container";
+
+/**
+ * From this point onwards we have the registration procedure. If you are
+ * looking at this file for a coding example, just follow the procedure bellow,
+ * minus local modifications you may need to apply.
+ */
+
+/**
+ * This defines the factory method F that can create codecs of this type.
+ *
+ * Here are the meanings of the mode flag that should be respected by your
+ * factory implementation:
+ *
+ * 'r': opens for reading only - no modifications can occur; it is an
+ *      error to open a file that does not exist for read-only operations.
+ * 'w': opens for reading and writing, but truncates the file if it
+ *      exists; it is not an error to open files that do not exist with
+ *      this flag.
+ * 'a': opens for reading and writing - any type of modification can
+ *      occur. If the file does not exist, this flag is effectively like
+ *      'w'.
+ *
+ * Returns a newly allocated File object that can read and write data to the
+ * file using a specific backend.
+ *
+ * @note: This method can be static.
+ */
+static boost::shared_ptr<bob::io::File>
+make_file (const std::string& path, char mode) {
+
+  return boost::make_shared<ArrayContainerFile>(path, mode);
+
+}
+
+/**
+ * Takes care of codec registration per se.
+ */
+static bool register_codec() {
+
+  boost::shared_ptr<bob::io::CodecRegistry> instance =
+    bob::io::CodecRegistry::instance();
+
+  instance->registerExtension(".arrays", "memory-mapped array container (bob)", &make_file);
+
+  return true;
+
+}
+
+static bool codec_registered = register_codec();
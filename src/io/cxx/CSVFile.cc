@@ -6,6 +6,12 @@
  * @brief Code to read and write CSV files to/from arrays. CSV files are always
  * treated as containing sequences of double precision numbers.
  *
+ * Files are memory-mapped for reading. The start of every line is found
+ * (and the number of values on each line checked) by several threads, each
+ * one scanning a part of the file, and lines are then parsed concurrently,
+ * straight into the output array. Numbers are written with the same format
+ * as printf("%.10e"), by several threads and through a buffered stream.
+ *
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  * 
  * This program is free software: you can redistribute it and/or modify
@@ -21,21 +27,350 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <sstream>
-#include <fstream>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
-#include <boost/filesystem.hpp>
 #include <boost/make_shared.hpp>
-#include <boost/tokenizer.hpp>
-
-#include <boost/shared_array.hpp>
-#include <boost/algorithm/string.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
+#include <bob/core/parallel.h>
 #include <bob/io/CodecRegistry.h>
 
-typedef boost::tokenizer<boost::escaped_list_separator<char> > Tokenizer;
+namespace {
+
+  /**
+   * Files (or batches of values to write) smaller than this are handled by
+   * a single thread
+   */
+  static const uint64_t MIN_BYTES_PER_THREAD = 1 << 20;
+  static const uint64_t MIN_VALUES_PER_THREAD = 1 << 14;
+
+  /**
+   * Number of values formatted before being written to the file
+   */
+  static const uint64_t VALUES_PER_BATCH = 1 << 22;
+
+  static const uint64_t NO_LINE = ~static_cast<uint64_t>(0);
+
+  /**
+   * Powers of 10, as correctly rounded by strtod()
+   */
+  struct Powers10 {
+    double value[309];
+    Powers10() {
+      char tmp[8];
+      for (int k=0; k<309; ++k) {
+        std::sprintf(tmp, "1e%d", k);
+        value[k] = std::strtod(tmp, 0);
+      }
+    }
+  };
+
+  static const Powers10 POW10;
+
+  static inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  static inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+  }
+
+  /**
+   * Parses a decimal number that fills [begin, end). The result is exact
+   * (i.e. the same as the one of strtod()) if the number has up to 19
+   * significant digits, that are less than 2^53, and a decimal exponent of
+   * at most 22 in absolute value: these are represented exactly by doubles
+   * and give a correctly rounded result with a single multiplication or
+   * division. Returns false for other numbers, or if the field is not a
+   * number.
+   */
+  static bool parse_fast(const char* begin, const char* end, double& value) {
+    const char* p = begin;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+
+    uint64_t mantissa = 0;
+    int digits = 0; //significant ones
+    int exponent = 0;
+    bool any = false;
+    for (; p < end && is_digit(*p); ++p) {
+      any = true;
+      if (digits < 19) {
+        mantissa = 10 * mantissa + (*p - '0');
+        if (mantissa) ++digits;
+      }
+      else return false;
+    }
+    if (p < end && *p == '.') {
+      for (++p; p < end && is_digit(*p); ++p) {
+        any = true;
+        if (digits < 19) {
+          mantissa = 10 * mantissa + (*p - '0');
+          if (mantissa) ++digits;
+          --exponent;
+        }
+        else return false;
+      }
+    }
+    if (!any) return false;
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+      ++p;
+      bool negative_exponent = false;
+      if (p < end && (*p == '-' || *p == '+'))
+        negative_exponent = (*p++ == '-');
+      if (p == end || !is_digit(*p)) return false;
+      int e = 0;
+      for (; p < end && is_digit(*p); ++p) {
+        e = 10 * e + (*p - '0');
+        if (e > 1000) return false;
+      }
+      exponent += negative_exponent ? -e : e;
+    }
+    if (p != end) return false;
+
+    if (mantissa > (static_cast<uint64_t>(1) << 53)) return false;
+    if (exponent < -22 || exponent > 22) return false;
+    const double m = static_cast<double>(mantissa);
+    value = (exponent < 0) ? m / POW10.value[-exponent] :
+      m * POW10.value[exponent];
+    if (negative) value = -value;
+    return true;
+  }
+
+  /**
+   * Parses the field [begin, end), which was stripped of blanks
+   */
+  static double parse_field(const char* begin, const char* end,
+      size_t line, const std::string& filename) {
+    // quoted fields are accepted, as when the file was read with a
+    // tokenizer
+    if (end - begin >= 2 && *begin == '"' && *(end-1) == '"') {
+      ++begin;
+      --end;
+    }
+
+    double retval;
+    if (parse_fast(begin, end, retval)) return retval;
+
+    // other numbers (e.g. with many digits, nan or inf) are parsed by
+    // strtod(), which needs a terminated string
+    const std::string field(begin, end);
+    char* stop = 0;
+    retval = std::strtod(field.c_str(), &stop);
+    if (field.empty() || stop != field.c_str() + field.size()) {
+      boost::format m("cannot parse `%s' as a number on line %u of file '%s'");
+      m % field % (line + 1) % filename;
+      throw std::runtime_error(m.str());
+    }
+    return retval;
+  }
+
+  /**
+   * Parses the n values of the line starting at data[start] into output
+   */
+  static void parse_line(const char* data, uint64_t size, uint64_t start,
+      size_t n, double* output, size_t line, const std::string& filename) {
+    const char* p = data + start;
+    const char* end = data + size;
+    for (size_t k=0; k<n; ++k) {
+      while (p < end && is_blank(*p)) ++p;
+      const char* field = p;
+      while (p < end && *p != ',' && *p != '\n') ++p;
+      const char* field_end = p;
+      while (field_end > field && is_blank(*(field_end-1))) --field_end;
+      output[k] = parse_field(field, field_end, line, filename);
+      if (k + 1 < n) {
+        if (p == end || *p != ',') {
+          boost::format m("line %d at file '%s' contains %d entries instead of %d (expected)");
+          m % (line + 1) % filename % (k + 1) % n;
+          throw std::runtime_error(m.str());
+        }
+        ++p;
+      }
+    }
+  }
+
+  /**
+   * Counts the values on the line starting at data[start], of which the
+   * end (the position of the new line or of the end of the file) is
+   * returned. Blank lines have no values.
+   */
+  static uint64_t scan_line(const char* data, uint64_t size, uint64_t start,
+      size_t& n) {
+    const char* p = data + start;
+    const char* end = data + size;
+    n = 1;
+    bool blank = true;
+    for (; p < end && *p != '\n'; ++p) {
+      if (*p == ',') ++n;
+      else if (blank && !is_blank(*p)) blank = false;
+    }
+    if (blank && n == 1) n = 0;
+    return p - data;
+  }
+
+  /**
+   * Finds the lines starting in [begin, end) and checks that they all have
+   * the same number of values. Each thread has its own outputs.
+   */
+  struct IndexLines {
+    const char* data;
+    uint64_t size;
+    std::vector<std::vector<uint64_t> >& starts; ///< of non-blank lines
+    std::vector<size_t>& columns; ///< of the first line of each thread
+    std::vector<uint64_t>& mismatch; ///< first line with other columns
+
+    IndexLines(const char* data_, uint64_t size_,
+        std::vector<std::vector<uint64_t> >& starts_,
+        std::vector<size_t>& columns_, std::vector<uint64_t>& mismatch_):
+      data(data_), size(size_), starts(starts_), columns(columns_),
+      mismatch(mismatch_) {}
+
+    void operator()(size_t thread, uint64_t begin, uint64_t end) const {
+      // the first line that starts in the range
+      uint64_t start = begin;
+      if (start) {
+        const void* nl = std::memchr(data + start - 1, '\n', size - start + 1);
+        start = nl ? static_cast<const char*>(nl) - data + 1 : size;
+      }
+
+      while (start < end) {
+        size_t n;
+        const uint64_t stop = scan_line(data, size, start, n);
+        if (n) {
+          starts[thread].push_back(start);
+          if (!columns[thread]) columns[thread] = n;
+          else if (n != columns[thread] && mismatch[thread] == NO_LINE)
+            mismatch[thread] = start;
+        }
+        start = stop + 1;
+      }
+    }
+  };
+
+  /**
+   * Parses the lines [begin, end) into their rows of the output
+   */
+  struct ParseLines {
+    const char* data;
+    uint64_t size;
+    const std::vector<uint64_t>& starts;
+    size_t columns;
+    double* output;
+    const std::string& filename;
+
+    ParseLines(const char* data_, uint64_t size_,
+        const std::vector<uint64_t>& starts_, size_t columns_,
+        double* output_, const std::string& filename_):
+      data(data_), size(size_), starts(starts_), columns(columns_),
+      output(output_), filename(filename_) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const {
+      for (uint64_t k=begin; k<end; ++k)
+        parse_line(data, size, starts[k], columns, output + k * columns, k,
+            filename);
+    }
+  };
+
+  /**
+   * Writes x as printf("%.10e") does, returning the number of characters
+   * written (at most 24). The 11 significant digits are computed from the
+   * product of x by a power of 10, of which the relative error is below
+   * 3e-16: if the result is too close to a tie to be rounded safely, or for
+   * very large, very small and non-finite numbers, printf() is used.
+   */
+  static size_t format_double(double x, char* output) {
+    char* p = output;
+    if (x != x || x - x != 0. || (x != 0. && (std::fabs(x) < 1e-280 ||
+            std::fabs(x) > 1e280))) {
+      return std::sprintf(output, "%.10e", x);
+    }
+
+    if (x < 0. || (x == 0. && 1. / x < 0.)) {
+      *p++ = '-';
+      x = -x;
+    }
+
+    if (x == 0.) {
+      std::memcpy(p, "0.0000000000e+00", 16);
+      return p - output + 16;
+    }
+
+    int exponent = static_cast<int>(std::floor(std::log10(x)));
+    uint64_t digits = 0;
+    for (int attempt=0; attempt<3; ++attempt) {
+      const int k = 10 - exponent;
+      const double m = (k >= 0) ? x * POW10.value[k] : x / POW10.value[-k];
+      const double r = std::floor(m + 0.5);
+      if (std::fabs(m - std::floor(m) - 0.5) < 1e-4)
+        return std::sprintf(output, "%.10e", (output == p) ? x : -x);
+      if (r >= 1e11) { ++exponent; continue; }
+      if (r < 1e10) { --exponent; continue; }
+      digits = static_cast<uint64_t>(r);
+      break;
+    }
+    if (!digits) return std::sprintf(output, "%.10e", (output == p) ? x : -x);
+
+    char tmp[11];
+    for (int k=10; k>=0; --k) {
+      tmp[k] = '0' + static_cast<char>(digits % 10);
+      digits /= 10;
+    }
+    *p++ = tmp[0];
+    *p++ = '.';
+    std::memcpy(p, tmp + 1, 10);
+    p += 10;
+    *p++ = 'e';
+    *p++ = (exponent < 0) ? '-' : '+';
+    const int e = std::abs(exponent);
+    if (e >= 100) *p++ = '0' + static_cast<char>(e / 100);
+    *p++ = '0' + static_cast<char>((e / 10) % 10);
+    *p++ = '0' + static_cast<char>(e % 10);
+    return p - output;
+  }
+
+  /**
+   * Formats the rows [begin, end) of a batch into the text of the thread
+   */
+  struct FormatRows {
+    const double* data;
+    size_t columns;
+    std::vector<std::string>& text;
+
+    FormatRows(const double* data_, size_t columns_,
+        std::vector<std::string>& text_):
+      data(data_), columns(columns_), text(text_) {}
+
+    void operator()(size_t thread, uint64_t begin, uint64_t end) const {
+      std::string& out = text[thread];
+      out.resize((end - begin) * columns * 25);
+      char* p = &out[0];
+      for (uint64_t r=begin; r<end; ++r) {
+        const double* row = data + r * columns;
+        for (size_t k=0; k<columns; ++k) {
+          p += format_double(row[k], p);
+          *p++ = (k + 1 < columns) ? ',' : '\n';
+        }
+      }
+      out.resize(p - &out[0]);
+    }
+  };
+
+  static size_t threads_for(uint64_t work, uint64_t min_work) {
+    return std::max<size_t>(1,
+        std::min<uint64_t>(bob::core::default_threads(), work / min_work));
+  }
+
+}
 
 class CSVFile: public bob::io::File {
 
@@ -48,33 +383,54 @@ class CSVFile: public bob::io::File {
      */
     void peek() {
 
-      std::string line;
-      size_t line_number = 0;
+      m_pos.clear();
+      m_map.reset();
+      m_stale = false;
+
+      const uint64_t size = boost::filesystem::file_size(m_filename);
+      if (size) {
+        m_map = boost::make_shared<boost::iostreams::mapped_file_source>(m_filename);
+        m_needs_newline = (m_map->data()[size-1] != '\n');
+      }
+
+      // lines are indexed in parallel, then gathered in order
+      const size_t n_threads = threads_for(size, MIN_BYTES_PER_THREAD);
+      std::vector<std::vector<uint64_t> > starts(n_threads);
+      std::vector<size_t> columns(n_threads, 0);
+      std::vector<uint64_t> mismatch(n_threads, NO_LINE);
+      if (size) {
+        bob::core::parallel_for(size, IndexLines(m_map->data(), size, starts,
+              columns, mismatch), n_threads);
+      }
+
       size_t entries = 0;
-      std::streampos cur_pos = 0;
-
-      m_file.seekg(0); //< returns to the begin of file and start reading...
-
-      while (std::getline(m_file,line)) {
-        ++line_number;
-        m_pos.push_back(cur_pos);
-        cur_pos = m_file.tellg();
-        Tokenizer tok(line);
-        size_t size = std::distance(tok.begin(), tok.end());
-        if (!entries) entries = size;
-        else if (entries != size) {
-          boost::format m("line %d at file '%s' contains %d entries instead of %d (expected)");
-          m % line_number % m_filename % size % entries;
-          throw std::runtime_error(m.str());
+      uint64_t bad = NO_LINE;
+      for (size_t t=0; t<n_threads; ++t) {
+        if (!columns[t]) continue;
+        if (!entries) entries = columns[t];
+        if (bad == NO_LINE) {
+          if (columns[t] != entries) bad = starts[t][0];
+          else bad = mismatch[t];
         }
+        m_pos.insert(m_pos.end(), starts[t].begin(), starts[t].end());
+      }
+
+      if (bad != NO_LINE) {
+        size_t size_bad;
+        scan_line(m_map->data(), size, bad, size_bad);
+        const size_t line = std::lower_bound(m_pos.begin(), m_pos.end(), bad)
+          - m_pos.begin();
+        boost::format m("line %d at file '%s' contains %d entries instead of %d (expected)");
+        m % (line + 1) % m_filename % size_bad % entries;
+        throw std::runtime_error(m.str());
       }
 
-      if (!line_number) {
+      if (m_pos.empty()) {
         m_newfile = true;
-        m_pos.clear();
         return;
       }
 
+      m_newfile = false;
       m_arrayset_type.dtype = bob::core::array::t_float64;
       m_arrayset_type.nd = 1;
       m_arrayset_type.shape[0] = entries;
@@ -89,38 +445,26 @@ class CSVFile: public bob::io::File {
 
     CSVFile(const std::string& path, char mode):
       m_filename(path),
-      m_newfile(false) {
+      m_newfile(true),
+      m_stale(false),
+      m_needs_newline(false) {
 
         if (mode == 'r' || (mode == 'a' && boost::filesystem::exists(path))) { //try peeking
-          
-          if (mode == 'r') 
-            m_file.open(m_filename.c_str(), std::ios::in);
-          else if (mode == 'a')
-            m_file.open(m_filename.c_str(), std::ios::app|std::ios::in|std::ios::out);
-          if (!m_file.is_open()) {
+
+          if (!boost::filesystem::exists(path)) {
             boost::format m("cannot open file '%s' for reading or appending");
             m % path;
             throw std::runtime_error(m.str());
           }
 
           peek(); ///< peek file properties
+
+          if (mode == 'a') open_output("ab");
         }
         else {
-          m_file.open(m_filename.c_str(), std::ios::trunc|std::ios::in|std::ios::out);
-          
-          if (!m_file.is_open()) {
-            boost::format m("cannot open file '%s' for writing");
-            m % path;
-            throw std::runtime_error(m.str());
-          }
-
-          m_newfile = true;
+          open_output("wb");
         }
 
-        //general precision settings, in case output is needed...
-        m_file.precision(10);
-        m_file.setf(std::ios_base::scientific, std::ios_base::floatfield);
-
       }
 
     virtual ~CSVFile() { }
@@ -138,7 +482,7 @@ class CSVFile: public bob::io::File {
     }
 
     virtual size_t size() const {
-      return m_pos.size();
+      return m_newfile ? 0 : m_array_type.shape[0];
     }
 
     virtual const std::string& name() const {
@@ -149,19 +493,16 @@ class CSVFile: public bob::io::File {
       if (m_newfile)
         throw std::runtime_error("uninitialized CSV file cannot be read");
 
+      update();
+
       if (!buffer.type().is_compatible(m_array_type)) buffer.set(m_array_type);
 
-      //read contents
-      std::string line;
-      if (m_file.eof()) m_file.clear(); ///< clear current "end" state.
-      m_file.seekg(0);
-      double* p = static_cast<double*>(buffer.ptr());
-      while (std::getline(m_file, line)) {
-        Tokenizer tok(line);
-        for(Tokenizer::iterator k=tok.begin(); k!=tok.end(); ++k) {
-          std::istringstream(*k) >> *(p++);
-        }
-      }
+      //parses lines concurrently, straight into the buffer
+      const uint64_t size = m_map->size();
+      bob::core::parallel_for(m_pos.size(), ParseLines(m_map->data(), size,
+            m_pos, m_arrayset_type.shape[0],
+            static_cast<double*>(buffer.ptr()), m_filename),
+          threads_for(size, MIN_BYTES_PER_THREAD));
     }
 
     virtual void read(bob::core::array::interface& buffer, size_t index) {
@@ -169,7 +510,9 @@ class CSVFile: public bob::io::File {
       if (m_newfile)
         throw std::runtime_error("uninitialized CSV file cannot be read");
 
-      if (!buffer.type().is_compatible(m_arrayset_type)) 
+      update();
+
+      if (!buffer.type().is_compatible(m_arrayset_type))
         buffer.set(m_arrayset_type);
 
       if (index >= m_pos.size()) {
@@ -179,19 +522,9 @@ class CSVFile: public bob::io::File {
       }
 
       //reads a specific line from the file.
-      std::string line;
-      if (m_file.eof()) m_file.clear(); ///< clear current "end" state.
-      m_file.seekg(m_pos[index]);
-      if (!std::getline(m_file, line)) {
-        boost::format m("could not seek to line %u (offset %u) while reading file '%s'");
-        m % index % m_pos[index] % m_filename;
-        throw std::runtime_error(m.str());
-      }
-      Tokenizer tok(line);
-      double* p = static_cast<double*>(buffer.ptr());
-      for(Tokenizer::iterator k=tok.begin(); k!=tok.end(); ++k) {
-        std::istringstream(*k) >> *(p++);
-      }
+      parse_line(m_map->data(), m_map->size(), m_pos[index],
+          m_arrayset_type.shape[0], static_cast<double*>(buffer.ptr()),
+          index, m_filename);
 
     }
 
@@ -205,10 +538,11 @@ class CSVFile: public bob::io::File {
           m % type.str() % m_filename;
           throw std::runtime_error(m.str());
         }
-        m_pos.clear();
-        m_arrayset_type = m_array_type = type;
-        m_array_type.shape[1] = m_arrayset_type.shape[0];
-        m_newfile = false;
+        m_arrayset_type = type;
+        m_array_type = type;
+        m_array_type.nd = 2;
+        m_array_type.shape[0] = 0;
+        m_array_type.shape[1] = type.shape[0];
       }
 
       else {
@@ -222,14 +556,11 @@ class CSVFile: public bob::io::File {
 
       }
 
-      const double* p = static_cast<const double*>(buffer.ptr());
-      if (m_pos.size()) m_file << std::endl; ///< adds a new line
-      m_pos.push_back(m_file.tellp()); ///< register start of line
-      for (size_t k=1; k<type.shape[0]; ++k) m_file << *(p++) << ",";
-      m_file << *(p++);
-      m_array_type.shape[0] = m_pos.size();
+      write_rows(static_cast<const double*>(buffer.ptr()), 1, type.shape[0]);
+      m_newfile = false;
+      m_array_type.shape[0] += 1;
       m_array_type.update_strides();
-      return (m_pos.size()-1);
+      return (m_array_type.shape[0]-1);
 
     }
 
@@ -243,14 +574,8 @@ class CSVFile: public bob::io::File {
           m % type.str() % m_filename;
           throw std::runtime_error(m.str());
         }
-        const double* p = static_cast<const double*>(buffer.ptr());
-        for (size_t l=1; l<type.shape[0]; ++l) {
-          m_pos.push_back(m_file.tellp());
-          for (size_t k=1; k<type.shape[1]; ++k) m_file << *(p++) << ",";
-          m_file << *(p++) << std::endl;
-        }
-        for (size_t k=1; k<type.shape[1]; ++k) m_file << *(p++) << ",";
-        m_file << *(p++);
+        write_rows(static_cast<const double*>(buffer.ptr()), type.shape[0],
+            type.shape[1]);
         m_arrayset_type = type;
         m_arrayset_type.nd = 1;
         m_arrayset_type.shape[0] = type.shape[1];
@@ -265,13 +590,75 @@ class CSVFile: public bob::io::File {
 
     }
 
+  private: //methods
+
+    void open_output(const char* flags) {
+      std::FILE* fp = std::fopen(m_filename.c_str(), flags);
+      if (!fp) {
+        boost::format m("cannot open file '%s' for writing");
+        m % m_filename;
+        throw std::runtime_error(m.str());
+      }
+      m_out.reset(fp, std::fclose);
+      std::setvbuf(fp, 0, _IOFBF, 1 << 20);
+    }
+
+    /**
+     * Maps the file again if rows were written since it was peeked
+     */
+    void update() {
+      if (!m_stale) return;
+      std::fflush(m_out.get());
+      peek();
+    }
+
+    /**
+     * Formats the rows in batches, by several threads, and writes them
+     */
+    void write_rows(const double* data, size_t rows, size_t columns) {
+      if (!m_out) {
+        boost::format m("CSV file '%s' was opened for reading only");
+        m % m_filename;
+        throw std::runtime_error(m.str());
+      }
+
+      if (m_needs_newline) {
+        std::fputc('\n', m_out.get());
+        m_needs_newline = false;
+      }
+
+      const size_t batch = std::max<uint64_t>(1, VALUES_PER_BATCH / columns);
+      std::vector<std::string> text;
+      for (size_t start=0; start<rows; start+=batch) {
+        const size_t count = std::min(batch, rows - start);
+        const size_t n_threads = threads_for(count * columns,
+            MIN_VALUES_PER_THREAD);
+        text.resize(n_threads);
+        const size_t used = bob::core::parallel_for(count,
+            FormatRows(data + start * columns, columns, text), n_threads);
+        for (size_t t=0; t<used; ++t) {
+          if (std::fwrite(text[t].data(), 1, text[t].size(), m_out.get())
+              != text[t].size()) {
+            boost::format m("error while writing to CSV file '%s'");
+            m % m_filename;
+            throw std::runtime_error(m.str());
+          }
+        }
+      }
+
+      m_stale = true;
+    }
+
   private: //representation
-    std::fstream m_file;
     std::string m_filename;
     bool m_newfile;
+    bool m_stale; ///< rows were written since the file was mapped
+    bool m_needs_newline; ///< the last line of the file is not terminated
     bob::core::array::typeinfo m_array_type;
     bob::core::array::typeinfo m_arrayset_type;
-    std::vector<std::streampos> m_pos; ///< dictionary of line starts
+    boost::shared_ptr<boost::iostreams::mapped_file_source> m_map;
+    boost::shared_ptr<std::FILE> m_out; ///< set if rows can be written
+    std::vector<uint64_t> m_pos; ///< dictionary of line starts
 
     static std::string s_codecname;
 
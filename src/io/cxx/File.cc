@@ -18,6 +18,33 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdexcept>
+#include <boost/format.hpp>
 #include <bob/io/File.h>
 
+bool bob::io::DecodeOptions::is_default() const {
+  return scale_denom == 1 && !gray && roi_y == 0 && roi_x == 0 &&
+    roi_height == 0 && roi_width == 0;
+}
+
+void bob::io::DecodeOptions::roi(size_t height, size_t width, size_t& y,
+    size_t& x, size_t& h, size_t& w) const {
+  y = roi_y;
+  x = roi_x;
+  h = roi_height ? roi_height : (roi_y < height ? height - roi_y : 0);
+  w = roi_width ? roi_width : (roi_x < width ? width - roi_x : 0);
+  if (h == 0 || w == 0 || y + h > height || x + w > width) {
+    boost::format m("the region of interest (y=%u, x=%u, height=%u, width=%u) does not fit in the (decoded) image of %u x %u pixels");
+    m % roi_y % roi_x % roi_height % roi_width % height % width;
+    throw std::runtime_error(m.str());
+  }
+}
+
 bob::io::File::~File() { }
+
+void bob::io::File::setDecodeOptions(const bob::io::DecodeOptions& options) {
+  if (options.is_default()) return;
+  boost::format m("the codec `%s' of file `%s' does not support decoding options");
+  m % name() % filename();
+  throw std::runtime_error(m.str());
+}
@@ -0,0 +1,192 @@
+/**
+ * @file io/cxx/HDF5Appender.cc
+ * @date Mon Oct 19 19:12:48 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Implementation of buffered, asynchronous appends to HDF5 datasets
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+#include <bob/core/logging.h>
+#include <bob/io/HDF5Appender.h>
+
+/**
+ * Blocks are only written by a background thread if the HDF5 library
+ * serializes its calls itself (i.e., if it was built thread-safe), since the
+ * caller may use other HDF5 files in the meantime. Otherwise, they are
+ * written by the thread that fills them.
+ */
+#ifdef H5_HAVE_THREADSAFE
+static const bool HDF5_THREADSAFE = true;
+#else
+static const bool HDF5_THREADSAFE = false;
+#endif
+
+bob::io::HDF5Appender::HDF5Appender(const bob::io::HDF5File& file,
+    const std::string& path, size_t block_size, size_t queue_size,
+    size_t compression):
+  m_file(file),
+  m_path(path),
+  m_block_size(block_size),
+  m_queue_size(queue_size),
+  m_compression(compression),
+  m_entry_size(0),
+  m_appended(0),
+  m_writing(false),
+  m_error_raised(false),
+  m_stop(false)
+{
+  if (!m_block_size)
+    throw std::runtime_error("the block size of an HDF5 appender must be at least 1");
+  if (!m_queue_size)
+    throw std::runtime_error("the queue size of an HDF5 appender must be at least 1");
+
+  if (HDF5_THREADSAFE)
+    m_thread.reset(new boost::thread(boost::bind(&HDF5Appender::write_blocks,
+            this)));
+}
+
+bob::io::HDF5Appender::~HDF5Appender() {
+  const bool raised = m_error_raised;
+  try {
+    flush();
+  }
+  catch (std::exception& e) {
+    if (!raised)
+      bob::core::warn << "error while appending to dataset `" << m_path
+        << "' of HDF5 file `" << m_file.filename() << "': " << e.what()
+        << std::endl;
+  }
+
+  if (m_thread) {
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      m_stop = true;
+      m_cond.notify_all();
+    }
+    m_thread->join();
+  }
+}
+
+void bob::io::HDF5Appender::append_buffer(const bob::io::HDF5Type& type,
+    const void* buffer) {
+
+  if (!m_entry_size) { //first entry: the writer is idle
+    if (type.element_type() == bob::core::array::t_unknown) {
+      boost::format m("cannot append `%s' to dataset `%s' of HDF5 file `%s': only numbers and arrays of numbers can be appended in blocks");
+      m % type.str() % m_path % m_file.filename();
+      throw std::runtime_error(m.str());
+    }
+    //creates the dataset, or checks the type of the existing one
+    m_file.create(m_path, type, true, m_compression);
+    m_type = type;
+    m_entry_size = bob::core::array::getElementSize(type.element_type()) *
+      type.shape().product();
+  }
+
+  else if (!(type == m_type)) {
+    boost::format m("cannot append `%s' to dataset `%s' of HDF5 file `%s', which contains `%s'");
+    m % type.str() % m_path % m_file.filename() % m_type.str();
+    throw std::runtime_error(m.str());
+  }
+
+  if (!m_block) {
+    m_block = boost::make_shared<Block>();
+    m_block->data.resize(m_block_size * m_entry_size);
+    m_block->count = 0;
+  }
+
+  std::memcpy(&m_block->data[m_block->count * m_entry_size], buffer,
+      m_entry_size);
+  ++m_block->count;
+  ++m_appended;
+
+  if (m_block->count == m_block_size) {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    push(lock);
+  }
+}
+
+void bob::io::HDF5Appender::flush() {
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  if (m_block) push(lock);
+  while (!m_error && (m_writing || !m_queue.empty())) m_cond.wait(lock);
+  check_error(lock);
+}
+
+void bob::io::HDF5Appender::push(boost::unique_lock<boost::mutex>& lock) {
+  if (!m_thread) { //written right away, by the caller
+    boost::shared_ptr<Block> block;
+    block.swap(m_block);
+    m_file.extend_buffer(m_path, m_type, block->count, &block->data[0]);
+    return;
+  }
+
+  // back-pressure: waits for room in the queue
+  while (!m_error && m_queue.size() >= m_queue_size) m_cond.wait(lock);
+  check_error(lock);
+  m_queue.push_back(m_block);
+  m_block.reset();
+  m_cond.notify_all();
+}
+
+void bob::io::HDF5Appender::check_error
+(boost::unique_lock<boost::mutex>& lock) {
+  if (!m_error) return;
+  m_block.reset();
+  m_error_raised = true;
+  boost::exception_ptr error = m_error;
+  lock.unlock();
+  boost::rethrow_exception(error);
+}
+
+void bob::io::HDF5Appender::write_blocks() {
+  while (true) {
+    boost::shared_ptr<Block> block;
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while (m_queue.empty() && !m_stop) m_cond.wait(lock);
+      if (m_queue.empty()) return; //stopped
+      block = m_queue.front();
+      m_queue.pop_front();
+      m_writing = true;
+      m_cond.notify_all(); //room in the queue
+    }
+
+    boost::exception_ptr error;
+    try {
+      // extends the dataset once for the whole block
+      m_file.extend_buffer(m_path, m_type, block->count, &block->data[0]);
+    }
+    catch (...) {
+      error = boost::current_exception();
+    }
+
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    m_writing = false;
+    if (error) {
+      // the blocks after a failure are not written
+      if (!m_error) m_error = error;
+      m_queue.clear();
+    }
+    m_cond.notify_all();
+  }
+}
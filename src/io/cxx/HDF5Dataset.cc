@@ -515,6 +515,10 @@ void bob::io::detail::hdf5::Dataset::write_buffer (size_t index, const bob::io::
 }
 
 void bob::io::detail::hdf5::Dataset::extend_buffer (const bob::io::HDF5Type& dest, const void* buffer) {
+  extend_buffer(dest, 1, buffer);
+}
+
+void bob::io::detail::hdf5::Dataset::extend_buffer (const bob::io::HDF5Type& dest, size_t count, const void* buffer) {
 
   //finds compatibility type
   std::vector<bob::io::HDF5Descriptor>::iterator it = find_type_index(m_descr, dest);
@@ -532,27 +536,42 @@ void bob::io::detail::hdf5::Dataset::extend_buffer (const bob::io::HDF5Type& des
     throw std::runtime_error(m.str());
   }
 
-  //if it is expandible, try expansion
+  if (!count) return;
+
+  //if it is expandible, try expansion by count entries at once
+  const size_t first = it->size;
   bob::io::HDF5Shape tmp(it->type.shape());
   tmp >>= 1;
-  tmp[0] = it->size + 1;
+  tmp[0] = first + count;
   herr_t status = H5Dset_extent(*m_id, tmp.get());
   if (status < 0) throw status_error("H5Dset_extent", status);
 
   //if expansion succeeded, update all compatible types
   for (size_t k=0; k<m_descr.size(); ++k) {
     if (m_descr[k].expandable) { //updated only the length
-      m_descr[k].size += 1;
+      m_descr[k].size += count;
     }
     else { //not expandable, update the shape/count for a straight read/write
-      m_descr[k].type.shape()[0] += 1;
-      m_descr[k].hyperslab_count[0] += 1;
+      m_descr[k].type.shape()[0] += count;
+      m_descr[k].hyperslab_count[0] += count;
     }
   }
 
   m_filespace = open_filespace(m_id); //update filespace
 
-  write_buffer(tmp[0]-1, dest, buffer);
+  //selects the new entries and writes them with a single call
+  bob::io::HDF5Shape start(it->hyperslab_start);
+  start[0] = first;
+  bob::io::HDF5Shape selected(it->hyperslab_count);
+  selected[0] = count;
+  status = H5Sselect_hyperslab(*m_filespace, H5S_SELECT_SET, start.get(), 0,
+      selected.get(), 0);
+  if (status < 0) throw status_error("H5Sselect_hyperslab", status);
+
+  boost::shared_ptr<hid_t> memspace = open_memspace(selected);
+  status = H5Dwrite(*m_id, *it->type.htype(), *memspace, *m_filespace,
+      H5P_DEFAULT, buffer);
+  if (status < 0) throw status_error("H5Dwrite", status);
 }
 
 void bob::io::detail::hdf5::Dataset::gettype_attribute(const std::string& name,
@@ -172,6 +172,16 @@ void bob::io::HDF5File::extend_buffer(const std::string& path,
   (*m_cwd)[path]->extend_buffer(type, buffer);
 }
 
+void bob::io::HDF5File::extend_buffer(const std::string& path,
+    const bob::io::HDF5Type& type, size_t count, const void* buffer) {
+  if (!m_file->writeable()) {
+    boost::format m("cannot extend object '%s' at path '%s' of file '%s' because the file is not writeable");
+    m % path % m_cwd->path() % m_file->filename();
+    throw std::runtime_error(m.str());
+  }
+  (*m_cwd)[path]->extend_buffer(type, count, buffer);
+}
+
 bool bob::io::HDF5File::hasAttribute(const std::string& path,
     const std::string& name) const {
   if (m_cwd->has_dataset(path)) {
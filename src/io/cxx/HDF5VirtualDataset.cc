@@ -0,0 +1,561 @@
+/**
+ * @file io/cxx/HDF5VirtualDataset.cc
+ * @date Mon Oct 19 17:41:05 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Implements the view of many HDF5 datasets as a single array
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/filesystem.hpp>
+#include <bob/core/logging.h>
+#include <bob/core/parallel.h>
+#include <bob/io/HDF5Types.h>
+#include <bob/io/HDF5VirtualDataset.h>
+
+/**
+ * The rows are only read by several threads, and batches prefetched by a
+ * background thread, if the HDF5 library serializes its calls itself (i.e.,
+ * if it was built thread-safe), since the caller may use other HDF5 files in
+ * the meantime. Otherwise, all calls are made by the calling thread.
+ */
+#ifdef H5_HAVE_THREADSAFE
+static const bool HDF5_THREADSAFE = true;
+#else
+static const bool HDF5_THREADSAFE = false;
+#endif
+
+namespace {
+
+  std::runtime_error status_error(const char* f, herr_t s,
+      const std::string& filename) {
+    boost::format m("call to HDF5 C-function %s() returned error %d while reading file `%s'. HDF5 error statck follows:\n%s");
+    m % f % s % filename % bob::io::format_hdf5_error();
+    return std::runtime_error(m.str());
+  }
+
+  void delete_h5file (hid_t* p) {
+    if (*p >= 0) {
+      herr_t err = H5Fclose(*p);
+      if (err < 0) {
+        bob::core::error << "H5Fclose(hid=" << *p << ") exited with an error (" << err << "). The stack trace follows:" << std::endl;
+        bob::core::error << bob::io::format_hdf5_error() << std::endl;
+      }
+    }
+    delete p;
+  }
+
+  void delete_h5dataset (hid_t* p) {
+    if (*p >= 0) {
+      herr_t err = H5Dclose(*p);
+      if (err < 0) {
+        bob::core::error << "H5Dclose() exited with an error (" << err << "). The stack trace follows:" << std::endl;
+        bob::core::error << bob::io::format_hdf5_error() << std::endl;
+      }
+    }
+    delete p;
+  }
+
+  void delete_h5datatype (hid_t* p) {
+    if (*p >= 0) {
+      herr_t err = H5Tclose(*p);
+      if (err < 0) {
+        bob::core::error << "H5Tclose() exited with an error (" << err << "). The stack trace follows:" << std::endl;
+        bob::core::error << bob::io::format_hdf5_error() << std::endl;
+      }
+    }
+    delete p;
+  }
+
+  void delete_h5dataspace (hid_t* p) {
+    if (*p >= 0) {
+      herr_t err = H5Sclose(*p);
+      if (err < 0) {
+        bob::core::error << "H5Sclose() exited with an error (" << err << "). The stack trace follows:" << std::endl;
+        bob::core::error << bob::io::format_hdf5_error() << std::endl;
+      }
+    }
+    delete p;
+  }
+
+  boost::shared_ptr<hid_t> open_filespace(const boost::shared_ptr<hid_t>& ds,
+      const std::string& filename) {
+    boost::shared_ptr<hid_t> retval(new hid_t(-1),
+        std::ptr_fun(delete_h5dataspace));
+    *retval = H5Dget_space(*ds);
+    if (*retval < 0) throw status_error("H5Dget_space", *retval, filename);
+    return retval;
+  }
+
+}
+
+/**
+ * A file and the dataset of the view in it, opened directly by its path
+ * (the groups of the file are not scanned)
+ */
+struct bob::io::HDF5VirtualDataset::Handle {
+
+  boost::shared_ptr<hid_t> file;
+  boost::shared_ptr<hid_t> dataset;
+  bob::io::HDF5Shape extents; ///< of the dataset
+
+  Handle(const std::string& filename, const std::string& path):
+    file(new hid_t(-1), std::ptr_fun(delete_h5file)),
+    dataset(new hid_t(-1), std::ptr_fun(delete_h5dataset))
+  {
+    if (!boost::filesystem::exists(filename)) {
+      boost::format m("cannot open file `%s'");
+      m % filename;
+      throw std::runtime_error(m.str());
+    }
+
+    *file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (*file < 0) throw status_error("H5Fopen", *file, filename);
+
+    *dataset = H5Dopen2(*file, path.c_str(), H5P_DEFAULT);
+    if (*dataset < 0) throw status_error("H5Dopen2", *dataset, filename);
+
+    boost::shared_ptr<hid_t> space = open_filespace(dataset, filename);
+    int rank = H5Sget_simple_extent_ndims(*space);
+    if (rank < 0) throw status_error("H5Sget_simple_extent_ndims", rank, filename);
+    extents = bob::io::HDF5Shape(rank);
+    herr_t status = H5Sget_simple_extent_dims(*space, extents.get(), 0);
+    if (status < 0) throw status_error("H5Sget_simple_extent_dims", status, filename);
+  }
+
+  /**
+   * The type of the rows of the dataset (the arrays of its first dimension)
+   */
+  void row_type(const std::string& filename, const std::string& path,
+      bob::core::array::typeinfo& info) const {
+    boost::shared_ptr<hid_t> dt(new hid_t(-1), std::ptr_fun(delete_h5datatype));
+    *dt = H5Dget_type(*dataset);
+    if (*dt < 0) throw status_error("H5Dget_type", *dt, filename);
+    bob::io::HDF5Type type(dt, extents);
+
+    if (extents.n() < 2 || extents.n() > BOB_MAX_DIM ||
+        type.element_type() == bob::core::array::t_unknown) {
+      boost::format m("the dataset `%s' of file `%s' is of type %s, but only lists of numerical arrays (with at least 2 and at most %d dimensions) can be viewed as rows");
+      m % path % filename % type.str() % BOB_MAX_DIM;
+      throw std::runtime_error(m.str());
+    }
+
+    size_t shape[BOB_MAX_DIM];
+    for (size_t k=1; k<extents.n(); ++k) shape[k-1] = extents[k];
+    info.set(type.element_type(), extents.n() - 1, shape);
+  }
+
+  /**
+   * Reads count rows, starting at the given one, into the data
+   */
+  void read(const std::string& filename, uint64_t first, uint64_t count,
+      const bob::core::array::typeinfo& type, void* data) const {
+    bob::io::HDF5Shape start(extents.n());
+    start[0] = first;
+    bob::io::HDF5Shape selected(extents);
+    selected[0] = count;
+
+    boost::shared_ptr<hid_t> space = open_filespace(dataset, filename);
+    herr_t status = H5Sselect_hyperslab(*space, H5S_SELECT_SET, start.get(),
+        0, selected.get(), 0);
+    if (status < 0) throw status_error("H5Sselect_hyperslab", status, filename);
+
+    boost::shared_ptr<hid_t> memspace(new hid_t(-1),
+        std::ptr_fun(delete_h5dataspace));
+    *memspace = H5Screate_simple(selected.n(), selected.get(), 0);
+    if (*memspace < 0) throw status_error("H5Screate_simple", *memspace, filename);
+
+    boost::shared_ptr<hid_t> memtype = bob::io::HDF5Type(type).htype();
+    status = H5Dread(*dataset, *memtype, *memspace, *space, H5P_DEFAULT, data);
+    if (status < 0) throw status_error("H5Dread", status, filename);
+  }
+
+};
+
+bob::io::HDF5VirtualDataset::HDF5VirtualDataset
+(const std::vector<std::string>& filenames, const std::string& path,
+ size_t max_open, size_t n_threads):
+  m_filenames(filenames),
+  m_path(path),
+  m_max_open(max_open),
+  m_n_threads(n_threads),
+  m_batch_size(0),
+  m_queue_size(0),
+  m_produced(0),
+  m_n_batches(0),
+  m_started(false),
+  m_stop(false)
+{
+  if (m_filenames.empty())
+    throw std::runtime_error("the list of HDF5 files to view is empty");
+
+  // finds the number of rows of each file, then the offsets
+  m_offsets.resize(m_filenames.size() + 1, 0);
+  std::vector<bob::core::array::typeinfo> types(m_filenames.size());
+  bob::core::parallel_for(m_filenames.size(),
+      boost::bind(&HDF5VirtualDataset::scan, this, boost::ref(types),
+        _1, _2, _3), HDF5_THREADSAFE ? m_n_threads : 1);
+
+  m_type = types[0];
+  for (size_t k=0; k<m_filenames.size(); ++k) {
+    if (!types[k].is_compatible(m_type)) {
+      boost::format m("the rows of dataset `%s' of file `%s' are of type %s, while the ones of file `%s' are of type %s");
+      m % m_path % m_filenames[k] % types[k].str() % m_filenames[0]
+        % m_type.str();
+      throw std::runtime_error(m.str());
+    }
+    m_offsets[k+1] += m_offsets[k];
+  }
+}
+
+bob::io::HDF5VirtualDataset::HDF5VirtualDataset(bob::io::HDF5File& index,
+    size_t max_open, size_t n_threads):
+  m_max_open(max_open),
+  m_n_threads(n_threads),
+  m_batch_size(0),
+  m_queue_size(0),
+  m_produced(0),
+  m_n_batches(0),
+  m_started(false),
+  m_stop(false)
+{
+  m_path = index.read<std::string>("path");
+
+  const std::string filenames = index.read<std::string>("filenames");
+  for (size_t begin=0; begin<filenames.size();) {
+    size_t end = filenames.find('\n', begin);
+    if (end == std::string::npos) end = filenames.size();
+    m_filenames.push_back(filenames.substr(begin, end-begin));
+    begin = end + 1;
+  }
+
+  blitz::Array<uint64_t,1> sizes = index.readArray<uint64_t,1>("sizes");
+  if (m_filenames.empty() || (size_t)sizes.extent(0) != m_filenames.size()) {
+    boost::format m("the index of HDF5 files in `%s' lists %u files, but the number of rows of %u files");
+    m % index.filename() % m_filenames.size() % sizes.extent(0);
+    throw std::runtime_error(m.str());
+  }
+  m_offsets.resize(m_filenames.size() + 1, 0);
+  for (size_t k=0; k<m_filenames.size(); ++k)
+    m_offsets[k+1] = m_offsets[k] + sizes(k);
+
+  blitz::Array<uint64_t,1> shape = index.readArray<uint64_t,1>("shape");
+  m_type.set(static_cast<bob::core::array::ElementType>(index.read<uint64_t>("dtype")),
+      static_cast<uint64_t>(shape.extent(0)), shape.data());
+}
+
+bob::io::HDF5VirtualDataset::~HDF5VirtualDataset() {
+  stop();
+}
+
+void bob::io::HDF5VirtualDataset::scan
+(std::vector<bob::core::array::typeinfo>& types, size_t, uint64_t begin,
+ uint64_t end) {
+  for (uint64_t k=begin; k<end; ++k) {
+    Handle h(m_filenames[k], m_path);
+    h.row_type(m_filenames[k], m_path, types[k]);
+    m_offsets[k+1] = h.extents[0];
+  }
+}
+
+void bob::io::HDF5VirtualDataset::save(bob::io::HDF5File& index) const {
+  std::string filenames = m_filenames[0];
+  for (size_t k=1; k<m_filenames.size(); ++k) filenames += "\n" + m_filenames[k];
+
+  blitz::Array<uint64_t,1> sizes(m_filenames.size());
+  for (size_t k=0; k<m_filenames.size(); ++k) sizes(k) = this->size(k);
+  blitz::Array<uint64_t,1> shape(m_type.nd);
+  for (size_t k=0; k<m_type.nd; ++k) shape(k) = m_type.shape[k];
+
+  index.set("path", m_path);
+  index.set("filenames", filenames);
+  index.set("dtype", static_cast<uint64_t>(m_type.dtype));
+  index.setArray("shape", shape);
+  index.setArray("sizes", sizes);
+}
+
+size_t bob::io::HDF5VirtualDataset::size(size_t file) const {
+  return m_offsets.at(file+1) - m_offsets[file];
+}
+
+size_t bob::io::HDF5VirtualDataset::offset(size_t file) const {
+  return m_offsets.at(file);
+}
+
+size_t bob::io::HDF5VirtualDataset::file(size_t row) const {
+  if (row >= size()) {
+    boost::format m("row %u is out of the range of the %u rows of the HDF5 files");
+    m % row % size();
+    throw std::runtime_error(m.str());
+  }
+  // the last file starting at or before the row (skips empty files)
+  return std::upper_bound(m_offsets.begin(), m_offsets.end(), row) -
+    m_offsets.begin() - 1;
+}
+
+bob::core::array::typeinfo bob::io::HDF5VirtualDataset::type(size_t count)
+  const {
+  size_t shape[BOB_MAX_DIM];
+  shape[0] = count;
+  for (size_t k=0; k<m_type.nd; ++k) shape[k+1] = m_type.shape[k];
+  return bob::core::array::typeinfo(m_type.dtype, m_type.nd + 1, shape);
+}
+
+void bob::io::HDF5VirtualDataset::setMaxOpen(size_t n) {
+  boost::lock_guard<boost::mutex> lock(m_open_mutex);
+  m_max_open = n;
+  while (m_lru.size() > m_max_open) {
+    m_open.erase(m_lru.back().first);
+    m_lru.pop_back();
+  }
+}
+
+size_t bob::io::HDF5VirtualDataset::getOpen() const {
+  boost::lock_guard<boost::mutex> lock(m_open_mutex);
+  return m_lru.size();
+}
+
+boost::shared_ptr<bob::io::HDF5VirtualDataset::Handle>
+bob::io::HDF5VirtualDataset::handle(size_t file) {
+  {
+    boost::lock_guard<boost::mutex> lock(m_open_mutex);
+    std::map<size_t, lru_t::iterator>::iterator it = m_open.find(file);
+    if (it != m_open.end()) {
+      m_lru.splice(m_lru.begin(), m_lru, it->second);
+      return it->second->second;
+    }
+  }
+
+  // the file is opened without locking the other threads out
+  boost::shared_ptr<Handle> retval =
+    boost::make_shared<Handle>(m_filenames[file], m_path);
+
+  boost::lock_guard<boost::mutex> lock(m_open_mutex);
+  if (!m_max_open || m_open.count(file)) return retval;
+  m_lru.push_front(std::make_pair(file, retval));
+  m_open[file] = m_lru.begin();
+  while (m_lru.size() > m_max_open) {
+    m_open.erase(m_lru.back().first);
+    m_lru.pop_back();
+  }
+  return retval;
+}
+
+void bob::io::HDF5VirtualDataset::read_segments
+(const std::vector<Segment>& segments, void* data, size_t, uint64_t begin,
+ uint64_t end) {
+  const size_t bytes = m_type.buffer_size();
+  for (uint64_t k=begin; k<end; ++k) {
+    const Segment& s = segments[k];
+    boost::shared_ptr<Handle> h = handle(s.file);
+    if (s.first + s.count > h->extents[0]) {
+      boost::format m("the dataset `%s' of file `%s' has %u rows, while the index of the HDF5 files says it has %u");
+      m % m_path % m_filenames[s.file] % h->extents[0] % size(s.file);
+      throw std::runtime_error(m.str());
+    }
+    h->read(m_filenames[s.file], s.first, s.count, m_type,
+        static_cast<char*>(data) + s.position*bytes);
+  }
+}
+
+void bob::io::HDF5VirtualDataset::read_parallel
+(const std::vector<Segment>& segments, size_t count,
+ bob::core::array::interface& buffer) {
+  const bob::core::array::typeinfo info = type(count);
+  if (!buffer.type().is_compatible(info)) buffer.set(info);
+  bob::core::parallel_for(segments.size(),
+      boost::bind(&HDF5VirtualDataset::read_segments, this,
+        boost::cref(segments), buffer.ptr(), _1, _2, _3),
+      HDF5_THREADSAFE ? m_n_threads : 1);
+}
+
+void bob::io::HDF5VirtualDataset::read(size_t row,
+    bob::core::array::interface& buffer) {
+  if (!buffer.type().is_compatible(m_type)) buffer.set(m_type);
+  std::vector<Segment> segments(1);
+  segments[0].file = file(row);
+  segments[0].first = row - m_offsets[segments[0].file];
+  segments[0].count = 1;
+  segments[0].position = 0;
+  read_segments(segments, buffer.ptr(), 0, 0, 1);
+}
+
+void bob::io::HDF5VirtualDataset::read(size_t start, size_t count,
+    bob::core::array::interface& buffer) {
+  if (start + count > size()) {
+    boost::format m("cannot read %u rows starting at row %u from HDF5 files of %u rows");
+    m % count % start % size();
+    throw std::runtime_error(m.str());
+  }
+
+  // one segment per file
+  std::vector<Segment> segments;
+  for (size_t row=start; row<start+count;) {
+    Segment s;
+    s.file = file(row);
+    s.first = row - m_offsets[s.file];
+    s.count = std::min<uint64_t>(m_offsets[s.file+1], start + count) - row;
+    s.position = row - start;
+    segments.push_back(s);
+    row += s.count;
+  }
+  read_parallel(segments, count, buffer);
+}
+
+void bob::io::HDF5VirtualDataset::read(const std::vector<size_t>& rows,
+    bob::core::array::interface& buffer) {
+  // runs of consecutive rows of the same file are read at once
+  std::vector<Segment> segments;
+  for (size_t k=0; k<rows.size(); ++k) {
+    const size_t f = file(rows[k]);
+    if (k && segments.back().file == f && rows[k] == rows[k-1] + 1) {
+      ++segments.back().count;
+      continue;
+    }
+    Segment s;
+    s.file = f;
+    s.first = rows[k] - m_offsets[f];
+    s.count = 1;
+    s.position = k;
+    segments.push_back(s);
+  }
+  read_parallel(segments, rows.size(), buffer);
+}
+
+void bob::io::HDF5VirtualDataset::start(size_t batch_size, size_t queue_size,
+    const std::vector<size_t>& rows) {
+  if (batch_size == 0)
+    throw std::runtime_error("the batch size must be at least 1");
+  if (queue_size == 0)
+    throw std::runtime_error("the prefetch queue size must be at least 1");
+  stop();
+
+  const size_t total = rows.empty() ? size() : rows.size();
+  m_rows = rows;
+  m_batch_size = batch_size;
+  m_queue_size = queue_size;
+  m_produced = 0;
+  m_n_batches = (total + batch_size - 1) / batch_size;
+  m_error = boost::exception_ptr();
+  m_started = true;
+  m_stop = false;
+  if (HDF5_THREADSAFE)
+    m_thread.reset(new boost::thread(boost::bind(&HDF5VirtualDataset::prefetch,
+            this)));
+  //otherwise, next() reads the batches
+}
+
+boost::shared_ptr<bob::core::array::blitz_array>
+bob::io::HDF5VirtualDataset::read_batch(size_t b) {
+  const size_t total = m_rows.empty() ? size() : m_rows.size();
+  const size_t start = b * m_batch_size;
+  const size_t count = std::min(m_batch_size, total - start);
+  boost::shared_ptr<bob::core::array::blitz_array> batch =
+    boost::make_shared<bob::core::array::blitz_array>(type(count));
+  if (m_rows.empty()) read(start, count, *batch);
+  else read(std::vector<size_t>(m_rows.begin() + start,
+        m_rows.begin() + start + count), *batch);
+  return batch;
+}
+
+void bob::io::HDF5VirtualDataset::prefetch() {
+  for (size_t b=0; b<m_n_batches; ++b) {
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while (!m_stop && m_queue.size() >= m_queue_size) m_cond.wait(lock);
+      if (m_stop) return;
+    }
+
+    boost::shared_ptr<bob::core::array::blitz_array> batch;
+    boost::exception_ptr error;
+    try {
+      batch = read_batch(b);
+    }
+    catch (...) {
+      error = boost::current_exception();
+    }
+
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    if (error) {
+      // the batches after a failure are not read
+      m_error = error;
+      m_produced = m_n_batches;
+      m_cond.notify_all();
+      return;
+    }
+    m_queue.push_back(batch);
+    ++m_produced;
+    m_cond.notify_all();
+  }
+}
+
+boost::shared_ptr<bob::core::array::blitz_array>
+bob::io::HDF5VirtualDataset::next() {
+  if (!m_started)
+    throw std::runtime_error("the prefetcher of the HDF5 files was not started");
+
+  if (!m_thread) { //reads the batch right away
+    if (m_produced >= m_n_batches)
+      return boost::shared_ptr<bob::core::array::blitz_array>();
+    const size_t b = m_produced++;
+    try {
+      return read_batch(b);
+    }
+    catch (...) {
+      // the batches after a failure are not read
+      m_produced = m_n_batches;
+      throw;
+    }
+  }
+
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  while (m_queue.empty() && m_produced < m_n_batches) m_cond.wait(lock);
+
+  if (!m_queue.empty()) {
+    boost::shared_ptr<bob::core::array::blitz_array> retval = m_queue.front();
+    m_queue.pop_front();
+    m_cond.notify_all();
+    return retval;
+  }
+
+  if (m_error) {
+    boost::exception_ptr error = m_error;
+    m_error = boost::exception_ptr();
+    lock.unlock();
+    boost::rethrow_exception(error);
+  }
+
+  return boost::shared_ptr<bob::core::array::blitz_array>();
+}
+
+void bob::io::HDF5VirtualDataset::stop() {
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    m_stop = true;
+    m_cond.notify_all();
+  }
+  if (m_thread) {
+    m_thread->join();
+    m_thread.reset();
+  }
+  m_started = false;
+  m_queue.clear();
+}
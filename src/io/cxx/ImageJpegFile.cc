@@ -28,7 +28,10 @@
 #include <boost/format.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/noncopyable.hpp>
 #include <string>
+#include <vector>
+#include <algorithm>
 
 #include <bob/io/CodecRegistry.h>
 #include <bob/core/logging.h>
@@ -52,62 +55,113 @@ static boost::shared_ptr<std::FILE> make_cfile(const char *filename, const char
 /**
  * LOADING
  */
-static void im_peek(const std::string& path, bob::core::array::typeinfo& info) {
-  // 1. JPEG structures
+
+/**
+ * A JPEG decompressor of which the header was already read. The codec keeps
+ * the one created when peeking the file, so that the file is only opened
+ * and parsed once if it is then read.
+ */
+struct JpegDecoder: private boost::noncopyable {
+
+  boost::shared_ptr<std::FILE> file;
   struct jpeg_decompress_struct cinfo;
   struct jpeg_error_mgr jerr;
-  cinfo.err = jpeg_std_error(&jerr);
-  jpeg_create_decompress(&cinfo);
 
-  // 2. JPEG file opening
-  boost::shared_ptr<std::FILE> in_file = make_cfile(path.c_str(), "rb");
-  jpeg_stdio_src(&cinfo, in_file.get());
+  JpegDecoder(const std::string& path):
+    file(make_cfile(path.c_str(), "rb"))
+  {
+    // 1. JPEG structures
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_decompress(&cinfo);
 
-  // 3. Read header
-  jpeg_read_header(&cinfo, TRUE);
+    // 2. JPEG file opening
+    jpeg_stdio_src(&cinfo, file.get());
 
-  // 4. Set parameters for decompression if any
+    // 3. Read header and compute the output dimensions
+    jpeg_read_header(&cinfo, TRUE);
+    jpeg_calc_output_dimensions(&cinfo);
+  }
 
-  // 5. Start decompression and get information
-  jpeg_start_decompress(&cinfo);
+  ~JpegDecoder() {
+    jpeg_destroy_decompress(&cinfo);
+  }
+
+};
+
+/**
+ * Sets the scaling and color space of the output of the decoder, which
+ * must not be started yet
+ */
+static void configure(const std::string& path, JpegDecoder& decoder,
+    const bob::io::DecodeOptions& options) {
+  struct jpeg_decompress_struct& cinfo = decoder.cinfo;
+
+  const size_t d = options.scale_denom;
+  if (d != 1 && d != 2 && d != 4 && d != 8) {
+    boost::format m("cannot decode file `%s' at 1/%u of its size: the jpeg codec supports 1, 1/2, 1/4 and 1/8");
+    m % path % d;
+    throw std::runtime_error(m.str());
+  }
+
+  // scaling is done by libjpeg in the DCT domain, i.e. much faster than
+  // decoding at the full size
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = d;
+
+  // gray images are given by the luminance, without computing the colors
+  if (cinfo.num_components == 3)
+    cinfo.out_color_space = options.gray ? JCS_GRAYSCALE : JCS_RGB;
+
+  jpeg_calc_output_dimensions(&cinfo);
+}
+
+static void im_peek(const std::string& path, const JpegDecoder& decoder,
+    const bob::io::DecodeOptions& options, bob::core::array::typeinfo& info) {
+  const struct jpeg_decompress_struct& cinfo = decoder.cinfo;
 
   if( cinfo.output_components != 1 && cinfo.output_components != 3)
   {
-    boost::format m("unsupported number of planes (%d) when reading file. Image depth must be 1 or 3.");
-    m % cinfo.output_components;
+    boost::format m("unsupported number of planes (%d) when reading file `%s'. Image depth must be 1 or 3.");
+    m % cinfo.output_components % path;
     throw std::runtime_error(m.str());
   }
 
+  // The image is (a region of interest of) the decoded output
+  size_t y, x, height, width;
+  options.roi(cinfo.output_height, cinfo.output_width, y, x, height, width);
+
   // Set depth and number of dimensions
   info.dtype = bob::core::array::t_uint8;
   info.nd = (cinfo.output_components == 1? 2 : 3);
   if(info.nd == 2)
   {
-    info.shape[0] = cinfo.output_height;
-    info.shape[1] = cinfo.output_width;
+    info.shape[0] = height;
+    info.shape[1] = width;
   }
   else
   {
     info.shape[0] = 3;
-    info.shape[1] = cinfo.output_height;
-    info.shape[2] = cinfo.output_width;
+    info.shape[1] = height;
+    info.shape[2] = width;
   }
   info.update_strides();
-
-  // TODO: check depth
 }
 
 template <typename T> static
 void im_load_gray(struct jpeg_decompress_struct *cinfo, bob::core::array::interface& b) {
   const bob::core::array::typeinfo& info = b.type();
 
+  // scanlines are decoded straight into the output, as many at a time as
+  // the decoder can produce
   T *element = static_cast<T*>(b.ptr());
   const int row_stride = info.shape[1];
-  JSAMPROW buffer_pptr[1];
-  while (cinfo->output_scanline < cinfo->image_height) {
-    buffer_pptr[0] = element;
-    jpeg_read_scanlines(cinfo, buffer_pptr, 1);
-    element += row_stride;
+  const int max_lines = cinfo->rec_outbuf_height;
+  std::vector<JSAMPROW> rows(max_lines);
+  while (cinfo->output_scanline < cinfo->output_height) {
+    const int lines = std::min<int>(max_lines,
+        cinfo->output_height - cinfo->output_scanline);
+    for (int k=0; k<lines; ++k) rows[k] = element + k*row_stride;
+    element += row_stride * jpeg_read_scanlines(cinfo, &rows[0], lines);
   }
 }
 
@@ -129,43 +183,84 @@ void im_load_color(struct jpeg_decompress_struct *cinfo, bob::core::array::inter
   T *element_g = element_r+frame_size;
   T *element_b = element_g+frame_size;
 
+  // libjpeg only produces interleaved RGB: the scanlines are decoded in
+  // groups into a buffer of the decompressor's own memory pool and split
+  // into the planes of the output from there
   const int row_stride = cinfo->output_width * cinfo->output_components;
-  JSAMPROW buffer_pptr[1];
-  boost::shared_array<JSAMPLE> buffer(new JSAMPLE[row_stride]);
-  buffer_pptr[0] = buffer.get();
+  const int max_lines = cinfo->rec_outbuf_height;
+  JSAMPARRAY buffer = (*cinfo->mem->alloc_sarray)
+    (reinterpret_cast<j_common_ptr>(cinfo), JPOOL_IMAGE, row_stride, max_lines);
   while (cinfo->output_scanline < cinfo->output_height) {
-    jpeg_read_scanlines(cinfo, buffer_pptr, 1);
-    imbuffer_to_rgb<T>(info.shape[2], reinterpret_cast<T*>(buffer_pptr[0]), element_r, element_g, element_b);
-    element_r += cinfo->output_width;
-    element_g += cinfo->output_width;
-    element_b += cinfo->output_width;
+    const int lines = jpeg_read_scanlines(cinfo, buffer, max_lines);
+    for (int k=0; k<lines; ++k) {
+      imbuffer_to_rgb<T>(info.shape[2], reinterpret_cast<T*>(buffer[k]), element_r, element_g, element_b);
+      element_r += cinfo->output_width;
+      element_g += cinfo->output_width;
+      element_b += cinfo->output_width;
+    }
   }
 }
 
-static void im_load(const std::string& filename, bob::core::array::interface& b) {
-  // 1. JPEG structures
-  struct jpeg_decompress_struct cinfo;
-  struct jpeg_error_mgr jerr;
-  cinfo.err = jpeg_std_error(&jerr);
-  jpeg_create_decompress(&cinfo);
-
-  // 2. JPEG file opening
-  boost::shared_ptr<std::FILE> in_file = make_cfile(filename.c_str(), "rb");
-  jpeg_stdio_src(&cinfo, in_file.get());
+/**
+ * Decodes the region of height x width pixels at (y, x) of the output. With
+ * libjpeg-turbo, only the blocks covering the columns of the region are
+ * decoded and the scanlines above it are skipped. The scanlines below it are
+ * never decoded.
+ */
+template <typename T> static
+void im_load_region(struct jpeg_decompress_struct *cinfo, size_t y, size_t x,
+    size_t height, size_t width, bob::core::array::interface& b) {
+  const size_t planes = cinfo->output_components;
+  const size_t frame_size = height * width;
+  T *element = static_cast<T*>(b.ptr());
 
-  // 3. Read header
-  jpeg_read_header(&cinfo, TRUE);
+  size_t xoffset = x; //column of the region in the decoded scanlines
+#ifdef LIBJPEG_TURBO_VERSION_NUMBER
+  if (width < cinfo->output_width) {
+    JDIMENSION crop_x = x;
+    JDIMENSION crop_width = width;
+    jpeg_crop_scanline(cinfo, &crop_x, &crop_width);
+    xoffset = x - crop_x;
+  }
+  if (y) jpeg_skip_scanlines(cinfo, y);
+#endif
+
+  const int row_stride = cinfo->output_width * planes;
+  const int max_lines = cinfo->rec_outbuf_height;
+  JSAMPARRAY buffer = (*cinfo->mem->alloc_sarray)
+    (reinterpret_cast<j_common_ptr>(cinfo), JPOOL_IMAGE, row_stride, max_lines);
+  while (cinfo->output_scanline < y + height) {
+    const size_t first = cinfo->output_scanline;
+    const int lines = jpeg_read_scanlines(cinfo, buffer, max_lines);
+    for (int k=0; k<lines; ++k) {
+      const size_t row = first + k;
+      if (row < y || row >= y + height) continue;
+      const T* src = reinterpret_cast<const T*>(buffer[k]) + xoffset * planes;
+      T* dst = element + (row - y) * width;
+      for (size_t p=0; p<planes; ++p)
+        for (size_t i=0; i<width; ++i)
+          dst[p*frame_size + i] = src[i*planes + p];
+    }
+  }
+}
 
-  // 4. Set parameters for decompression
+static void im_load(const std::string& filename, JpegDecoder& decoder,
+    const bob::io::DecodeOptions& options, bob::core::array::interface& b) {
+  struct jpeg_decompress_struct& cinfo = decoder.cinfo;
 
-  // 5. Start decompression and get information
+  // 4. Start decompression
   jpeg_start_decompress(&cinfo);
 
-  // 6. Read content
+  // 5. Read content
   const bob::core::array::typeinfo& info = b.type();
+  size_t y, x, height, width;
+  options.roi(cinfo.output_height, cinfo.output_width, y, x, height, width);
+  const bool full = (height == cinfo.output_height && width == cinfo.output_width);
   if(info.dtype == bob::core::array::t_uint8) {
-    if(info.nd == 2) im_load_gray<uint8_t>(&cinfo, b);
-    else if( info.nd == 3) im_load_color<uint8_t>(&cinfo, b);
+    if(info.nd == 2 && full) im_load_gray<uint8_t>(&cinfo, b);
+    else if(info.nd == 3 && full) im_load_color<uint8_t>(&cinfo, b);
+    else if(info.nd == 2 || info.nd == 3)
+      im_load_region<uint8_t>(&cinfo, y, x, height, width, b);
     else {
       boost::format m("the image in file `%s' has a number of dimensions this jpeg codec has no support for: %s");
       m % filename % info.str();
@@ -178,11 +273,12 @@ static void im_load(const std::string& filename, bob::core::array::interface& b)
     throw std::runtime_error(m.str());
   }
 
-  // 7. Finish decompression
-  jpeg_finish_decompress(&cinfo);
-
-  // 8. Release JPEG decompression object
-  jpeg_destroy_decompress(&cinfo);
+  // 6. Finish decompression (the decompressor is released by its owner).
+  // Scanlines below a region of interest are not decoded at all.
+  if (cinfo.output_scanline < cinfo.output_height)
+    jpeg_abort_decompress(&cinfo);
+  else
+    jpeg_finish_decompress(&cinfo);
 }
 
 /**
@@ -306,7 +402,9 @@ class ImageJpegFile: public bob::io::File {
 
         if (mode == 'r' || (mode == 'a' && boost::filesystem::exists(path))) {
           {
-            im_peek(path, m_type);
+            m_decoder.reset(new JpegDecoder(path));
+            configure(path, *m_decoder, m_options);
+            im_peek(path, *m_decoder, m_options, m_type);
             m_length = 1;
             m_newfile = false;
           }
@@ -354,7 +452,38 @@ class ImageJpegFile: public bob::io::File {
         throw std::runtime_error("cannot read image with index > 0 -- there is only one image in an image file");
 
       if(!buffer.type().is_compatible(m_type)) buffer.set(m_type);
-      im_load(m_filename, buffer);
+
+      // a decompressor can only be used once: the one that was opened to
+      // peek the file is used for the first read only
+      boost::shared_ptr<JpegDecoder> decoder;
+      decoder.swap(m_decoder);
+      if (!decoder) {
+        decoder.reset(new JpegDecoder(m_filename));
+        configure(m_filename, *decoder, m_options);
+      }
+      im_load(m_filename, *decoder, m_options, buffer);
+    }
+
+    virtual void setDecodeOptions(const bob::io::DecodeOptions& options) {
+      if (m_newfile) {
+        boost::format m("cannot set the decoding options of file `%s', which has no image yet");
+        m % m_filename;
+        throw std::runtime_error(m.str());
+      }
+
+      if (!m_decoder) m_decoder.reset(new JpegDecoder(m_filename));
+      try {
+        bob::core::array::typeinfo type;
+        configure(m_filename, *m_decoder, options);
+        im_peek(m_filename, *m_decoder, options, type);
+        m_options = options;
+        m_type = type;
+      }
+      catch (...) {
+        // the decoder may have been configured with the rejected options
+        m_decoder.reset();
+        throw;
+      }
     }
 
     virtual size_t append (const bob::core::array::interface& buffer) {
@@ -384,6 +513,8 @@ class ImageJpegFile: public bob::io::File {
     bool m_newfile;
     bob::core::array::typeinfo m_type;
     size_t m_length;
+    boost::shared_ptr<JpegDecoder> m_decoder; ///< opened by the last peek
+    bob::io::DecodeOptions m_options;
 
     static std::string s_codecname;
 
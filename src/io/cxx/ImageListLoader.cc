@@ -0,0 +1,269 @@
+/**
+ * @file io/cxx/ImageListLoader.cc
+ * @date Mon Oct 19 22:05:37 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Parallel loading of lists of images. Implementation.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+#include <hdf5.h>
+#include <bob/core/parallel.h>
+#include <bob/io/utils.h>
+#include <bob/io/CodecRegistry.h>
+#include <bob/io/ImageListLoader.h>
+
+/**
+ * Files read through HDF5 (by the HDF5 and Matlab codecs) are only decoded
+ * by several threads, and batches prefetched by a background thread, if the
+ * HDF5 library serializes its calls itself (i.e., if it was built
+ * thread-safe).
+ */
+#ifdef H5_HAVE_THREADSAFE
+static const bool HDF5_THREADSAFE = true;
+#else
+static const bool HDF5_THREADSAFE = false;
+#endif
+
+namespace {
+
+  /**
+   * Tells if any of the files is read by a codec based on HDF5
+   */
+  bool uses_hdf5(const std::vector<std::string>& filenames) {
+    static const char* HDF5_EXTENSIONS[] = {".hdf5", ".mat", 0};
+    boost::shared_ptr<bob::io::CodecRegistry> registry =
+      bob::io::CodecRegistry::instance();
+    std::vector<bob::io::file_factory_t> factories;
+    for (const char** ext = HDF5_EXTENSIONS; *ext; ++ext)
+      if (registry->isRegistered(*ext))
+        factories.push_back(registry->findByExtension(*ext));
+    for (size_t k=0; k<filenames.size(); ++k) {
+      bob::io::file_factory_t f =
+        registry->findByFilenameExtension(filenames[k]);
+      if (std::find(factories.begin(), factories.end(), f) != factories.end())
+        return true;
+    }
+    return false;
+  }
+
+  /**
+   * Decodes the images [begin, end) of a read into their place in the
+   * output. Only raw pointers to the output are shared between threads.
+   */
+  struct DecodeImages {
+    const std::vector<std::string>& filenames;
+    size_t start;
+    const bob::core::array::typeinfo& type;
+    const bob::io::DecodeOptions& options;
+    char* data;
+
+    DecodeImages(const std::vector<std::string>& filenames_, size_t start_,
+        const bob::core::array::typeinfo& type_,
+        const bob::io::DecodeOptions& options_, void* data_):
+      filenames(filenames_), start(start_), type(type_), options(options_),
+      data(static_cast<char*>(data_)) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const {
+      const size_t bytes = type.buffer_size();
+      for (uint64_t k=begin; k<end; ++k) {
+        const std::string& filename = filenames[start + k];
+        boost::shared_ptr<bob::io::File> f = bob::io::open(filename, 'r');
+        f->setDecodeOptions(options);
+        if (!f->type().is_compatible(type)) {
+          boost::format m("the image in file `%s' is of type %s, while the images of the list are of type %s");
+          m % filename % f->type().str() % type.str();
+          throw std::runtime_error(m.str());
+        }
+        bob::core::array::blitz_array image(data + k*bytes, type);
+        f->read(image, 0);
+      }
+    }
+  };
+
+}
+
+bob::io::ImageListLoader::ImageListLoader
+(const std::vector<std::string>& filenames, size_t n_threads,
+ const bob::io::DecodeOptions& options):
+  m_filenames(filenames),
+  m_n_threads(n_threads),
+  m_options(options),
+  m_serialized(false),
+  m_batch_size(0),
+  m_queue_size(0),
+  m_produced(0),
+  m_n_batches(0),
+  m_started(false),
+  m_stop(false)
+{
+  if (m_filenames.empty())
+    throw std::runtime_error("the list of images to load is empty");
+  m_serialized = !HDF5_THREADSAFE && uses_hdf5(m_filenames);
+  boost::shared_ptr<bob::io::File> f = bob::io::open(m_filenames[0], 'r');
+  f->setDecodeOptions(m_options);
+  m_type = f->type();
+  if (m_type.nd + 1 > BOB_MAX_DIM) {
+    boost::format m("the images of the list (e.g. `%s') are of type %s, which has too many dimensions to be stacked");
+    m % m_filenames[0] % m_type.str();
+    throw std::runtime_error(m.str());
+  }
+}
+
+bob::io::ImageListLoader::~ImageListLoader() {
+  stop();
+}
+
+bob::core::array::typeinfo bob::io::ImageListLoader::type(size_t count) const {
+  size_t shape[BOB_MAX_DIM];
+  shape[0] = count;
+  for (size_t k=0; k<m_type.nd; ++k) shape[k+1] = m_type.shape[k];
+  return bob::core::array::typeinfo(m_type.dtype, m_type.nd + 1, shape);
+}
+
+void bob::io::ImageListLoader::read(size_t start, size_t count,
+    bob::core::array::interface& buffer) {
+  if (start + count > size()) {
+    boost::format m("cannot read %u images starting at index %u from a list of %u images");
+    m % count % start % size();
+    throw std::runtime_error(m.str());
+  }
+  const bob::core::array::typeinfo info = type(count);
+  if (!buffer.type().is_compatible(info)) buffer.set(info);
+  if (!count) return;
+  bob::core::parallel_for(count,
+      DecodeImages(m_filenames, start, m_type, m_options, buffer.ptr()),
+      m_serialized ? 1 : m_n_threads);
+}
+
+void bob::io::ImageListLoader::start(size_t batch_size, size_t queue_size) {
+  if (batch_size == 0)
+    throw std::runtime_error("the batch size must be at least 1");
+  if (queue_size == 0)
+    throw std::runtime_error("the prefetch queue size must be at least 1");
+  stop();
+
+  m_batch_size = batch_size;
+  m_queue_size = queue_size;
+  m_produced = 0;
+  m_n_batches = (size() + batch_size - 1) / batch_size;
+  m_error = boost::exception_ptr();
+  m_started = true;
+  m_stop = false;
+  if (!m_serialized)
+    m_thread.reset(new boost::thread(boost::bind(&ImageListLoader::prefetch,
+            this)));
+  //otherwise, next() decodes the batches
+}
+
+boost::shared_ptr<bob::core::array::blitz_array>
+bob::io::ImageListLoader::read_batch(size_t b) {
+  const size_t start = b * m_batch_size;
+  const size_t count = std::min(m_batch_size, size() - start);
+  boost::shared_ptr<bob::core::array::blitz_array> batch =
+    boost::make_shared<bob::core::array::blitz_array>(type(count));
+  read(start, count, *batch);
+  return batch;
+}
+
+void bob::io::ImageListLoader::prefetch() {
+  for (size_t b=0; b<m_n_batches; ++b) {
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while (!m_stop && m_queue.size() >= m_queue_size) m_cond.wait(lock);
+      if (m_stop) return;
+    }
+
+    boost::shared_ptr<bob::core::array::blitz_array> batch;
+    boost::exception_ptr error;
+    try {
+      batch = read_batch(b);
+    }
+    catch (...) {
+      error = boost::current_exception();
+    }
+
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    if (error) {
+      // the batches after a failure are not decoded
+      m_error = error;
+      m_produced = m_n_batches;
+      m_cond.notify_all();
+      return;
+    }
+    m_queue.push_back(batch);
+    ++m_produced;
+    m_cond.notify_all();
+  }
+}
+
+boost::shared_ptr<bob::core::array::blitz_array>
+bob::io::ImageListLoader::next() {
+  if (!m_started)
+    throw std::runtime_error("the prefetcher of the image list was not started");
+
+  if (!m_thread) { //decodes the batch right away
+    if (m_produced >= m_n_batches)
+      return boost::shared_ptr<bob::core::array::blitz_array>();
+    const size_t b = m_produced++;
+    try {
+      return read_batch(b);
+    }
+    catch (...) {
+      // the batches after a failure are not decoded
+      m_produced = m_n_batches;
+      throw;
+    }
+  }
+
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  while (m_queue.empty() && m_produced < m_n_batches) m_cond.wait(lock);
+
+  if (!m_queue.empty()) {
+    boost::shared_ptr<bob::core::array::blitz_array> retval = m_queue.front();
+    m_queue.pop_front();
+    m_cond.notify_all();
+    return retval;
+  }
+
+  if (m_error) {
+    boost::exception_ptr error = m_error;
+    m_error = boost::exception_ptr();
+    lock.unlock();
+    boost::rethrow_exception(error);
+  }
+
+  return boost::shared_ptr<bob::core::array::blitz_array>();
+}
+
+void bob::io::ImageListLoader::stop() {
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    m_stop = true;
+    m_cond.notify_all();
+  }
+  if (m_thread) {
+    m_thread->join();
+    m_thread.reset();
+  }
+  m_started = false;
+  m_queue.clear();
+}
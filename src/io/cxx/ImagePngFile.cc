@@ -27,7 +27,10 @@
 #include <boost/format.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/noncopyable.hpp>
 #include <string>
+#include <vector>
+#include <algorithm>
 
 #include <bob/io/CodecRegistry.h>
 
@@ -58,62 +61,93 @@ static boost::shared_ptr<std::FILE> make_cfile(const char *filename, const char
 /**
  * LOADING
  */
-static void im_peek(const std::string& path, bob::core::array::typeinfo& info)
-{
-  // 1. PNG structure declarations
+
+/**
+ * A PNG reader of which the header was already read. The codec keeps the
+ * one created when peeking the file, so that the file is only opened and
+ * parsed once if it is then read.
+ */
+struct PngDecoder: private boost::noncopyable {
+
+  boost::shared_ptr<std::FILE> file;
   png_structp png_ptr;
   png_infop info_ptr;
+  png_uint_32 width;
+  png_uint_32 height;
+  int bit_depth;
+  int color_type;
+  int interlace_type;
+
+  PngDecoder(const std::string& path):
+    file(make_cfile(path.c_str(), "rb")),
+    png_ptr(0),
+    info_ptr(0)
+  {
+    // 1. Create and initialize the png_struct. The compiler header file
+    //    version is supplied, so that we know if the application was
+    //    compiled with a compatible version of the library.
+    png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if(png_ptr == NULL) throw std::runtime_error("PNG: error while creating read png structure (function png_create_read_struct())");
+
+    // Allocate/initialize the memory for image information.
+    info_ptr = png_create_info_struct(png_ptr);
+    if(info_ptr == NULL) {
+      png_destroy_read_struct(&png_ptr, NULL, NULL);
+      throw std::runtime_error("PNG: error while creating info png structure (function png_create_info_struct())");
+    }
 
-  // 2. PNG file opening
-  boost::shared_ptr<std::FILE> in_file = make_cfile(path.c_str(), "rb");
+    // 2. Set error handling if you are using the setjmp/longjmp method (this
+    // is the normal method of doing things with libpng). This is required as
+    // we did not set up our own error handlers in the png_create_read_struct()
+    // earlier.
+    if(setjmp(png_jmpbuf(png_ptr)))
+    {
+      // Free all of the memory associated with the png_ptr and info_ptr
+      png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+      boost::format m("PNG: error while reading the header of file `%s'");
+      m % path;
+      throw std::runtime_error(m.str());
+    }
 
-  // 3. Create and initialize the png_struct. The compiler header file version
-  //    is supplied, so that we know if the application was compiled with a
-  //    compatible version of the library.
-  png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-  if(png_ptr == NULL) throw std::runtime_error("PNG: error while creating read png structure (function png_create_read_struct())");
+    // 3. Initialize
+    png_init_io(png_ptr, file.get());
 
-  // Allocate/initialize the memory for image information.
-  info_ptr = png_create_info_struct(png_ptr);
-  if(info_ptr == NULL) {
-    png_destroy_read_struct(&png_ptr, NULL, NULL);
-    throw std::runtime_error("PNG: error while creating info png structure (function png_create_info_struct())");
+    // 4. The call to png_read_info() gives us all of the information from
+    // the PNG file.
+    png_read_info(png_ptr, info_ptr);
+    png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type,
+      &interlace_type, NULL, NULL);
   }
 
-  // 4. Set error handling if you are using the setjmp/longjmp method (this is
-  // the normal method of doing things with libpng). This is required as we
-  // did not set up our own error handlers in the png_create_read_struct() earlier.
-  if(setjmp(png_jmpbuf(png_ptr)))
-  {
-    // Free all of the memory associated with the png_ptr and info_ptr
+  ~PngDecoder() {
     png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-    throw std::runtime_error("PNG: error while setting error handling (function setjmp(png_jmpbuf(()))");
   }
 
-  // 5. Initialize
-  png_init_io(png_ptr, in_file.get());
-
-  // 7. The call to png_read_info() gives us all of the information from the
-  // PNG file.
-  png_read_info(png_ptr, info_ptr);
-  // Get header information
-  png_uint_32 width, height;
-  int bit_depth, color_type, interlace_type;
-  png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type,
-    &interlace_type, NULL, NULL);
+};
 
-  // 8. Clean up after the read, and free any memory allocated
-  png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+static void im_peek(const std::string& path, const PngDecoder& decoder,
+    const bob::io::DecodeOptions& options, bob::core::array::typeinfo& info)
+{
+  if (options.scale_denom == 0) {
+    boost::format m("cannot decode file `%s' at 1/0 of its size");
+    m % path;
+    throw std::runtime_error(m.str());
+  }
 
   // Set depth and number of dimensions
-  info.dtype = (bit_depth <= 8 ? bob::core::array::t_uint8 : bob::core::array::t_uint16);
-  if(color_type == PNG_COLOR_TYPE_GRAY)
+  info.dtype = (decoder.bit_depth <= 8 ? bob::core::array::t_uint8 : bob::core::array::t_uint16);
+  if(decoder.color_type == PNG_COLOR_TYPE_GRAY || options.gray)
     info.nd = 2;
-  else if (color_type == PNG_COLOR_TYPE_RGB || PNG_COLOR_TYPE_PALETTE)
+  else if (decoder.color_type == PNG_COLOR_TYPE_RGB || PNG_COLOR_TYPE_PALETTE)
     info.nd = 3;
   else {// Unsupported color type
     throw std::runtime_error("PNG: codec does not support images with color spaces different than GRAY, RGB or Indexed colors (Palette)");
   }
+
+  // The image is (a region of interest of) the scaled image
+  size_t y, x, height, width;
+  options.roi(options.scaled(decoder.height), options.scaled(decoder.width),
+      y, x, height, width);
   if(info.nd == 2)
   {
     info.shape[0] = height;
@@ -209,97 +243,172 @@ void im_load_color(png_structp png_ptr, bob::core::array::interface& b)
   }
 }
 
-static void im_load(const std::string& filename, bob::core::array::interface& b)
+/**
+ * Samples of the decoded rows, which are in the byte order of the file for
+ * 16 bits images (the codec does not swap them)
+ */
+static inline size_t get_sample(const uint8_t* p) { return *p; }
+static inline void set_sample(uint8_t* p, size_t v) { *p = v; }
+
+static inline size_t get_sample(const uint16_t* p) {
+  const uint8_t* b = reinterpret_cast<const uint8_t*>(p);
+  return (static_cast<size_t>(b[0]) << 8) | b[1];
+}
+
+static inline void set_sample(uint16_t* p, size_t v) {
+  uint8_t* b = reinterpret_cast<uint8_t*>(p);
+  b[0] = (v >> 8) & 0xff;
+  b[1] = v & 0xff;
+}
+
+/**
+ * Decodes the region of interest of the image scaled to 1/scale_denom of
+ * its size, where each pixel is the average of a block of scale_denom x
+ * scale_denom pixels (smaller at the right and bottom borders). Only the
+ * rows above and in the region are decoded, except for interlaced images,
+ * which are fully decoded first. Returns true if all rows were decoded.
+ */
+template <typename T> static
+bool im_load_region(png_structp png_ptr, const PngDecoder& decoder,
+    const bob::io::DecodeOptions& options, bob::core::array::interface& b)
 {
-  // 1. PNG structure declarations
-  png_structp png_ptr;
-  png_infop info_ptr;
+  const bob::core::array::typeinfo& info = b.type();
+  const size_t planes = (info.nd == 2 ? 1 : 3);
+  const size_t s = options.scale_denom;
+  const size_t full_height = decoder.height;
+  const size_t full_width = decoder.width;
+  size_t y, x, height, width;
+  options.roi(options.scaled(full_height), options.scaled(full_width),
+      y, x, height, width);
+  const size_t frame_size = height * width;
+  T *element = static_cast<T*>(b.ptr());
 
-  // 2. PNG file opening
-  boost::shared_ptr<std::FILE> in_file = make_cfile(filename.c_str(), "rb");
+  // Rows of the full image covering the region of interest
+  const size_t first = y * s;
+  const size_t last = std::min((y + height) * s, full_height);
+  const size_t row_size = planes * full_width;
 
-  // 3. Create and initialize the png_struct with the desired error handler
-  // functions. The compiler header file version is supplied, so that we
-  // know if the application was compiled with a compatible version of the library.
-  png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-  if(png_ptr == NULL) throw std::runtime_error("PNG: error while creating read png structure (function png_create_read_struct())");
+#ifdef PNG_READ_INTERLACING_SUPPORTED
+  // Turn on interlace handling.
+  int number_passes = png_set_interlace_handling(png_ptr);
+#else
+  int number_passes = 1;
+#endif // PNG_READ_INTERLACING_SUPPORTED
 
-  // Allocate/initialize the memory for image informatio
-  info_ptr = png_create_info_struct(png_ptr);
-  if(info_ptr == NULL) {
-    png_destroy_read_struct(&png_ptr, NULL, NULL);
-    throw std::runtime_error("PNG: error while creating info png structure (function png_create_info_struct())");
+  // The passes of interlaced images refine all rows, which are kept
+  std::vector<T> rows(number_passes > 1 ? full_height * row_size : row_size);
+  if (number_passes > 1) {
+    for(int pass=0; pass<number_passes; ++pass)
+      for(size_t r=0; r<full_height; ++r)
+        png_read_row(png_ptr, reinterpret_cast<png_bytep>(&rows[r*row_size]), NULL);
   }
 
-  // 4. Set error handling if you are using the setjmp/longjmp method (this is
-  // the normal method of doing things with libpng). This is required as we did
-  // not set up your own error handlers in the png_create_read_struct() earlier.
-  if(setjmp(png_jmpbuf(png_ptr)))
+  std::vector<size_t> sums(planes * width, 0);
+  for(size_t r=0; r<last; ++r)
   {
-    // Free all of the memory associated with the png_ptr and info_ptr
-    png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-    throw std::runtime_error("PNG: error while setting error handling (function setjmp(png_jmpbuf(()))");
+    const T* src = &rows[0];
+    if (number_passes > 1) src += r * row_size;
+    else png_read_row(png_ptr, reinterpret_cast<png_bytep>(&rows[0]), NULL);
+    if (r < first) continue;
+
+    // Accumulates the row in the blocks of the region of interest
+    for(size_t i=0; i<width; ++i)
+    {
+      const size_t c_end = std::min((x + i + 1) * s, full_width);
+      for(size_t c=(x + i) * s; c<c_end; ++c)
+        for(size_t p=0; p<planes; ++p)
+          sums[p*width + i] += get_sample(src + c*planes + p);
+    }
+
+    // The last row of a block gives a row of the region of interest
+    if ((r + 1) % s && r + 1 != full_height) continue;
+    const size_t block_rows = r + 1 - (r / s) * s;
+    T* dst = element + (r / s - y) * width;
+    for(size_t i=0; i<width; ++i)
+    {
+      const size_t block_cols = std::min((x + i + 1) * s, full_width) - (x + i) * s;
+      const size_t n = block_rows * block_cols;
+      for(size_t p=0; p<planes; ++p)
+      {
+        size_t& sum = sums[p*width + i];
+        set_sample(dst + p*frame_size + i, (sum + n / 2) / n);
+        sum = 0;
+      }
+    }
   }
 
-  // 5. Initialize
-  png_init_io(png_ptr, in_file.get());
+  return number_passes > 1 || last == full_height;
+}
 
-  // 6. The call to png_read_info() gives us all of the information from the
-  // PNG file.
-  png_read_info(png_ptr, info_ptr);
-  // Get header information
-  png_uint_32 width, height;
-  int bit_depth, color_type, interlace_type;
-  png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type,
-       &interlace_type, NULL, NULL);
+static void im_load(const std::string& filename, PngDecoder& decoder,
+    const bob::io::DecodeOptions& options, bob::core::array::interface& b)
+{
+  png_structp png_ptr = decoder.png_ptr;
+
+  // 1. Errors while decoding jump back here. The png structures are
+  // released by the owner of the decoder.
+  if(setjmp(png_jmpbuf(png_ptr)))
+  {
+    boost::format m("PNG: error while reading file `%s'");
+    m % filename;
+    throw std::runtime_error(m.str());
+  }
 
   // Extract multiple pixels with bit depths of 1, 2, and 4 from a single
   // byte into separate bytes (useful for paletted and grayscale images).
   png_set_packing(png_ptr);
 
   // Expand grayscale images to the full 8 bits from 1, 2, or 4 bits/pixel
-  if(color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8)
+  if(decoder.color_type == PNG_COLOR_TYPE_GRAY && decoder.bit_depth < 8)
     png_set_expand_gray_1_2_4_to_8(png_ptr);
-  else if(color_type == PNG_COLOR_TYPE_PALETTE)
+  else if(decoder.color_type == PNG_COLOR_TYPE_PALETTE)
     png_set_palette_to_rgb(png_ptr);
   // We currently only support grayscale and rgb images
-  if(color_type != PNG_COLOR_TYPE_GRAY && color_type != PNG_COLOR_TYPE_RGB && color_type != PNG_COLOR_TYPE_PALETTE) {
+  if(decoder.color_type != PNG_COLOR_TYPE_GRAY && decoder.color_type != PNG_COLOR_TYPE_RGB && decoder.color_type != PNG_COLOR_TYPE_PALETTE) {
     throw std::runtime_error("PNG: codec does not support images with color spaces different than GRAY, RGB or Indexed colors (Palette)");
   }
 
-  // 7. Read content
+  // Color images may be converted to gray by libpng (with the default
+  // weights of ITU-R BT.709)
+  if(options.gray && decoder.color_type != PNG_COLOR_TYPE_GRAY)
+    png_set_rgb_to_gray_fixed(png_ptr, 1, -1, -1);
+
+  // 2. Read content
   const bob::core::array::typeinfo& info = b.type();
+  bool complete = true;
+  const bool full = options.scale_denom == 1 &&
+    info.shape[info.nd-2] == decoder.height && info.shape[info.nd-1] == decoder.width;
   if(info.dtype == bob::core::array::t_uint8) {
-    if(info.nd == 2) im_load_gray<uint8_t>(png_ptr, b);
-    else if( info.nd == 3) im_load_color<uint8_t>(png_ptr, b);
+    if(info.nd == 2 && full) im_load_gray<uint8_t>(png_ptr, b);
+    else if( info.nd == 3 && full) im_load_color<uint8_t>(png_ptr, b);
+    else if(info.nd == 2 || info.nd == 3)
+      complete = im_load_region<uint8_t>(png_ptr, decoder, options, b);
     else {
-      png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
       boost::format m("the image in file `%s' has a number of dimensions for which this png codec has no support for: %s");
-      m % info.str();
+      m % filename % info.str();
       throw std::runtime_error(m.str());
     }
   }
   else if(info.dtype == bob::core::array::t_uint16) {
-    if(info.nd == 2) im_load_gray<uint16_t>(png_ptr, b);
-    else if( info.nd == 3) im_load_color<uint16_t>(png_ptr, b);
+    if(info.nd == 2 && full) im_load_gray<uint16_t>(png_ptr, b);
+    else if( info.nd == 3 && full) im_load_color<uint16_t>(png_ptr, b);
+    else if(info.nd == 2 || info.nd == 3)
+      complete = im_load_region<uint16_t>(png_ptr, decoder, options, b);
     else {
-      png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
       boost::format m("the image in file `%s' has a number of dimensions for which this png codec has no support for: %s");
-      m % info.str();
+      m % filename % info.str();
       throw std::runtime_error(m.str());
     }
   }
   else {
-    png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
     boost::format m("the image in file `%s' has a data type this png codec has no support for: %s");
-    m % info.str();
+    m % filename % info.str();
     throw std::runtime_error(m.str());
   }
 
-  // 8. Clean up after the read, and free any memory allocated
-  // Read rest of file, and get additional chunks in info_ptr
-  png_read_end(png_ptr, NULL);
-  png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+  // 3. Read rest of file, and get additional chunks in info_ptr. The rows
+  // below a region of interest are not decoded at all.
+  if (complete) png_read_end(png_ptr, NULL);
 }
 
 
@@ -485,7 +594,8 @@ class ImagePngFile: public bob::io::File {
 
         if (mode == 'r' || (mode == 'a' && boost::filesystem::exists(path))) {
           {
-            im_peek(path, m_type);
+            m_decoder.reset(new PngDecoder(path));
+            im_peek(path, *m_decoder, m_options, m_type);
             m_length = 1;
             m_newfile = false;
           }
@@ -533,7 +643,27 @@ class ImagePngFile: public bob::io::File {
         throw std::runtime_error("cannot read image with index > 0 -- there is only one image in an image file");
 
       if(!buffer.type().is_compatible(m_type)) buffer.set(m_type);
-      im_load(m_filename, buffer);
+
+      // png structures can only be used once: the ones that were opened to
+      // peek the file are used for the first read only
+      boost::shared_ptr<PngDecoder> decoder;
+      decoder.swap(m_decoder);
+      if (!decoder) decoder.reset(new PngDecoder(m_filename));
+      im_load(m_filename, *decoder, m_options, buffer);
+    }
+
+    virtual void setDecodeOptions(const bob::io::DecodeOptions& options) {
+      if (m_newfile) {
+        boost::format m("cannot set the decoding options of file `%s', which has no image yet");
+        m % m_filename;
+        throw std::runtime_error(m.str());
+      }
+
+      if (!m_decoder) m_decoder.reset(new PngDecoder(m_filename));
+      bob::core::array::typeinfo type;
+      im_peek(m_filename, *m_decoder, options, type);
+      m_options = options;
+      m_type = type;
     }
 
     virtual size_t append (const bob::core::array::interface& buffer) {
@@ -563,6 +693,8 @@ class ImagePngFile: public bob::io::File {
     bool m_newfile;
     bob::core::array::typeinfo m_type;
     size_t m_length;
+    boost::shared_ptr<PngDecoder> m_decoder; ///< opened by the last peek
+    bob::io::DecodeOptions m_options;
 
     static std::string s_codecname;
 
@@ -24,33 +24,61 @@
 #include <bob/io/VideoReader.h>
 
 #include <stdexcept>
+#include <algorithm>
 #include <boost/format.hpp>
 #include <boost/preprocessor.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/locks.hpp>
 #include <limits>
 
 #include <bob/core/check.h>
 #include <bob/core/blitz_array.h>
 #include <bob/core/logging.h>
+#include <bob/io/HDF5File.h>
 
 #ifndef AV_PIX_FMT_RGB24
 #define AV_PIX_FMT_RGB24 PIX_FMT_RGB24
 #endif
 
-bob::io::VideoReader::VideoReader(const std::string& filename, bool check) {
+bob::io::VideoReader::VideoReader(const std::string& filename, bool check):
+  m_cache_size(0)
+{
   open(filename, check);
 }
 
-bob::io::VideoReader::VideoReader(const bob::io::VideoReader& other) {
+bob::io::VideoReader::VideoReader(const bob::io::VideoReader& other):
+  m_cache_size(0)
+{
   *this = other;
 }
 
 bob::io::VideoReader& bob::io::VideoReader::operator= (const bob::io::VideoReader& other) {
+  if (this == &other) return *this;
+
   open(other.filename(), other.m_check);
+
+  //the index is shared, the cache is not
+  m_index = other.m_index;
+  if (m_index) {
+    m_nframes = m_index->frames;
+    m_typeinfo_video.shape[0] = m_nframes;
+    m_typeinfo_video.update_strides();
+  }
+  {
+    boost::lock_guard<boost::mutex> lock(m_cache_mutex);
+    m_cache.clear();
+    m_cache_lru.clear();
+  }
+  setCacheSize(other.getCacheSize());
+
   return *this;
 }
 
 void bob::io::VideoReader::open(const std::string& filename, bool check) {
   m_filepath = filename;
+  m_check = check;
+  m_index.reset();
 
   boost::shared_ptr<AVFormatContext> format_ctxt =
     bob::io::detail::ffmpeg::make_input_format_context(m_filepath);
@@ -175,6 +203,132 @@ size_t bob::io::VideoReader::load(bob::core::array::interface& b,
   return frames_read;
 }
 
+void bob::io::VideoReader::buildIndex(const std::string& index_file) {
+
+  //identifies the current version of the video file
+  const uint64_t size = boost::filesystem::file_size(m_filepath);
+  const int64_t mtime = boost::filesystem::last_write_time(m_filepath);
+
+  boost::shared_ptr<Index> index;
+
+  if (!index_file.empty() && boost::filesystem::exists(index_file)) {
+    bob::io::HDF5File f(index_file, bob::io::HDF5File::in);
+    if (f.contains("size") && f.read<uint64_t>("size") == size &&
+        f.contains("mtime") && f.read<int64_t>("mtime") == mtime) {
+      index = boost::make_shared<Index>();
+      index->frames = f.read<uint64_t>("frames");
+      index->seekable = f.read<bool>("seekable");
+      if (f.contains("keyframes")) {
+        blitz::Array<uint64_t,1> keyframes = f.readArray<uint64_t,1>("keyframes");
+        blitz::Array<int64_t,1> timestamps = f.readArray<int64_t,1>("timestamps");
+        index->keyframes.assign(keyframes.begin(), keyframes.end());
+        index->timestamps.assign(timestamps.begin(), timestamps.end());
+      }
+    }
+    //otherwise, the index is outdated
+  }
+
+  if (!index) {
+    index = boost::make_shared<Index>();
+    boost::shared_ptr<AVFormatContext> format_ctxt =
+      bob::io::detail::ffmpeg::make_input_format_context(m_filepath);
+    int stream_index = bob::io::detail::ffmpeg::find_video_stream(m_filepath,
+        format_ctxt);
+    index->frames = bob::io::detail::ffmpeg::scan_video_packets(m_filepath,
+        stream_index, format_ctxt, index->keyframes, index->timestamps,
+        index->seekable);
+
+    if (!index_file.empty()) {
+      bob::io::HDF5File f(index_file, bob::io::HDF5File::trunc);
+      f.set("filename", m_filepath);
+      f.set("size", size);
+      f.set("mtime", mtime);
+      f.set("frames", index->frames);
+      f.set("seekable", index->seekable);
+      if (!index->keyframes.empty()) { //empty datasets cannot be stored
+        blitz::TinyVector<int,1> shape(index->keyframes.size());
+        f.setArray("keyframes", blitz::Array<uint64_t,1>(&index->keyframes[0],
+              shape, blitz::neverDeleteData));
+        f.setArray("timestamps", blitz::Array<int64_t,1>(&index->timestamps[0],
+              shape, blitz::neverDeleteData));
+      }
+    }
+  }
+
+  m_index = index;
+
+  //the number of frames is now exact
+  m_nframes = index->frames;
+  m_typeinfo_video.shape[0] = m_nframes;
+  m_typeinfo_video.update_strides();
+}
+
+std::vector<uint64_t> bob::io::VideoReader::keyframes() const {
+  if (!m_index) return std::vector<uint64_t>();
+  return m_index->keyframes;
+}
+
+void bob::io::VideoReader::setCacheSize(size_t frames) {
+  boost::lock_guard<boost::mutex> lock(m_cache_mutex);
+  m_cache_size = frames;
+  while (m_cache.size() > m_cache_size) {
+    m_cache.erase(m_cache_lru.back());
+    m_cache_lru.pop_back();
+  }
+}
+
+size_t bob::io::VideoReader::getCacheSize() const {
+  boost::lock_guard<boost::mutex> lock(m_cache_mutex);
+  return m_cache_size;
+}
+
+size_t bob::io::VideoReader::cachedFrames() const {
+  boost::lock_guard<boost::mutex> lock(m_cache_mutex);
+  return m_cache.size();
+}
+
+/**
+ * Copies a frame, organized as (color-bands, height, width), into a buffer
+ * with the same shape, but possibly other strides
+ */
+static void copy_frame(const blitz::Array<uint8_t,3>& frame,
+    bob::core::array::interface& data) {
+  const bob::core::array::typeinfo& info = data.type();
+  blitz::TinyVector<int,3> shape;
+  blitz::TinyVector<int,3> stride;
+  shape = info.shape[0], info.shape[1], info.shape[2];
+  stride = info.stride[0], info.stride[1], info.stride[2];
+  blitz::Array<uint8_t,3> dst(static_cast<uint8_t*>(data.ptr()),
+      shape, stride, blitz::neverDeleteData);
+  dst = frame;
+}
+
+bool bob::io::VideoReader::cached(size_t frame,
+    bob::core::array::interface& data) const {
+  boost::lock_guard<boost::mutex> lock(m_cache_mutex);
+  cache_type::iterator it = m_cache.find(frame);
+  if (it == m_cache.end()) return false;
+  //this frame is now the most recently read
+  m_cache_lru.splice(m_cache_lru.begin(), m_cache_lru, it->second.second);
+  copy_frame(it->second.first, data);
+  return true;
+}
+
+void bob::io::VideoReader::cache(size_t frame,
+    const blitz::Array<uint8_t,3>& rgb) const {
+  boost::lock_guard<boost::mutex> lock(m_cache_mutex);
+  if (!m_cache_size || m_cache.find(frame) != m_cache.end()) return;
+  if (m_cache.size() == m_cache_size) { //drops the least recently read
+    m_cache.erase(m_cache_lru.back());
+    m_cache_lru.pop_back();
+  }
+  m_cache_lru.push_front(frame);
+  blitz::Array<uint8_t,3> copy(rgb.extent(2), rgb.extent(0), rgb.extent(1));
+  copy = rgb.transpose(2,0,1);
+  m_cache.insert(std::make_pair(frame, std::make_pair(copy,
+          m_cache_lru.begin())));
+}
+
 bob::io::VideoReader::const_iterator bob::io::VideoReader::begin() const {
   return bob::io::VideoReader::const_iterator(this);
 }
@@ -185,22 +339,26 @@ bob::io::VideoReader::const_iterator bob::io::VideoReader::end() const {
 
 bob::io::VideoReader::const_iterator::const_iterator(const bob::io::VideoReader* parent) :
   m_parent(parent),
-  m_current_frame(std::numeric_limits<size_t>::max())
+  m_current_frame(std::numeric_limits<size_t>::max()),
+  m_decoded_frame(0)
 {
   init();
 }
 
 bob::io::VideoReader::const_iterator::const_iterator():
   m_parent(0),
-  m_current_frame(std::numeric_limits<size_t>::max())
+  m_current_frame(std::numeric_limits<size_t>::max()),
+  m_decoded_frame(0)
 {
 }
 
 bob::io::VideoReader::const_iterator::const_iterator
 (const bob::io::VideoReader::const_iterator& other) :
   m_parent(other.m_parent),
-  m_current_frame(std::numeric_limits<size_t>::max())
+  m_current_frame(std::numeric_limits<size_t>::max()),
+  m_decoded_frame(0)
 {
+  if (!m_parent) return; //"end"
   init();
   (*this) += other.m_current_frame;
 }
@@ -210,8 +368,10 @@ bob::io::VideoReader::const_iterator::~const_iterator() {
 }
 
 bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::operator= (const bob::io::VideoReader::const_iterator& other) {
+  if (this == &other) return *this;
   reset();
   m_parent = other.m_parent;
+  if (!m_parent) return *this; //"end"
   init();
   (*this) += other.m_current_frame;
   return *this;
@@ -219,6 +379,19 @@ bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::oper
 
 void bob::io::VideoReader::const_iterator::init() {
 
+  //the ffmpeg infrastructure is only set up when a frame is decoded
+  m_current_frame = 0;
+  
+  //the file maybe valid, but contain zero frames... We check for this here:
+  if (m_current_frame >= m_parent->numberOfFrames()) {
+    //transforms the current iterator in "end"
+    reset();
+  }
+
+}
+
+void bob::io::VideoReader::const_iterator::open() {
+
   //ffmpeg initialization
   const std::string& filename = m_parent->filename();
   m_format_context = bob::io::detail::ffmpeg::make_input_format_context(filename);
@@ -233,14 +406,48 @@ void bob::io::VideoReader::const_iterator::init() {
       m_codec_context->width, 3));
 
   //at this point we are ready to start reading out frames.
-  m_current_frame = 0;
-  
-  //the file maybe valid, but contain zero frames... We check for this here:
-  if (m_current_frame >= m_parent->numberOfFrames()) {
-    //transforms the current iterator in "end"
-    reset();
+  m_decoded_frame = 0;
+
+}
+
+bool bob::io::VideoReader::const_iterator::seek_decoder(bool throw_on_error) {
+
+  const size_t target = m_current_frame;
+
+  if (!m_format_context) open();
+
+  //jumps to the last keyframe before the target, unless the decoder is
+  //already between the two
+  boost::shared_ptr<const VideoReader::Index> index = m_parent->m_index;
+  if (index && index->seekable && 
+      !index->keyframes.empty()) {
+    std::vector<uint64_t>::const_iterator it = 
+      std::upper_bound(index->keyframes.begin(), index->keyframes.end(), 
+          (uint64_t)target);
+    if (it != index->keyframes.begin()) {
+      --it;
+      if (target < m_decoded_frame || *it > m_decoded_frame) {
+        const int64_t timestamp = 
+          index->timestamps[it - index->keyframes.begin()];
+        if (bob::io::detail::ffmpeg::seek_video_keyframe(m_stream_index,
+              timestamp, m_format_context, m_codec_context))
+          m_decoded_frame = *it;
+      }
+    }
   }
 
+  //otherwise, rewinds by re-opening the file
+  if (target < m_decoded_frame) open();
+
+  //and decodes the frames in between
+  while (m_decoded_frame < target) {
+    if (!bob::io::detail::ffmpeg::skip_video_frame(m_parent->m_filepath,
+          m_decoded_frame, m_stream_index, m_format_context, m_codec_context,
+          m_context_frame, throw_on_error)) return false;
+    ++m_decoded_frame;
+  }
+
+  return true;
 }
 
 void bob::io::VideoReader::const_iterator::reset() {
@@ -250,6 +457,7 @@ void bob::io::VideoReader::const_iterator::reset() {
   m_codec = 0;
   m_format_context.reset();
   m_current_frame = std::numeric_limits<size_t>::max(); //that means "end" 
+  m_decoded_frame = 0;
   m_parent = 0;
 }
 
@@ -290,6 +498,14 @@ bool bob::io::VideoReader::const_iterator::read(bob::core::array::interface& dat
     throw std::runtime_error(s.str());
   }
 
+  //frames read before (by any iterator) are not decoded again
+  if (m_parent->cached(m_current_frame, data)) {
+    ++m_current_frame;
+    return true;
+  }
+
+  if (!seek_decoder(throw_on_error)) return false;
+
   //we are going to need another copy step - use our internal array
   bool ok = bob::io::detail::ffmpeg::read_video_frame(m_parent->m_filepath, m_current_frame,
       m_stream_index, m_format_context, m_codec_context, m_swscaler,
@@ -298,15 +514,9 @@ bool bob::io::VideoReader::const_iterator::read(bob::core::array::interface& dat
   if (ok) {
 
     //now we copy from one container to the other, using our Blitz++ technique
-    blitz::TinyVector<int,3> shape;
-    blitz::TinyVector<int,3> stride;
-
-    shape = info.shape[0], info.shape[1], info.shape[2];
-    stride = info.stride[0], info.stride[1], info.stride[2];
-    blitz::Array<uint8_t,3> dst(static_cast<uint8_t*>(data.ptr()), 
-        shape, stride, blitz::neverDeleteData);
-
-    dst = m_rgb_array.transpose(2,0,1);
+    copy_frame(m_rgb_array.transpose(2,0,1), data);
+    m_parent->cache(m_current_frame, m_rgb_array);
+    ++m_decoded_frame;
     ++m_current_frame;
 
   }
@@ -319,33 +529,34 @@ bool bob::io::VideoReader::const_iterator::read(bob::core::array::interface& dat
  * operations to get a better performance.
  */
 bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::operator++ () {
+  //frames are only decoded when read
+  return seek(m_current_frame + 1);
+}
+
+bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::operator+= (size_t frames) {
   if (!m_parent) {
     //we are already past the end of the stream
     throw std::runtime_error("video iterator for file has already reached its end and was reset");
   }
 
-  //checks if we have not passed the end of the video sequence already
-  if(m_current_frame >= m_parent->numberOfFrames()) {
+  if (frames >= m_parent->numberOfFrames() - std::min(m_current_frame,
+        m_parent->numberOfFrames())) {
     reset();
     return *this;
   }
 
-  //we are going to need another copy step - use our internal array
-  try {
-    bool ok = bob::io::detail::ffmpeg::skip_video_frame(m_parent->m_filepath, m_current_frame,
-        m_stream_index, m_format_context, m_codec_context, m_context_frame,
-        true);
-    if (ok) ++m_current_frame;
-  }
-  catch (std::runtime_error& e) {
-    reset();
+  return seek(m_current_frame + frames);
+}
+
+bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::seek (size_t frame) {
+  if (!m_parent) {
+    //we are already past the end of the stream
+    throw std::runtime_error("video iterator for file has already reached its end and was reset");
   }
 
-  return *this;
-}
+  if (frame >= m_parent->numberOfFrames()) reset();
+  else m_current_frame = frame;
 
-bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::operator+= (size_t frames) {
-  for (size_t i=0; i<frames; ++i) ++(*this);
   return *this;
 }
 
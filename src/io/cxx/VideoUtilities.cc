@@ -20,6 +20,7 @@
  */
 
 #include <set>
+#include <limits>
 #include <boost/token_iterator.hpp>
 #include <boost/format.hpp>
 
@@ -34,10 +35,22 @@ extern "C" {
 #include <libavutil/mathematics.h>
 }
 
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+
 #include <bob/io/VideoUtilities.h>
 #include <bob/core/logging.h>
 #include <bob/config.h>
 
+/**
+ * Opening and closing codecs is not thread-safe in ffmpeg: these calls are
+ * serialized, so that videos can be read or written by concurrent threads.
+ */
+static boost::mutex& codec_mutex() {
+  static boost::mutex mutex;
+  return mutex;
+}
+
 /**
  * Some code to account for older versions of ffmpeg
  */
@@ -667,7 +680,7 @@ boost::shared_ptr<AVStream> bob::io::detail::ffmpeg::make_stream(
     const std::string& codecname,
     size_t height, size_t width,
     float framerate, float bitrate, size_t gop,
-    AVCodec* codec) {
+    AVCodec* codec, size_t threads) {
 
 #if LIBAVFORMAT_VERSION_INT >= 0x351500 //53.21.0 @ ffmpeg-0.9
 
@@ -753,6 +766,15 @@ boost::shared_ptr<AVStream> bob::io::detail::ffmpeg::make_stream(
     retval->codec->flags |= CODEC_FLAG_GLOBAL_HEADER;
   }
 
+  /* Threaded encoding: FFmpeg uses frame threads if the codec supports them,
+   * slice threads otherwise. Codecs supporting neither ignore this. */
+  if (threads) {
+    retval->codec->thread_count = threads;
+#   ifdef FF_THREAD_FRAME
+    retval->codec->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#   endif
+  }
+
   return boost::shared_ptr<AVStream>(retval, std::ptr_fun(deallocate_stream));
 }
 
@@ -952,6 +974,7 @@ static void image_to_context(const blitz::Array<uint8_t,3>& data,
 }
 
 static void deallocate_codec_context(AVCodecContext* c) {
+  boost::lock_guard<boost::mutex> lock(codec_mutex());
   int ok = avcodec_close(c);
   if (ok < 0) {
     bob::core::warn << "bob::io::detail::ffmpeg::avcodec_close() failed: cannot close codec context to stop reading or writing video file (ffmpeg error " << ok << ")" << std::endl;
@@ -970,6 +993,7 @@ boost::shared_ptr<AVCodecContext> bob::io::detail::ffmpeg::make_codec_context(
 
 # if LIBAVCODEC_VERSION_INT < 0x347a00 //52.122.0 @ ffmpeg-0.7
 
+  boost::lock_guard<boost::mutex> lock(codec_mutex());
   int ok = avcodec_open(retval, codec);
   if (ok < 0) {
     boost::format m("bob::io::detail::ffmpeg::avcodec_open(codec=`%s'(0x%x) == `%s') failed: cannot open codec context to start reading or writing video file `%s' - ffmpeg reports error %d == `%s'");
@@ -980,6 +1004,7 @@ boost::shared_ptr<AVCodecContext> bob::io::detail::ffmpeg::make_codec_context(
 
 # else //fmpeg >= 0.7
 
+  boost::lock_guard<boost::mutex> lock(codec_mutex());
   int ok = avcodec_open2(retval, codec, 0);
   if (ok < 0) {
     boost::format m("bob::io::detail::ffmpeg::avcodec_open2(codec=`%s'(0x%x) == `%s') failed: cannot open codec context to start reading or writing video file `%s' - ffmpeg reports error %d == `%s'");
@@ -1187,11 +1212,31 @@ void bob::io::detail::ffmpeg::write_video_frame (const blitz::Array<uint8_t,3>&
     boost::shared_array<uint8_t> buffer,
     size_t buffer_size) {
 
+  convert_video_frame(data, stream, context_frame, tmp_frame, swscaler);
+  encode_video_frame(filename, format_context, stream, context_frame, buffer,
+      buffer_size);
+
+}
+
+void bob::io::detail::ffmpeg::convert_video_frame
+(const blitz::Array<uint8_t,3>& data, boost::shared_ptr<AVStream> stream,
+ boost::shared_ptr<AVFrame> context_frame, boost::shared_ptr<AVFrame> tmp_frame,
+ boost::shared_ptr<SwsContext> swscaler) {
+
   if (tmp_frame) 
     image_to_context(data, stream, swscaler, context_frame, tmp_frame);
   else 
     image_to_context(data, stream, swscaler, context_frame);
 
+}
+
+void bob::io::detail::ffmpeg::encode_video_frame (const std::string& filename,
+    boost::shared_ptr<AVFormatContext> format_context,
+    boost::shared_ptr<AVStream> stream,
+    boost::shared_ptr<AVFrame> context_frame,
+    boost::shared_array<uint8_t> buffer,
+    size_t buffer_size) {
+
   if (format_context->oformat->flags & AVFMT_RAWPICTURE) {
     
     /* Raw video case - directly store the picture in the packet */
@@ -1515,3 +1560,63 @@ bool bob::io::detail::ffmpeg::skip_video_frame (const std::string& filename,
 
   return true;
 }
+
+uint64_t bob::io::detail::ffmpeg::scan_video_packets
+(const std::string& filename, int stream_index,
+ boost::shared_ptr<AVFormatContext> format_context,
+ std::vector<uint64_t>& keyframes, std::vector<int64_t>& timestamps,
+ bool& ordered) {
+
+  boost::shared_ptr<AVPacket> pkt = make_packet();
+
+  int ok = 0;
+  uint64_t frames = 0;
+  int64_t last = std::numeric_limits<int64_t>::min();
+  ordered = true;
+
+  while ((ok = av_read_frame(format_context.get(), pkt.get())) >= 0) {
+    if (pkt->stream_index == stream_index) {
+      // packets are in decoding order: frames are reordered if the
+      // presentation timestamps decrease
+      int64_t pts = pkt->pts;
+      if (pts == (int64_t)AV_NOPTS_VALUE) pts = pkt->dts;
+      if (pts == (int64_t)AV_NOPTS_VALUE || pts < last) ordered = false;
+      else last = pts;
+      // seeking relies on the decoding timestamps, if they are available
+      int64_t timestamp = pkt->dts;
+      if (timestamp == (int64_t)AV_NOPTS_VALUE) timestamp = pkt->pts;
+      if (pkt->flags & AV_PKT_FLAG_KEY) {
+        keyframes.push_back(frames);
+        timestamps.push_back(timestamp);
+      }
+      ++frames;
+    }
+    av_free_packet(pkt.get());
+  }
+
+#if LIBAVCODEC_VERSION_INT >= 0x344802 //52.72.2 @ ffmpeg-0.6
+  if (ok < 0 && ok != (int)AVERROR_EOF) {
+    boost::format m("bob::io::detail::ffmpeg::av_read_frame() failed: on file `%s' - ffmpeg reports error %d == `%s'");
+    m % filename % ok % ffmpeg_error(ok);
+    throw std::runtime_error(m.str());
+  }
+#endif
+
+  // the packets of streams with B-frames are stored in decoding order
+  if (format_context->streams[stream_index]->codec->has_b_frames)
+    ordered = false;
+
+  return frames;
+}
+
+bool bob::io::detail::ffmpeg::seek_video_keyframe (int stream_index,
+    int64_t timestamp, boost::shared_ptr<AVFormatContext> format_context,
+    boost::shared_ptr<AVCodecContext> codec_context) {
+
+  if (av_seek_frame(format_context.get(), stream_index, timestamp,
+        AVSEEK_FLAG_BACKWARD) < 0) return false;
+
+  // drops the frames of the previous position buffered by the decoder
+  avcodec_flush_buffers(codec_context.get());
+  return true;
+}
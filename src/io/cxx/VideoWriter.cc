@@ -21,8 +21,11 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <boost/bind.hpp>
 #include <boost/format.hpp>
+#include <boost/make_shared.hpp>
 #include <boost/preprocessor.hpp>
+#include <bob/core/logging.h>
 #include <bob/io/VideoWriter.h>
 
 #if LIBAVFORMAT_VERSION_INT < 0x361764 /* 54.23.100 @ ffmpeg-0.11 */
@@ -35,6 +38,16 @@
 #define AV_PIX_FMT_RGB24 PIX_FMT_RGB24
 #endif
 
+/**
+ * A frame queued for asynchronous writing: a contiguous copy of the input
+ * and its conversion to the pixel format of the codec
+ */
+struct bob::io::VideoWriter::Slot {
+  blitz::Array<uint8_t,3> image;
+  boost::shared_ptr<AVFrame> frame;
+  bool converted;
+};
+
 bob::io::VideoWriter::VideoWriter(
     const std::string& filename,
     size_t height,
@@ -44,13 +57,15 @@ bob::io::VideoWriter::VideoWriter(
     size_t gop,
     const std::string& codec,
     const std::string& format,
-    bool check) :
+    bool check,
+    size_t threads,
+    size_t queue_size) :
   m_filename(filename),
   m_opened(false),
   m_format_context(bob::io::detail::ffmpeg::make_output_format_context(filename, format)),
   m_codec(bob::io::detail::ffmpeg::find_encoder(filename, m_format_context, codec)),
   m_stream(bob::io::detail::ffmpeg::make_stream(filename, m_format_context, codec, height,
-        width, framerate, bitrate, gop, m_codec)),
+        width, framerate, bitrate, gop, m_codec, threads)),
   m_codec_context(bob::io::detail::ffmpeg::make_codec_context(filename, m_stream.get(), m_codec)),
   m_context_frame(bob::io::detail::ffmpeg::make_frame(filename, m_codec_context, m_stream->codec->pix_fmt)),
 #if LIBAVCODEC_VERSION_INT >= 0x352a00 //53.42.0 @ ffmpeg-0.9
@@ -67,7 +82,12 @@ bob::io::VideoWriter::VideoWriter(
   m_gop(gop),
   m_codecname(codec),
   m_formatname(format),
-  m_current_frame(0)
+  m_current_frame(0),
+  m_threads(threads),
+  m_queued(0),
+  m_encoded(0),
+  m_error_raised(false),
+  m_stop(false)
 {
   //runs a codec/format check if the user asked so
   if (check) {
@@ -106,19 +126,31 @@ bob::io::VideoWriter::VideoWriter(
   //frame_rate = 1/time_base will be assumed].
   m_context_frame->pts = 0;
 
+  if (m_threads) start(queue_size ? queue_size : 2*m_threads);
+
   m_opened = true; ///< file is now considered opened for bussiness
 }
 
 bob::io::VideoWriter::~VideoWriter() {
-  close();
+  try {
+    close();
+  }
+  catch (std::exception& e) {
+    bob::core::warn << "error while closing video file `" << m_filename
+      << "': " << e.what() << std::endl;
+  }
 }
 
 void bob::io::VideoWriter::close() {
 
   if (!m_opened) return;
 
-  bob::io::detail::ffmpeg::flush_encoder(m_filename, m_format_context, m_stream, m_codec,
-      m_buffer, FFMPEG_VIDEO_BUFFER_SIZE);
+  // frames still queued are encoded before the encoder is flushed
+  boost::exception_ptr error = stop();
+
+  if (!m_error)
+    bob::io::detail::ffmpeg::flush_encoder(m_filename, m_format_context, m_stream, m_codec,
+        m_buffer, FFMPEG_VIDEO_BUFFER_SIZE);
   bob::io::detail::ffmpeg::close_output_file(m_filename, m_format_context);
 
   /* Destroyes resources in an orderly fashion */
@@ -129,8 +161,156 @@ void bob::io::VideoWriter::close() {
   m_swscaler.reset();
   m_stream.reset();
   m_format_context.reset();
+  m_slots.clear();
 
   m_opened = false; ///< file is now considered closed
+
+  if (error) boost::rethrow_exception(error);
+}
+
+void bob::io::VideoWriter::start(size_t queue_size) {
+  m_slots.reserve(queue_size);
+  for (size_t k=0; k<queue_size; ++k) {
+    boost::shared_ptr<Slot> slot = boost::make_shared<Slot>();
+    slot->image.resize(3, m_height, m_width);
+    slot->frame = bob::io::detail::ffmpeg::make_frame(m_filename,
+        m_codec_context, m_stream->codec->pix_fmt);
+    slot->converted = false;
+    m_slots.push_back(slot);
+  }
+
+  m_pool.create_thread(boost::bind(&VideoWriter::encode_frames, this));
+  for (size_t k=0; k<m_threads; ++k)
+    m_pool.create_thread(boost::bind(&VideoWriter::convert_frames, this));
+}
+
+boost::exception_ptr bob::io::VideoWriter::stop() {
+  if (m_slots.empty()) return boost::exception_ptr();
+
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    while (!m_error && m_encoded < m_queued) m_cond.wait(lock);
+    m_stop = true;
+    m_cond.notify_all();
+  }
+  m_pool.join_all();
+
+  if (m_error_raised) return boost::exception_ptr();
+  return m_error;
+}
+
+void bob::io::VideoWriter::convert_frames() {
+  try {
+    // the scalers (and their buffers) cannot be shared between threads
+#if LIBAVCODEC_VERSION_INT >= 0x352a00 //53.42.0 @ ffmpeg-0.9
+    boost::shared_ptr<AVFrame> tmp_frame;
+    boost::shared_ptr<SwsContext> swscaler =
+      bob::io::detail::ffmpeg::make_scaler(m_filename, m_codec_context,
+          PIX_FMT_GBRP, m_stream->codec->pix_fmt);
+#else
+    boost::shared_ptr<AVFrame> tmp_frame =
+      bob::io::detail::ffmpeg::make_frame(m_filename, m_codec_context,
+          AV_PIX_FMT_RGB24);
+    boost::shared_ptr<SwsContext> swscaler =
+      bob::io::detail::ffmpeg::make_scaler(m_filename, m_codec_context,
+          AV_PIX_FMT_RGB24, m_stream->codec->pix_fmt);
+#endif
+
+    while (true) {
+      size_t index;
+      {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        while (!m_stop && !m_error && m_to_convert.empty()) m_cond.wait(lock);
+        if (m_error || m_to_convert.empty()) return;
+        index = m_to_convert.front();
+        m_to_convert.pop_front();
+      }
+
+      Slot& slot = *m_slots[index % m_slots.size()];
+      bob::io::detail::ffmpeg::convert_video_frame(slot.image, m_stream,
+          slot.frame, tmp_frame, swscaler);
+
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      slot.converted = true;
+      m_cond.notify_all();
+    }
+  }
+  catch (...) {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    if (!m_error) m_error = boost::current_exception();
+    m_cond.notify_all();
+  }
+}
+
+void bob::io::VideoWriter::encode_frames() {
+  try {
+    while (true) {
+      Slot* slot = 0;
+      {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        while (!m_error) {
+          if (m_encoded < m_queued) {
+            slot = m_slots[m_encoded % m_slots.size()].get();
+            if (slot->converted) break;
+          }
+          else if (m_stop) break;
+          m_cond.wait(lock);
+        }
+        if (m_error || m_encoded == m_queued) return;
+      }
+
+      // m_context_frame only keeps the timestamp of the next frame
+      slot->frame->pts = m_context_frame->pts;
+      bob::io::detail::ffmpeg::encode_video_frame(m_filename,
+          m_format_context, m_stream, slot->frame, m_buffer,
+          FFMPEG_VIDEO_BUFFER_SIZE);
+      m_context_frame->pts = slot->frame->pts;
+
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      slot->converted = false;
+      ++m_encoded;
+      m_cond.notify_all();
+    }
+  }
+  catch (...) {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    if (!m_error) m_error = boost::current_exception();
+    m_cond.notify_all();
+  }
+}
+
+void bob::io::VideoWriter::write(const blitz::Array<uint8_t,3>& data) {
+  if (m_slots.empty()) {
+    bob::io::detail::ffmpeg::write_video_frame(data, m_filename, m_format_context,
+        m_stream, m_context_frame, m_rgb24_frame, m_swscaler, m_buffer,
+        FFMPEG_VIDEO_BUFFER_SIZE);
+  }
+
+  else {
+    // back-pressure: waits for a free slot in the queue
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    while (!m_error && m_queued - m_encoded >= m_slots.size())
+      m_cond.wait(lock);
+    if (m_error) {
+      m_error_raised = true;
+      boost::exception_ptr error = m_error;
+      lock.unlock();
+      boost::rethrow_exception(error);
+    }
+    const size_t index = m_queued;
+    lock.unlock();
+
+    // the slot is not used by the threads until it is queued
+    m_slots[index % m_slots.size()]->image = data;
+
+    lock.lock();
+    m_to_convert.push_back(index);
+    ++m_queued;
+    m_cond.notify_all();
+  }
+
+  ++m_current_frame;
+  m_typeinfo_video.shape[0] += 1;
 }
 
 std::string bob::io::VideoWriter::info() const {
@@ -174,11 +354,7 @@ void bob::io::VideoWriter::append(const blitz::Array<uint8_t,4>& data) {
 
   blitz::Range a = blitz::Range::all();
   for(int i=data.lbound(0); i<(data.extent(0)+data.lbound(0)); ++i) {
-    bob::io::detail::ffmpeg::write_video_frame(data(i, a, a, a), m_filename, m_format_context,
-        m_stream, m_context_frame, m_rgb24_frame, m_swscaler, m_buffer,
-        FFMPEG_VIDEO_BUFFER_SIZE);
-    ++m_current_frame;
-    m_typeinfo_video.shape[0] += 1;
+    write(data(i, a, a, a));
   }
 }
 
@@ -198,11 +374,7 @@ void bob::io::VideoWriter::append(const blitz::Array<uint8_t,3>& data) {
     throw std::runtime_error(m.str());
   }
 
-  bob::io::detail::ffmpeg::write_video_frame(data, m_filename, m_format_context,
-      m_stream, m_context_frame, m_rgb24_frame, m_swscaler, m_buffer,
-      FFMPEG_VIDEO_BUFFER_SIZE);
-  ++m_current_frame;
-  m_typeinfo_video.shape[0] += 1;
+  write(data);
 }
 
 void bob::io::VideoWriter::append(const bob::core::array::interface& data) {
@@ -234,11 +406,7 @@ void bob::io::VideoWriter::append(const bob::core::array::interface& data) {
     shape = 3, m_height, m_width;
     blitz::Array<uint8_t,3> tmp(const_cast<uint8_t*>(static_cast<const uint8_t*>(data.ptr())), shape,
         blitz::neverDeleteData);
-    bob::io::detail::ffmpeg::write_video_frame(tmp, m_filename, m_format_context,
-        m_stream, m_context_frame, m_rgb24_frame, m_swscaler, m_buffer,
-        FFMPEG_VIDEO_BUFFER_SIZE);
-    ++m_current_frame;
-    m_typeinfo_video.shape[0] += 1;
+    write(tmp);
   }
   
   else if ( type.nd == 4 ) { //appends a sequence of frames
@@ -258,11 +426,7 @@ void bob::io::VideoWriter::append(const bob::core::array::interface& data) {
 
     for(size_t i=0; i<type.shape[0]; ++i) {
       blitz::Array<uint8_t,3> tmp(ptr, shape, blitz::neverDeleteData);
-      bob::io::detail::ffmpeg::write_video_frame(tmp, m_filename, m_format_context,
-          m_stream, m_context_frame, m_rgb24_frame, m_swscaler, m_buffer,
-          FFMPEG_VIDEO_BUFFER_SIZE);
-      ++m_current_frame;
-      m_typeinfo_video.shape[0] += 1;
+      write(tmp);
       ptr += frame_size;
     }
   }
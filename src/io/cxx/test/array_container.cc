@@ -0,0 +1,150 @@
+/**
+ * @file io/cxx/test/array_container.cc
+ * @date Mon Oct 19 23:12:48 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Tests of the memory-mapped array container
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ArrayContainer Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <blitz/array.h>
+#include "bob/core/logging.h"
+#include "bob/io/utils.h"
+#include "bob/io/ArrayContainer.h"
+
+struct T {
+  blitz::Array<double,2> a;
+  blitz::Array<int32_t,3> b;
+
+  T() {
+    a.resize(3,5);
+    for (int i=0; i<3; ++i)
+      for (int j=0; j<5; ++j) a(i,j) = 0.5 * i - j;
+    b.resize(2,3,7);
+    for (int i=0; i<2; ++i)
+      for (int j=0; j<3; ++j)
+        for (int k=0; k<7; ++k) b(i,j,k) = 100 * i - 10 * j + k;
+  }
+
+  ~T() { }
+
+};
+
+template<typename T, int N>
+void check_equal(const blitz::Array<T,N>& a, const blitz::Array<T,N>& b)
+{
+  for (int d=0; d<N; ++d) BOOST_REQUIRE_EQUAL(a.extent(d), b.extent(d));
+  BOOST_CHECK(blitz::all(a == b));
+}
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( container_heterogeneous )
+{
+  std::string filename = bob::core::tmpfile(".arrays");
+  {
+    bob::io::ArrayContainer c(filename, 'w');
+    BOOST_CHECK_EQUAL(c.append(a), 0);
+    BOOST_CHECK_EQUAL(c.append(b), 1);
+    BOOST_CHECK_EQUAL(c.append(a), 2);
+  }
+
+  bob::io::ArrayContainer c(filename);
+  BOOST_REQUIRE_EQUAL(c.size(), 3);
+  check_equal(c.read<double,2>(0), a);
+  check_equal(c.read<int32_t,3>(1), b);
+
+  // views refer to the mapping
+  blitz::Array<int32_t,3> v = c.view<int32_t,3>(1);
+  check_equal(v, b);
+  boost::shared_ptr<bob::core::array::interface> view = c.view(2);
+  BOOST_CHECK(view->type().is_compatible(bob::core::array::blitz_array(a).type()));
+  BOOST_CHECK_EQUAL(reinterpret_cast<size_t>(view->ptr()) % 64, 0);
+
+  // containers opened for reading cannot be appended to
+  BOOST_CHECK_THROW(c.append(a), std::runtime_error);
+  BOOST_CHECK_THROW(c.type(3), std::runtime_error);
+
+  // arrays appended by another writer are seen after a refresh
+  {
+    bob::io::ArrayContainer w(filename, 'a');
+    w.append(b);
+  }
+  BOOST_CHECK_EQUAL(c.size(), 3);
+  BOOST_CHECK_EQUAL(c.refresh(), 4);
+  check_equal(c.read<int32_t,3>(3), b);
+  // views taken before the refresh are still valid
+  check_equal(bob::core::array::wrap<double,2>(*view), a);
+
+  boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE( container_read_while_appending )
+{
+  // arrays appended to an open container are mapped when they are first read
+  std::string filename = bob::core::tmpfile(".arrays");
+  bob::io::ArrayContainer c(filename, 'w');
+  for (int k=0; k<20; ++k) {
+    blitz::Array<double,2> x(a * (double)k);
+    BOOST_CHECK_EQUAL(c.append(x), (size_t)k);
+    if (k % 7 == 0) check_equal(c.read<double,2>(k), x);
+  }
+  BOOST_CHECK_EQUAL(c.size(), 20);
+  blitz::Array<double,2> x(a * 19.);
+  check_equal(c.read<double,2>(19), x);
+  x = a * 18.;
+  check_equal(c.view<double,2>(18), x);
+
+  boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE( container_codec )
+{
+  // homogeneous containers are read at once through bob::io::File
+  std::string filename = bob::core::tmpfile(".arrays");
+  std::string tensor = bob::core::tmpfile(".tensor");
+  {
+    boost::shared_ptr<bob::io::File> f = bob::io::open(tensor, 'w');
+    for (int k=0; k<4; ++k) f->append(bob::core::array::blitz_array(a));
+  }
+  {
+    bob::io::ArrayContainer c(filename, 'w');
+    boost::shared_ptr<bob::io::File> f = bob::io::open(tensor, 'r');
+    BOOST_CHECK_EQUAL(c.extend(*f), 4);
+    BOOST_CHECK_EQUAL(c.size(), 4);
+  }
+
+  boost::shared_ptr<bob::io::File> f = bob::io::open(filename, 'r');
+  BOOST_CHECK_EQUAL(f->size(), 4);
+  BOOST_CHECK_EQUAL(f->type_all().nd, 3);
+  BOOST_CHECK_EQUAL(f->type_all().shape[0], 4);
+  blitz::Array<double,3> all = f->read_all<double,3>();
+  for (int k=0; k<4; ++k)
+    check_equal(blitz::Array<double,2>(all(k, blitz::Range::all(), blitz::Range::all())), a);
+  check_equal(f->read<double,2>(3), a);
+
+  boost::filesystem::remove(filename);
+  boost::filesystem::remove(tensor);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
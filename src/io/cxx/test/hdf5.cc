@@ -34,6 +34,7 @@
 #include "bob/core/logging.h" // for bob::core::tmpdir()
 #include "bob/core/cast.h"
 #include "bob/io/HDF5File.h"
+#include "bob/io/HDF5Appender.h"
 
 struct T {
   blitz::Array<double,2> a;
@@ -146,4 +147,41 @@ BOOST_AUTO_TEST_CASE( hdf5_write_on_readonly )
   boost::filesystem::remove(filename);
 }
 
+BOOST_AUTO_TEST_CASE( hdf5_append_blocks )
+{
+  // Appends the rows of a 2D array and some scalars in blocks
+  const std::string filename = bob::core::tmpfile();
+  bob::io::HDF5File config(filename, bob::io::HDF5File::trunc);
+  blitz::Array<double,2> at = a.transpose(1,0); //not contiguous
+  {
+    bob::io::HDF5Appender rows(config, "rows", 3, 1);
+    bob::io::HDF5Appender values(config, "values", 2);
+    for (int k=0; k<4; ++k) {
+      rows.appendArray(a(k, blitz::Range::all()));
+      values.append(c(k));
+    }
+    values.flush();
+    rows.flush(); //the file is not used while blocks are written
+    BOOST_CHECK_EQUAL(config.describe("values")[0].size, 4);
+    values.append(c(4));
+    for (int k=0; k<2; ++k) rows.appendArray(at(k, blitz::Range::all()));
+    BOOST_CHECK_EQUAL(rows.size(), 6);
+
+    // entries of a different type are refused
+    BOOST_CHECK_THROW(rows.appendArray(c), std::runtime_error);
+  } //written when the appenders are destroyed
+
+  BOOST_REQUIRE_EQUAL(config.describe("rows")[0].size, 6);
+  for (int k=0; k<4; ++k)
+    check_equal(blitz::Array<double,1>(a(k, blitz::Range::all())),
+        config.readArray<double,1>("rows", k));
+  for (int k=0; k<2; ++k)
+    check_equal(blitz::Array<double,1>(at(k, blitz::Range::all())),
+        config.readArray<double,1>("rows", k+4));
+  check_equal(c, config.readArray<double,1>("values"));
+
+  // Clean-up
+  boost::filesystem::remove(filename);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
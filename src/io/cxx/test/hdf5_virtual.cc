@@ -0,0 +1,171 @@
+/**
+ * @file io/cxx/test/hdf5_virtual.cc
+ * @date Mon Oct 19 17:41:05 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Tests of the view of many HDF5 files as a single array
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE HDF5VirtualDataset Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <blitz/array.h>
+#include "bob/core/logging.h"
+#include "bob/io/HDF5File.h"
+#include "bob/io/HDF5VirtualDataset.h"
+
+/**
+ * Three files of 3, 1 and 3 rows of 5 values (row r of the view is filled
+ * with r), in a sub-group of each file
+ */
+struct T {
+  std::vector<std::string> filenames;
+
+  T() {
+    const int rows[] = {3, 1, 3};
+    int row = 0;
+    for (int f=0; f<3; ++f) {
+      filenames.push_back(bob::core::tmpfile(".hdf5"));
+      bob::io::HDF5File file(filenames.back(), bob::io::HDF5File::trunc);
+      file.createGroup("/data");
+      file.cd("/data");
+      file.set("other", 1.5); //not part of the view
+      blitz::Array<double,1> a(5);
+      for (int i=0; i<rows[f]; ++i, ++row) {
+        a = row;
+        file.appendArray("features", a);
+      }
+    }
+  }
+
+  ~T() {
+    for (size_t k=0; k<filenames.size(); ++k)
+      boost::filesystem::remove(filenames[k]);
+  }
+
+};
+
+static void check_rows(const blitz::Array<double,2>& a,
+    const std::vector<size_t>& rows) {
+  BOOST_REQUIRE_EQUAL(a.extent(0), (int)rows.size());
+  BOOST_REQUIRE_EQUAL(a.extent(1), 5);
+  for (int i=0; i<a.extent(0); ++i)
+    for (int j=0; j<5; ++j) BOOST_CHECK_EQUAL(a(i,j), rows[i]);
+}
+
+static std::vector<size_t> range(size_t start, size_t count) {
+  std::vector<size_t> retval;
+  for (size_t k=start; k<start+count; ++k) retval.push_back(k);
+  return retval;
+}
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( virtual_read )
+{
+  bob::io::HDF5VirtualDataset v(filenames, "/data/features", 2, 2);
+  BOOST_CHECK_EQUAL(v.size(), 7);
+  BOOST_CHECK_EQUAL(v.size(1), 1);
+  BOOST_CHECK_EQUAL(v.offset(2), 4);
+  BOOST_CHECK_EQUAL(v.file(2), 0);
+  BOOST_CHECK_EQUAL(v.file(3), 1);
+  BOOST_CHECK_EQUAL(v.file(4), 2);
+  BOOST_CHECK_EQUAL(v.type().nd, 1);
+  BOOST_CHECK_EQUAL(v.type().shape[0], 5);
+  BOOST_CHECK_EQUAL(v.type_all().shape[0], 7);
+
+  blitz::Array<double,1> row = v.read<double,1>(4);
+  BOOST_CHECK(blitz::all(row == 4.));
+  check_rows(v.read<double,2>(0, 7), range(0, 7));
+  check_rows(v.read<double,2>(2, 3), range(2, 3));
+
+  std::vector<size_t> rows;
+  rows.push_back(6); rows.push_back(0); rows.push_back(1); rows.push_back(5);
+  check_rows(v.read<double,2>(rows), rows);
+
+  // at most 2 files are kept open
+  BOOST_CHECK(v.getOpen() <= 2);
+  v.setMaxOpen(1);
+  BOOST_CHECK(v.getOpen() <= 1);
+
+  BOOST_CHECK_THROW(v.read<double,1>(7), std::runtime_error);
+  BOOST_CHECK_THROW(v.read<double,2>(5, 3), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( virtual_index )
+{
+  std::string index = bob::core::tmpfile(".hdf5");
+  {
+    bob::io::HDF5VirtualDataset v(filenames, "/data/features");
+    bob::io::HDF5File f(index, bob::io::HDF5File::trunc);
+    v.save(f);
+  }
+
+  bob::io::HDF5File f(index, bob::io::HDF5File::in);
+  bob::io::HDF5VirtualDataset v(f);
+  BOOST_CHECK(v.getFilenames() == filenames);
+  BOOST_CHECK_EQUAL(v.getPath(), "/data/features");
+  BOOST_CHECK_EQUAL(v.size(), 7);
+  BOOST_CHECK_EQUAL(v.getOpen(), 0);
+  check_rows(v.read<double,2>(0, 7), range(0, 7));
+
+  boost::filesystem::remove(index);
+}
+
+BOOST_AUTO_TEST_CASE( virtual_prefetch )
+{
+  bob::io::HDF5VirtualDataset v(filenames, "/data/features");
+
+  v.start(3);
+  for (size_t b=0; b<3; ++b) {
+    boost::shared_ptr<bob::core::array::blitz_array> batch = v.next();
+    BOOST_REQUIRE(batch);
+    check_rows(batch->get<double,2>(), range(3*b, std::min<size_t>(3, 7-3*b)));
+  }
+  BOOST_CHECK(!v.next());
+
+  std::vector<size_t> rows;
+  rows.push_back(5); rows.push_back(2); rows.push_back(3);
+  v.start(2, 1, rows);
+  check_rows(v.next()->get<double,2>(), std::vector<size_t>(rows.begin(), rows.begin()+2));
+  check_rows(v.next()->get<double,2>(), std::vector<size_t>(rows.begin()+2, rows.end()));
+  BOOST_CHECK(!v.next());
+}
+
+BOOST_AUTO_TEST_CASE( virtual_incompatible )
+{
+  std::string other = bob::core::tmpfile(".hdf5");
+  {
+    bob::io::HDF5File f(other, bob::io::HDF5File::trunc);
+    f.createGroup("/data");
+    f.cd("/data");
+    f.appendArray("features", blitz::Array<double,1>(4));
+  }
+  std::vector<std::string> files(filenames);
+  files.push_back(other);
+  BOOST_CHECK_THROW(bob::io::HDF5VirtualDataset(files, "/data/features"),
+      std::runtime_error);
+  BOOST_CHECK_THROW(bob::io::HDF5VirtualDataset(filenames, "/data/other"),
+      std::runtime_error);
+  boost::filesystem::remove(other);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
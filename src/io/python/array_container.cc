@@ -0,0 +1,70 @@
+/**
+ * @file io/python/array_container.cc
+ * @date Mon Oct 19 23:12:48 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Bindings for the memory-mapped array container
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/python.hpp>
+#include <boost/make_shared.hpp>
+#include <bob/io/ArrayContainer.h>
+
+#include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
+
+using namespace boost::python;
+
+static boost::shared_ptr<bob::io::ArrayContainer> container_init(const
+    std::string& filename, const std::string& mode) {
+  return boost::make_shared<bob::io::ArrayContainer>(filename, mode[0]);
+}
+
+static object container_read(const bob::io::ArrayContainer& c, size_t index) {
+  bob::python::py_array a(c.view(index));
+  return a.pyobject(); //read-only, refers to the mapping
+}
+
+static object container_getitem(const bob::io::ArrayContainer& c, int index) {
+  if (index < 0) index += c.size();
+  if (index < 0 || (size_t)index >= c.size()) {
+    PYTHON_ERROR(IndexError, "array container index out of range");
+  }
+  return container_read(c, index);
+}
+
+static size_t container_append(bob::io::ArrayContainer& c, object array) {
+  bob::python::py_array a(array, object());
+  bob::python::no_gil unlock;
+  return c.append(a);
+}
+
+void bind_io_array_container() {
+
+  class_<bob::io::ArrayContainer, boost::shared_ptr<bob::io::ArrayContainer>, boost::noncopyable>("ArrayContainer", "An append-only file of arrays of any type and shape (e.g. the features of a whole database), that is memory-mapped for reading: arrays are read without being copied. Other processes see the arrays appended to an open container once they call refresh(). Containers are also read and written by bob.io.File, with the extension '.arrays'.", no_init)
+    .def("__init__", make_constructor(&container_init, default_call_policies(), (arg("filename"), arg("mode")="r")), "Opens a container for reading ('r'), creates it, truncating existing files ('w'), or opens it for appending arrays, creating it if needed ('a')")
+    .add_property("filename", make_function(&bob::io::ArrayContainer::getFilename, return_value_policy<copy_const_reference>()), "The path to the file")
+    .def("__len__", &bob::io::ArrayContainer::size, (arg("self")), "The number of arrays in the container")
+    .def("type", &bob::io::ArrayContainer::type, return_value_policy<copy_const_reference>(), (arg("self"), arg("index")), "Typing information of an array")
+    .def("read", &container_read, (arg("self"), arg("index")), "Returns a read-only NumPy ndarray that refers to the memory of an array in the mapping, without copying it. The mapping lives as long as the returned array.")
+    .def("__getitem__", &container_getitem, (arg("self"), arg("index")), "Same as read()")
+    .def("append", &container_append, (arg("self"), arg("array")), "Appends an array at the end of the container and returns its index")
+    .def("extend", &bob::io::ArrayContainer::extend, (arg("self"), arg("file")), "Appends all arrays of a bob.io.File (e.g. an HDF5 or tensor file) at the end of the container and returns the number of arrays appended")
+    .def("refresh", &bob::io::ArrayContainer::refresh, (arg("self")), "Maps the file again, to see the arrays appended by other processes since it was opened, and returns the number of arrays")
+    ;
+
+}
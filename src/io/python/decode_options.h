@@ -0,0 +1,38 @@
+/**
+ * @file io/python/decode_options.h
+ * @date Mon Oct 19 23:41:02 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Conversion of the Python arguments of the image decoding options,
+ * shared by the bindings of bob::io::File and bob::io::ImageListLoader
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_IO_PYTHON_DECODE_OPTIONS_H
+#define BOB_IO_PYTHON_DECODE_OPTIONS_H
+
+#include <boost/python.hpp>
+#include <bob/io/File.h>
+
+/**
+ * Builds the decoding options from the scale denominator, the gray flag and
+ * the region of interest, given as None or a tuple (y, x, height, width).
+ * Raises a TypeError if the region of interest has not 4 elements.
+ */
+bob::io::DecodeOptions make_decode_options(size_t scale_denom, bool gray,
+    boost::python::object roi);
+
+#endif /* BOB_IO_PYTHON_DECODE_OPTIONS_H */
@@ -21,23 +21,46 @@
  */
 
 #include <boost/python.hpp>
+#include <hdf5.h>
 #include <bob/io/CodecRegistry.h>
 #include <bob/io/File.h>
 #include <bob/io/utils.h>
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
+
+#include "decode_options.h"
 
 using namespace boost::python;
 
+/**
+ * Tells if the GIL can be released while the file is read or written. This is
+ * the case of all codecs, except the ones based on HDF5 (if the HDF5 library
+ * does not serialize its calls itself).
+ */
+static bool releases_gil(const bob::io::File& f) {
+#ifdef H5_HAVE_THREADSAFE
+  return true;
+#else
+  return f.name() != "bob.hdf5" && f.name() != "bob.matlab";
+#endif
+}
+
 static object file_read_all(bob::io::File& f) {
   bob::python::py_array a(f.type_all());
-  f.read_all(a);
+  {
+    bob::python::no_gil unlock(releases_gil(f));
+    f.read_all(a);
+  }
   return a.pyobject(); //shallow copy
 }
 
 static object file_read(bob::io::File& f, size_t index) {
-  bob::python::py_array a(f.type_all());
-  f.read(a, index);
+  bob::python::py_array a(f.type());
+  {
+    bob::python::no_gil unlock(releases_gil(f));
+    f.read(a, index);
+  }
   return a.pyobject(); //shallow copy
 }
 
@@ -53,14 +76,38 @@ static boost::shared_ptr<bob::io::File> string_open2 (const std::string& filenam
 
 static void file_write(bob::io::File& f, object array) {
   bob::python::py_array a(array, object());
+  bob::python::no_gil unlock(releases_gil(f));
   f.write(a);
 }
 
 static void file_append(bob::io::File& f, object array) {
   bob::python::py_array a(array, object());
+  bob::python::no_gil unlock(releases_gil(f));
   f.append(a);
 }
 
+bob::io::DecodeOptions make_decode_options(size_t scale_denom, bool gray,
+    object roi) {
+  bob::io::DecodeOptions options;
+  options.scale_denom = scale_denom;
+  options.gray = gray;
+  if (!roi.is_none()) {
+    if (len(roi) != 4) {
+      PYTHON_ERROR(TypeError, "the region of interest should be given as a tuple (y, x, height, width), not a sequence of length %ld", (long)len(roi));
+    }
+    options.roi_y = extract<size_t>(roi[0]);
+    options.roi_x = extract<size_t>(roi[1]);
+    options.roi_height = extract<size_t>(roi[2]);
+    options.roi_width = extract<size_t>(roi[3]);
+  }
+  return options;
+}
+
+static void file_set_decode_options(bob::io::File& f, size_t scale_denom,
+    bool gray, object roi) {
+  f.setDecodeOptions(make_decode_options(scale_denom, gray, roi));
+}
+
 static dict extensions() {
   typedef std::map<std::string, std::string> map_type;
   dict retval;
@@ -86,6 +133,7 @@ void bind_io_file() {
     .def("read", &file_read, (arg("self"), arg("index")), "Reads a single array from the file considering it to be an arrayset list")
     .def("__getitem__", &file_read, (arg("self"), arg("index")), "Reads a single array from the file considering it to be an arrayset list")
     .def("append", &file_append, (arg("self"), arg("array")), "Appends an array to a file. Compatibility requirements may be enforced.")
+    .def("set_decode_options", &file_set_decode_options, (arg("self"), arg("scale_denom")=1, arg("gray")=false, arg("roi")=object()), "Sets how the image of this file is decoded, changing its type accordingly (only supported by the JPEG and PNG codecs). The image is decoded at 1/scale_denom of its size (1, 2, 4 or 8 for JPEG images, which are scaled while decoding; PNG images are averaged over blocks of scale_denom x scale_denom pixels), as a single gray plane if gray is set, and only the region of interest roi = (y, x, height, width) of the scaled image is decoded, if given. A height or width of 0 extends the region to the bottom or right border of the image.")
     ;
 
   def("extensions", &extensions, "Returns a dictionary containing all extensions and descriptions currently stored on the global codec registry");
@@ -26,11 +26,23 @@
 
 #include <bob/python/exception.h>
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 
 #include <bob/io/HDF5File.h>
+#include <bob/io/HDF5Appender.h>
 
 using namespace boost::python;
 
+/**
+ * The GIL is released while arrays are transferred, if the HDF5 library
+ * serializes its calls itself (i.e., if it was built thread-safe)
+ */
+#ifdef H5_HAVE_THREADSAFE
+static const bool RELEASE_GIL = true;
+#else
+static const bool RELEASE_GIL = false;
+#endif
+
 /**
  * Allows us to write HDF5File("filename.hdf5", "r")
  */
@@ -136,7 +148,10 @@ static object hdf5file_xread(bob::io::HDF5File& f, const std::string& p,
   bob::core::array::typeinfo atype;
   type.copy_to(atype);
   bob::python::py_array retval(atype);
-  f.read_buffer(p, pos, atype, retval.ptr());
+  {
+    bob::python::no_gil unlock(RELEASE_GIL);
+    f.read_buffer(p, pos, atype, retval.ptr());
+  }
   return retval.pyobject();
 }
 
@@ -309,6 +324,7 @@ static void inner_replace(bob::io::HDF5File& f, const std::string& path,
 
   else { //write as an numpy array
     bob::python::py_array tmp(obj, object());
+    bob::python::no_gil unlock(RELEASE_GIL);
     f.write_buffer(path, pos, tmp.type(), tmp.ptr());
   }
 }
@@ -374,6 +390,7 @@ static void inner_append(bob::io::HDF5File& f, const std::string& path,
   else { //write as an numpy array
     bob::python::py_array tmp(obj, object());
     if (!f.contains(path)) f.create(path, tmp.type(), true, compression);
+    bob::python::no_gil unlock(RELEASE_GIL);
     f.extend_buffer(path, tmp.type(), tmp.ptr());
   }
 }
@@ -457,6 +474,7 @@ static void inner_set(bob::io::HDF5File& f, const std::string& path,
   else { //write as an numpy array
     bob::python::py_array tmp(obj, object());
     if (!f.contains(path)) f.create(path, tmp.type(), false, compression);
+    bob::python::no_gil unlock(RELEASE_GIL);
     f.write_buffer(path, 0, tmp.type(), tmp.ptr());
   }
 }
@@ -687,6 +705,89 @@ static void hdf5file_del_attributes(bob::io::HDF5File& f, const std::string& pat
 
 BOOST_PYTHON_FUNCTION_OVERLOADS(hdf5file_del_attributes_overloads, hdf5file_del_attributes, 1, 2)
 
+template <typename T>
+static void inner_appender_scalar(bob::io::HDF5Appender& a, object obj) {
+  T value = extract<T>(obj);
+  bob::python::no_gil unlock(RELEASE_GIL); //may write a block
+  a.append(value);
+}
+
+static void hdf5appender_append(bob::io::HDF5Appender& a, object obj) {
+  bob::io::HDF5Type type;
+  bool scalar = get_object_type(obj, type);
+
+  if (scalar) {
+    switch(type.type()) {
+      case bob::io::b:
+        return inner_appender_scalar<bool>(a, obj);
+      case bob::io::i8:
+        return inner_appender_scalar<int8_t>(a, obj);
+      case bob::io::i16:
+        return inner_appender_scalar<int16_t>(a, obj);
+      case bob::io::i32:
+        return inner_appender_scalar<int32_t>(a, obj);
+      case bob::io::i64:
+        return inner_appender_scalar<int64_t>(a, obj);
+      case bob::io::u8:
+        return inner_appender_scalar<uint8_t>(a, obj);
+      case bob::io::u16:
+        return inner_appender_scalar<uint16_t>(a, obj);
+      case bob::io::u32:
+        return inner_appender_scalar<uint32_t>(a, obj);
+      case bob::io::u64:
+        return inner_appender_scalar<uint64_t>(a, obj);
+      case bob::io::f32:
+        return inner_appender_scalar<float>(a, obj);
+      case bob::io::f64:
+        return inner_appender_scalar<double>(a, obj);
+      case bob::io::f128:
+        return inner_appender_scalar<long double>(a, obj);
+      case bob::io::c64:
+        return inner_appender_scalar<std::complex<float> >(a, obj);
+      case bob::io::c128:
+        return inner_appender_scalar<std::complex<double> >(a, obj);
+      case bob::io::c256:
+        return inner_appender_scalar<std::complex<long double> >(a, obj);
+      default:
+        PYTHON_ERROR(TypeError, "only numbers and arrays of numbers can be appended with an HDF5Appender, not `%s'", type.str().c_str());
+    }
+  }
+
+  bob::python::py_array tmp(obj, object());
+  bob::python::no_gil unlock(RELEASE_GIL); //may write a block
+  a.appendArray(tmp);
+}
+
+static void hdf5appender_append_iterable(bob::io::HDF5Appender& a,
+    object iterable) {
+  for (int k=0; k<len(iterable); ++k) hdf5appender_append(a, iterable[k]);
+}
+
+static void hdf5appender_flush(bob::io::HDF5Appender& a) {
+  bob::python::no_gil unlock(RELEASE_GIL);
+  a.flush();
+}
+
+static boost::shared_ptr<bob::io::HDF5Appender> hdf5appender_init
+(const bob::io::HDF5File& f, const std::string& path, size_t block_size,
+ size_t queue_size, size_t compression) {
+  return boost::make_shared<bob::io::HDF5Appender>(f, path, block_size,
+      queue_size, compression);
+}
+
+static void bind_io_hdf5_appender() {
+  class_<bob::io::HDF5Appender, boost::shared_ptr<bob::io::HDF5Appender>, boost::noncopyable>("HDF5Appender", "Appends scalars or arrays to a dataset of an HDF5File, as HDF5File.append() does, but in blocks: the entries are copied into a block of block_size entries and, once it is full, the dataset is extended and the block is written at once. If the HDF5 library is thread-safe, full blocks are written by a background thread, at most queue_size of them waiting to be written. flush() writes the entries appended so far; this is also done when the appender is deleted. The file should not be used until flush() returns.", no_init)
+    .def("__init__", make_constructor(&hdf5appender_init, default_call_policies(), (arg("file"), arg("path"), arg("block_size")=1024, arg("queue_size")=2, arg("compression")=0)), "Appends to the dataset at the given path of the HDF5File (relative to its current directory), which is created on the first append if it does not exist. The compression level (0 to 9) is only used if the dataset is created.")
+    .add_property("path", make_function(&bob::io::HDF5Appender::getPath, return_value_policy<copy_const_reference>()), "The path of the dataset, relative to the current directory of the file when the appender was created")
+    .add_property("block_size", &bob::io::HDF5Appender::getBlockSize, "The number of entries written at once")
+    .add_property("queue_size", &bob::io::HDF5Appender::getQueueSize, "The maximum number of full blocks waiting to be written")
+    .def("__len__", &bob::io::HDF5Appender::size, (arg("self")), "The number of entries appended so far")
+    .def("append", &hdf5appender_append, (arg("self"), arg("data")), "Appends a scalar (a simple python or numpy scalar) or a numpy.ndarray to the dataset. All entries must be of the same type.")
+    .def("extend", &hdf5appender_append_iterable, (arg("self"), arg("data")), "Appends each of the scalars or arrays of the given sequence")
+    .def("flush", &hdf5appender_flush, (arg("self")), "Writes the entries appended so far and waits for them to be written. Errors raised while writing are raised here, or by the next append that fills a block.")
+    ;
+}
+
 void bind_io_hdf5() {
   class_<bob::io::HDF5File, boost::shared_ptr<bob::io::HDF5File> >("HDF5File", "A HDF5File allows users to read and write data from and to files containing standard bob binary coded data in HDF5 format. For an introduction to HDF5, please visit http://www.hdfgroup.org/HDF5.", no_init)
     .def(boost::python::init<const bob::io::HDF5File&>(boost::python::args("other"), "Generates a shallow copy of the already opened file."))
@@ -739,4 +840,6 @@ void bind_io_hdf5() {
     .def("delete_attribute", &hdf5file_del_attribute, hdf5file_del_attribute_overloads((arg("self"), arg("name"), arg("path")="."), "Deletes a given attribute associated to a (existing) path in the file. The path may point to a subdirectory or to a particular dataset. If the path does not exist, a RuntimeError is raised."))
     .def("delete_attributes", &hdf5file_del_attributes, hdf5file_del_attributes_overloads((arg("self"), arg("path")="."), "Deletes **all** attributes associated to a (existing) path in the file. The path may point to a subdirectory or to a particular dataset. If the path does not exist, a RuntimeError is raised."))
     ;
+
+  bind_io_hdf5_appender();
 }
@@ -0,0 +1,145 @@
+/**
+ * @file io/python/hdf5_virtual.cc
+ * @date Mon Oct 19 17:41:05 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Bindings for the view of many HDF5 files as a single array
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/python.hpp>
+#include <boost/python/stl_iterator.hpp>
+#include <boost/make_shared.hpp>
+#include <bob/io/HDF5VirtualDataset.h>
+
+#include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
+
+using namespace boost::python;
+
+/**
+ * The GIL is released while rows are read, if the HDF5 library serializes
+ * its calls itself (i.e., if it was built thread-safe)
+ */
+#ifdef H5_HAVE_THREADSAFE
+static const bool RELEASE_GIL = true;
+#else
+static const bool RELEASE_GIL = false;
+#endif
+
+static boost::shared_ptr<bob::io::HDF5VirtualDataset> virtual_init(object
+    filenames, const std::string& path, size_t max_open, size_t n_threads) {
+  stl_input_iterator<std::string> begin(filenames), end;
+  std::vector<std::string> v(begin, end);
+  bob::python::no_gil unlock(RELEASE_GIL); //scans the files
+  return boost::make_shared<bob::io::HDF5VirtualDataset>(v, path, max_open,
+      n_threads);
+}
+
+static boost::shared_ptr<bob::io::HDF5VirtualDataset> virtual_load
+(bob::io::HDF5File& index, size_t max_open, size_t n_threads) {
+  return boost::make_shared<bob::io::HDF5VirtualDataset>(index, max_open,
+      n_threads);
+}
+
+static tuple virtual_filenames(const bob::io::HDF5VirtualDataset& d) {
+  list retval;
+  const std::vector<std::string>& v = d.getFilenames();
+  for (size_t k=0; k<v.size(); ++k) retval.append(v[k]);
+  return tuple(retval);
+}
+
+static object virtual_read_row(bob::io::HDF5VirtualDataset& d, size_t row) {
+  bob::python::py_array a(d.type());
+  {
+    bob::python::no_gil unlock(RELEASE_GIL);
+    d.read(row, a);
+  }
+  return a.pyobject(); //shallow copy
+}
+
+static object virtual_read(bob::io::HDF5VirtualDataset& d, size_t start,
+    size_t count) {
+  bob::python::py_array a(d.type(count));
+  {
+    bob::python::no_gil unlock(RELEASE_GIL);
+    d.read(start, count, a);
+  }
+  return a.pyobject(); //shallow copy
+}
+
+static object virtual_read_rows(bob::io::HDF5VirtualDataset& d,
+    object rows) {
+  stl_input_iterator<size_t> begin(rows), end;
+  std::vector<size_t> v(begin, end);
+  bob::python::py_array a(d.type(v.size()));
+  {
+    bob::python::no_gil unlock(RELEASE_GIL);
+    d.read(v, a);
+  }
+  return a.pyobject(); //shallow copy
+}
+
+static void virtual_start(bob::io::HDF5VirtualDataset& d, size_t batch_size,
+    size_t queue_size, object rows) {
+  std::vector<size_t> v;
+  if (!TPY_ISNONE(rows)) {
+    stl_input_iterator<size_t> begin(rows), end;
+    v.assign(begin, end);
+  }
+  bob::python::no_gil unlock(RELEASE_GIL); //waits for a running prefetcher
+  d.start(batch_size, queue_size, v);
+}
+
+static object virtual_next(bob::io::HDF5VirtualDataset& d) {
+  boost::shared_ptr<bob::core::array::blitz_array> batch;
+  {
+    bob::python::no_gil unlock(RELEASE_GIL); //waits for, or reads, the batch
+    batch = d.next();
+  }
+  if (!batch) return object(); //None
+  bob::python::py_array a(boost::static_pointer_cast<bob::core::array::interface>(batch));
+  return a.pyobject(); //refers to the read batch
+}
+
+static void virtual_stop(bob::io::HDF5VirtualDataset& d) {
+  bob::python::no_gil unlock(RELEASE_GIL); //waits for the prefetcher
+  d.stop();
+}
+
+void bind_io_hdf5_virtual() {
+
+  class_<bob::io::HDF5VirtualDataset, boost::shared_ptr<bob::io::HDF5VirtualDataset>, boost::noncopyable>("HDF5VirtualDataset", "Views the dataset at the same path of many HDF5 files (e.g. the features of each sample of a database, stored one file per sample) as a single N x D array, of which the rows are the arrays of the datasets, one file after the other. The files are scanned once, when the view is created, and this index can be saved to an HDF5 file and loaded back without opening them. At most max_open files are kept open, the least recently used being closed first. Rows are read by n_threads threads, consecutive rows of the same file being read at once, and batches of rows can be prefetched in the background with start() and retrieved in order with next(). The reads are only parallel, and batches only prefetched in the background, if the HDF5 library is built thread-safe (otherwise, next() reads each batch).", no_init)
+    .def("__init__", make_constructor(&virtual_init, default_call_policies(), (arg("filenames"), arg("path"), arg("max_open")=64, arg("n_threads")=0)), "Scans the dataset at the given path of each file of the given iterable of file names. All datasets must contain arrays of the same type. If n_threads is 0, the default number of threads of bob is used.")
+    .def("__init__", make_constructor(&virtual_load, default_call_policies(), (arg("index"), arg("max_open")=64, arg("n_threads")=0)), "Loads an index saved with save() from the current directory of the given bob.io.HDF5File, without opening the files of the view")
+    .def("save", &bob::io::HDF5VirtualDataset::save, (arg("self"), arg("index")), "Saves the index (files, path, type and number of rows of each file) in the current directory of the given bob.io.HDF5File")
+    .add_property("filenames", &virtual_filenames, "The list of files")
+    .add_property("path", make_function(&bob::io::HDF5VirtualDataset::getPath, return_value_policy<copy_const_reference>()), "The path of the dataset in each file")
+    .add_property("type", make_function((const bob::core::array::typeinfo& (bob::io::HDF5VirtualDataset::*)() const)&bob::io::HDF5VirtualDataset::type, return_value_policy<copy_const_reference>()), "Typing information of every row")
+    .add_property("type_all", &bob::io::HDF5VirtualDataset::type_all, "Typing information to read all rows at once")
+    .add_property("max_open", &bob::io::HDF5VirtualDataset::getMaxOpen, &bob::io::HDF5VirtualDataset::setMaxOpen, "The maximum number of files kept open")
+    .add_property("open_files", &bob::io::HDF5VirtualDataset::getOpen, "The number of files currently open")
+    .add_property("n_threads", &bob::io::HDF5VirtualDataset::getNThreads, &bob::io::HDF5VirtualDataset::setNThreads, "The number of threads reading rows (0 means the default number of threads of bob)")
+    .def("__len__", (size_t (bob::io::HDF5VirtualDataset::*)() const)&bob::io::HDF5VirtualDataset::size, (arg("self")), "The number of rows of all files")
+    .def("read", &virtual_read_row, (arg("self"), arg("row")), "Reads a row into a NumPy ndarray")
+    .def("read", &virtual_read, (arg("self"), arg("start"), arg("count")), "Reads count rows starting at the given one into a single NumPy ndarray")
+    .def("read_rows", &virtual_read_rows, (arg("self"), arg("rows")), "Reads the rows of the given iterable of indexes, in this order, into a single NumPy ndarray")
+    .def("start", &virtual_start, (arg("self"), arg("batch_size"), arg("queue_size")=2, arg("rows")=object()), "Starts prefetching the given rows (all rows, in order, if None) in the background, in batches of batch_size rows, keeping at most queue_size batches ahead of next()")
+    .def("next", &virtual_next, (arg("self")), "Returns the next prefetched batch as a NumPy ndarray, waiting for it if needed, or None once all batches were returned")
+    .def("stop", &virtual_stop, (arg("self")), "Stops the prefetcher and drops the batches not returned yet")
+    ;
+
+}
@@ -0,0 +1,92 @@
+/**
+ * @file io/python/image_list.cc
+ * @date Mon Oct 19 22:05:37 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Bindings for the parallel image list loader
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/python.hpp>
+#include <boost/python/stl_iterator.hpp>
+#include <boost/make_shared.hpp>
+#include <bob/io/ImageListLoader.h>
+
+#include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
+
+#include "decode_options.h"
+
+using namespace boost::python;
+
+static boost::shared_ptr<bob::io::ImageListLoader> loader_init(object
+    filenames, size_t n_threads, size_t scale_denom, bool gray, object roi) {
+  stl_input_iterator<std::string> begin(filenames), end;
+  std::vector<std::string> v(begin, end);
+  return boost::make_shared<bob::io::ImageListLoader>(v, n_threads,
+      make_decode_options(scale_denom, gray, roi));
+}
+
+static tuple loader_filenames(const bob::io::ImageListLoader& l) {
+  list retval;
+  const std::vector<std::string>& v = l.getFilenames();
+  for (size_t k=0; k<v.size(); ++k) retval.append(v[k]);
+  return tuple(retval);
+}
+
+static object loader_read(bob::io::ImageListLoader& l, size_t start,
+    size_t count) {
+  bob::python::py_array a(l.type(count));
+  {
+    bob::python::no_gil unlock(!l.serialized()); //HDF5 may not be thread-safe
+    l.read(start, count, a);
+  }
+  return a.pyobject(); //shallow copy
+}
+
+static object loader_read_all(bob::io::ImageListLoader& l) {
+  return loader_read(l, 0, l.size());
+}
+
+static object loader_next(bob::io::ImageListLoader& l) {
+  boost::shared_ptr<bob::core::array::blitz_array> batch;
+  {
+    bob::python::no_gil unlock(!l.serialized()); //waits for the prefetcher
+    batch = l.next();
+  }
+  if (!batch) return object(); //None
+  bob::python::py_array a(boost::static_pointer_cast<bob::core::array::interface>(batch));
+  return a.pyobject(); //refers to the decoded batch
+}
+
+void bind_io_image_list() {
+
+  class_<bob::io::ImageListLoader, boost::shared_ptr<bob::io::ImageListLoader>, boost::noncopyable>("ImageListLoader", "Loads a list of images of the same type and shape into a single N x H x W (gray) or N x C x H x W (color) array, decoding them in parallel. Batches of consecutive images can also be prefetched in the background with start() and retrieved in order with next().", no_init)
+    .def("__init__", make_constructor(&loader_init, default_call_policies(), (arg("filenames"), arg("n_threads")=0, arg("scale_denom")=1, arg("gray")=false, arg("roi")=object())), "Creates a loader for the given iterable of file names. The type of all images is given by the first one. If n_threads is 0, the default number of threads of bob is used. The images are decoded with the options scale_denom, gray and roi, as described in bob.io.File.set_decode_options().")
+    .add_property("filenames", &loader_filenames, "The list of files")
+    .add_property("type", make_function((const bob::core::array::typeinfo& (bob::io::ImageListLoader::*)() const)&bob::io::ImageListLoader::type, return_value_policy<copy_const_reference>()), "Typing information of every image")
+    .add_property("type_all", &bob::io::ImageListLoader::type_all, "Typing information to load all images at once")
+    .add_property("n_threads", &bob::io::ImageListLoader::getNThreads, &bob::io::ImageListLoader::setNThreads, "The number of threads decoding images (0 means the default number of threads of bob)")
+    .add_property("serialized", &bob::io::ImageListLoader::serialized, "True if all images are decoded by the calling thread, one at a time, because some of the files are read through HDF5 and the HDF5 library is not thread-safe. next() then decodes each batch when it is called.")
+    .def("__len__", &bob::io::ImageListLoader::size, (arg("self")), "The number of images in the list")
+    .def("read", &loader_read_all, (arg("self")), "Reads all images into a single NumPy ndarray")
+    .def("read", &loader_read, (arg("self"), arg("start"), arg("count")), "Reads count images starting at the given index into a single NumPy ndarray")
+    .def("start", &bob::io::ImageListLoader::start, (arg("self"), arg("batch_size"), arg("queue_size")=2), "Starts prefetching the list in the background, in batches of batch_size images, keeping at most queue_size decoded batches ahead of next()")
+    .def("next", &loader_next, (arg("self")), "Returns the next prefetched batch as a NumPy ndarray, waiting for it if needed, or None once all batches were returned")
+    .def("stop", &bob::io::ImageListLoader::stop, (arg("self")), "Stops the prefetcher and drops the batches not returned yet")
+    ;
+
+}
@@ -35,8 +35,11 @@ static void set_ignore_double_registration(bool v) {
 
 void bind_io_version();
 void bind_io_file();
+void bind_io_image_list();
+void bind_io_array_container();
 void bind_io_hdf5();
 void bind_io_hdf5_extras();
+void bind_io_hdf5_virtual();
 void bind_io_datetime();
 
 #if WITH_FFMPEG
@@ -49,8 +52,11 @@ BOOST_PYTHON_MODULE(_io) {
 
   bind_io_version();
   bind_io_file();
+  bind_io_image_list();
+  bind_io_array_container();
   bind_io_hdf5();
   bind_io_hdf5_extras();
+  bind_io_hdf5_virtual();
   bind_io_datetime();
 
 #if WITH_FFMPEG
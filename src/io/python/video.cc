@@ -22,6 +22,7 @@
 
 #include <boost/python.hpp>
 #include <boost/python/slice.hpp>
+#include <hdf5.h>
 
 #include <bob/io/VideoReader.h>
 #include <bob/io/VideoWriter.h>
@@ -40,6 +41,17 @@ extern "C" {
 
 using namespace boost::python;
 
+/**
+ * The GIL is released while the index of the keyframes is built, which reads
+ * and writes an HDF5 file, if the HDF5 library serializes its calls itself
+ * (i.e., if it was built thread-safe)
+ */
+#ifdef H5_HAVE_THREADSAFE
+static const bool RELEASE_GIL = true;
+#else
+static const bool RELEASE_GIL = false;
+#endif
+
 #if !HAVE_FFMPEG_AVCODEC_AVCODECID
 #define AVCodecID CodecID
 #endif
@@ -67,7 +79,11 @@ struct iterator_wrapper {
 
     //load the next frame: if an error is detected internally, throw
     bob::python::py_array retval(reader->frame_type());
-    bool ok = o.read(retval); //note that this will advance the iterator
+    bool ok;
+    {
+      bob::python::no_gil unlock;
+      ok = o.read(retval); //note that this will advance the iterator
+    }
     if (!ok) PYTHON_ERROR(StopIteration, "iteration finished");
     return retval.pyobject();
   }
@@ -100,8 +116,11 @@ static object videoreader_getitem (bob::io::VideoReader& v, object intobj) {
 
   bob::python::py_array retval(v.frame_type());
   bob::io::VideoReader::const_iterator it = v.begin();
-  it += frame;
-  it.read(retval); //read and throw if a problem occurs
+  {
+    bob::python::no_gil unlock;
+    it += frame;
+    it.read(retval); //read and throw if a problem occurs
+  }
   return retval.pyobject();
 }
 
@@ -159,7 +178,10 @@ static object videoreader_getslice (bob::io::VideoReader& v, slice sobj) {
   for (size_t i=start; it.parent() && i<stop; i+=step, it+=(step-1)) {
     bob::python::check_signals(); //catches keyboard interruption
     bob::python::py_array tmp(v.frame_type());
-    it.read(tmp); //throw if a problem occurs while reading the video
+    {
+      bob::python::no_gil unlock;
+      it.read(tmp); //throw if a problem occurs while reading the video
+    }
     retval.append(tmp.pyobject());
   }
 
@@ -167,11 +189,35 @@ static object videoreader_getslice (bob::io::VideoReader& v, slice sobj) {
   return py_retval.pyobject();
 }
 
+/**
+ * Checks for keyboard interrupts while the GIL is released
+ */
+static void check_signals_unlocked() {
+  bob::python::gil lock;
+  bob::python::check_signals();
+}
+
+static void videoreader_build_index(bob::io::VideoReader& reader,
+    const std::string& index_file) {
+  bob::python::no_gil unlock(RELEASE_GIL); //reads the whole file
+  reader.buildIndex(index_file);
+}
+
+static tuple videoreader_keyframes(const bob::io::VideoReader& reader) {
+  list retval;
+  std::vector<uint64_t> keyframes = reader.keyframes();
+  for (size_t k=0; k<keyframes.size(); ++k) retval.append(keyframes[k]);
+  return tuple(retval);
+}
+
 static object videoreader_load(bob::io::VideoReader& reader,
   bool raise_on_error=false) {
   bob::python::py_array tmp(reader.video_type());
   size_t frames_read = 0;
-  frames_read = reader.load(tmp, raise_on_error, bob::python::check_signals);
+  {
+    bob::python::no_gil unlock;
+    frames_read = reader.load(tmp, raise_on_error, check_signals_unlocked);
+  }
   return make_tuple(frames_read, tmp.pyobject());
 }
 
@@ -183,15 +229,22 @@ static void videowriter_append(bob::io::VideoWriter& writer, object a) {
   if (result != bob::python::IMPOSSIBLE) {
     bob::python::dtype dtype(writer.frame_type().dtype);
     bob::python::py_array tmp(a, dtype.self());
+    bob::python::no_gil unlock;
     writer.append(tmp);
   }
   else {
     bob::python::dtype dtype(writer.video_type().dtype);
     bob::python::py_array tmp(a, dtype.self());
+    bob::python::no_gil unlock;
     writer.append(tmp);
   }
 }
 
+static void videowriter_close(bob::io::VideoWriter& writer) {
+  bob::python::no_gil unlock;
+  writer.close();
+}
+
 /**
  * Describes a given codec or returns an empty dictionary, in case the codec
  * cannot be accessed
@@ -458,11 +511,16 @@ void bind_io_video() {
     .def("__iter__", &bob::io::VideoReader::begin, with_custodian_and_ward_postcall<0,1>())
     .def("__getitem__", &videoreader_getitem)
     .def("__getitem__", &videoreader_getslice)
+    .def("build_index", &videoreader_build_index, (arg("self"), arg("index_file")=""), "Builds the index of the keyframes of the video stream, by reading (but not decoding) all of its packets. Afterwards, ``number_of_frames`` is the exact number of frames of the stream and reading a frame with ``__getitem__()`` seeks to the keyframe before it, instead of decoding all frames in between. If ``index_file`` is given, the index is loaded from this HDF5 file if it was saved for the current version of the video file, or built and saved there otherwise. Seeking is only used for streams of which the frames are stored in presentation order (e.g., without B-frames).")
+    .add_property("has_index", &bob::io::VideoReader::hasIndex, "Tells if the index of the keyframes was built with ``build_index()``")
+    .add_property("keyframes", &videoreader_keyframes, "The numbers of the keyframes of the video stream (empty if the index was not built)")
+    .add_property("cache_size", &bob::io::VideoReader::getCacheSize, &bob::io::VideoReader::setCacheSize, "The maximum number of decoded frames kept in memory, shared by all iterators of this reader, the least recently read ones being dropped first (0, the default, disables the cache)")
+    .add_property("cached_frames", &bob::io::VideoReader::cachedFrames, "The number of decoded frames currently kept in memory")
     ;
 
   class_<bob::io::VideoWriter, boost::shared_ptr<bob::io::VideoWriter>, boost::noncopyable>("VideoWriter",
      "Use objects of this class to create and write video files using `FFmpeg <http://ffmpeg.org>`_ (or `libav <http://libav.org>`_ if FFmpeg is not available).",
-     init<const std::string&, size_t, size_t, optional<float, float, size_t, const std::string&, const std::string&, bool> >((arg("self"), arg("filename"), arg("height"), arg("width"), arg("framerate")=25., arg("bitrate")=1500000., arg("gop")=12, arg("codec")="", arg("format")="", arg("check")=true), "Creates a new output file given the input parameters. The format and codec to be used will be derived from the filename extension unless you define them explicetly (you can set both or just one of these two optional parameters)")
+     init<const std::string&, size_t, size_t, optional<float, float, size_t, const std::string&, const std::string&, bool, size_t, size_t> >((arg("self"), arg("filename"), arg("height"), arg("width"), arg("framerate")=25., arg("bitrate")=1500000., arg("gop")=12, arg("codec")="", arg("format")="", arg("check")=true, arg("threads")=0, arg("queue_size")=0), "Creates a new output file given the input parameters. The format and codec to be used will be derived from the filename extension unless you define them explicetly (you can set both or just one of these two optional parameters).\n\nIf ``threads`` is not zero, frames are written asynchronously: ``append()`` copies them into a queue of at most ``queue_size`` frames (twice the number of threads, if zero) and returns, while ``threads`` threads convert them to the pixel format of the codec and another one encodes them in order, using the same number of threads in `FFmpeg`. ``append()`` waits when the queue is full and ``close()`` waits for all frames to be encoded.")
      )
     .add_property("filename", make_function(&bob::io::VideoReader::filename, return_value_policy<copy_const_reference>()), "The full path to the file that will be encoded by this object")
     .add_property("height", &bob::io::VideoWriter::height, "The height of the output video file (must be a multiple of 2)")
@@ -477,9 +535,11 @@ void bind_io_video() {
     .add_property("frame_rate", &bob::io::VideoWriter::frameRate, "The indicative frame rate of this video file")
     .add_property("bit_rate", &bob::io::VideoWriter::bitRate, "The indicative bit rate for this video file, given as a hint to `FFmpeg` (compression levels are subject to the picture textures)")
     .add_property("gop", &bob::io::VideoWriter::gop, "Group of pictures setting (see the `Wikipedia entry <http://en.wikipedia.org/wiki/Group_of_pictures>`_ for details on this setting)")
+    .add_property("threads", &bob::io::VideoWriter::threads, "The number of threads converting frames, or 0 if frames are written synchronously")
+    .add_property("queue_size", &bob::io::VideoWriter::queueSize, "The maximum number of frames queued when writing asynchronously")
     .add_property("info", &bob::io::VideoWriter::info, "Informative string containing many details of this video and available ffmpeg bindings that will read it")
     .add_property("is_opened", &bob::io::VideoWriter::is_opened, "A boolean flag, indicating if the video is still opened for writing (or has already been closed by the user using ``close()``)")
-    .def("close", &bob::io::VideoWriter::close, (arg("self")), "Closes the current video stream and forces writing the trailer. After this point the video is finalized and cannot be written to anymore.")
+    .def("close", &videowriter_close, (arg("self")), "Closes the current video stream and forces writing the trailer. After this point the video is finalized and cannot be written to anymore. Frames still queued are encoded first.")
     .add_property("video_type", make_function(&bob::io::VideoWriter::video_type, return_value_policy<copy_const_reference>()), "Typing information to load all of the file at once")
     .add_property("frame_type", make_function(&bob::io::VideoWriter::frame_type, return_value_policy<copy_const_reference>()), "Typing information to load the file frame by frame.")
     .def("append", &videowriter_append, (arg("self"), arg("frame")), "Writes a new frame or set of frames to the file. The frame should be setup as a array with 3 dimensions organized in this way (RGB color-bands, height, width). Sets of frames should be setup as a 4D array in this way: (frame-number, RGB color-bands, height, width).\n\n.. note::\n\n  At present time we only support arrays that have C-style storages (if you pass reversed arrays or arrays with Fortran-style storage, the result is undefined).")
@@ -21,6 +21,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/ip/FaceEyesNorm.h>
 
 using namespace boost::python;
@@ -58,7 +59,10 @@ static object inner_call1b(bob::ip::FaceEyesNorm& op,
   bob::python::ndarray dst(bob::core::array::t_float64, op.getCropHeight(), 
     op.getCropWidth());
   blitz::Array<double,2> dst_ = dst.bz<double,2>();
-  op(src.bz<T,2>(), dst_, e1y, e1x, e2y, e2x);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<T,2>(), dst_, e1y, e1x, e2y, e2x);
+  }
   return dst.self();
 }
 
@@ -21,6 +21,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/ip/GaussianScaleSpace.h>
 #include <boost/python/stl_iterator.hpp>
 
@@ -49,6 +50,7 @@ static void inner_call_c(const bob::ip::GaussianScaleSpace& op,
   for(std::vector<bob::python::const_ndarray>::iterator it=ndst.begin(); 
     it!=ndst.end(); ++it)
   vdst.push_back(it->bz<double,3>());
+  bob::python::no_gil unlock;
   op(src.bz<T,2>(), vdst);
 }
 
@@ -82,7 +84,10 @@ static object inner_call_p(const bob::ip::GaussianScaleSpace& op,
     dst_p.append(dst_i);
     dst.push_back(dst_i.bz<double,3>());
   }
-  op(src.bz<T,2>(), dst);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<T,2>(), dst);
+  }
   return dst_p;
 }
 
@@ -21,6 +21,7 @@
  */
 
 #include "bob/python/ndarray.h"
+#include "bob/python/gil.h"
 #include "bob/ip/GeomNorm.h"
 #include "bob/ip/maxRectInMask.h"
 
@@ -35,6 +36,7 @@ static void inner_call1(bob::ip::GeomNorm& obj,
   const double a, const double b)
 {
   blitz::Array<double,2> output_ = output.bz<double,2>();
+  bob::python::no_gil unlock;
   obj(input.bz<T,2>(), output_, a,b);
 }
 
@@ -65,6 +67,7 @@ static void inner_call2(bob::ip::GeomNorm& obj,
 {
   blitz::Array<double,2> output_ = output.bz<double,2>();
   blitz::Array<bool,2> output_mask_ = output_mask.bz<bool,2>();
+  bob::python::no_gil unlock;
   obj(input.bz<T,2>(), input_mask.bz<bool,2>(), output_, output_mask_,
       a, b);
 }
@@ -21,6 +21,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 
 #include <stdint.h>
 #include <vector>
@@ -93,6 +94,7 @@ static void inner_call_lbptop (const bob::ip::LBPTop& op, bob::python::const_nda
   blitz::Array<uint16_t,3> xy_ = xy.bz<uint16_t,3>();
   blitz::Array<uint16_t,3> xt_ = xt.bz<uint16_t,3>();
   blitz::Array<uint16_t,3> yt_ = yt.bz<uint16_t,3>();
+  bob::python::no_gil unlock;
   op(input.bz<T,3>(), xy_, xt_, yt_);
 }
 
@@ -109,7 +111,10 @@ static void call_lbptop (const bob::ip::LBPTop& op, bob::python::const_ndarray i
 template <typename T>
 static object inner_lbp_apply (bob::ip::LBPHSFeatures& op, bob::python::const_ndarray input) {
   std::vector<blitz::Array<uint64_t,1> > dst;
-  op(input.bz<T,2>(), dst);
+  {
+    bob::python::no_gil unlock;
+    op(input.bz<T,2>(), dst);
+  }
   list t;
   for(size_t i=0; i<dst.size(); ++i) t.append(dst[i]);
   return t;
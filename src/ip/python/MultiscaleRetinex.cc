@@ -21,6 +21,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/ip/MultiscaleRetinex.h>
 
 using namespace boost::python;
@@ -30,6 +31,7 @@ static void inner_call1(bob::ip::MultiscaleRetinex& op,
     bob::python::const_ndarray src, bob::python::ndarray dst) 
 {
   blitz::Array<double,N> dst_ = dst.bz<double,N>();
+  bob::python::no_gil unlock;
   op(src.bz<T,N>(), dst_);
 }
 
@@ -72,7 +74,10 @@ static object inner_call2_2d(bob::ip::MultiscaleRetinex& op,
   bob::python::ndarray dst(bob::core::array::t_float64, info.shape[0], 
     info.shape[1]);
   blitz::Array<double,2> dst_ = dst.bz<double,2>();
-  op(src.bz<T,2>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<T,2>(), dst_);
+  }
   return dst.self();
 }
 
@@ -84,7 +89,10 @@ static object inner_call2_3d(bob::ip::MultiscaleRetinex& op,
   bob::python::ndarray dst(bob::core::array::t_float64, info.shape[0], 
     info.shape[1], info.shape[3]);
   blitz::Array<double,3> dst_ = dst.bz<double,3>();
-  op(src.bz<T,3>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<T,3>(), dst_);
+  }
   return dst.self();
 }
 
@@ -21,6 +21,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/ip/TanTriggs.h>
 
 using namespace boost::python;
@@ -58,7 +59,10 @@ static object inner_call2(bob::ip::TanTriggs& op,
   bob::python::ndarray dst(bob::core::array::t_float64, info.shape[0], 
     info.shape[1]);
   blitz::Array<double,2> dst_ = dst.bz<double,2>();
-  op(src.bz<T,2>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<T,2>(), dst_);
+  }
   return dst.self();
 }
 
@@ -21,6 +21,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/ip/Gaussian.h>
 
 using namespace boost::python;
@@ -50,6 +51,7 @@ static void inner_call_gs1(bob::ip::Gaussian& op,
     bob::python::const_ndarray src, bob::python::ndarray dst) 
 {
   blitz::Array<double,N> dst_ = dst.bz<double,N>();
+  bob::python::no_gil unlock;
   op(src.bz<T,N>(), dst_);
 }
 
@@ -95,7 +97,10 @@ static object inner_call_gs2_2d(bob::ip::Gaussian& op,
   bob::python::ndarray dst(bob::core::array::t_float64, info.shape[0], 
     info.shape[1]);
   blitz::Array<double,2> dst_ = dst.bz<double,2>();
-  op(src.bz<T,2>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<T,2>(), dst_);
+  }
   return dst.self();
 }
 
@@ -107,7 +112,10 @@ static object inner_call_gs2_3d(bob::ip::Gaussian& op,
   bob::python::ndarray dst(bob::core::array::t_float64, info.shape[0], 
     info.shape[1], info.shape[2]);
   blitz::Array<double,3> dst_ = dst.bz<double,3>();
-  op(src.bz<T,3>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<T,3>(), dst_);
+  }
   return dst.self();
 }
 
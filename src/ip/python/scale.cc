@@ -21,6 +21,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/ip/scale.h>
 
 using namespace boost::python;
@@ -30,6 +31,7 @@ static void inner_scale(bob::python::const_ndarray src,
   bob::python::ndarray dst, bob::ip::Rescale::Algorithm algo)
 {
   blitz::Array<double,N> dst_ = dst.bz<double,N>();
+  bob::python::no_gil unlock;
   bob::ip::scale(src.bz<T,N>(), dst_, algo);
 }
 
@@ -82,6 +84,7 @@ static void inner_scale2(bob::python::const_ndarray src,
 {
   blitz::Array<double,N> dst_ = dst.bz<double,N>();
   blitz::Array<bool,N> dmask_ = dmask.bz<bool,N>();
+  bob::python::no_gil unlock;
   bob::ip::scale(src.bz<T,N>(), smask.bz<bool,N>(), dst_, dmask_, algo);
 }
 
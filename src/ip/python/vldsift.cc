@@ -21,19 +21,24 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/ip/VLDSIFT.h>
 
 using namespace boost::python;
 
 static void call_vldsift_(bob::ip::VLDSIFT& op, bob::python::const_ndarray src, bob::python::ndarray dst) {
   blitz::Array<float,2> dst_ = dst.bz<float,2>();
+  bob::python::no_gil unlock;
   op(src.bz<float,2>(), dst_);
 }
 
 static object call_vldsift(bob::ip::VLDSIFT& op, bob::python::const_ndarray src) {
   bob::python::ndarray dst(bob::core::array::t_float32, op.getNKeypoints(), op.getDescriptorSize());
   blitz::Array<float,2> dst_ = dst.bz<float,2>();
-  op(src.bz<float,2>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<float,2>(), dst_);
+  }
   return dst.self();
 }
 
@@ -26,12 +26,30 @@
 
 namespace bob { namespace machine {
 
+  void Activation::f (blitz::Array<double,2>& z) const {
+    for (int i=0; i<z.extent(0); ++i)
+      for (int j=0; j<z.extent(1); ++j)
+        z(i,j) = f(z(i,j));
+  }
+
+  void Activation::f_prime_from_f (const blitz::Array<double,2>& a,
+      blitz::Array<double,2>& d) const {
+    for (int i=0; i<a.extent(0); ++i)
+      for (int j=0; j<a.extent(1); ++j)
+        d(i,j) = f_prime_from_f(a(i,j));
+  }
+
   double IdentityActivation::f (double z) const { return z; }
 
   double IdentityActivation::f_prime (double) const { return 1.; }
   
   double IdentityActivation::f_prime_from_f (double) const { return 1.; }
 
+  void IdentityActivation::f (blitz::Array<double,2>&) const { }
+
+  void IdentityActivation::f_prime_from_f (const blitz::Array<double,2>&,
+      blitz::Array<double,2>& d) const { d = 1.; }
+
   void IdentityActivation::save(bob::io::HDF5File& f) const {
     f.set("id", unique_identifier());
   }
@@ -57,6 +75,11 @@ namespace bob { namespace machine {
   
   double LinearActivation::f_prime_from_f (double a) const { return m_C; }
 
+  void LinearActivation::f (blitz::Array<double,2>& z) const { z *= m_C; }
+
+  void LinearActivation::f_prime_from_f (const blitz::Array<double,2>&,
+      blitz::Array<double,2>& d) const { d = m_C; }
+
   double LinearActivation::C() const { return m_C; }
 
   void LinearActivation::save(bob::io::HDF5File& f) const {
@@ -84,6 +107,13 @@ namespace bob { namespace machine {
 
   double HyperbolicTangentActivation::f_prime_from_f (double a) const { return (1. - (a*a)); }
 
+  void HyperbolicTangentActivation::f (blitz::Array<double,2>& z) const
+  { z = blitz::tanh(z); }
+
+  void HyperbolicTangentActivation::f_prime_from_f
+  (const blitz::Array<double,2>& a, blitz::Array<double,2>& d) const
+  { d = 1. - (a*a); }
+
   void HyperbolicTangentActivation::save(bob::io::HDF5File& f) const {
     f.set("id", unique_identifier());
   }
@@ -111,6 +141,13 @@ namespace bob { namespace machine {
   double MultipliedHyperbolicTangentActivation::f_prime_from_f (double a) const
   { return m_C * m_M * (1. - std::pow(a/m_C,2)); }
 
+  void MultipliedHyperbolicTangentActivation::f (blitz::Array<double,2>& z) const
+  { z = m_C * blitz::tanh(m_M * z); }
+
+  void MultipliedHyperbolicTangentActivation::f_prime_from_f
+  (const blitz::Array<double,2>& a, blitz::Array<double,2>& d) const
+  { d = m_C * m_M * (1. - blitz::pow2(a/m_C)); }
+
   double MultipliedHyperbolicTangentActivation::C() const { return m_C; }
 
   double MultipliedHyperbolicTangentActivation::M() const { return m_M; }
@@ -143,6 +180,13 @@ namespace bob { namespace machine {
 
   double LogisticActivation::f_prime_from_f (double a) const { return a * (1. - a); }
 
+  void LogisticActivation::f (blitz::Array<double,2>& z) const
+  { z = 1. / ( 1. + blitz::exp(-z) ); }
+
+  void LogisticActivation::f_prime_from_f (const blitz::Array<double,2>& a,
+      blitz::Array<double,2>& d) const
+  { d = a * (1. - a); }
+
   void LogisticActivation::save(bob::io::HDF5File& f) const {
     f.set("id", unique_identifier());
   }
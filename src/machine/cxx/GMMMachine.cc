@@ -21,7 +21,9 @@
 
 #include <bob/machine/GMMMachine.h>
 #include <bob/core/assert.h>
+#include <bob/core/check.h>
 #include <bob/math/log.h>
+#include <bob/math/kernels.h>
 
 bob::machine::GMMMachine::GMMMachine(): m_gaussians(0) {
   resize(0,0);
@@ -241,18 +243,13 @@ double bob::machine::GMMMachine::logLikelihood(const blitz::Array<double, 1> &x,
 double bob::machine::GMMMachine::logLikelihood_(const blitz::Array<double, 1> &x,
   blitz::Array<double,1> &log_weighted_gaussian_likelihoods) const
 {
-  // Initialise variables
-  double log_likelihood = bob::math::Log::LogZero;
-
-  // Accumulate the weighted log likelihoods from each Gaussian
-  for(size_t i=0; i<m_n_gaussians; ++i) {
-    double l = m_cache_log_weights(i) + m_gaussians[i]->logLikelihood_(x);
-    log_weighted_gaussian_likelihoods(i) = l;
-    log_likelihood = bob::math::Log::logAdd(log_likelihood, l);
-  }
+  // Compute the weighted log likelihoods from each Gaussian
+  for(size_t i=0; i<m_n_gaussians; ++i)
+    log_weighted_gaussian_likelihoods(i) = m_cache_log_weights(i) +
+      m_gaussians[i]->logLikelihood_(x);
 
   // Return log(p(x|GMMMachine))
-  return log_likelihood;
+  return bob::math::Log::logSumExp(log_weighted_gaussian_likelihoods);
 }
 
 double bob::machine::GMMMachine::logLikelihood(const blitz::Array<double, 1> &x) const {
@@ -333,7 +330,8 @@ void bob::machine::GMMMachine::accStatisticsInternal(const blitz::Array<double,
   bob::machine::GMMStats& stats, const double log_likelihood) const
 {
   // Calculate responsibilities
-  m_cache_P = blitz::exp(m_cache_log_weighted_gaussian_likelihoods - log_likelihood);
+  m_cache_P = m_cache_log_weighted_gaussian_likelihoods - log_likelihood;
+  bob::math::fastExp(m_cache_P.data(), m_cache_P.data(), m_n_gaussians);
 
   // Accumulate statistics
   // - total likelihood
@@ -345,16 +343,30 @@ void bob::machine::GMMMachine::accStatisticsInternal(const blitz::Array<double,
   // - responsibilities
   stats.n += m_cache_P;
 
-  // - first order stats
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-
-  m_cache_Px = m_cache_P(i) * x(j);
-
-  stats.sumPx += m_cache_Px;
-
-  // - second order stats
-  stats.sumPxx += (m_cache_Px(i,j) * x(j));
+  // - first and second order stats, in a single pass
+  if (x.stride(0) == 1 && bob::core::array::isCZeroBaseContiguous(stats.sumPx) &&
+      bob::core::array::isCZeroBaseContiguous(stats.sumPxx)) {
+    const double* px = x.data();
+    const double* P = m_cache_P.data();
+    double* sumPx = stats.sumPx.data();
+    double* sumPxx = stats.sumPxx.data();
+    for (size_t i=0; i<m_n_gaussians; ++i) {
+      const double p = P[i];
+      double* s1 = sumPx + i*m_n_inputs;
+      double* s2 = sumPxx + i*m_n_inputs;
+      for (size_t j=0; j<m_n_inputs; ++j) {
+        const double v = p * px[j];
+        s1[j] += v;
+        s2[j] += v * px[j];
+      }
+    }
+  }
+  else {
+    blitz::firstIndex i;
+    blitz::secondIndex j;
+    stats.sumPx += m_cache_P(i) * x(j);
+    stats.sumPxx += (m_cache_P(i) * x(j)) * x(j);
+  }
 }
 
 boost::shared_ptr<const bob::machine::Gaussian> bob::machine::GMMMachine::getGaussian(const size_t i) const {
@@ -434,7 +446,6 @@ void bob::machine::GMMMachine::initCache() const {
   recomputeLogWeights();
   m_cache_log_weighted_gaussian_likelihoods.resize(m_n_gaussians);
   m_cache_P.resize(m_n_gaussians);
-  m_cache_Px.resize(m_n_gaussians,m_n_inputs);
   m_cache_supervector = false;
 }
 
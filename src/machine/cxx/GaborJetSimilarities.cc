@@ -21,6 +21,7 @@
  */
 
 #include "bob/machine/GaborJetSimilarities.h"
+#include "bob/core/array_copy.h"
 
 bob::machine::GaborJetSimilarity::GaborJetSimilarity(bob::machine::GaborJetSimilarity::SimilarityType type, const bob::ip::GaborWaveletTransform& gwt)
 :
@@ -53,6 +54,10 @@ void bob::machine::GaborJetSimilarity::init(){
 
 
 double bob::machine::GaborJetSimilarity::operator()(const blitz::Array<double,1>& jet1, const blitz::Array<double,1>& jet2) const{
+  // strided jets (e.g. slices) are copied to contiguous memory first
+  if (!bob::core::array::isCZeroBaseContiguous(jet1) || !bob::core::array::isCZeroBaseContiguous(jet2)){
+    return operator()(bob::core::array::ccopy(jet1), bob::core::array::ccopy(jet2));
+  }
   bob::core::array::assertCZeroBaseContiguous(jet1);
   bob::core::array::assertCZeroBaseContiguous(jet2);
   bob::core::array::assertSameShape(jet1,jet2);
@@ -83,6 +88,10 @@ double bob::machine::GaborJetSimilarity::operator()(const blitz::Array<double,2>
   }
 
   // Here, only the disparity based similarity functions are executed
+  // strided jets (e.g. slices) are copied to contiguous memory first
+  if (!bob::core::array::isCZeroBaseContiguous(jet1) || !bob::core::array::isCZeroBaseContiguous(jet2)){
+    return operator()(bob::core::array::ccopy(jet1), bob::core::array::ccopy(jet2));
+  }
   bob::core::array::assertCZeroBaseContiguous(jet1);
   bob::core::array::assertCZeroBaseContiguous(jet2);
   bob::core::array::assertSameShape(jet1,jet2);
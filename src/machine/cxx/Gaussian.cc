@@ -23,6 +23,7 @@
 
 #include <bob/core/assert.h>
 #include <bob/math/log.h>
+#include <bob/math/kernels.h>
 
 bob::machine::Gaussian::Gaussian() {
   resize(0);
@@ -81,6 +82,9 @@ void bob::machine::Gaussian::copy(const bob::machine::Gaussian& other) {
   m_variance_thresholds.resize(m_n_inputs);
   m_variance_thresholds = other.m_variance_thresholds;
 
+  m_precision.resize(m_n_inputs);
+  m_precision = other.m_precision;
+
   m_n_log2pi = other.m_n_log2pi;
   m_g_norm = other.m_g_norm;
 }
@@ -98,6 +102,7 @@ void bob::machine::Gaussian::resize(const size_t n_inputs) {
   m_variance = 1;
   m_variance_thresholds.resize(m_n_inputs);
   m_variance_thresholds = 0;
+  m_precision.resize(m_n_inputs);
 
   // Re-compute g_norm, because m_n_inputs and m_variance
   // have changed
@@ -150,7 +155,7 @@ double bob::machine::Gaussian::logLikelihood(const blitz::Array<double,1> &x) co
 }
 
 double bob::machine::Gaussian::logLikelihood_(const blitz::Array<double,1> &x) const {
-  double z = blitz::sum(blitz::pow2(x - m_mean) / m_variance);
+  double z = bob::math::mahalanobisDiag_(x, m_mean, m_precision);
   // Log Likelihood
   return (-0.5 * (m_g_norm + z));
 }
@@ -160,6 +165,7 @@ void bob::machine::Gaussian::preComputeNLog2Pi() {
 }
 
 void bob::machine::Gaussian::preComputeConstants() {
+  m_precision = 1. / m_variance;
   m_g_norm = m_n_log2pi + blitz::sum(blitz::log(m_variance));
 }
 
@@ -179,12 +185,14 @@ void bob::machine::Gaussian::load(bob::io::HDF5File& config) {
   m_mean.resize(m_n_inputs);
   m_variance.resize(m_n_inputs);
   m_variance_thresholds.resize(m_n_inputs);
+  m_precision.resize(m_n_inputs);
 
   config.readArray("m_mean", m_mean);
   config.readArray("m_variance", m_variance);
   config.readArray("m_variance_thresholds", m_variance_thresholds);
 
   preComputeNLog2Pi();
+  m_precision = 1. / m_variance;
   m_g_norm = config.read<double>("g_norm");
 }
 
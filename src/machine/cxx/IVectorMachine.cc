@@ -255,7 +255,8 @@ void bob::machine::IVectorMachine::forward_(const bob::machine::GMMStats& gs,
   // Computes \f$T^{T} \Sigma^{-1} \sum_{c=1}^{C} (F_c - N_c ubmmean_{c})\f$
   computeTtSigmaInvFnorm(gs, m_tmp_t1);
 
-  // Solves m_tmp_tt.ivector = m_tmp_t1
-  bob::math::linsolve(m_tmp_tt, ivector, m_tmp_t1);
+  // Solves m_tmp_tt.ivector = m_tmp_t1 (m_tmp_tt is symmetric positive
+  // definite)
+  bob::math::linsolveSympos_(m_tmp_tt, ivector, m_tmp_t1, m_workspace);
 }
 
@@ -18,12 +18,195 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <bob/machine/LinearScoring.h>
+#include <bob/core/parallel.h>
+#include <bob/core/cast.h>
+#include <bob/core/array_copy.h>
 #include <bob/math/linear.h>
+#include <algorithm>
+#include <limits>
 
 namespace bob { namespace machine {
 
 namespace detail {
 
+  // Sizes of the blocks used for the matrix product: a block of models and
+  // a block of probes are multiplied by chunks of the supervector, so that
+  // the chunks being multiplied stay in cache.
+  static const int BLOCK_MODELS = 16;
+  static const int BLOCK_PROBES = 16;
+  static const int BLOCK_LENGTH = 1024;
+
+  template <typename T>
+  inline double dot(const T* a, const T* b, const int n) {
+    // independent partial sums help the compiler to vectorise this loop
+    T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int k = 0;
+    for (; k + 3 < n; k += 4) {
+      s0 += a[k] * b[k];
+      s1 += a[k+1] * b[k+1];
+      s2 += a[k+2] * b[k+2];
+      s3 += a[k+3] * b[k+3];
+    }
+    for (; k < n; ++k) s0 += a[k] * b[k];
+    return static_cast<double>((s0 + s1) + (s2 + s3));
+  }
+
+  /**
+   * Computes scores = A * B^T over a grid of (models x probes) tiles. A is
+   * (models x CD) and Bt is (probes x CD), both C-contiguous.
+   */
+  template <typename T>
+  struct BlockedProduct {
+    const blitz::Array<T,2>& A;
+    const blitz::Array<T,2>& Bt;
+    blitz::Array<double,2>& scores;
+    int tiles_probes;
+
+    BlockedProduct(const blitz::Array<T,2>& A_, const blitz::Array<T,2>& Bt_,
+        blitz::Array<double,2>& scores_):
+      A(A_), Bt(Bt_), scores(scores_),
+      tiles_probes((Bt_.extent(0) + BLOCK_PROBES - 1) / BLOCK_PROBES) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const {
+      const int Tm = A.extent(0);
+      const int Tt = Bt.extent(0);
+      const int CD = A.extent(1);
+      double acc[BLOCK_MODELS][BLOCK_PROBES];
+
+      for (uint64_t tile = begin; tile < end; ++tile) {
+        const int m0 = (tile / tiles_probes) * BLOCK_MODELS;
+        const int t0 = (tile % tiles_probes) * BLOCK_PROBES;
+        const int m1 = std::min(m0 + BLOCK_MODELS, Tm);
+        const int t1 = std::min(t0 + BLOCK_PROBES, Tt);
+
+        for (int m = 0; m < m1 - m0; ++m)
+          for (int t = 0; t < t1 - t0; ++t) acc[m][t] = 0.;
+
+        for (int k0 = 0; k0 < CD; k0 += BLOCK_LENGTH) {
+          const int n = std::min(BLOCK_LENGTH, CD - k0);
+          for (int m = m0; m < m1; ++m) {
+            const T* a = A.data() + m * CD + k0;
+            for (int t = t0; t < t1; ++t)
+              acc[m-m0][t-t0] += dot(a, Bt.data() + t * CD + k0, n);
+          }
+        }
+
+        for (int m = m0; m < m1; ++m)
+          for (int t = t0; t < t1; ++t) scores(m, t) = acc[m-m0][t-t0];
+      }
+    }
+  };
+
+  /**
+   * Computes scores = A * B^T in double precision, each thread multiplying
+   * a band of models with bob::math::prod_(), which calls the BLAS. The
+   * views of the shared arrays are built from their data, so that the
+   * threads do not change the (not thread-safe) reference count of their
+   * memory.
+   */
+  struct BlasProduct {
+    const blitz::Array<double,2>& A;
+    const blitz::Array<double,2>& Bt;
+    blitz::Array<double,2>& scores;
+
+    BlasProduct(const blitz::Array<double,2>& A_,
+        const blitz::Array<double,2>& Bt_, blitz::Array<double,2>& scores_):
+      A(A_), Bt(Bt_), scores(scores_) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const {
+      const int M = end - begin;
+      const int Tt = Bt.extent(0);
+      const int CD = A.extent(1);
+      const blitz::Array<double,2> a(const_cast<double*>(A.data()) + begin * CD,
+          blitz::shape(M, CD), blitz::neverDeleteData);
+      const blitz::Array<double,2> bt(const_cast<double*>(Bt.data()),
+          blitz::shape(Tt, CD), blitz::neverDeleteData);
+      blitz::Array<double,2> s(scores.data() + begin * scores.stride(0),
+          blitz::shape(M, Tt), blitz::shape(scores.stride(0), scores.stride(1)),
+          blitz::neverDeleteData);
+      bob::math::prod_(a, bt.transpose(1,0), s);
+    }
+  };
+
+  /**
+   * Computes scores = A * B^T, over a grid of tiles
+   */
+  template <typename T>
+  void product(const blitz::Array<T,2>& A, const blitz::Array<T,2>& Bt,
+      blitz::Array<double,2>& scores, size_t n_threads) {
+    const int Tm = A.extent(0);
+    const int Tt = Bt.extent(0);
+    const uint64_t n_tiles =
+      (uint64_t)((Tm + BLOCK_MODELS - 1) / BLOCK_MODELS) *
+      ((Tt + BLOCK_PROBES - 1) / BLOCK_PROBES);
+    bob::core::parallel_for(n_tiles, BlockedProduct<T>(A, Bt, scores),
+        n_threads);
+  }
+
+  /**
+   * Computes scores = A * B^T with the BLAS, over bands of models
+   */
+  inline void product(const blitz::Array<double,2>& A,
+      const blitz::Array<double,2>& Bt, blitz::Array<double,2>& scores,
+      size_t n_threads) {
+    bob::core::parallel_for(A.extent(0), BlasProduct(A, Bt, scores),
+        n_threads);
+  }
+
+  /**
+   * Fills the rows of Bt (one per probe) with the centered first order
+   * statistics, component by component.
+   */
+  template <typename T>
+  struct FillStatistics {
+    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& stats;
+    const std::vector<blitz::Array<double,1> >* offset;
+    const blitz::Array<double,1>& ubm_mean;
+    const bool frame_length_normalisation;
+    blitz::Array<T,2>& Bt;
+
+    FillStatistics(const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& stats_,
+        const std::vector<blitz::Array<double,1> >* offset_,
+        const blitz::Array<double,1>& ubm_mean_, const bool fln,
+        blitz::Array<T,2>& Bt_):
+      stats(stats_), offset(offset_), ubm_mean(ubm_mean_),
+      frame_length_normalisation(fln), Bt(Bt_) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const {
+      const int CD = Bt.extent(1);
+      for (int t = (int)begin; t < (int)end; ++t) {
+        const bob::machine::GMMStats& s = *stats[t];
+        const int C = s.sumPx.extent(0);
+        const int D = s.sumPx.extent(1);
+        bob::core::array::assertSameDimensionLength(C*D, CD);
+        T* row = Bt.data() + t * CD;
+
+        double scale = 1.;
+        if (frame_length_normalisation) {
+          double sum_N = s.T;
+          if (sum_N <= std::numeric_limits<double>::epsilon() && sum_N >= -std::numeric_limits<double>::epsilon())
+            scale = 0.;
+          else
+            scale = 1. / sum_N;
+        }
+
+        for (int c = 0; c < C; ++c) {
+          const double n_c = s.n(c);
+          T* out = row + c * D;
+          if (offset) {
+            const blitz::Array<double,1>& o = (*offset)[t];
+            for (int d = 0; d < D; ++d)
+              out[d] = static_cast<T>((s.sumPx(c, d) - n_c * (ubm_mean(c*D+d) + o(c*D+d))) * scale);
+          }
+          else {
+            for (int d = 0; d < D; ++d)
+              out[d] = static_cast<T>((s.sumPx(c, d) - ubm_mean(c*D+d) * n_c) * scale);
+          }
+        }
+      }
+    }
+  };
+
   void linearScoring(const std::vector<blitz::Array<double,1> >& models,
                      const blitz::Array<double,1>& ubm_mean,
                      const blitz::Array<double,1>& ubm_variance,
@@ -32,57 +215,117 @@ namespace detail {
                      const bool frame_length_normalisation,
                      blitz::Array<double,2>& scores) 
   {
-    int C = test_stats[0]->sumPx.extent(0);
-    int D = test_stats[0]->sumPx.extent(1);
-    int CD = C*D;
-    int Tt = test_stats.size();
-    int Tm = models.size();
-
-    // Check output size
-    bob::core::array::assertSameDimensionLength(scores.extent(0), models.size());
-    bob::core::array::assertSameDimensionLength(scores.extent(1), test_stats.size());
-
-    blitz::Array<double,2> A(Tm, CD);
-    blitz::Array<double,2> B(CD, Tt);
-
-    // 1) Compute A
-    for(int t=0; t<Tm; ++t) {
-      blitz::Array<double, 1> tmp = A(t, blitz::Range::all());
-      tmp = (models[t] - ubm_mean) / ubm_variance;
-    }
+    LinearScoring engine(models, ubm_mean, ubm_variance);
+    if (test_channelOffset)
+      engine(test_stats, *test_channelOffset, frame_length_normalisation, scores);
+    else
+      engine(test_stats, frame_length_normalisation, scores);
+  } 
+}
 
-    // 2) Compute B
-    if(test_channelOffset == 0) {
-      for(int t=0; t<Tt; ++t) 
-        for(int s=0; s<CD; ++s)
-          B(s, t) = test_stats[t]->sumPx(s/D, s%D) - (ubm_mean(s) * test_stats[t]->n(s/D));
-    }
-    else {
-      bob::core::array::assertSameDimensionLength((*test_channelOffset).size(), Tt);
-      
-      for(int t=0; t<Tt; ++t) {
-        bob::core::array::assertSameDimensionLength((*test_channelOffset)[t].extent(0), CD);
-        for(int s=0; s<CD; ++s) 
-          B(s, t) = test_stats[t]->sumPx(s/D, s%D) - (test_stats[t]->n(s/D) * (ubm_mean(s) + (*test_channelOffset)[t](s)));
-      }
-    }
+LinearScoring::LinearScoring(const std::vector<blitz::Array<double,1> >& models,
+    const blitz::Array<double,1>& ubm_mean,
+    const blitz::Array<double,1>& ubm_variance,
+    const bool single_precision, const size_t n_threads):
+  m_single_precision(single_precision),
+  m_n_threads(n_threads)
+{
+  setModels(models, ubm_mean, ubm_variance);
+}
 
-    // Apply the normalisation if needed
-    if(frame_length_normalisation) {
-      for(int t=0; t<Tt; ++t) {
-        double sum_N = test_stats[t]->T;
-        blitz::Array<double, 1> v_t = B(blitz::Range::all(),t);
+LinearScoring::LinearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMachine> >& models,
+    const bob::machine::GMMMachine& ubm,
+    const bool single_precision, const size_t n_threads):
+  m_single_precision(single_precision),
+  m_n_threads(n_threads)
+{
+  const blitz::Array<double,1>& ubm_mean = ubm.getMeanSupervector();
+  std::vector<blitz::Array<double,1> > models_b;
+  // Allocate and get the mean supervector
+  for(size_t i=0; i<models.size(); ++i) {
+    blitz::Array<double,1> mod(ubm_mean.extent(0));
+    models[i]->getMeanSupervector(mod);
+    models_b.push_back(mod);
+  }
+  setModels(models_b, ubm_mean, ubm.getVarianceSupervector());
+}
 
-        if (sum_N <= std::numeric_limits<double>::epsilon() && sum_N >= -std::numeric_limits<double>::epsilon())
-          v_t = 0;
-        else 
-          v_t /= sum_N;
-      }
-    }
+void LinearScoring::setModels(const std::vector<blitz::Array<double,1> >& models,
+    const blitz::Array<double,1>& ubm_mean,
+    const blitz::Array<double,1>& ubm_variance)
+{
+  const int CD = ubm_mean.extent(0);
+  bob::core::array::assertSameDimensionLength(ubm_variance.extent(0), CD);
 
-    // 3) Compute LLR
-    bob::math::prod(A, B, scores);
-  } 
+  m_ubm_mean.reference(bob::core::array::ccopy(ubm_mean));
+  m_A.resize(models.size(), CD);
+  for (size_t t=0; t<models.size(); ++t) {
+    bob::core::array::assertSameDimensionLength(models[t].extent(0), CD);
+    blitz::Array<double,1> tmp = m_A(t, blitz::Range::all());
+    tmp = (models[t] - ubm_mean) / ubm_variance;
+  }
+  setSinglePrecision(m_single_precision);
+}
+
+void LinearScoring::setSinglePrecision(const bool single_precision)
+{
+  m_single_precision = single_precision;
+  if (m_single_precision) {
+    m_A_single.reference(bob::core::array::cast<float>(m_A));
+  }
+  else
+    m_A_single.resize(0, 0);
+}
+
+template <typename T>
+void LinearScoring::score_(const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
+    const std::vector<blitz::Array<double,1> >* test_channelOffset,
+    const bool frame_length_normalisation,
+    const blitz::Array<T,2>& A,
+    blitz::Array<double,2>& scores) const
+{
+  const int Tm = A.extent(0);
+  const int Tt = test_stats.size();
+  const int CD = m_ubm_mean.extent(0);
+
+  // Check output size
+  bob::core::array::assertSameDimensionLength(scores.extent(0), Tm);
+  bob::core::array::assertSameDimensionLength(scores.extent(1), Tt);
+  if (test_channelOffset) {
+    bob::core::array::assertSameDimensionLength((*test_channelOffset).size(), Tt);
+    for (int t=0; t<Tt; ++t)
+      bob::core::array::assertSameDimensionLength((*test_channelOffset)[t].extent(0), CD);
+  }
+
+  // 1) Compute the (transposed) statistics matrix
+  blitz::Array<T,2> Bt(Tt, CD);
+  bob::core::parallel_for(Tt, detail::FillStatistics<T>(test_stats,
+        test_channelOffset, m_ubm_mean, frame_length_normalisation, Bt),
+      m_n_threads);
+
+  // 2) Compute LLR
+  detail::product(A, Bt, scores, m_n_threads);
+}
+
+void LinearScoring::operator()(const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
+    const bool frame_length_normalisation,
+    blitz::Array<double,2>& scores) const
+{
+  if (m_single_precision)
+    score_(test_stats, 0, frame_length_normalisation, m_A_single, scores);
+  else
+    score_(test_stats, 0, frame_length_normalisation, m_A, scores);
+}
+
+void LinearScoring::operator()(const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
+    const std::vector<blitz::Array<double,1> >& test_channelOffset,
+    const bool frame_length_normalisation,
+    blitz::Array<double,2>& scores) const
+{
+  if (m_single_precision)
+    score_(test_stats, &test_channelOffset, frame_length_normalisation, m_A_single, scores);
+  else
+    score_(test_stats, &test_channelOffset, frame_length_normalisation, m_A, scores);
 }
 
 
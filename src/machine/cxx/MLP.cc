@@ -264,12 +264,32 @@ void bob::machine::MLP::forward (const blitz::Array<double,1>& input,
 void bob::machine::MLP::forward_ (const blitz::Array<double,2>& input,
     blitz::Array<double,2>& output) {
 
-  blitz::Range all = blitz::Range::all();
-  for (int i=0; i<input.extent(0); ++i) {
-    blitz::Array<double,1> inref(input(i,all));
-    blitz::Array<double,1> outref(output(i,all));
-    forward_(inref, outref);
+  //(re)allocates the batch buffers if the batch size or layers changed
+  const int batch_size = input.extent(0);
+  if (m_batch_buffer.size() != m_buffer.size())
+    m_batch_buffer.resize(m_buffer.size());
+  for (size_t j=0; j<m_buffer.size(); ++j) {
+    if (m_batch_buffer[j].extent(0) != batch_size ||
+        m_batch_buffer[j].extent(1) != m_buffer[j].extent(0))
+      m_batch_buffer[j].resize(batch_size, m_buffer[j].extent(0));
   }
+
+  //doesn't check input, just computes
+  blitz::firstIndex i;
+  blitz::secondIndex k;
+  m_batch_buffer[0] = (input(i,k) - m_input_sub(k)) / m_input_div(k);
+
+  //input -> hidden[0]; hidden[0] -> hidden[1], ..., hidden[N-2] -> hidden[N-1]
+  for (size_t j=1; j<m_weight.size(); ++j) {
+    bob::math::prod_(m_batch_buffer[j-1], m_weight[j-1], m_batch_buffer[j]);
+    m_batch_buffer[j] = m_batch_buffer[j](i,k) + m_bias[j-1](k);
+    m_hidden_activation->f(m_batch_buffer[j]);
+  }
+
+  //hidden[N-1] -> output
+  bob::math::prod_(m_batch_buffer.back(), m_weight.back(), output);
+  output = output(i,k) + m_bias.back()(k);
+  m_output_activation->f(output);
 }
 
 void bob::machine::MLP::forward (const blitz::Array<double,2>& input,
@@ -27,6 +27,7 @@
 #include <bob/math/linear.h>
 #include <bob/math/det.h>
 #include <bob/math/inv.h>
+#include <bob/math/lu.h>
 
 #include <cmath>
 #include <boost/lexical_cast.hpp>
@@ -454,8 +455,9 @@ void bob::machine::PLDABase::precomputeAlpha()
   bob::math::prod(m_cache_Gt_isigma, m_G, m_tmp_ng_ng_1);
   // m_tmp_ng_ng_1 = Id + G^T.sigma^-1.G
   for(int i=0; i<m_tmp_ng_ng_1.extent(0); ++i) m_tmp_ng_ng_1(i,i) += 1;
-  // m_cache_alpha = (Id + G^T.sigma^-1.G)^-1
-  bob::math::inv(m_tmp_ng_ng_1, m_cache_alpha);
+  // m_cache_alpha = (Id + G^T.sigma^-1.G)^-1 (symmetric positive definite,
+  // hence the Cholesky-based inverse)
+  bob::math::cholInv_(m_tmp_ng_ng_1, m_cache_alpha, m_workspace);
 }
 
 void bob::machine::PLDABase::precomputeBeta() 
@@ -504,8 +506,9 @@ void bob::machine::PLDABase::computeGamma(const size_t a,
   // m_tmp_nf_nf_1 = Id + a.F^T.beta.F
   for(int i=0; i<m_tmp_nf_nf_1.extent(0); ++i) m_tmp_nf_nf_1(i,i) += 1;
 
-  // res = (Id + a.F^T.beta.F)^-1
-  bob::math::inv(m_tmp_nf_nf_1, res);
+  // res = (Id + a.F^T.beta.F)^-1 (symmetric positive definite, hence the
+  // Cholesky-based inverse)
+  bob::math::cholInv_(m_tmp_nf_nf_1, res, m_workspace);
 }
 
 void bob::machine::PLDABase::precomputeLogDetAlpha()
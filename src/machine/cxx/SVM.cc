@@ -28,12 +28,14 @@
 #include <bob/machine/SVM.h>
 #include <bob/core/check.h>
 #include <bob/core/logging.h>
+#include <bob/core/parallel.h>
 #include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <algorithm>
+#include <vector>
 
 static bool is_colon(char i) { return i == ':'; }
 
@@ -231,6 +233,58 @@ void bob::machine::SupportVector::reset() {
   m_input_sub = 0.0;
   m_input_div.resize(inputSize());
   m_input_div = 1.0;
+
+  collapseLinear();
+}
+
+/**
+ * Adds coef times the (sparse) support vector sv to row p of weights
+ */
+static void accumulate_sv(blitz::Array<double,2>& weights, int p, double coef,
+    const svm_node* sv) {
+  for (; sv->index != -1; ++sv) weights(p, sv->index-1) += coef * sv->value;
+}
+
+void bob::machine::SupportVector::collapseLinear() {
+  if (kernelType() != LINEAR) {
+    m_linear_weights.resize(0, 0);
+    m_linear_biases.resize(0);
+    return;
+  }
+
+  const svm_model* model = m_model.get();
+  const svm_t type = machineType();
+
+  if (type == ONE_CLASS || type == EPSILON_SVR || type == NU_SVR) {
+    //a single decision function over all support vectors
+    m_linear_weights.resize(1, m_input_size);
+    m_linear_weights = 0.;
+    m_linear_biases.resize(1);
+    for (int i=0; i<model->l; ++i)
+      accumulate_sv(m_linear_weights, 0, model->sv_coef[0][i], model->SV[i]);
+    m_linear_biases(0) = -model->rho[0];
+    return;
+  }
+
+  //one decision function per pair of classes, in the order used by libsvm
+  const int n_classes = model->nr_class;
+  std::vector<int> start(n_classes, 0);
+  for (int i=1; i<n_classes; ++i) start[i] = start[i-1] + model->nSV[i-1];
+
+  m_linear_weights.resize(n_classes*(n_classes-1)/2, m_input_size);
+  m_linear_weights = 0.;
+  m_linear_biases.resize(n_classes*(n_classes-1)/2);
+  int p = 0;
+  for (int i=0; i<n_classes; ++i) {
+    for (int j=i+1; j<n_classes; ++j) {
+      for (int k=start[i]; k<start[i]+model->nSV[i]; ++k)
+        accumulate_sv(m_linear_weights, p, model->sv_coef[j-1][k], model->SV[k]);
+      for (int k=start[j]; k<start[j]+model->nSV[j]; ++k)
+        accumulate_sv(m_linear_weights, p, model->sv_coef[i][k], model->SV[k]);
+      m_linear_biases(p) = -model->rho[p];
+      ++p;
+    }
+  }
 }
 
 bob::machine::SupportVector::SupportVector(const std::string& model_file):
@@ -381,6 +435,13 @@ int bob::machine::SupportVector::predictClass
 int bob::machine::SupportVector::predictClassAndScores_
 (const blitz::Array<double,1>& input,
  blitz::Array<double,1>& scores) const {
+  // libsvm writes contiguously: strided outputs go through a buffer
+  if (!bob::core::array::isCZeroBaseContiguous(scores)) {
+    blitz::Array<double,1> scores_(scores.shape());
+    int retval = predictClassAndScores_(input, scores_);
+    scores = scores_;
+    return retval;
+  }
   copy(input, m_input_cache, m_input_sub, m_input_div);
 #if LIBSVM_VERSION > 290
   int retval = round(svm_predict_values(m_model.get(), m_input_cache.get(), scores.data()));
@@ -401,10 +462,6 @@ int bob::machine::SupportVector::predictClassAndScores
     throw std::runtime_error(s.str());
   }
 
-  if (!bob::core::array::isCContiguous(scores)) {
-    throw std::runtime_error("scores output array should be C-style contiguous and what you provided is not");
-  }
-
   if ((size_t)scores.extent(0) != outputSize()) {
     boost::format s("output scores for this SVM should have %d components, but you provided an array with %d elements instead");
     s % outputSize() % scores.extent(0);
@@ -417,6 +474,13 @@ int bob::machine::SupportVector::predictClassAndScores
 int bob::machine::SupportVector::predictClassAndProbabilities_
 (const blitz::Array<double,1>& input,
  blitz::Array<double,1>& probabilities) const {
+  // libsvm writes contiguously: strided outputs go through a buffer
+  if (!bob::core::array::isCZeroBaseContiguous(probabilities)) {
+    blitz::Array<double,1> probabilities_(probabilities.shape());
+    int retval = predictClassAndProbabilities_(input, probabilities_);
+    probabilities = probabilities_;
+    return retval;
+  }
   copy(input, m_input_cache, m_input_sub, m_input_div);
   int retval = round(svm_predict_probability(m_model.get(), m_input_cache.get(), probabilities.data()));
   return retval;
@@ -436,10 +500,6 @@ int bob::machine::SupportVector::predictClassAndProbabilities
     throw std::runtime_error("this SVM does not support probabilities");
   }
 
-  if (!bob::core::array::isCContiguous(probabilities)) {
-    throw std::runtime_error("probabilities output array should be C-style contiguous and what you provided is not");
-  }
-
   if ((size_t)probabilities.extent(0) != outputSize()) {
     boost::format s("output probabilities for this SVM should have %d components, but you provided an array with %d elements instead");
     s % outputSize() % probabilities.extent(0);
@@ -449,6 +509,237 @@ int bob::machine::SupportVector::predictClassAndProbabilities
   return predictClassAndProbabilities_(input, probabilities);
 }
 
+/**
+ * Same as copy(), but for row r of a matrix. Elements are accessed directly,
+ * so no array slices (and reference counts) are created, which makes this
+ * safe to call from several threads on the same input.
+ */
+static inline void copy_row(const blitz::Array<double,2>& input, int r,
+    svm_node* cache, const blitz::Array<double,1>& sub,
+    const blitz::Array<double,1>& div) {
+
+  size_t cur = 0; ///< currently used index
+
+  for (int k=0; k<input.extent(1); ++k) {
+    double tmp = (input(r,k) - sub(k))/div(k);
+    if (!tmp) continue;
+    cache[cur].index = k+1;
+    cache[cur].value = tmp;
+    ++cur;
+  }
+
+  cache[cur].index = -1; //libsvm detects end of input if index==-1
+}
+
+/**
+ * The number of decision values libsvm computes for each sample
+ */
+static size_t n_decision_values(const svm_model* model) {
+  switch (svm_get_svm_type(model)) {
+    case ONE_CLASS:
+    case EPSILON_SVR:
+    case NU_SVR:
+      return 1;
+    default:
+      return model->nr_class*(model->nr_class-1)/2;
+  }
+}
+
+/**
+ * Decides on the output label from the decision values, as libsvm does
+ */
+static int decide(const svm_model* model, const double* values,
+    std::vector<int>& votes) {
+  switch (svm_get_svm_type(model)) {
+    case ONE_CLASS:
+      return (values[0] > 0) ? 1 : -1;
+    case EPSILON_SVR:
+    case NU_SVR:
+      return round(values[0]);
+    default:
+      {
+        const int n_classes = model->nr_class;
+        std::fill(votes.begin(), votes.end(), 0);
+        int p = 0;
+        for (int i=0; i<n_classes; ++i)
+          for (int j=i+1; j<n_classes; ++j)
+            ++votes[(values[p++] > 0) ? i : j];
+        int winner = 0;
+        for (int i=1; i<n_classes; ++i)
+          if (votes[i] > votes[winner]) winner = i;
+        return model->label[winner];
+      }
+  }
+}
+
+namespace bob { namespace machine { namespace detail {
+
+  /**
+   * Predicts a range of rows with libsvm, using a node buffer per thread
+   */
+  struct LibsvmPredict {
+
+    const svm_model* m_model;
+    const blitz::Array<double,2>& m_input;
+    const blitz::Array<double,1>& m_sub;
+    const blitz::Array<double,1>& m_div;
+    blitz::Array<int,1>& m_labels;
+    blitz::Array<double,2>* m_scores; ///< null if not required
+
+    LibsvmPredict(const svm_model* model, const blitz::Array<double,2>& input,
+        const blitz::Array<double,1>& sub, const blitz::Array<double,1>& div,
+        blitz::Array<int,1>& labels, blitz::Array<double,2>* scores):
+      m_model(model), m_input(input), m_sub(sub), m_div(div),
+      m_labels(labels), m_scores(scores) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const {
+      boost::shared_array<svm_node> nodes(new svm_node[m_input.extent(1)+1]);
+      std::vector<double> values(n_decision_values(m_model));
+      for (int r=(int)begin; r<(int)end; ++r) {
+        copy_row(m_input, r, nodes.get(), m_sub, m_div);
+        if (!m_scores) {
+          m_labels(r) = round(svm_predict(m_model, nodes.get()));
+          continue;
+        }
+#if LIBSVM_VERSION > 290
+        m_labels(r) = round(svm_predict_values(m_model, nodes.get(), &values[0]));
+#else
+        svm_predict_values(m_model, nodes.get(), &values[0]);
+        m_labels(r) = round(svm_predict(m_model, nodes.get()));
+#endif
+        for (int k=0; k<m_scores->extent(1); ++k) (*m_scores)(r,k) = values[k];
+      }
+    }
+
+  };
+
+  /**
+   * Predicts a range of rows with the collapsed weights of a linear machine
+   */
+  struct LinearPredict {
+
+    const svm_model* m_model;
+    const blitz::Array<double,2>& m_input;
+    const blitz::Array<double,2>& m_weights; ///< scaling included
+    const blitz::Array<double,1>& m_biases; ///< scaling included
+    blitz::Array<int,1>& m_labels;
+    blitz::Array<double,2>* m_scores; ///< null if not required
+
+    LinearPredict(const svm_model* model, const blitz::Array<double,2>& input,
+        const blitz::Array<double,2>& weights,
+        const blitz::Array<double,1>& biases, blitz::Array<int,1>& labels,
+        blitz::Array<double,2>* scores):
+      m_model(model), m_input(input), m_weights(weights), m_biases(biases),
+      m_labels(labels), m_scores(scores) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const {
+      const int P = m_weights.extent(0);
+      const int D = m_weights.extent(1);
+      std::vector<double> values(P);
+      std::vector<int> votes(m_model->nr_class);
+      for (int r=(int)begin; r<(int)end; ++r) {
+        for (int p=0; p<P; ++p) {
+          double value = m_biases(p);
+          for (int d=0; d<D; ++d) value += m_weights(p,d) * m_input(r,d);
+          values[p] = value;
+        }
+        m_labels(r) = decide(m_model, &values[0], votes);
+        if (m_scores)
+          for (int k=0; k<m_scores->extent(1); ++k) (*m_scores)(r,k) = values[k];
+      }
+    }
+
+  };
+
+}}}
+
+/**
+ * Dispatches the batch prediction to the linear or the libsvm predictor
+ */
+static void predict_batch(const svm_model* model,
+    const blitz::Array<double,2>& input, const blitz::Array<double,1>& sub,
+    const blitz::Array<double,1>& div, const blitz::Array<double,2>& weights,
+    const blitz::Array<double,1>& biases, blitz::Array<int,1>& labels,
+    blitz::Array<double,2>* scores, size_t n_threads) {
+
+  if (!weights.size()) {
+    bob::core::parallel_for(input.extent(0), bob::machine::detail::LibsvmPredict(
+          model, input, sub, div, labels, scores), n_threads);
+    return;
+  }
+
+  //folds the input scaling into the weights and biases
+  blitz::Array<double,2> scaled_weights(weights.shape());
+  blitz::Array<double,1> scaled_biases(biases.copy());
+  for (int p=0; p<weights.extent(0); ++p) {
+    for (int d=0; d<weights.extent(1); ++d) {
+      scaled_weights(p,d) = weights(p,d) / div(d);
+      scaled_biases(p) -= scaled_weights(p,d) * sub(d);
+    }
+  }
+  bob::core::parallel_for(input.extent(0), bob::machine::detail::LinearPredict(
+        model, input, scaled_weights, scaled_biases, labels, scores), n_threads);
+}
+
+void bob::machine::SupportVector::predictClasses_
+(const blitz::Array<double,2>& input, blitz::Array<int,1>& labels,
+ size_t n_threads) const {
+  predict_batch(m_model.get(), input, m_input_sub, m_input_div,
+      m_linear_weights, m_linear_biases, labels, 0, n_threads);
+}
+
+void bob::machine::SupportVector::predictClasses
+(const blitz::Array<double,2>& input, blitz::Array<int,1>& labels,
+ size_t n_threads) const {
+
+  if ((size_t)input.extent(1) != inputSize()) {
+    boost::format s("input for this SVM should have %d columns, but you provided an array with %d columns instead");
+    s % inputSize() % input.extent(1);
+    throw std::runtime_error(s.str());
+  }
+
+  if (labels.extent(0) != input.extent(0)) {
+    boost::format s("output labels should have %d components (one per input row), but you provided an array with %d elements instead");
+    s % input.extent(0) % labels.extent(0);
+    throw std::runtime_error(s.str());
+  }
+
+  predictClasses_(input, labels, n_threads);
+}
+
+void bob::machine::SupportVector::predictClassesAndScores_
+(const blitz::Array<double,2>& input, blitz::Array<int,1>& labels,
+ blitz::Array<double,2>& scores, size_t n_threads) const {
+  predict_batch(m_model.get(), input, m_input_sub, m_input_div,
+      m_linear_weights, m_linear_biases, labels, &scores, n_threads);
+}
+
+void bob::machine::SupportVector::predictClassesAndScores
+(const blitz::Array<double,2>& input, blitz::Array<int,1>& labels,
+ blitz::Array<double,2>& scores, size_t n_threads) const {
+
+  if ((size_t)input.extent(1) != inputSize()) {
+    boost::format s("input for this SVM should have %d columns, but you provided an array with %d columns instead");
+    s % inputSize() % input.extent(1);
+    throw std::runtime_error(s.str());
+  }
+
+  if (labels.extent(0) != input.extent(0)) {
+    boost::format s("output labels should have %d components (one per input row), but you provided an array with %d elements instead");
+    s % input.extent(0) % labels.extent(0);
+    throw std::runtime_error(s.str());
+  }
+
+  if (scores.extent(0) != input.extent(0) ||
+      (size_t)scores.extent(1) != outputSize()) {
+    boost::format s("output scores for this SVM should have shape (%d, %d), but you provided an array with shape (%d, %d) instead");
+    s % input.extent(0) % outputSize() % scores.extent(0) % scores.extent(1);
+    throw std::runtime_error(s.str());
+  }
+
+  predictClassesAndScores_(input, labels, scores, n_threads);
+}
+
 void bob::machine::SupportVector::save(const std::string& filename) const {
   if (svm_save_model(filename.c_str(), m_model.get())) {
     boost::format s("cannot save SVM model to file '%s'");
@@ -21,12 +21,164 @@
 
 #include <bob/machine/ZTNorm.h>
 #include <bob/core/assert.h>
+#include <bob/core/parallel.h>
 #include <limits>
+#include <cmath>
 
 namespace bob { 
 namespace machine {
 
 namespace detail {
+
+  // Constant to check if the std is close to 0. 
+  static const double eps = std::numeric_limits<double>::min();
+
+  /**
+   * Mean and standard deviation of the impostor scores (as indicated by the
+   * optional mask) of each row of D, the scores of the Z-Norm probes
+   * against the T-Norm models
+   */
+  struct ImpostorRowStatistics {
+    const blitz::Array<double,2>& D;
+    const blitz::Array<bool,2>* mask;
+    blitz::Array<double,1>& mean;
+    blitz::Array<double,1>& std;
+
+    ImpostorRowStatistics(const blitz::Array<double,2>& D_,
+        const blitz::Array<bool,2>* mask_, blitz::Array<double,1>& mean_,
+        blitz::Array<double,1>& std_):
+      D(D_), mask(mask_), mean(mean_), std(std_) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const {
+      const int size_znorm = D.extent(1);
+      for (int i = (int)begin; i < (int)end; ++i) {
+        double sum = 0;
+        double sumsq = 0;
+        double count = 0;
+        for (int j = 0; j < size_znorm; ++j) {
+          // The second part is never executed if mask==NULL
+          bool keep = (mask == NULL) || !(*mask)(i, j);
+          double value = keep * D(i, j);
+          sum += value;
+          sumsq += value*value;
+          count += keep;
+        }
+
+        double m = sum / count;
+        mean(i) = m;
+        if (count > 1)
+          std(i) = sqrt((sumsq - count * m * m) / (count -1));
+        else // 1 single value -> std = 0
+          std(i) = 0;
+        if (std(i) <= eps) std(i) = 1.;
+      }
+    }
+  };
+
+  /**
+   * Mean and standard deviation, over the T-Norm models, of the
+   * (Z-normalised) T-Norm scores of each enrolled model. Each thread
+   * handles a range of columns of C, so no reduction is required and zC is
+   * never stored.
+   */
+  struct ColumnStatistics {
+    const blitz::Array<double,2>& C;
+    const blitz::Array<double,1>* row_mean;
+    const blitz::Array<double,1>* row_std;
+    blitz::Array<double,1>& mean;
+    blitz::Array<double,1>& std;
+
+    ColumnStatistics(const blitz::Array<double,2>& C_,
+        const blitz::Array<double,1>* row_mean_,
+        const blitz::Array<double,1>* row_std_,
+        blitz::Array<double,1>& mean_, blitz::Array<double,1>& std_):
+      C(C_), row_mean(row_mean_), row_std(row_std_), mean(mean_), std(std_) {}
+
+    double zc(int i, int j) const {
+      if (row_mean) return (C(i,j) - (*row_mean)(i)) / (*row_std)(i);
+      return C(i,j);
+    }
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const {
+      // no slices of mean and std are created here: their (shared) memory
+      // block reference count is not thread-safe
+      const int size_tnorm = C.extent(0);
+      for (int j = (int)begin; j < (int)end; ++j) {
+        mean(j) = 0.;
+        std(j) = 0.;
+      }
+      // iterates row-wise to keep memory access contiguous on C
+      for (int i = 0; i < size_tnorm; ++i)
+        for (int j = (int)begin; j < (int)end; ++j) mean(j) += zc(i,j);
+      for (int j = (int)begin; j < (int)end; ++j) mean(j) /= size_tnorm;
+      if (size_tnorm > 1) {
+        for (int i = 0; i < size_tnorm; ++i)
+          for (int j = (int)begin; j < (int)end; ++j) {
+            double d = zc(i,j) - mean(j);
+            std(j) += d*d;
+          }
+        for (int j = (int)begin; j < (int)end; ++j)
+          std(j) = sqrt(std(j) / (size_tnorm - 1));
+      }
+      // else 1 single value -> std = 0
+      for (int j = (int)begin; j < (int)end; ++j)
+        if (std(j) <= eps) std(j) = 1.;
+    }
+  };
+
+  /**
+   * Normalises a range of probes (rows). The Z-Norm statistics of a probe
+   * are computed from its row of B just before it is normalised.
+   */
+  struct NormalizeRows {
+    const blitz::Array<double,2>& A;
+    const blitz::Array<double,2>* B;
+    const ZTNorm& ztnorm;
+    blitz::Array<double,2>& scores;
+
+    NormalizeRows(const blitz::Array<double,2>& A_,
+        const blitz::Array<double,2>* B_, const ZTNorm& ztnorm_,
+        blitz::Array<double,2>& scores_):
+      A(A_), B(B_), ztnorm(ztnorm_), scores(scores_) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const {
+      const int size_enrol = A.extent(1);
+      const int size_znorm = (B ? B->extent(1) : 0);
+      const bool tnorm = ztnorm.hasTNorm();
+      const blitz::Array<double,1>& mean_zC = ztnorm.getTNormMean();
+      const blitz::Array<double,1>& std_zC = ztnorm.getTNormStd();
+
+      for (int i = (int)begin; i < (int)end; ++i) {
+        // Znorm  -->      zA  = (A - mean(B) ) / std(B)    [znorm on oringinal scores]
+        double mean_B = 0.;
+        double std_B = 1.;
+        if (size_znorm > 0) {
+          for (int k = 0; k < size_znorm; ++k) mean_B += (*B)(i,k);
+          mean_B /= size_znorm;
+          if (size_znorm > 1) {
+            double sumsq = 0.;
+            for (int k = 0; k < size_znorm; ++k) {
+              double d = (*B)(i,k) - mean_B;
+              sumsq += d*d;
+            }
+            std_B = sqrt(sumsq / (size_znorm - 1));
+          }
+          else // 1 single value -> std = 0
+            std_B = 0.;
+          if (std_B <= eps) std_B = 1.;
+        }
+
+        for (int j = 0; j < size_enrol; ++j) {
+          double v = A(i,j);
+          if (size_znorm > 0) v = (v - mean_B) / std_B;
+          // ztA = (zA - mean(zC)) / std(zC)  [ztnorm on eval scores]
+          if (tnorm) v = (v - mean_zC(j)) / std_zC(j);
+          scores(i,j) = v;
+        }
+      }
+    }
+  };
+
   void ztNorm(const blitz::Array<double,2>& rawscores_probes_vs_models,
               const blitz::Array<double,2>* rawscores_zprobes_vs_models,
               const blitz::Array<double,2>* rawscores_probes_vs_tmodels,
@@ -75,89 +227,115 @@ namespace detail {
     bob::core::array::assertSameDimensionLength(scores.extent(0), size_eval);
     bob::core::array::assertSameDimensionLength(scores.extent(1), size_enrol);
 
-    // Declare needed IndexPlaceholder
-    blitz::firstIndex ii;
-    blitz::secondIndex jj;
-
-    // Constant to check if the std is close to 0. 
-    const double eps = std::numeric_limits<double>::min();
-    
-    // zA
-    blitz::Array<double,2> zA(A.shape());
-    if (B && size_znorm > 0) {
-      // Znorm  -->      zA  = (A - mean(B) ) / std(B)    [znorm on oringinal scores]
-      // mean(B)
-      blitz::Array<double,1> mean_B(blitz::mean(*B, jj));
-      // std(B)
-      blitz::Array<double,2> B2n(B->shape());
-      B2n = blitz::pow2((*B)(ii, jj) - mean_B(ii));
-      blitz::Array<double,1> std_B(B->extent(0));
-      if(size_znorm>1)
-        std_B = blitz::sqrt(blitz::sum(B2n, jj) / (size_znorm - 1));
-      else // 1 single value -> std = 0
-        std_B = 0; 
-      std_B = blitz::where( std_B <= eps, 1., std_B);
-
-      zA = (A(ii, jj) - mean_B(ii)) / std_B(ii);
+    ZTNorm ztnorm;
+    if (C && size_tnorm > 0) {
+      if (D && size_znorm > 0) {
+        if (mask_zprobes_vs_tmodels_istruetrial)
+          ztnorm.setTNormScores(*C, *D, *mask_zprobes_vs_tmodels_istruetrial);
+        else
+          ztnorm.setTNormScores(*C, *D);
+      }
+      else
+        ztnorm.setTNormScores(*C);
     }
-    else
-      zA = A;
 
-    blitz::Array<double,2> zC(size_tnorm, size_enrol);
-    if (D && size_tnorm > 0 && size_znorm > 0) {
-      blitz::Array<double,1> mean_Dimp(size_tnorm);
-      blitz::Array<double,1> std_Dimp(size_tnorm);
+    if (B && size_znorm > 0) ztnorm.normalize(A, *B, scores);
+    else ztnorm.normalize(A, scores);
+  }
+}
 
-      // Compute mean_Dimp and std_Dimp = D only with impostors
-      for (int i = 0; i < size_tnorm; ++i) {
-        double sum = 0;
-        double sumsq = 0;
-        double count = 0;
-        for (int j = 0; j < size_znorm; ++j) {
-          bool keep;
-          // The second part is never executed if mask_zprobes_vs_tmodels_istruetrial==NULL
-          keep = (mask_zprobes_vs_tmodels_istruetrial == NULL) || !(*mask_zprobes_vs_tmodels_istruetrial)(i, j); //tnorm_models_spk_ids(i) != znorm_tests_spk_ids(j);
-          
-          double value = keep * (*D)(i, j);
-          sum += value;
-          sumsq += value*value;
-          count += keep;
-        }
+ZTNorm::ZTNorm(const size_t n_threads):
+  m_n_threads(n_threads),
+  m_has_tnorm(false)
+{
+}
 
-        double mean = sum / count;
-        mean_Dimp(i) = mean;
-        if (count > 1)
-          std_Dimp(i) = sqrt((sumsq - count * mean * mean) / (count -1));
-        else // 1 single value -> std = 0
-          std_Dimp(i) = 0;
-      }
+void ZTNorm::resetTNorm()
+{
+  m_has_tnorm = false;
+  m_tnorm_mean.resize(0);
+  m_tnorm_std.resize(0);
+}
 
-      // zC  = (C - mean(D)) / std(D)     [znorm the tnorm scores]
-      std_Dimp = blitz::where( std_Dimp <= eps, 1., std_Dimp);
-      zC = ((*C)(ii, jj) - mean_Dimp(ii)) / std_Dimp(ii);
-    }
-    else if (C && size_tnorm > 0)
-      zC = *C;
-
-    if (C && size_tnorm > 0)
-    {
-      blitz::Array<double,1> mean_zC(size_enrol);
-      blitz::Array<double,1> std_zC(size_enrol);
-      
-      // ztA = (zA - mean(zC)) / std(zC)  [ztnorm on eval scores]
-      mean_zC = blitz::mean(zC(jj, ii), jj);
-      if (size_tnorm > 1)
-        std_zC = sqrt(blitz::sum(pow(zC(jj, ii) - mean_zC(ii), 2) , jj) / (size_tnorm - 1));
-      else // 1 single value -> std = 0
-        std_zC = 0;
-      std_zC = blitz::where( std_zC <= eps, 1., std_zC);
-
-      // Normalised scores
-      scores = (zA(ii, jj) - mean_zC(jj)) /  std_zC(jj);
+void ZTNorm::setTNormScores_(const blitz::Array<double,2>& C,
+    const blitz::Array<double,2>* D, const blitz::Array<bool,2>* mask)
+{
+  const int size_tnorm = C.extent(0);
+  const int size_enrol = C.extent(1);
+  if (size_tnorm == 0) {
+    resetTNorm();
+    return;
+  }
+
+  if (D && D->extent(1) == 0) D = 0;
+  if (D) {
+    bob::core::array::assertSameDimensionLength(D->extent(0), size_tnorm);
+    if (mask) {
+      bob::core::array::assertSameDimensionLength(mask->extent(0), size_tnorm);
+      bob::core::array::assertSameDimensionLength(mask->extent(1), D->extent(1));
     }
-    else
-      scores = zA;
   }
+
+  // zC  = (C - mean(D)) / std(D)     [znorm the tnorm scores]
+  blitz::Array<double,1> mean_Dimp;
+  blitz::Array<double,1> std_Dimp;
+  if (D) {
+    mean_Dimp.resize(size_tnorm);
+    std_Dimp.resize(size_tnorm);
+    bob::core::parallel_for(size_tnorm,
+        detail::ImpostorRowStatistics(*D, mask, mean_Dimp, std_Dimp),
+        m_n_threads);
+  }
+
+  m_tnorm_mean.resize(size_enrol);
+  m_tnorm_std.resize(size_enrol);
+  bob::core::parallel_for(size_enrol,
+      detail::ColumnStatistics(C, D ? &mean_Dimp : 0, D ? &std_Dimp : 0,
+        m_tnorm_mean, m_tnorm_std),
+      m_n_threads);
+  m_has_tnorm = true;
+}
+
+void ZTNorm::setTNormScores(const blitz::Array<double,2>& C)
+{
+  setTNormScores_(C, 0, 0);
+}
+
+void ZTNorm::setTNormScores(const blitz::Array<double,2>& C,
+    const blitz::Array<double,2>& D)
+{
+  setTNormScores_(C, &D, 0);
+}
+
+void ZTNorm::setTNormScores(const blitz::Array<double,2>& C,
+    const blitz::Array<double,2>& D, const blitz::Array<bool,2>& mask)
+{
+  setTNormScores_(C, &D, &mask);
+}
+
+void ZTNorm::normalize(const blitz::Array<double,2>& A,
+    const blitz::Array<double,2>& B, blitz::Array<double,2>& scores) const
+{
+  if (m_has_tnorm)
+    bob::core::array::assertSameDimensionLength(A.extent(1), m_tnorm_mean.extent(0));
+  if (B.extent(1) > 0)
+    bob::core::array::assertSameDimensionLength(B.extent(0), A.extent(0));
+  bob::core::array::assertSameShape(scores, A);
+
+  bob::core::parallel_for(A.extent(0),
+      detail::NormalizeRows(A, B.extent(1) > 0 ? &B : 0, *this, scores),
+      m_n_threads);
+}
+
+void ZTNorm::normalize(const blitz::Array<double,2>& A,
+    blitz::Array<double,2>& scores) const
+{
+  if (m_has_tnorm)
+    bob::core::array::assertSameDimensionLength(A.extent(1), m_tnorm_mean.extent(0));
+  bob::core::array::assertSameShape(scores, A);
+
+  bob::core::parallel_for(A.extent(0),
+      detail::NormalizeRows(A, 0, *this, scores), m_n_threads);
 }
 
 void ztNorm(const blitz::Array<double,2>& rawscores_probes_vs_models,
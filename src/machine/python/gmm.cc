@@ -19,6 +19,7 @@
  */
 #include <boost/python.hpp>
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <boost/concept_check.hpp>
 #include <bob/machine/GMMStats.h>
 #include <bob/machine/GMMMachine.h>
@@ -171,6 +172,7 @@ static double py_gmmmachine_loglikelihoodA(const bob::machine::GMMMachine& machi
   bob::python::const_ndarray x, bob::python::ndarray ll)
 {
   blitz::Array<double,1> ll_ = ll.bz<double,1>();
+  bob::python::no_gil unlock;
   return machine.logLikelihood(x.bz<double,1>(), ll_);
 }
 
@@ -178,18 +180,21 @@ static double py_gmmmachine_loglikelihoodA_(const bob::machine::GMMMachine& mach
   bob::python::const_ndarray x, bob::python::ndarray ll)
 {
   blitz::Array<double,1> ll_ = ll.bz<double,1>();
+  bob::python::no_gil unlock;
   return machine.logLikelihood_(x.bz<double,1>(), ll_);
 }
 
 static double py_gmmmachine_loglikelihoodB(const bob::machine::GMMMachine& machine,
   bob::python::const_ndarray x)
 {
+  bob::python::no_gil unlock;
   return machine.logLikelihood(x.bz<double,1>());
 }
 
 static double py_gmmmachine_loglikelihoodB_(const bob::machine::GMMMachine& machine,
   bob::python::const_ndarray x)
 {
+  bob::python::no_gil unlock;
   return machine.logLikelihood_(x.bz<double,1>());
 }
 
@@ -199,10 +204,16 @@ static void py_gmmmachine_accStatistics(const bob::machine::GMMMachine& machine,
   const bob::core::array::typeinfo& info = x.type();
   switch(info.nd) {
     case 1:
-      machine.accStatistics(x.bz<double,1>(), gs);
+      {
+        bob::python::no_gil unlock;
+        machine.accStatistics(x.bz<double,1>(), gs);
+      }
       break;
     case 2:
-      machine.accStatistics(x.bz<double,2>(), gs);
+      {
+        bob::python::no_gil unlock;
+        machine.accStatistics(x.bz<double,2>(), gs);
+      }
       break;
     default:
       PYTHON_ERROR(TypeError, "cannot accStatistics of arrays with "  SIZE_T_FMT " dimensions (only with 1 or 2 dimensions).", info.nd);
@@ -215,10 +226,16 @@ static void py_gmmmachine_accStatistics_(const bob::machine::GMMMachine& machine
   const bob::core::array::typeinfo& info = x.type();
   switch(info.nd) {
     case 1:
-      machine.accStatistics_(x.bz<double,1>(), gs);
+      {
+        bob::python::no_gil unlock;
+        machine.accStatistics_(x.bz<double,1>(), gs);
+      }
       break;
     case 2:
-      machine.accStatistics_(x.bz<double,2>(), gs);
+      {
+        bob::python::no_gil unlock;
+        machine.accStatistics_(x.bz<double,2>(), gs);
+      }
       break;
     default:
       PYTHON_ERROR(TypeError, "cannot accStatistics of arrays with "  SIZE_T_FMT " dimensions (only with 1 or 2 dimensions).", info.nd);
@@ -19,6 +19,7 @@
  */
 #include <boost/python.hpp>
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <boost/shared_ptr.hpp>
 #include <bob/machine/LinearScoring.h>
 #include <boost/python/stl_iterator.hpp>
@@ -72,11 +73,13 @@ static object linearScoring1(object models,
   bob::python::ndarray ret(bob::core::array::t_float64, models_c.size(), test_stats_c.size());
   blitz::Array<double,2> ret_ = ret.bz<double,2>();
   if (test_channelOffset.ptr() == Py_None || len(test_channelOffset) == 0) { //list is empty
+    bob::python::no_gil unlock;
     bob::machine::linearScoring(models_c, ubm_mean_, ubm_variance_, test_stats_c, frame_length_normalisation, ret_);
   }
   else { 
     std::vector<blitz::Array<double,1> > test_channelOffset_c;
     convertChannelOffsetList(test_channelOffset, test_channelOffset_c);
+    bob::python::no_gil unlock;
     bob::machine::linearScoring(models_c, ubm_mean_, ubm_variance_, test_stats_c, test_channelOffset_c, frame_length_normalisation, ret_);
   }
  
@@ -97,11 +100,13 @@ static object linearScoring2(object models,
   bob::python::ndarray ret(bob::core::array::t_float64, models_c.size(), test_stats_c.size());
   blitz::Array<double,2> ret_ = ret.bz<double,2>();
   if (test_channelOffset.ptr() == Py_None || len(test_channelOffset) == 0) { //list is empty
+    bob::python::no_gil unlock;
     bob::machine::linearScoring(models_c, ubm, test_stats_c, frame_length_normalisation, ret_);
   }
   else { 
     std::vector<blitz::Array<double,1> > test_channelOffset_c;
     convertChannelOffsetList(test_channelOffset, test_channelOffset_c);
+    bob::python::no_gil unlock;
     bob::machine::linearScoring(models_c, ubm, test_stats_c, test_channelOffset_c, frame_length_normalisation, ret_);
   }
   
@@ -113,10 +118,57 @@ static double linearScoring3(bob::python::const_ndarray model,
   const bob::machine::GMMStats& test_stats, bob::python::const_ndarray test_channelOffset,
   const bool frame_length_normalisation = false)
 {
+  bob::python::no_gil unlock;
   return bob::machine::linearScoring(model.bz<double,1>(), ubm_mean.bz<double,1>(),
           ubm_var.bz<double,1>(), test_stats, test_channelOffset.bz<double,1>(), frame_length_normalisation);
 }
 
+static boost::shared_ptr<bob::machine::LinearScoring> engine_from_means(
+    object models, bob::python::const_ndarray ubm_mean,
+    bob::python::const_ndarray ubm_variance, const bool single_precision,
+    const size_t n_threads)
+{
+  std::vector<blitz::Array<double,1> > models_c;
+  convertGMMMeanList(models, models_c);
+  return boost::shared_ptr<bob::machine::LinearScoring>(
+      new bob::machine::LinearScoring(models_c, ubm_mean.bz<double,1>(),
+        ubm_variance.bz<double,1>(), single_precision, n_threads));
+}
+
+static boost::shared_ptr<bob::machine::LinearScoring> engine_from_machines(
+    object models, const bob::machine::GMMMachine& ubm,
+    const bool single_precision, const size_t n_threads)
+{
+  std::vector<boost::shared_ptr<const bob::machine::GMMMachine> > models_c;
+  convertGMMMachineList(models, models_c);
+  return boost::shared_ptr<bob::machine::LinearScoring>(
+      new bob::machine::LinearScoring(models_c, ubm, single_precision,
+        n_threads));
+}
+
+static object engine_call(const bob::machine::LinearScoring& engine,
+    object test_stats, object test_channelOffset = list(), // Empty list
+    bool frame_length_normalisation = false)
+{
+  std::vector<boost::shared_ptr<const bob::machine::GMMStats> > test_stats_c;
+  convertGMMStatsList(test_stats, test_stats_c);
+
+  bob::python::ndarray ret(bob::core::array::t_float64, engine.getNModels(), test_stats_c.size());
+  blitz::Array<double,2> ret_ = ret.bz<double,2>();
+  if (test_channelOffset.ptr() == Py_None || len(test_channelOffset) == 0) { //list is empty
+    engine(test_stats_c, frame_length_normalisation, ret_);
+  }
+  else {
+    std::vector<blitz::Array<double,1> > test_channelOffset_c;
+    convertChannelOffsetList(test_channelOffset, test_channelOffset_c);
+    engine(test_stats_c, test_channelOffset_c, frame_length_normalisation, ret_);
+  }
+
+  return ret.self();
+}
+
+BOOST_PYTHON_FUNCTION_OVERLOADS(engine_call_overloads, engine_call, 2, 4)
+
 BOOST_PYTHON_FUNCTION_OVERLOADS(linearScoring1_overloads, linearScoring1, 4, 6)
 BOOST_PYTHON_FUNCTION_OVERLOADS(linearScoring2_overloads, linearScoring2, 3, 5)
 BOOST_PYTHON_FUNCTION_OVERLOADS(linearScoring3_overloads, linearScoring3, 5, 6)
@@ -157,4 +209,17 @@ void bind_machine_linear_scoring() {
     "test_channelOffset -- \n"
     "frame_length_normlisation -- perform a normalisation by the number of feature vectors\n"
     ));
+
+  class_<bob::machine::LinearScoring, boost::shared_ptr<bob::machine::LinearScoring> >("LinearScoring",
+      "Linear scoring engine for a fixed set of enrolled models. The UBM-normalised model matrix is computed once, so that batches of test statistics can be scored repeatedly. Scores are computed with a cache-blocked matrix product on several threads, optionally in single precision.",
+      no_init)
+    .def("__init__", make_constructor(&engine_from_means, default_call_policies(), (arg("models"), arg("ubm_mean"), arg("ubm_variance"), arg("single_precision")=false, arg("n_threads")=0)), "Builds the engine from the mean supervectors of the client models and the mean and variance supervectors of the world model.")
+    .def("__init__", make_constructor(&engine_from_machines, default_call_policies(), (arg("models"), arg("ubm"), arg("single_precision")=false, arg("n_threads")=0)), "Builds the engine from the client models and the world model, given as GMMMachines.")
+    .def("__call__", &engine_call, engine_call_overloads((arg("self"), arg("test_stats"), arg("test_channel_offset"), arg("frame_length_normalisation")), "Scores a list of GMMStats against all the models and returns a 2D matrix of scores, scores[m, s] is the score for model m against statistics s."))
+    .add_property("n_models", &bob::machine::LinearScoring::getNModels, "The number of enrolled models")
+    .add_property("supervector_length", &bob::machine::LinearScoring::getSupervectorLength, "The length of the supervectors")
+    .add_property("model_matrix", make_function(&bob::machine::LinearScoring::getModelMatrix, return_value_policy<copy_const_reference>()), "The cached UBM-normalised model matrix (models x supervector length)")
+    .add_property("single_precision", &bob::machine::LinearScoring::getSinglePrecision, &bob::machine::LinearScoring::setSinglePrecision, "Computes scores in single precision if set")
+    .add_property("n_threads", &bob::machine::LinearScoring::getNThreads, &bob::machine::LinearScoring::setNThreads, "The number of threads to use (0 means the number of hardware threads)")
+    ;
 }
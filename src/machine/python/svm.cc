@@ -21,6 +21,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/machine/SVM.h>
 
 using namespace boost::python;
@@ -40,17 +41,18 @@ static object predict_class_(const bob::machine::SupportVector& m,
 }
 
 static object predict_class_n(const bob::machine::SupportVector& m,
-    bob::python::const_ndarray input) {
+    bob::python::const_ndarray input, size_t n_threads=0) {
   blitz::Array<double,2> i_ = input.bz<double,2>();
   if ((size_t)i_.extent(1) != m.inputSize()) {
     PYTHON_ERROR(RuntimeError, "Input array should have " SIZE_T_FMT " columns, but you have given me one with %d instead", m.inputSize(), i_.extent(1));
   }
-  blitz::Range all = blitz::Range::all();
-  list retval;
-  for (int k=0; k<i_.extent(0); ++k) {
-    blitz::Array<double,1> tmp = i_(k,all);
-    retval.append(m.predictClass_(tmp));
+  blitz::Array<int,1> labels(i_.extent(0));
+  {
+    bob::python::no_gil unlock;
+    m.predictClasses_(i_, labels, n_threads);
   }
+  list retval;
+  for (int k=0; k<labels.extent(0); ++k) retval.append(labels(k));
   return tuple(retval);
 }
 
@@ -87,18 +89,24 @@ static tuple predict_class_and_scores2(const bob::machine::SupportVector& m,
 }
 
 static object predict_class_and_scores_n(const bob::machine::SupportVector& m,
-    bob::python::const_ndarray input) {
+    bob::python::const_ndarray input, size_t n_threads=0) {
   blitz::Array<double,2> i_ = input.bz<double,2>();
   if ((size_t)i_.extent(1) != m.inputSize()) {
     PYTHON_ERROR(RuntimeError, "Input array should have " SIZE_T_FMT " columns, but you have given me one with %d instead", m.inputSize(), i_.extent(1));
   }
+  blitz::Array<int,1> labels(i_.extent(0));
+  blitz::Array<double,2> scores_(i_.extent(0), m.outputSize());
+  {
+    bob::python::no_gil unlock;
+    m.predictClassesAndScores_(i_, labels, scores_, n_threads);
+  }
   blitz::Range all = blitz::Range::all();
   list classes, scores;
   for (int k=0; k<i_.extent(0); ++k) {
-    blitz::Array<double,1> tmp = i_(k,all);
     bob::python::ndarray s(bob::core::array::t_float64, m.outputSize());
     blitz::Array<double,1> s_ = s.bz<double,1>();
-    classes.append(m.predictClassAndScores_(tmp, s_));
+    s_ = scores_(k,all);
+    classes.append(labels(k));
     scores.append(s.self());
   }
   return make_tuple(tuple(classes), tuple(scores));
@@ -276,14 +284,16 @@ void bind_machine_svm() {
     .add_property("gamma", &bob::machine::SupportVector::gamma, "The gamma parameter for polynomial, RBF (gaussian) or sigmoidal kernels")
     .add_property("coef0", &bob::machine::SupportVector::coefficient0, "The coefficient 0 for polynomial or sigmoidal kernels")
     .add_property("probability", &bob::machine::SupportVector::supportsProbability, "true if this machine supports probability outputs")
+    .add_property("linear_weights", make_function(&bob::machine::SupportVector::getLinearWeights, return_value_policy<copy_const_reference>()), "For machines with a linear kernel, the weights of each decision function, one per row (a single row for regression, one-class and two-class machines, one row per pair of classes otherwise, in the libsvm order). The decision value of row p for a scaled input x is dot(linear_weights[p,:], x) + linear_biases[p]. Empty for other kernels.")
+    .add_property("linear_biases", make_function(&bob::machine::SupportVector::getLinearBiases, return_value_policy<copy_const_reference>()), "For machines with a linear kernel, the bias of each decision function (see linear_weights). Empty for other kernels.")
     .def("predict_class", &predict_class, (arg("self"), arg("input")), "Returns the predicted class given a certain input. Checks the input data for size conformity. If the size is wrong, an exception is raised.")
     .def("predict_class_", &predict_class_, (arg("self"), arg("input")), "Returns the predicted class given a certain input. Does not check the input data and is, therefore, a little bit faster.")
-    .def("predict_classes", &predict_class_n, (arg("self"), arg("input")), "Returns the predicted class given a certain input. Checks the input data for size conformity. If the size is wrong, an exception is raised. This variant accepts as input a 2D array with samples arranged in lines. The array can have as many lines as you want, but the number of columns should match the expected machine input size.")
+    .def("predict_classes", &predict_class_n, (arg("self"), arg("input"), arg("n_threads")=0), "Returns the predicted class given a certain input. Checks the input data for size conformity. If the size is wrong, an exception is raised. This variant accepts as input a 2D array with samples arranged in lines. The array can have as many lines as you want, but the number of columns should match the expected machine input size. The samples are split over n_threads threads (0 means the number of hardware threads). For machines with a linear kernel, the support vectors are collapsed into the weights available at linear_weights, which are then used instead of libsvm.")
     .def("__call__", &svm_call, (arg("self"), arg("input")), "Returns the predicted class(es) given a certain input. Checks the input data for size conformity. If the size is wrong, an exception is raised. The input may be either a 1D or a 2D numpy ndarray object of double-precision floating-point numbers. If the array is 1D, a single answer is returned (the class of the input vector). If the array is 2D, then the number of columns in such array must match the input size. In this case, the SupportVector object will return 1 prediction for every row at the input array.")
     .def("predict_class_and_scores", &predict_class_and_scores2, (arg("self"), arg("input")), "Returns the predicted class and output scores as a tuple, in this order. Checks the input and output arrays for size conformity. If the size is wrong, an exception is raised.")
     .def("predict_class_and_scores", &predict_class_and_scores, (arg("self"), arg("input"), arg("scores")), "Returns the predicted class given a certain input. Returns the scores for each class in the second argument. Checks the input and output arrays for size conformity. If the size is wrong, an exception is raised.")
     .def("predict_class_and_scores_", &predict_class_and_scores_, (arg("self"), arg("input"), arg("scores")), "Returns the predicted class given a certain input. Returns the scores for each class in the second argument. Checks the input and output arrays for size conformity. Does not check the input data and is, therefore, a little bit faster.")
-    .def("predict_classes_and_scores", &predict_class_and_scores_n, (arg("self"), arg("input")), "Returns the predicted class and output scores as a tuple, in this order. Checks the input array for size conformity. If the size is wrong, an exception is raised. This variant takes a single 2D double array as input. The samples should be organized row-wise.")
+    .def("predict_classes_and_scores", &predict_class_and_scores_n, (arg("self"), arg("input"), arg("n_threads")=0), "Returns the predicted class and output scores as a tuple, in this order. Checks the input array for size conformity. If the size is wrong, an exception is raised. This variant takes a single 2D double array as input. The samples should be organized row-wise. The samples are split over n_threads threads (0 means the number of hardware threads), as in predict_classes().")
     .def("predict_class_and_probabilities", &predict_class_and_probs2, (arg("self"), arg("input")), "Returns the predicted class and probabilities in a tuple (on that order) given a certain input. The current machine has to support probabilities, otherwise an exception is raised. Checks the input array for size conformity. If the size is wrong, an exception is raised.")
     .def("predict_class_and_probabilities", &predict_class_and_probs, (arg("self"), arg("input"), arg("probabilities")), "Returns the predicted class given a certain input. If the model supports it, returns the probabilities for each class in the second argument, otherwise raises an exception. Checks the input and output arrays for size conformity. If the size is wrong, an exception is raised.")
     .def("predict_class_and_probabilities_", &predict_class_and_probs_, (arg("self"), arg("input"), arg("probabilities")), "Returns the predicted class given a certain input. This version will not run any checks, so you must be sure to pass the correct input to the classifier.")
@@ -24,6 +24,7 @@
 #include <bob/python/ndarray.h>
 
 #include <boost/python.hpp>
+#include <boost/shared_ptr.hpp>
 #include <bob/machine/ZTNorm.h>
 
 using namespace boost::python;
@@ -128,8 +129,77 @@ static object znorm(
   return ret.self();
 }
 
+static void py_set_tnorm1(bob::machine::ZTNorm& z,
+  bob::python::const_ndarray rawscores_probes_vs_tmodels)
+{
+  z.setTNormScores(rawscores_probes_vs_tmodels.bz<double,2>());
+}
+
+static void py_set_tnorm2(bob::machine::ZTNorm& z,
+  bob::python::const_ndarray rawscores_probes_vs_tmodels,
+  bob::python::const_ndarray rawscores_zprobes_vs_tmodels)
+{
+  z.setTNormScores(rawscores_probes_vs_tmodels.bz<double,2>(),
+                   rawscores_zprobes_vs_tmodels.bz<double,2>());
+}
+
+static void py_set_tnorm3(bob::machine::ZTNorm& z,
+  bob::python::const_ndarray rawscores_probes_vs_tmodels,
+  bob::python::const_ndarray rawscores_zprobes_vs_tmodels,
+  bob::python::const_ndarray mask_zprobes_vs_tmodels_istruetrial)
+{
+  z.setTNormScores(rawscores_probes_vs_tmodels.bz<double,2>(),
+                   rawscores_zprobes_vs_tmodels.bz<double,2>(),
+                   mask_zprobes_vs_tmodels_istruetrial.bz<bool,2>());
+}
+
+static object py_normalize1(const bob::machine::ZTNorm& z,
+  bob::python::const_ndarray rawscores_probes_vs_models)
+{
+  const blitz::Array<double,2> A = rawscores_probes_vs_models.bz<double,2>();
+  bob::python::ndarray ret(bob::core::array::t_float64, A.extent(0), A.extent(1));
+  blitz::Array<double, 2> ret_ = ret.bz<double,2>();
+  z.normalize(A, ret_);
+  return ret.self();
+}
+
+static object py_normalize2(const bob::machine::ZTNorm& z,
+  bob::python::const_ndarray rawscores_probes_vs_models,
+  bob::python::const_ndarray rawscores_zprobes_vs_models)
+{
+  const blitz::Array<double,2> A = rawscores_probes_vs_models.bz<double,2>();
+  bob::python::ndarray ret(bob::core::array::t_float64, A.extent(0), A.extent(1));
+  blitz::Array<double, 2> ret_ = ret.bz<double,2>();
+  z.normalize(A, rawscores_zprobes_vs_models.bz<double,2>(), ret_);
+  return ret.self();
+}
+
+static void py_normalize_inplace(const bob::machine::ZTNorm& z,
+  bob::python::ndarray scores,
+  bob::python::const_ndarray rawscores_zprobes_vs_models)
+{
+  blitz::Array<double,2> scores_ = scores.bz<double,2>();
+  z.normalize(scores_, rawscores_zprobes_vs_models.bz<double,2>(), scores_);
+}
+
 void bind_machine_ztnorm() 
 {
+  class_<bob::machine::ZTNorm, boost::shared_ptr<bob::machine::ZTNorm> >("ZTNorm",
+      "Block-wise ZT-Norm. The T-Norm statistics of each enrolled model are computed once with set_tnorm_scores(), after which blocks of probes (rows of the score matrix, together with the matching rows of the Z-Norm scores) can be normalised independently and on several threads. This allows to normalise score matrices that do not fit in memory, for instance reading them block by block from HDF5 files.",
+      init<optional<const size_t> >((arg("self"), arg("n_threads")=0), "Creates a new ZT-Norm engine using the given number of threads (0 means the number of hardware threads)."))
+    .def("set_tnorm_scores", &py_set_tnorm1, (arg("self"), arg("rawscores_probes_vs_tmodels")), "Sets the T-Norm statistics from the raw T-Norm scores, without Z-Norm.")
+    .def("set_tnorm_scores", &py_set_tnorm2, (arg("self"), arg("rawscores_probes_vs_tmodels"), arg("rawscores_zprobes_vs_tmodels")), "Sets the T-Norm statistics from the T-Norm scores Z-normalised with the scores of the Z-Norm probes against the T-Norm models. Assume that znorm and tnorm have no common subject id.")
+    .def("set_tnorm_scores", &py_set_tnorm3, (arg("self"), arg("rawscores_probes_vs_tmodels"), arg("rawscores_zprobes_vs_tmodels"), arg("mask_zprobes_vs_tmodels_istruetrial")), "Sets the T-Norm statistics from the T-Norm scores Z-normalised with the impostor scores of the Z-Norm probes against the T-Norm models.")
+    .def("reset_tnorm", &bob::machine::ZTNorm::resetTNorm, (arg("self")), "Disables T-Norm.")
+    .def("normalize", &py_normalize1, (arg("self"), arg("rawscores_probes_vs_models")), "Normalises a block of probes using T-Norm only and returns the normalised scores.")
+    .def("normalize", &py_normalize2, (arg("self"), arg("rawscores_probes_vs_models"), arg("rawscores_zprobes_vs_models")), "Normalises a block of probes using the Z-Norm scores of the same probes (and T-Norm, if set) and returns the normalised scores.")
+    .def("normalize_inplace", &py_normalize_inplace, (arg("self"), arg("scores"), arg("rawscores_zprobes_vs_models")), "Normalises a block of probes in place. Pass an empty Z-Norm score array to skip Z-Norm.")
+    .add_property("has_tnorm", &bob::machine::ZTNorm::hasTNorm, "Tells if T-Norm statistics are set")
+    .add_property("tnorm_mean", make_function(&bob::machine::ZTNorm::getTNormMean, return_value_policy<copy_const_reference>()), "The mean of the (Z-normalised) T-Norm scores of each model")
+    .add_property("tnorm_std", make_function(&bob::machine::ZTNorm::getTNormStd, return_value_policy<copy_const_reference>()), "The standard deviation of the (Z-normalised) T-Norm scores of each model")
+    .add_property("n_threads", &bob::machine::ZTNorm::getNThreads, &bob::machine::ZTNorm::setNThreads, "The number of threads to use (0 means the number of hardware threads)")
+    ;
+
   def("ztnorm",
       ztnorm1,
       args("rawscores_probes_vs_models",
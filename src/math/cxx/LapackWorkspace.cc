@@ -0,0 +1,116 @@
+/**
+ * @file math/cxx/LapackWorkspace.cc
+ * @date Mon Oct 19 20:03:51 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Scratch memory reused by the LAPACK wrappers. Implementation.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+#include <boost/format.hpp>
+#include <bob/math/LapackWorkspace.h>
+
+bob::math::LapackWorkspace::LapackWorkspace() {}
+
+bob::math::LapackWorkspace::LapackWorkspace
+(const bob::math::LapackWorkspace&) {}
+
+bob::math::LapackWorkspace::~LapackWorkspace() {}
+
+bob::math::LapackWorkspace& bob::math::LapackWorkspace::operator=
+(const bob::math::LapackWorkspace&) {
+  return *this;
+}
+
+double* bob::math::LapackWorkspace::doubles(size_t slot, size_t n) {
+  if (slot >= 5) {
+    boost::format m("workspace slot %u of doubles does not exist (there are 5)");
+    m % slot;
+    throw std::runtime_error(m.str());
+  }
+  if (!n) n = 1;
+  if (m_doubles[slot].size() < n) m_doubles[slot].resize(n);
+  return &m_doubles[slot][0];
+}
+
+int* bob::math::LapackWorkspace::ints(size_t slot, size_t n) {
+  if (slot >= 2) {
+    boost::format m("workspace slot %u of ints does not exist (there are 2)");
+    m % slot;
+    throw std::runtime_error(m.str());
+  }
+  if (!n) n = 1;
+  if (m_ints[slot].size() < n) m_ints[slot].resize(n);
+  return &m_ints[slot][0];
+}
+
+double* bob::math::LapackWorkspace::columnMajor(size_t slot,
+    const blitz::Array<double,2>& A) {
+  const int M = A.extent(0);
+  const int N = A.extent(1);
+  double* retval = doubles(slot, (size_t)M * N);
+  for (int j=0; j<N; ++j)
+    for (int i=0; i<M; ++i) retval[i + (size_t)j*M] = A(i,j);
+  return retval;
+}
+
+double* bob::math::LapackWorkspace::vector(size_t slot,
+    const blitz::Array<double,1>& a) {
+  double* retval = doubles(slot, a.extent(0));
+  for (int i=0; i<a.extent(0); ++i) retval[i] = a(i);
+  return retval;
+}
+
+void bob::math::LapackWorkspace::fromColumnMajor(const double* data,
+    blitz::Array<double,2>& A) {
+  const int M = A.extent(0);
+  const int N = A.extent(1);
+  for (int j=0; j<N; ++j)
+    for (int i=0; i<M; ++i) A(i,j) = data[i + (size_t)j*M];
+}
+
+void bob::math::LapackWorkspace::fromVector(const double* data,
+    blitz::Array<double,1>& a) {
+  for (int i=0; i<a.extent(0); ++i) a(i) = data[i];
+}
+
+bool bob::math::LapackWorkspace::getWorkSize(const char* routine, int M,
+    int N, int& lwork, int& liwork) const {
+  for (size_t k=0; k<m_work_sizes.size(); ++k) {
+    const WorkSize& w = m_work_sizes[k];
+    if (w.M == M && w.N == N && w.routine == routine) {
+      lwork = w.lwork;
+      liwork = w.liwork;
+      return true;
+    }
+  }
+  return false;
+}
+
+void bob::math::LapackWorkspace::setWorkSize(const char* routine, int M,
+    int N, int lwork, int liwork) {
+  for (size_t k=0; k<m_work_sizes.size(); ++k) {
+    WorkSize& w = m_work_sizes[k];
+    if (w.M == M && w.N == N && w.routine == routine) {
+      w.lwork = lwork;
+      w.liwork = liwork;
+      return;
+    }
+  }
+  WorkSize w = {routine, M, N, lwork, liwork};
+  m_work_sizes.push_back(w);
+}
@@ -0,0 +1,302 @@
+/**
+ * @file math/cxx/ScatterAccumulator.cc
+ * @date Mon Oct 19 18:05:12 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Blocked, multi-threaded accumulation of scatter matrices.
+ * Implementation.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/format.hpp>
+#include <bob/core/assert.h>
+#include <bob/core/array_copy.h>
+#include <bob/core/parallel.h>
+#include <bob/math/linear.h>
+#include <bob/math/ScatterAccumulator.h>
+
+namespace {
+
+  /**
+   * Width of the square tiles of the output matrix each thread works on. A
+   * tile of doubles (32 kB) stays in cache while the rows of a block are
+   * accumulated into it.
+   */
+  static const size_t TILE = 64;
+
+  /**
+   * Adds B^T B to the tiles [begin, end) of the upper triangle of C, where B
+   * is a (C-contiguous) rows x F matrix and C is F x F. The product of the
+   * columns of a tile is computed by bob::math::prod_() (i.e., by the BLAS,
+   * if large enough) into a scratch tile owned by the thread, then added to
+   * C. Each tile is only written by one thread and the views of B and C are
+   * built from their data, so that the threads share no reference count.
+   */
+  struct SyrkTiles {
+    const double* B;
+    double* C;
+    size_t rows;
+    size_t F;
+    const std::vector<std::pair<size_t,size_t> >& tiles;
+
+    SyrkTiles(const double* B_, double* C_, size_t rows_, size_t F_,
+        const std::vector<std::pair<size_t,size_t> >& tiles_):
+      B(B_), C(C_), rows(rows_), F(F_), tiles(tiles_) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const {
+      blitz::Array<double,2> scratch(TILE, TILE);
+      blitz::TinyVector<int,2> stride(F, 1);
+      for (uint64_t t=begin; t<end; ++t) {
+        const size_t i0 = tiles[t].first * TILE;
+        const size_t i1 = std::min(i0 + TILE, F);
+        const size_t j0 = tiles[t].second * TILE;
+        const size_t j1 = std::min(j0 + TILE, F);
+        const blitz::Array<double,2> bi(const_cast<double*>(B) + i0,
+            blitz::shape(rows, i1-i0), stride, blitz::neverDeleteData);
+        const blitz::Array<double,2> bj(const_cast<double*>(B) + j0,
+            blitz::shape(rows, j1-j0), stride, blitz::neverDeleteData);
+        blitz::Array<double,2> p(scratch.data(), blitz::shape(i1-i0, j1-j0),
+            blitz::shape(TILE, 1), blitz::neverDeleteData);
+        bob::math::prod_(bi.transpose(1,0), bj, p);
+        for (size_t i=i0; i<i1; ++i) {
+          double* c = C + i*F;
+          for (size_t j=std::max(i, j0); j<j1; ++j) c[j] += p(i-i0, j-j0);
+        }
+      }
+    }
+  };
+
+  /**
+   * Adds B^T B to the upper triangle of C, using n_threads threads
+   */
+  static void syrk_upper(const blitz::Array<double,2>& B, size_t rows,
+      blitz::Array<double,2>& C, size_t n_threads) {
+    const size_t F = C.extent(0);
+    const size_t n_tiles = (F + TILE - 1) / TILE;
+    std::vector<std::pair<size_t,size_t> > tiles;
+    tiles.reserve(n_tiles * (n_tiles + 1) / 2);
+    for (size_t i=0; i<n_tiles; ++i)
+      for (size_t j=i; j<n_tiles; ++j) tiles.push_back(std::make_pair(i, j));
+    bob::core::parallel_for(tiles.size(),
+        SyrkTiles(B.data(), C.data(), rows, F, tiles), n_threads);
+  }
+
+  /**
+   * Copies the upper triangle of A into S, mirroring it into the lower one
+   */
+  static void symmetric_copy(const blitz::Array<double,2>& A,
+      blitz::Array<double,2>& S) {
+    for (int i=0; i<A.extent(0); ++i)
+      for (int j=i; j<A.extent(1); ++j) S(i,j) = S(j,i) = A(i,j);
+  }
+
+}
+
+bob::math::ScatterAccumulator::ScatterAccumulator(size_t n_features,
+    size_t n_classes, size_t n_threads):
+  m_sw(n_features, n_features),
+  m_means(n_features, n_classes),
+  m_counts(n_classes),
+  m_n_threads(n_threads),
+  m_block_size(256)
+{
+  if (n_features == 0)
+    throw std::runtime_error("the number of features must be at least 1");
+  if (n_classes == 0)
+    throw std::runtime_error("the number of classes must be at least 1");
+  reset();
+}
+
+bob::math::ScatterAccumulator::ScatterAccumulator
+(const bob::math::ScatterAccumulator& other):
+  m_sw(bob::core::array::ccopy(other.m_sw)),
+  m_means(bob::core::array::ccopy(other.m_means)),
+  m_counts(bob::core::array::ccopy(other.m_counts)),
+  m_n_threads(other.m_n_threads),
+  m_block_size(other.m_block_size)
+{
+}
+
+bob::math::ScatterAccumulator::~ScatterAccumulator() {}
+
+bob::math::ScatterAccumulator& bob::math::ScatterAccumulator::operator=
+(const bob::math::ScatterAccumulator& other)
+{
+  if (this != &other) {
+    m_sw.reference(bob::core::array::ccopy(other.m_sw));
+    m_means.reference(bob::core::array::ccopy(other.m_means));
+    m_counts.reference(bob::core::array::ccopy(other.m_counts));
+    m_n_threads = other.m_n_threads;
+    m_block_size = other.m_block_size;
+  }
+  return *this;
+}
+
+void bob::math::ScatterAccumulator::setBlockSize(size_t n) {
+  if (n == 0) throw std::runtime_error("the block size must be at least 1");
+  m_block_size = n;
+}
+
+void bob::math::ScatterAccumulator::reset() {
+  m_sw = 0.;
+  m_means = 0.;
+  m_counts = 0;
+}
+
+uint64_t bob::math::ScatterAccumulator::getNSamples() const {
+  uint64_t retval = 0;
+  for (int k=0; k<m_counts.extent(0); ++k) retval += m_counts(k);
+  return retval;
+}
+
+void bob::math::ScatterAccumulator::accumulate(size_t n_rows) {
+  syrk_upper(m_block, n_rows, m_sw, m_n_threads);
+}
+
+void bob::math::ScatterAccumulator::shift(size_t k, uint64_t n,
+    const blitz::Array<double,1>& mean) {
+  const int F = getNFeatures();
+  const double current = m_counts((int)k);
+  const double total = current + n;
+
+  if (m_counts((int)k)) {
+    // rank-1 correction: current * n / total * (m_k - mean) (m_k - mean)^T
+    const double scale = std::sqrt(current * n / total);
+    for (int f=0; f<F; ++f)
+      m_block(0,f) = scale * (m_means(f,(int)k) - mean(f));
+    accumulate(1);
+  }
+
+  for (int f=0; f<F; ++f)
+    m_means(f,(int)k) = (current * m_means(f,(int)k) + n * mean(f)) / total;
+  m_counts((int)k) += n;
+}
+
+void bob::math::ScatterAccumulator::add(const blitz::Array<double,2>& X,
+    size_t k) {
+  const int F = getNFeatures();
+  if (X.extent(1) != F) {
+    boost::format m("number of features (columns) of the input array (%d) does not match that of the accumulator (%d)");
+    m % X.extent(1) % F;
+    throw std::runtime_error(m.str());
+  }
+  if (k >= getNClasses()) {
+    boost::format m("class index (%u) is out of range (there are %u classes)");
+    m % k % getNClasses();
+    throw std::runtime_error(m.str());
+  }
+  const int M = X.extent(0);
+  if (M == 0) return;
+
+  if (m_block.extent(0) != (int)m_block_size || m_block.extent(1) != F)
+    m_block.resize(m_block_size, F);
+
+  // mean of the chunk
+  blitz::Array<double,1> mean(F);
+  mean = 0.;
+  for (int r=0; r<M; ++r)
+    for (int f=0; f<F; ++f) mean(f) += X(r,f);
+  mean /= M;
+
+  // scatter of the chunk around its own mean, block by block
+  for (int start=0; start<M; start+=m_block_size) {
+    const int rows = std::min(M - start, (int)m_block_size);
+    for (int r=0; r<rows; ++r)
+      for (int f=0; f<F; ++f) m_block(r,f) = X(start+r,f) - mean(f);
+    accumulate(rows);
+  }
+
+  shift(k, M, mean);
+}
+
+void bob::math::ScatterAccumulator::add
+(const std::vector<blitz::Array<double,2> >& data) {
+  if (data.size() != getNClasses()) {
+    boost::format m("number of input arrays (%u) does not match the number of classes of the accumulator (%u)");
+    m % data.size() % getNClasses();
+    throw std::runtime_error(m.str());
+  }
+  for (size_t k=0; k<data.size(); ++k) add(data[k], k);
+}
+
+void bob::math::ScatterAccumulator::merge
+(const bob::math::ScatterAccumulator& other) {
+  if (other.getNFeatures() != getNFeatures() ||
+      other.getNClasses() != getNClasses()) {
+    boost::format m("cannot merge an accumulator of %u features and %u classes into one of %u features and %u classes");
+    m % other.getNFeatures() % other.getNClasses() % getNFeatures() % getNClasses();
+    throw std::runtime_error(m.str());
+  }
+  if (m_block.extent(0) != (int)m_block_size ||
+      m_block.extent(1) != (int)getNFeatures())
+    m_block.resize(m_block_size, getNFeatures());
+
+  m_sw += other.m_sw;
+  blitz::Range a = blitz::Range::all();
+  for (int k=0; k<m_counts.extent(0); ++k)
+    if (other.m_counts(k)) shift(k, other.m_counts(k), other.m_means(a,k));
+}
+
+void bob::math::ScatterAccumulator::getMean(blitz::Array<double,1>& m) const {
+  bob::core::array::assertSameDimensionLength(m.extent(0), getNFeatures());
+  m = 0.;
+  const uint64_t total = getNSamples();
+  if (!total) return;
+  for (int k=0; k<m_counts.extent(0); ++k)
+    for (int f=0; f<m.extent(0); ++f) m(f) += m_counts(k) * m_means(f,k);
+  m /= (double)total;
+}
+
+void bob::math::ScatterAccumulator::getWithinScatter
+(blitz::Array<double,2>& Sw) const {
+  bob::core::array::assertSameDimensionLength(Sw.extent(0), getNFeatures());
+  bob::core::array::assertSameDimensionLength(Sw.extent(1), getNFeatures());
+  symmetric_copy(m_sw, Sw);
+}
+
+void bob::math::ScatterAccumulator::getBetweenScatter
+(blitz::Array<double,2>& Sb) const {
+  const int F = getNFeatures();
+  const int K = getNClasses();
+  bob::core::array::assertSameDimensionLength(Sb.extent(0), F);
+  bob::core::array::assertSameDimensionLength(Sb.extent(1), F);
+
+  // Sb = D^T D, where row k of D is sqrt(N_k) * (m_k - m)
+  blitz::Array<double,1> m(F);
+  getMean(m);
+  blitz::Array<double,2> D(K, F);
+  for (int k=0; k<K; ++k) {
+    const double scale = std::sqrt((double)m_counts(k));
+    for (int f=0; f<F; ++f) D(k,f) = scale * (m_means(f,k) - m(f));
+  }
+  blitz::Array<double,2> upper(F, F);
+  upper = 0.;
+  syrk_upper(D, K, upper, m_n_threads);
+  symmetric_copy(upper, Sb);
+}
+
+void bob::math::ScatterAccumulator::getTotalScatter
+(blitz::Array<double,2>& St) const {
+  getBetweenScatter(St);
+  for (int i=0; i<St.extent(0); ++i)
+    for (int j=i; j<St.extent(1); ++j) {
+      St(i,j) += m_sw(i,j);
+      if (j != i) St(j,i) = St(i,j);
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ * @file math/cxx/benchmark/prod.cc
+ * @date Mon Oct 19 19:12:37 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Compares the time taken by products computed with blitz
+ * expressions and with the BLAS, for increasing sizes, and reports the
+ * crossover point to be used with bob::math::set_blas_threshold().
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <bob/math/linear.h>
+
+/**
+ * Runs a product repeatedly for (at least) a given time and returns the
+ * time per call, in microseconds
+ */
+template <typename TA, typename TB, typename TC>
+static double time_prod(const TA& A, const TB& B, TC& C, double min_seconds) {
+  uint64_t calls = 0;
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+  boost::posix_time::time_duration dt;
+  do {
+    for (int k=0; k<8; ++k) bob::math::prod_(A, B, C);
+    calls += 8;
+    dt = boost::posix_time::microsec_clock::local_time() - start;
+  } while (dt.total_microseconds() < min_seconds * 1e6);
+  return (double)dt.total_microseconds() / calls;
+}
+
+static void fill(blitz::Array<double,2>& A) {
+  for (int i=0; i<A.extent(0); ++i)
+    for (int j=0; j<A.extent(1); ++j) A(i,j) = rand() / (double)RAND_MAX;
+}
+
+static void fill(blitz::Array<double,1>& a) {
+  for (int i=0; i<a.extent(0); ++i) a(i) = rand() / (double)RAND_MAX;
+}
+
+/**
+ * Times both implementations and keeps the smallest size (in multiply-adds)
+ * from which the BLAS is always faster
+ */
+static void report(const char* name, int size, uint64_t multiply_adds,
+    double blitz_time, double blas_time, uint64_t& crossover) {
+  printf("%-8s %6d %14llu %12.2f %12.2f %8.2f\n", name, size,
+      (unsigned long long)multiply_adds, blitz_time, blas_time,
+      blitz_time / blas_time);
+  if (blas_time >= blitz_time) crossover = 0;
+  else if (!crossover) crossover = multiply_adds;
+}
+
+int main(int argc, char** argv) {
+  const double min_seconds = (argc > 1) ? atof(argv[1]) : 0.2;
+  const int sizes[] = {2, 4, 6, 8, 12, 16, 24, 32, 48, 64, 128, 256, 512};
+  const int n_sizes = sizeof(sizes) / sizeof(int);
+
+  printf("%-8s %6s %14s %12s %12s %8s\n", "product", "size",
+      "multiply-adds", "blitz (us)", "blas (us)", "speedup");
+
+  const uint64_t threshold = bob::math::blas_threshold();
+  bob::math::set_blas_threshold(0);
+  uint64_t gemm_crossover = 0;
+  uint64_t gemv_crossover = 0;
+  uint64_t ger_crossover = 0;
+
+  for (int s=0; s<n_sizes; ++s) {
+    const int n = sizes[s];
+    const uint64_t n2 = (uint64_t)n * n;
+    blitz::Array<double,2> A(n,n), B(n,n), C(n,n);
+    blitz::Array<double,1> a(n), c(n);
+    fill(A); fill(B); fill(a);
+
+    bob::math::set_use_blas(false);
+    double blitz_gemm = time_prod(A, B, C, min_seconds);
+    double blitz_gemv = time_prod(A, a, c, min_seconds);
+    double blitz_ger = time_prod(a, a, C, min_seconds);
+    bob::math::set_use_blas(true);
+    double blas_gemm = time_prod(A, B, C, min_seconds);
+    double blas_gemv = time_prod(A, a, c, min_seconds);
+    double blas_ger = time_prod(a, a, C, min_seconds);
+
+    report("gemm", n, n2 * n, blitz_gemm, blas_gemm, gemm_crossover);
+    report("gemv", n, n2, blitz_gemv, blas_gemv, gemv_crossover);
+    report("ger", n, n2, blitz_ger, blas_ger, ger_crossover);
+  }
+
+  printf("\nthe BLAS is faster from (multiply-adds, 0 means never):\n");
+  printf("  gemm: %llu\n  gemv: %llu\n  ger: %llu\n",
+      (unsigned long long)gemm_crossover, (unsigned long long)gemv_crossover,
+      (unsigned long long)ger_crossover);
+  printf("the default threshold is %llu\n", (unsigned long long)threshold);
+  return 0;
+}
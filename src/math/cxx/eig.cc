@@ -163,6 +163,14 @@ void bob::math::eigSym(const blitz::Array<double,2>& A,
 
 void bob::math::eigSym_(const blitz::Array<double,2>& A,
   blitz::Array<double,2>& V, blitz::Array<double,1>& D)
+{
+  bob::math::LapackWorkspace ws;
+  bob::math::eigSym_(A, V, D, ws);
+}
+
+void bob::math::eigSym_(const blitz::Array<double,2>& A,
+  blitz::Array<double,2>& V, blitz::Array<double,1>& D,
+  bob::math::LapackWorkspace& ws)
 {
   // Size variable
   const int N = A.extent(0);
@@ -174,57 +182,38 @@ void bob::math::eigSym_(const blitz::Array<double,2>& A,
   int info = 0;
   const int lda = N;
 
-  // Initialises LAPACK arrays
-  blitz::Array<double,2> A_blitz_lapack;
-  // Tries to use V directly
-  blitz::Array<double,2> Vt = V.transpose(1,0);
-  const bool V_direct_use = bob::core::array::isCZeroBaseContiguous(Vt);
-  if (V_direct_use)
-  {
-    A_blitz_lapack.reference(Vt);
-    // Ugly fix for non-const transpose
-    A_blitz_lapack = const_cast<blitz::Array<double,2>&>(A).transpose(1,0);
-  }
-  else
-    // Ugly fix for non-const transpose
-    A_blitz_lapack.reference(
-      bob::core::array::ccopy(const_cast<blitz::Array<double,2>&>(A).transpose(1,0)));
-  double *A_lapack = A_blitz_lapack.data();
-  blitz::Array<double,1> D_blitz_lapack;
-  const bool D_direct_use = bob::core::array::isCZeroBaseContiguous(D);
-  if (D_direct_use)
-    D_blitz_lapack.reference(D);
-  else
-    D_blitz_lapack.resize(D.shape());
-  double *D_lapack = D_blitz_lapack.data();
+  // Initialises LAPACK arrays (column-major copies, reused from the
+  // workspace)
+  double *A_lapack = ws.columnMajor(0, A);
+  double *D_lapack = ws.doubles(1, N);
 
   // Calls the LAPACK function
-  // A/ Queries the optimal size of the working arrays
-  const int lwork_query = -1;
-  double work_query;
-  const int liwork_query = -1;
-  int iwork_query;
-  dsyevd_( &jobz, &uplo, &N, A_lapack, &lda, D_lapack, &work_query,
-    &lwork_query, &iwork_query, &liwork_query, &info);
+  // A/ Queries the optimal size of the working arrays (once per size)
+  int lwork, liwork;
+  if (!ws.getWorkSize("dsyevd", N, N, lwork, liwork)) {
+    const int lwork_query = -1;
+    double work_query;
+    const int liwork_query = -1;
+    int iwork_query;
+    dsyevd_( &jobz, &uplo, &N, A_lapack, &lda, D_lapack, &work_query,
+      &lwork_query, &iwork_query, &liwork_query, &info);
+    lwork = static_cast<int>(work_query);
+    liwork = iwork_query;
+    ws.setWorkSize("dsyevd", N, N, lwork, liwork);
+  }
   // B/ Computes the eigenvalue decomposition
-  const int lwork = static_cast<int>(work_query);
-  boost::shared_array<double> work(new double[lwork]);
-  const int liwork = static_cast<int>(iwork_query);
-  boost::shared_array<int> iwork(new int[liwork]);
-  dsyevd_( &jobz, &uplo, &N, A_lapack, &lda, D_lapack, work.get(), &lwork,
-    iwork.get(), &liwork, &info);
+  double *work = ws.doubles(2, lwork);
+  int *iwork = ws.ints(1, liwork);
+  dsyevd_( &jobz, &uplo, &N, A_lapack, &lda, D_lapack, work, &lwork,
+    iwork, &liwork, &info);
 
   // Checks info variable
   if (info != 0)
     throw std::runtime_error("The LAPACK function 'dsyevd' returned a non-zero value.");
 
-  // Copy singular vectors back to V if required
-  if (!V_direct_use)
-    Vt = A_blitz_lapack;
-
-  // Copy result back to sigma if required
-  if (!D_direct_use)
-    D = D_blitz_lapack;
+  // Copy eigenvectors and eigenvalues back
+  bob::math::LapackWorkspace::fromColumnMajor(A_lapack, V);
+  bob::math::LapackWorkspace::fromVector(D_lapack, D);
 }
 
 
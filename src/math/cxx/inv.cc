@@ -24,7 +24,7 @@
 #include <bob/core/assert.h>
 #include <bob/core/check.h>
 #include <bob/core/array_copy.h>
-#include <boost/shared_array.hpp>
+#include <algorithm>
 
 // Declaration of the external LAPACK function
 // LU decomposition of a general matrix (dgetrf)
@@ -49,6 +49,13 @@ void bob::math::inv(const blitz::Array<double,2>& A, blitz::Array<double,2>& B)
 }
 
 void bob::math::inv_(const blitz::Array<double,2>& A, blitz::Array<double,2>& B)
+{
+  bob::math::LapackWorkspace ws;
+  bob::math::inv_(A, B, ws);
+}
+
+void bob::math::inv_(const blitz::Array<double,2>& A, blitz::Array<double,2>& B,
+  bob::math::LapackWorkspace& ws)
 {
   // Size variable
   const int N = A.extent(0);
@@ -59,28 +66,13 @@ void bob::math::inv_(const blitz::Array<double,2>& A, blitz::Array<double,2>& B)
   int info = 0;
   const int lda = N;
 
-  // Initializes LAPACK arrays
-  boost::shared_array<int> ipiv(new int[N]);
-
-  // Tries to use B directly if possible
-  //   Input and output arrays are both column-major order.
-  //   Hence, we can ignore the problem of column- and row-major order
-  //   conversions.
-  bool B_direct_use = bob::core::array::isCZeroBaseContiguous(B);
-  blitz::Array<double,2> A_blitz_lapack;
-  if (B_direct_use)
-  {
-    A_blitz_lapack.reference(B);
-    A_blitz_lapack = A;
-  }
-  else
-    A_blitz_lapack.reference(bob::core::array::ccopy(A));
-  double *A_lapack = A_blitz_lapack.data();
-
+  // Initializes LAPACK arrays (reused from the workspace)
+  int* ipiv = ws.ints(0, N);
+  double* A_lapack = ws.columnMajor(0, A);
 
   // Calls the LAPACK functions
   // 1/ Computes the LU decomposition
-  dgetrf_( &N, &N, A_lapack, &lda, ipiv.get(), &info);
+  dgetrf_( &N, &N, A_lapack, &lda, ipiv, &info);
   // Checks the info variable
   if (info != 0)
     throw std::runtime_error("The LAPACK dgetrf function returned a non-zero value.");
@@ -90,20 +82,23 @@ void bob::math::inv_(const blitz::Array<double,2>& A, blitz::Array<double,2>& B)
   // http://icl.cs.utk.edu/lapack-forum/archives/lapack/msg00778.html
 
   // 2/ Computes the inverse matrix
-  // 2/A/ Queries the optimal size of the working array
-  const int lwork_query = -1;
-  double work_query;
-  dgetri_( &N, A_lapack, &lda, ipiv.get(), &work_query, &lwork_query, &info);
+  // 2/A/ Queries the optimal size of the working array (once per size)
+  int lwork, liwork;
+  if (!ws.getWorkSize("dgetri", N, N, lwork, liwork))
+  {
+    const int lwork_query = -1;
+    double work_query;
+    dgetri_( &N, A_lapack, &lda, ipiv, &work_query, &lwork_query, &info);
+    lwork = std::max(static_cast<int>(work_query), std::max(N, 1));
+    ws.setWorkSize("dgetri", N, N, lwork, 0);
+  }
   // 2/B/ Computes the inverse
-  const int lwork = static_cast<int>(work_query);
-  boost::shared_array<double> work(new double[lwork]);
-  dgetri_( &N, A_lapack, &lda, ipiv.get(), work.get(), &lwork, &info);
+  double* work = ws.doubles(1, lwork);
+  dgetri_( &N, A_lapack, &lda, ipiv, work, &lwork, &info);
   // Checks info variable
   if (info != 0)
     throw std::runtime_error("The LAPACK dgetri function returned a non-zero value. The matrix might not be invertible.");
 
-  // Copy back content to B if required
-  if (!B_direct_use)
-    B = A_blitz_lapack;
+  // Copy back content to B
+  bob::math::LapackWorkspace::fromColumnMajor(A_lapack, B);
 }
-
@@ -0,0 +1,208 @@
+/**
+ * @file math/cxx/kernels.cc
+ * @date Mon Oct 19 21:14:02 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Vectorisable kernels on contiguous arrays of doubles.
+ * Implementation.
+ *
+ * The loops below have no data-dependent branches (only selects) and no
+ * calls into libm, so that the compiler can turn them into SIMD code for
+ * whichever instruction set the library is built for.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <stdint.h>
+#include <bob/math/kernels.h>
+
+namespace {
+
+  static const double LOG2E = 1.44269504088896338700e+00;
+  static const double LN2_HI = 6.93147180369123816490e-01;
+  static const double LN2_LO = 1.90821492927058770002e-10;
+  static const double SQRT2 = 1.41421356237309504880e+00;
+  static const double EXP_MIN = -708.;
+  static const double EXP_MAX = 7.09782712893383973096e+02; //log(DBL_MAX)
+  static const double TWO54 = 1.80143985094819840000e+16;
+
+  /**
+   * Size of the buffers used to run the kernels on strided blitz arrays
+   */
+  static const size_t CHUNK = 256;
+
+  static inline double from_bits(int64_t i) {
+    double retval;
+    std::memcpy(&retval, &i, sizeof(double));
+    return retval;
+  }
+
+  static inline int64_t to_bits(double d) {
+    int64_t retval;
+    std::memcpy(&retval, &d, sizeof(double));
+    return retval;
+  }
+
+  /**
+   * exp(x) = 2^k * exp(r), with k = round(x/log(2)) and |r| <= log(2)/2.
+   * exp(r) is evaluated with its Taylor series up to degree 12, of which
+   * the truncation error is below 2e-16.
+   */
+  static inline double exp1(double x) {
+    double xc = (x > EXP_MIN) ? x : EXP_MIN;
+    xc = (xc < EXP_MAX) ? xc : EXP_MAX;
+    const double k = std::floor(xc * LOG2E + 0.5);
+    const double r = (xc - k * LN2_HI) - k * LN2_LO;
+    double p = 1./479001600.;
+    p = p * r + 1./39916800.;
+    p = p * r + 1./3628800.;
+    p = p * r + 1./362880.;
+    p = p * r + 1./40320.;
+    p = p * r + 1./5040.;
+    p = p * r + 1./720.;
+    p = p * r + 1./120.;
+    p = p * r + 1./24.;
+    p = p * r + 1./6.;
+    p = p * r + 0.5;
+    p = p * r + 1.;
+    p = p * r + 1.;
+    // 2^(k-1) * 2 avoids the overflow of the exponent for k = 1024
+    const double v = 2. * p * from_bits(((int64_t)k + 1022) << 52);
+    const double retval = (x >= EXP_MIN) ?
+      ((x <= EXP_MAX) ? v : std::numeric_limits<double>::infinity()) : 0.;
+    return (x != x) ? x : retval; //NaN in, NaN out
+  }
+
+  /**
+   * log(x) = e * log(2) + log(m), with m in [sqrt(2)/2, sqrt(2)). log(m) is
+   * evaluated as 2 atanh(s), with s = (m-1)/(m+1) and |s| < 0.172, of which
+   * the series is truncated after the term in s^21 (error below 3e-17).
+   * Subnormal inputs are scaled by 2^54 first.
+   */
+  static inline double log1(double x) {
+    const bool subnormal = (x < std::numeric_limits<double>::min());
+    const double xs = subnormal ? x * TWO54 : x;
+    const int64_t bits = to_bits(xs);
+    double e = (double)(((bits >> 52) & 0x7ff) - 1023) - (subnormal ? 54. : 0.);
+    double m = from_bits((bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL);
+    const bool big = (m > SQRT2);
+    m = big ? 0.5 * m : m;
+    e = big ? e + 1. : e;
+    const double s = (m - 1.) / (m + 1.);
+    const double s2 = s * s;
+    double p = 1./21.;
+    p = p * s2 + 1./19.;
+    p = p * s2 + 1./17.;
+    p = p * s2 + 1./15.;
+    p = p * s2 + 1./13.;
+    p = p * s2 + 1./11.;
+    p = p * s2 + 1./9.;
+    p = p * s2 + 1./7.;
+    p = p * s2 + 1./5.;
+    p = p * s2 + 1./3.;
+    p = p * s2 + 1.;
+    const double v = e * LN2_HI + (e * LN2_LO + 2. * s * p);
+    return (x > 0.) ?
+      ((x <= std::numeric_limits<double>::max()) ? v : x) :
+      ((x == 0.) ? -std::numeric_limits<double>::infinity() :
+       std::numeric_limits<double>::quiet_NaN());
+  }
+
+  /**
+   * Applies the operation on a strided blitz array through a contiguous
+   * buffer, or directly if both arrays are contiguous
+   */
+  template <typename F>
+  static void apply(const blitz::Array<double,1>& x, blitz::Array<double,1>& y,
+      F f) {
+    const int n = x.extent(0);
+    if (n == 0) return;
+    if (x.stride(0) == 1 && y.stride(0) == 1) {
+      f(x.data(), y.data(), n);
+      return;
+    }
+    double buffer[CHUNK];
+    const int base_x = x.lbound(0);
+    const int base_y = y.lbound(0);
+    for (int start=0; start<n; start+=CHUNK) {
+      const int len = std::min(n - start, (int)CHUNK);
+      for (int i=0; i<len; ++i) buffer[i] = x(base_x + start + i);
+      f(buffer, buffer, len);
+      for (int i=0; i<len; ++i) y(base_y + start + i) = buffer[i];
+    }
+  }
+
+}
+
+double bob::math::mahalanobisDiag(const double* x, const double* mean,
+    const double* precision, size_t n) {
+  // four independent accumulators break the dependency chain of the sum
+  double s0 = 0., s1 = 0., s2 = 0., s3 = 0.;
+  size_t i = 0;
+  for (; i+4<=n; i+=4) {
+    const double d0 = x[i] - mean[i];
+    const double d1 = x[i+1] - mean[i+1];
+    const double d2 = x[i+2] - mean[i+2];
+    const double d3 = x[i+3] - mean[i+3];
+    s0 += d0 * d0 * precision[i];
+    s1 += d1 * d1 * precision[i+1];
+    s2 += d2 * d2 * precision[i+2];
+    s3 += d3 * d3 * precision[i+3];
+  }
+  for (; i<n; ++i) {
+    const double d = x[i] - mean[i];
+    s0 += d * d * precision[i];
+  }
+  return (s0 + s1) + (s2 + s3);
+}
+
+double bob::math::mahalanobisDiag_(const blitz::Array<double,1>& x,
+    const blitz::Array<double,1>& mean,
+    const blitz::Array<double,1>& precision) {
+  const size_t n = mean.extent(0);
+  if (x.stride(0) == 1)
+    return mahalanobisDiag(x.data(), mean.data(), precision.data(), n);
+  const double* m = mean.data();
+  const double* p = precision.data();
+  const int base = x.lbound(0);
+  double retval = 0.;
+  for (size_t i=0; i<n; ++i) {
+    const double d = x(base + (int)i) - m[i];
+    retval += d * d * p[i];
+  }
+  return retval;
+}
+
+void bob::math::fastExp(const double* x, double* y, size_t n) {
+  for (size_t i=0; i<n; ++i) y[i] = exp1(x[i]);
+}
+
+void bob::math::fastLog(const double* x, double* y, size_t n) {
+  for (size_t i=0; i<n; ++i) y[i] = log1(x[i]);
+}
+
+void bob::math::fastExp_(const blitz::Array<double,1>& x,
+    blitz::Array<double,1>& y) {
+  apply(x, y, bob::math::fastExp);
+}
+
+void bob::math::fastLog_(const blitz::Array<double,1>& x,
+    blitz::Array<double,1>& y) {
+  apply(x, y, bob::math::fastLog);
+}
@@ -0,0 +1,224 @@
+/**
+ * @file math/cxx/linear.cc
+ * @date Mon Oct 19 19:12:37 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Double precision products dispatched to the BLAS
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/math/linear.h>
+
+// Declaration of the external BLAS functions
+extern "C" void dgemm_( const char *transa, const char *transb, const int *m,
+  const int *n, const int *k, const double *alpha, const double *a,
+  const int *lda, const double *b, const int *ldb, const double *beta,
+  double *c, const int *ldc);
+extern "C" void dgemv_( const char *trans, const int *m, const int *n,
+  const double *alpha, const double *a, const int *lda, const double *x,
+  const int *incx, const double *beta, double *y, const int *incy);
+extern "C" void dger_( const int *m, const int *n, const double *alpha,
+  const double *x, const int *incx, const double *y, const int *incy,
+  double *a, const int *lda);
+
+static bool s_use_blas = true;
+static uint64_t s_blas_threshold = 512;
+
+void bob::math::set_use_blas(bool use) {
+  s_use_blas = use;
+}
+
+bool bob::math::use_blas() {
+  return s_use_blas;
+}
+
+void bob::math::set_blas_threshold(uint64_t n) {
+  s_blas_threshold = n;
+}
+
+uint64_t bob::math::blas_threshold() {
+  return s_blas_threshold;
+}
+
+namespace {
+
+  /**
+   * How a 2D array is seen by the (column-major) BLAS: either as itself
+   * (Fortran order) or as its transpose (C order), with a leading dimension
+   */
+  struct Layout {
+    bool valid;
+    bool transposed; ///< true if the BLAS sees the transpose of the array
+    int ld; ///< leading dimension
+  };
+
+  static Layout layout(const blitz::Array<double,2>& A) {
+    Layout retval = {false, false, 0};
+    const int rows = A.extent(0);
+    const int cols = A.extent(1);
+    if (A.stride(1) == 1 && (rows == 1 || A.stride(0) >= std::max(cols, 1))) {
+      retval.valid = true;
+      retval.transposed = true;
+      retval.ld = (rows == 1) ? std::max(cols, 1) : A.stride(0);
+    }
+    else if (A.stride(0) == 1 && (cols == 1 || A.stride(1) >= std::max(rows, 1))) {
+      retval.valid = true;
+      retval.transposed = false;
+      retval.ld = (cols == 1) ? std::max(rows, 1) : A.stride(1);
+    }
+    return retval;
+  }
+
+  static bool valid(const blitz::Array<double,1>& a) {
+    return a.stride(0) > 0;
+  }
+
+  static bool large_enough(uint64_t multiply_adds) {
+    return s_use_blas && multiply_adds >= s_blas_threshold;
+  }
+
+}
+
+void bob::math::prod_(const blitz::Array<double,2>& A,
+    const blitz::Array<double,2>& B, blitz::Array<double,2>& C) {
+  const int M = A.extent(0);
+  const int N = A.extent(1);
+  const int P = B.extent(1);
+  if (M == 0 || N == 0 || P == 0 ||
+      !large_enough((uint64_t)M * (uint64_t)N * (uint64_t)P)) {
+    detail::prod_blitz_(A, B, C);
+    return;
+  }
+
+  Layout la = layout(A);
+  Layout lb = layout(B);
+  Layout lc = layout(C);
+  if (!la.valid || !lb.valid || !lc.valid) {
+    detail::prod_blitz_(A, B, C);
+    return;
+  }
+
+  const double alpha = 1.;
+  const double beta = 0.;
+  if (lc.transposed) {
+    // C order output: the BLAS computes C' = B' * A'
+    const char ta = la.transposed ? 'N' : 'T';
+    const char tb = lb.transposed ? 'N' : 'T';
+    dgemm_(&tb, &ta, &P, &M, &N, &alpha, B.data(), &lb.ld, A.data(), &la.ld,
+        &beta, C.data(), &lc.ld);
+  }
+  else {
+    // Fortran order output: the BLAS computes C = A * B
+    const char ta = la.transposed ? 'T' : 'N';
+    const char tb = lb.transposed ? 'T' : 'N';
+    dgemm_(&ta, &tb, &M, &P, &N, &alpha, A.data(), &la.ld, B.data(), &lb.ld,
+        &beta, C.data(), &lc.ld);
+  }
+}
+
+void bob::math::prod_(const blitz::Array<double,2>& A,
+    const blitz::Array<double,1>& b, blitz::Array<double,1>& c) {
+  const int M = A.extent(0);
+  const int N = A.extent(1);
+  if (M == 0 || N == 0 || !large_enough((uint64_t)M * (uint64_t)N)) {
+    detail::prod_blitz_(A, b, c);
+    return;
+  }
+
+  Layout la = layout(A);
+  if (!la.valid || !valid(b) || !valid(c)) {
+    detail::prod_blitz_(A, b, c);
+    return;
+  }
+
+  const double alpha = 1.;
+  const double beta = 0.;
+  const int incb = b.stride(0);
+  const int incc = c.stride(0);
+  if (la.transposed) {
+    // the BLAS sees A' (N x M)
+    const char trans = 'T';
+    dgemv_(&trans, &N, &M, &alpha, A.data(), &la.ld, b.data(), &incb,
+        &beta, c.data(), &incc);
+  }
+  else {
+    const char trans = 'N';
+    dgemv_(&trans, &M, &N, &alpha, A.data(), &la.ld, b.data(), &incb,
+        &beta, c.data(), &incc);
+  }
+}
+
+void bob::math::prod_(const blitz::Array<double,1>& a,
+    const blitz::Array<double,2>& B, blitz::Array<double,1>& c) {
+  const int M = B.extent(0);
+  const int N = B.extent(1);
+  if (M == 0 || N == 0 || !large_enough((uint64_t)M * (uint64_t)N)) {
+    detail::prod_blitz_(a, B, c);
+    return;
+  }
+
+  Layout lb = layout(B);
+  if (!lb.valid || !valid(a) || !valid(c)) {
+    detail::prod_blitz_(a, B, c);
+    return;
+  }
+
+  // c = B' * a
+  const double alpha = 1.;
+  const double beta = 0.;
+  const int inca = a.stride(0);
+  const int incc = c.stride(0);
+  if (lb.transposed) {
+    // the BLAS sees B' (N x M)
+    const char trans = 'N';
+    dgemv_(&trans, &N, &M, &alpha, B.data(), &lb.ld, a.data(), &inca,
+        &beta, c.data(), &incc);
+  }
+  else {
+    const char trans = 'T';
+    dgemv_(&trans, &M, &N, &alpha, B.data(), &lb.ld, a.data(), &inca,
+        &beta, c.data(), &incc);
+  }
+}
+
+void bob::math::prod_(const blitz::Array<double,1>& a,
+    const blitz::Array<double,1>& b, blitz::Array<double,2>& C) {
+  const int M = a.extent(0);
+  const int N = b.extent(0);
+  if (M == 0 || N == 0 || !large_enough((uint64_t)M * (uint64_t)N)) {
+    detail::prod_blitz_(a, b, C);
+    return;
+  }
+
+  Layout lc = layout(C);
+  if (!lc.valid || !valid(a) || !valid(b)) {
+    detail::prod_blitz_(a, b, C);
+    return;
+  }
+
+  // dger accumulates into its output
+  C = 0.;
+  const double alpha = 1.;
+  const int inca = a.stride(0);
+  const int incb = b.stride(0);
+  if (lc.transposed) {
+    // the BLAS sees C' = b * a'
+    dger_(&N, &M, &alpha, b.data(), &incb, a.data(), &inca, C.data(), &lc.ld);
+  }
+  else {
+    dger_(&M, &N, &alpha, a.data(), &inca, b.data(), &incb, C.data(), &lc.ld);
+  }
+}
@@ -50,29 +50,23 @@ void bob::math::linsolve(const blitz::Array<double,2>& A, blitz::Array<double,1>
 
 void bob::math::linsolve_(const blitz::Array<double,2>& A, blitz::Array<double,1>& x,
   const blitz::Array<double,1>& b)
+{
+  bob::math::LapackWorkspace ws;
+  bob::math::linsolve_(A, x, b, ws);
+}
+
+void bob::math::linsolve_(const blitz::Array<double,2>& A, blitz::Array<double,1>& x,
+  const blitz::Array<double,1>& b, bob::math::LapackWorkspace& ws)
 {
   // Defines dimensionality variables
   const int N = A.extent(0);
 
   // Prepares to call LAPACK function
-  // Initialises LAPACK arrays
-  boost::shared_array<int> ipiv(new int[N]);
-  // Transpose (C: row major order, Fortran: column major)
-  // Ugly fix for old blitz version support
-  blitz::Array<double,2> A_blitz_lapack(
-    bob::core::array::ccopy(const_cast<blitz::Array<double,2>&>(A).transpose(1,0)));
-  double* A_lapack = A_blitz_lapack.data();
-  // Tries to use X directly
-  bool x_direct_use = bob::core::array::isCZeroBaseContiguous(x);
-  blitz::Array<double,1> x_blitz_lapack;
-  if (x_direct_use)
-  {
-    x_blitz_lapack.reference(x);
-    x_blitz_lapack = b;
-  }
-  else
-    x_blitz_lapack.reference(bob::core::array::ccopy(b));
-  double *x_lapack = x_blitz_lapack.data();
+  // Initialises LAPACK arrays (column-major copies, reused from the
+  // workspace)
+  int* ipiv = ws.ints(0, N);
+  double* A_lapack = ws.columnMajor(0, A);
+  double* x_lapack = ws.vector(1, b);
   // Remaining variables
   int info = 0;
   const int lda = N;
@@ -80,15 +74,14 @@ void bob::math::linsolve_(const blitz::Array<double,2>& A, blitz::Array<double,1
   const int NRHS = 1;
 
   // Calls the LAPACK function (dgesv(
-  dgesv_( &N, &NRHS, A_lapack, &lda, ipiv.get(), x_lapack, &ldb, &info );
+  dgesv_( &N, &NRHS, A_lapack, &lda, ipiv, x_lapack, &ldb, &info );
 
   // Check info variable
   if (info != 0)
     throw std::runtime_error("The LAPACK dgesv function returned a non-zero value.");
 
-  // Copy result back to x if required
-  if (!x_direct_use)
-    x = x_blitz_lapack;
+  // Copy result back to x
+  bob::math::LapackWorkspace::fromVector(x_lapack, x);
 }
 
 
@@ -109,33 +102,24 @@ void bob::math::linsolve(const blitz::Array<double,2>& A, blitz::Array<double,2>
 
 void bob::math::linsolve_(const blitz::Array<double,2>& A, blitz::Array<double,2>& X,
   const blitz::Array<double,2>& B)
+{
+  bob::math::LapackWorkspace ws;
+  bob::math::linsolve_(A, X, B, ws);
+}
+
+void bob::math::linsolve_(const blitz::Array<double,2>& A, blitz::Array<double,2>& X,
+  const blitz::Array<double,2>& B, bob::math::LapackWorkspace& ws)
 {
   // Defines dimensionality variables
   const int N = A.extent(0);
   const int P = X.extent(1);
 
   // Prepares to call LAPACK function (dgesv)
-  // Initialises LAPACK arrays
-  boost::shared_array<int> ipiv(new int[N]);
-  // Transpose (C: row major order, Fortran: column major)
-  // Ugly fix for old blitz version support
-  blitz::Array<double,2> A_blitz_lapack(
-    bob::core::array::ccopy(const_cast<blitz::Array<double,2>&>(A).transpose(1,0)));
-  double* A_lapack = A_blitz_lapack.data();
-  // Tries to use X directly
-  blitz::Array<double,2> Xt = X.transpose(1,0);
-  bool X_direct_use = bob::core::array::isCZeroBaseContiguous(Xt);
-  blitz::Array<double,2> X_blitz_lapack;
-  if (X_direct_use)
-  {
-    X_blitz_lapack.reference(Xt);
-    // Ugly fix for old blitz version support
-    X_blitz_lapack = const_cast<blitz::Array<double,2>&>(B).transpose(1,0);
-  }
-  else
-    X_blitz_lapack.reference(
-      bob::core::array::ccopy(const_cast<blitz::Array<double,2>&>(B).transpose(1,0)));
-  double *X_lapack = X_blitz_lapack.data();
+  // Initialises LAPACK arrays (column-major copies, reused from the
+  // workspace)
+  int* ipiv = ws.ints(0, N);
+  double* A_lapack = ws.columnMajor(0, A);
+  double* X_lapack = ws.columnMajor(1, B);
   // Remaining variables
   int info = 0;
   const int lda = N;
@@ -143,15 +127,14 @@ void bob::math::linsolve_(const blitz::Array<double,2>& A, blitz::Array<double,2
   const int NRHS = P;
 
   // Calls the LAPACK function (dgesv)
-  dgesv_( &N, &NRHS, A_lapack, &lda, ipiv.get(), X_lapack, &ldb, &info );
+  dgesv_( &N, &NRHS, A_lapack, &lda, ipiv, X_lapack, &ldb, &info );
 
   // Checks info variable
   if (info != 0)
-    throw std::runtime_error("The LAPACK dgesdd function returned a non-zero value.");
+    throw std::runtime_error("The LAPACK dgesv function returned a non-zero value.");
 
-  // Copy result back to X if required
-  if (!X_direct_use )
-    X = X_blitz_lapack.transpose(1,0);
+  // Copy result back to X
+  bob::math::LapackWorkspace::fromColumnMajor(X_lapack, X);
 }
 
 
@@ -175,28 +158,23 @@ void bob::math::linsolveSympos(const blitz::Array<double,2>& A,
 
 void bob::math::linsolveSympos_(const blitz::Array<double,2>& A,
   blitz::Array<double,1>& x, const blitz::Array<double,1>& b)
+{
+  bob::math::LapackWorkspace ws;
+  bob::math::linsolveSympos_(A, x, b, ws);
+}
+
+void bob::math::linsolveSympos_(const blitz::Array<double,2>& A,
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& b,
+  bob::math::LapackWorkspace& ws)
 {
   // Defines dimensionality variables
   const int N = A.extent(0);
 
   // Prepares to call LAPACK function
-  // Initialises LAPACK arrays
-  // Transpose (C: row major order, Fortran: column major)
-  // Ugly fix for old blitz version support
-  blitz::Array<double,2> A_blitz_lapack(
-    bob::core::array::ccopy(const_cast<blitz::Array<double,2>&>(A).transpose(1,0)));
-  double* A_lapack = A_blitz_lapack.data();
-  // Tries to use X directly
-  bool x_direct_use = bob::core::array::isCZeroBaseContiguous(x);
-  blitz::Array<double,1> x_blitz_lapack;
-  if (x_direct_use)
-  {
-    x_blitz_lapack.reference(x);
-    x_blitz_lapack = b;
-  }
-  else
-    x_blitz_lapack.reference(bob::core::array::ccopy(b));
-  double *x_lapack = x_blitz_lapack.data();
+  // Initialises LAPACK arrays (column-major copies, reused from the
+  // workspace)
+  double* A_lapack = ws.columnMajor(0, A);
+  double* x_lapack = ws.vector(1, b);
   // Remaining variables
   int info = 0;
   const char uplo = 'U';
@@ -213,9 +191,8 @@ void bob::math::linsolveSympos_(const blitz::Array<double,2>& A,
       non-zero value. This might be caused by a non-symmetric definite \
       positive matrix.");
 
-  // Copy result back to x if required
-  if (!x_direct_use )
-    x = x_blitz_lapack;
+  // Copy result back to x
+  bob::math::LapackWorkspace::fromVector(x_lapack, x);
 }
 
 void bob::math::linsolveSympos(const blitz::Array<double,2>& A, blitz::Array<double,2>& X,
@@ -235,32 +212,23 @@ void bob::math::linsolveSympos(const blitz::Array<double,2>& A, blitz::Array<dou
 
 void bob::math::linsolveSympos_(const blitz::Array<double,2>& A, blitz::Array<double,2>& X,
   const blitz::Array<double,2>& B)
+{
+  bob::math::LapackWorkspace ws;
+  bob::math::linsolveSympos_(A, X, B, ws);
+}
+
+void bob::math::linsolveSympos_(const blitz::Array<double,2>& A, blitz::Array<double,2>& X,
+  const blitz::Array<double,2>& B, bob::math::LapackWorkspace& ws)
 {
   // Defines dimensionality variables
   const int N = A.extent(0);
   const int P = X.extent(1);
 
   // Prepares to call LAPACK function (dposv)
-  // Initialises LAPACK arrays
-  // Transpose (C: row major order, Fortran: column major)
-  // Ugly fix for old blitz version support
-  blitz::Array<double,2> A_blitz_lapack(
-    bob::core::array::ccopy(const_cast<blitz::Array<double,2>&>(A).transpose(1,0)));
-  double* A_lapack = A_blitz_lapack.data();
-  // Tries to use X directly
-  blitz::Array<double,2> Xt = X.transpose(1,0);
-  bool X_direct_use = bob::core::array::isCZeroBaseContiguous(Xt);
-  blitz::Array<double,2> X_blitz_lapack;
-  if (X_direct_use)
-  {
-    X_blitz_lapack.reference(Xt);
-    // Ugly fix for old blitz version support
-    X_blitz_lapack = const_cast<blitz::Array<double,2>&>(B).transpose(1,0);
-  }
-  else
-    X_blitz_lapack.reference(
-      bob::core::array::ccopy(const_cast<blitz::Array<double,2>&>(B).transpose(1,0)));
-  double *X_lapack = X_blitz_lapack.data();
+  // Initialises LAPACK arrays (column-major copies, reused from the
+  // workspace)
+  double* A_lapack = ws.columnMajor(0, A);
+  double* X_lapack = ws.columnMajor(1, B);
   // Remaining variables
   int info = 0;
   const char uplo = 'U';
@@ -277,9 +245,8 @@ void bob::math::linsolveSympos_(const blitz::Array<double,2>& A, blitz::Array<do
       non-zero value. This might be caused by a non-symmetric definite \
       positive matrix.");
 
-  // Copy result back to X if required
-  if (!X_direct_use)
-    X = X_blitz_lapack.transpose(1,0);
+  // Copy result back to X
+  bob::math::LapackWorkspace::fromColumnMajor(X_lapack, X);
 }
 
 
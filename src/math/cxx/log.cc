@@ -19,8 +19,10 @@
  */
 
 #include <stdexcept>
+#include <algorithm>
 #include <boost/format.hpp>
 #include <bob/math/log.h>
+#include <bob/math/kernels.h>
 #include <bob/core/logging.h>
 
 /**
@@ -78,3 +80,46 @@ double bob::math::Log::logSub(double log_a, double log_b)
   else return log_a + log1p(-exp(minusdif));
 }
 
+
+/**
+ * Computes log(sum_i exp(log_a_i)) as max + log(sum_i exp(log_a_i - max)),
+ * with the exponentials evaluated in blocks by the vectorised kernel
+ */
+double bob::math::Log::logSumExp(const double* log_a, size_t n)
+{
+  if(n == 0) return bob::math::Log::LogZero;
+
+  double max = log_a[0];
+  for(size_t i=1; i<n; ++i) max = (log_a[i] > max) ? log_a[i] : max;
+  for(size_t i=0; i<n; ++i)
+  {
+    if(std::isnan(log_a[i]))
+    {
+      boost::format m("logsumexp: log_a[%u] is nan");
+      m % i;
+      throw std::runtime_error(m.str());
+    }
+  }
+  if(max <= bob::math::Log::LogZero) return bob::math::Log::LogZero;
+  if(std::isinf(max)) return max;
+
+  static const size_t BLOCK = 256;
+  double buffer[BLOCK];
+  double sum = 0.;
+  for(size_t start=0; start<n; start+=BLOCK)
+  {
+    const size_t len = std::min(n - start, BLOCK);
+    for(size_t i=0; i<len; ++i) buffer[i] = log_a[start+i] - max;
+    bob::math::fastExp(buffer, buffer, len);
+    for(size_t i=0; i<len; ++i) sum += buffer[i];
+  }
+  // the largest term contributes exactly 1 to the sum
+  return max + log1p(sum - 1.);
+}
+
+double bob::math::Log::logSumExp(const blitz::Array<double,1>& log_a)
+{
+  if(log_a.stride(0) == 1) return logSumExp(log_a.data(), log_a.extent(0));
+  blitz::Array<double,1> tmp(log_a.copy());
+  return logSumExp(tmp.data(), tmp.extent(0));
+}
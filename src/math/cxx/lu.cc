@@ -32,6 +32,12 @@ extern "C" void dgetrf_( const int *M, const int *N, double *A,
 // Cholesky decomposition of a real symmetric definite-positive matrix (dpotrf)
 extern "C" void dpotrf_( const char *uplo, const int *N, double *A,
   const int *lda, int *info);
+// Solves a system given the Cholesky decomposition of its matrix (dpotrs)
+extern "C" void dpotrs_( const char *uplo, const int *N, const int *NRHS,
+  const double *A, const int *lda, double *B, const int *ldb, int *info);
+// Inverse of a matrix given its Cholesky decomposition (dpotri)
+extern "C" void dpotri_( const char *uplo, const int *N, double *A,
+  const int *lda, int *info);
 
 
 void bob::math::lu(const blitz::Array<double,2>& A, blitz::Array<double,2>& L,
@@ -131,6 +137,13 @@ void bob::math::chol(const blitz::Array<double,2>& A,
 
 void bob::math::chol_(const blitz::Array<double,2>& A,
   blitz::Array<double,2>& L)
+{
+  bob::math::LapackWorkspace ws;
+  bob::math::chol_(A, L, ws);
+}
+
+void bob::math::chol_(const blitz::Array<double,2>& A,
+  blitz::Array<double,2>& L, bob::math::LapackWorkspace& ws)
 {
   // Size variable
   const int N = A.extent(0);
@@ -141,19 +154,9 @@ void bob::math::chol_(const blitz::Array<double,2>& A,
   const int lda = N;
   const char uplo = 'L';
 
-  // Initialises LAPACK arrays
-  blitz::Array<double,2> A_blitz_lapack;
-  // Tries to use V directly
-  blitz::Array<double,2> Lt = L.transpose(1,0);
-  const bool Lt_direct_use = bob::core::array::isCZeroBaseContiguous(Lt);
-  if (Lt_direct_use)
-  {
-    A_blitz_lapack.reference(Lt);
-    A_blitz_lapack = A;
-  }
-  else
-    A_blitz_lapack.reference(bob::core::array::ccopy(A));
-  double *A_lapack = A_blitz_lapack.data();
+  // Initialises LAPACK arrays (column-major copy, reused from the
+  // workspace)
+  double *A_lapack = ws.columnMajor(0, A);
 
   // Calls the LAPACK function
   dpotrf_( &uplo, &N, A_lapack, &lda, &info);
@@ -162,13 +165,166 @@ void bob::math::chol_(const blitz::Array<double,2>& A,
   if (info != 0)
     throw std::runtime_error("The LAPACK dpotrf function returned a non-zero value.");
 
-  // Copy result back to L if required
-  if (!Lt_direct_use)
-    Lt = A_blitz_lapack;
+  // Copy result back to L, setting the strictly upper triangular part to 0
+  for (int j=0; j<N; ++j) {
+    for (int i=0; i<j; ++i) L(i,j) = 0.;
+    for (int i=j; i<N; ++i) L(i,j) = A_lapack[i + j*N];
+  }
+}
+
+
+void bob::math::cholSolve(const blitz::Array<double,2>& L,
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& b)
+{
+  // Check
+  bob::core::array::assertZeroBase(L);
+  bob::core::array::assertZeroBase(x);
+  bob::core::array::assertZeroBase(b);
+  bob::core::array::assertSameDimensionLength(L.extent(0), L.extent(1));
+  bob::core::array::assertSameDimensionLength(L.extent(0), x.extent(0));
+  bob::core::array::assertSameDimensionLength(x.extent(0), b.extent(0));
+
+  bob::math::cholSolve_(L, x, b);
+}
+
+void bob::math::cholSolve_(const blitz::Array<double,2>& L,
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& b)
+{
+  bob::math::LapackWorkspace ws;
+  bob::math::cholSolve_(L, x, b, ws);
+}
+
+void bob::math::cholSolve_(const blitz::Array<double,2>& L,
+  blitz::Array<double,1>& x, const blitz::Array<double,1>& b,
+  bob::math::LapackWorkspace& ws)
+{
+  // Size variable
+  const int N = L.extent(0);
+
+  // Prepares to call LAPACK function
+  // Initialises LAPACK variables
+  int info = 0;
+  const char uplo = 'L';
+  const int lda = N;
+  const int ldb = N;
+  const int NRHS = 1;
+
+  // Initialises LAPACK arrays (copies, reused from the workspace)
+  double *L_lapack = ws.columnMajor(0, L);
+  double *x_lapack = ws.vector(1, b);
+
+  // Calls the LAPACK function
+  dpotrs_( &uplo, &N, &NRHS, L_lapack, &lda, x_lapack, &ldb, &info);
+
+  // Checks info variable
+  if (info != 0)
+    throw std::runtime_error("The LAPACK dpotrs function returned a non-zero value.");
+
+  // Copy result back to x
+  bob::math::LapackWorkspace::fromVector(x_lapack, x);
+}
+
+void bob::math::cholSolve(const blitz::Array<double,2>& L,
+  blitz::Array<double,2>& X, const blitz::Array<double,2>& B)
+{
+  // Check
+  bob::core::array::assertZeroBase(L);
+  bob::core::array::assertZeroBase(X);
+  bob::core::array::assertZeroBase(B);
+  bob::core::array::assertSameDimensionLength(L.extent(0), L.extent(1));
+  bob::core::array::assertSameDimensionLength(L.extent(0), X.extent(0));
+  bob::core::array::assertSameShape(X, B);
+
+  bob::math::cholSolve_(L, X, B);
+}
+
+void bob::math::cholSolve_(const blitz::Array<double,2>& L,
+  blitz::Array<double,2>& X, const blitz::Array<double,2>& B)
+{
+  bob::math::LapackWorkspace ws;
+  bob::math::cholSolve_(L, X, B, ws);
+}
+
+void bob::math::cholSolve_(const blitz::Array<double,2>& L,
+  blitz::Array<double,2>& X, const blitz::Array<double,2>& B,
+  bob::math::LapackWorkspace& ws)
+{
+  // Size variables
+  const int N = L.extent(0);
+  const int P = X.extent(1);
+
+  // Prepares to call LAPACK function
+  // Initialises LAPACK variables
+  int info = 0;
+  const char uplo = 'L';
+  const int lda = N;
+  const int ldb = N;
+  const int NRHS = P;
+
+  // Initialises LAPACK arrays (column-major copies, reused from the
+  // workspace)
+  double *L_lapack = ws.columnMajor(0, L);
+  double *X_lapack = ws.columnMajor(1, B);
+
+  // Calls the LAPACK function
+  dpotrs_( &uplo, &N, &NRHS, L_lapack, &lda, X_lapack, &ldb, &info);
+
+  // Checks info variable
+  if (info != 0)
+    throw std::runtime_error("The LAPACK dpotrs function returned a non-zero value.");
+
+  // Copy result back to X
+  bob::math::LapackWorkspace::fromColumnMajor(X_lapack, X);
+}
+
+
+void bob::math::cholInv(const blitz::Array<double,2>& A,
+  blitz::Array<double,2>& B)
+{
+  // Check
+  bob::core::array::assertZeroBase(A);
+  bob::core::array::assertZeroBase(B);
+  bob::core::array::assertSameDimensionLength(A.extent(0), A.extent(1));
+  bob::core::array::assertSameShape(A, B);
+
+  bob::math::cholInv_(A, B);
+}
+
+void bob::math::cholInv_(const blitz::Array<double,2>& A,
+  blitz::Array<double,2>& B)
+{
+  bob::math::LapackWorkspace ws;
+  bob::math::cholInv_(A, B, ws);
+}
+
+void bob::math::cholInv_(const blitz::Array<double,2>& A,
+  blitz::Array<double,2>& B, bob::math::LapackWorkspace& ws)
+{
+  // Size variable
+  const int N = A.extent(0);
+
+  // Prepares to call LAPACK functions
+  // Initialises LAPACK variables
+  int info = 0;
+  const char uplo = 'L';
+  const int lda = N;
+
+  // Initialises LAPACK arrays (column-major copy, reused from the
+  // workspace)
+  double *A_lapack = ws.columnMajor(0, A);
+
+  // Calls the LAPACK functions
+  // A/ Cholesky decomposition
+  dpotrf_( &uplo, &N, A_lapack, &lda, &info);
+  if (info != 0)
+    throw std::runtime_error("The LAPACK dpotrf function returned a non-zero value. This might be caused by a non-symmetric definite positive matrix.");
+  // B/ Inverse from the decomposition (lower triangular part only)
+  dpotri_( &uplo, &N, A_lapack, &lda, &info);
+  if (info != 0)
+    throw std::runtime_error("The LAPACK dpotri function returned a non-zero value.");
 
-  // Sets strictly upper triangular part to 0
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  L = blitz::where(i < j, 0, L);
+  // Copy result back to B, mirroring the lower triangular part
+  for (int j=0; j<N; ++j)
+    for (int i=j; i<N; ++i) B(i,j) = B(j,i) = A_lapack[i + j*N];
 }
 
@@ -150,6 +150,13 @@ void bob::math::svd(const blitz::Array<double,2>& A, blitz::Array<double,2>& U,
 
 void bob::math::svd_(const blitz::Array<double,2>& A, blitz::Array<double,2>& U,
   blitz::Array<double,1>& sigma)
+{
+  bob::math::LapackWorkspace ws;
+  bob::math::svd_(A, U, sigma, ws);
+}
+
+void bob::math::svd_(const blitz::Array<double,2>& A, blitz::Array<double,2>& U,
+  blitz::Array<double,1>& sigma, bob::math::LapackWorkspace& ws)
 {
   // Size variables
   const int M = A.extent(0);
@@ -166,26 +173,13 @@ void bob::math::svd_(const blitz::Array<double,2>& A, blitz::Array<double,2>& U,
   const int ldvt = std::min(M,N);
 
   // Integer (workspace) array, dimension (8*min(M,N))
-  const int l_iwork = 8*std::min(M,N);
-  boost::shared_array<int> iwork(new int[l_iwork]);
-  // Initialises LAPACK arrays
-  blitz::Array<double,2> A_blitz_lapack(bob::core::array::ccopy(const_cast<blitz::Array<double,2>&>(A).transpose(1,0)));
-  double* A_lapack = A_blitz_lapack.data();
-  // Tries to use U and S directly to limit the number of copy()
-  // S_lapack = S
-  blitz::Array<double,1> S_blitz_lapack;
-  const bool sigma_direct_use = bob::core::array::isCZeroBaseContiguous(sigma);
-  if (!sigma_direct_use) S_blitz_lapack.resize(nb_singular);
-  else                   S_blitz_lapack.reference(sigma);
-  double *S_lapack = S_blitz_lapack.data();
-  // U_lapack = U^T
-  blitz::Array<double,2> U_blitz_lapack;
-  blitz::Array<double,2> Ut = U.transpose(1,0);
-  const bool U_direct_use = bob::core::array::isCZeroBaseContiguous(Ut);
-  if (!U_direct_use) U_blitz_lapack.resize(nb_singular,M);
-  else               U_blitz_lapack.reference(Ut);
-  double *U_lapack = U_blitz_lapack.data();
-  boost::shared_array<double> VT_lapack(new double[nb_singular*N]);
+  int *iwork = ws.ints(0, 8*std::min(M,N));
+  // Initialises LAPACK arrays (column-major copies, reused from the
+  // workspace)
+  double *A_lapack = ws.columnMajor(0, A);
+  double *S_lapack = ws.doubles(1, nb_singular);
+  double *U_lapack = ws.doubles(2, (size_t)M*nb_singular);
+  double *VT_lapack = ws.doubles(3, (size_t)nb_singular*N);
 
   // Calls the LAPACK function:
   // We use dgesdd which is faster than its predecessor dgesvd, when
@@ -193,24 +187,29 @@ void bob::math::svd_(const blitz::Array<double,2>& A, blitz::Array<double,2>& U,
   //   (cf. http://www.netlib.org/lapack/lug/node71.html)
   // Please note that matlab is relying on dgesvd.
 
-  // A/ Queries the optimal size of the working array
-  const int lwork_query = -1;
-  double work_query;
-  dgesdd_( &jobz, &M, &N, A_lapack, &lda, S_lapack, U_lapack, &ldu,
-    VT_lapack.get(), &ldvt, &work_query, &lwork_query, iwork.get(), &info );
+  // A/ Queries the optimal size of the working array (once per size)
+  int lwork, liwork;
+  if (!ws.getWorkSize("dgesdd", M, N, lwork, liwork)) {
+    const int lwork_query = -1;
+    double work_query;
+    dgesdd_( &jobz, &M, &N, A_lapack, &lda, S_lapack, U_lapack, &ldu,
+      VT_lapack, &ldvt, &work_query, &lwork_query, iwork, &info );
+    lwork = static_cast<int>(work_query);
+    liwork = 8*std::min(M,N);
+    ws.setWorkSize("dgesdd", M, N, lwork, liwork);
+  }
   // B/ Computes
-  const int lwork = static_cast<int>(work_query);
-  boost::shared_array<double> work(new double[lwork]);
+  double *work = ws.doubles(4, lwork);
   dgesdd_( &jobz, &M, &N, A_lapack, &lda, S_lapack, U_lapack, &ldu,
-    VT_lapack.get(), &ldvt, work.get(), &lwork, iwork.get(), &info );
+    VT_lapack, &ldvt, work, &lwork, iwork, &info );
 
   // Check info variable
   if (info != 0)
     throw std::runtime_error("The LAPACK dgesdd function returned a non-zero value.");
 
-  // Copy singular vectors back to U, V and sigma if required
-  if (!U_direct_use) Ut = U_blitz_lapack;
-  if (!sigma_direct_use) sigma = S_blitz_lapack;
+  // Copy singular vectors and values back to U and sigma
+  bob::math::LapackWorkspace::fromColumnMajor(U_lapack, U);
+  bob::math::LapackWorkspace::fromVector(S_lapack, sigma);
 }
 
 
@@ -0,0 +1,130 @@
+/**
+ * @file math/cxx/test/kernels.cc
+ * @date Mon Oct 19 21:14:02 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Test the vectorised kernels and the log-sum-exp
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE math-kernels Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <bob/math/kernels.h>
+#include <bob/math/log.h>
+
+struct T {
+  double eps;
+  T(): eps(1e-10) {} // Tolerance in percentage
+  ~T() {}
+};
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_fast_exp )
+{
+  std::vector<double> x, y;
+  for (double v=-700.; v<=700.; v+=0.37) x.push_back(v);
+  y.resize(x.size());
+  bob::math::fastExp(&x[0], &y[0], x.size());
+  for (size_t i=0; i<x.size(); ++i) BOOST_CHECK_CLOSE(y[i], std::exp(x[i]), eps);
+
+  const double special[] = {0., -1000., 1000.,
+    -std::numeric_limits<double>::infinity()};
+  double out[4];
+  bob::math::fastExp(special, out, 4);
+  BOOST_CHECK_EQUAL(out[0], 1.);
+  BOOST_CHECK_EQUAL(out[1], 0.);
+  BOOST_CHECK(std::isinf(out[2]));
+  BOOST_CHECK_EQUAL(out[3], 0.);
+}
+
+BOOST_AUTO_TEST_CASE( test_fast_log )
+{
+  std::vector<double> x, y;
+  for (double v=-300.; v<=300.; v+=0.29) x.push_back(std::pow(10., v));
+  x.push_back(5e-320); //subnormal
+  y.resize(x.size());
+  bob::math::fastLog(&x[0], &y[0], x.size());
+  for (size_t i=0; i<x.size(); ++i) BOOST_CHECK_CLOSE(y[i], std::log(x[i]), eps);
+
+  const double special[] = {1., 0., -1.};
+  double out[3];
+  bob::math::fastLog(special, out, 3);
+  BOOST_CHECK_EQUAL(out[0], 0.);
+  BOOST_CHECK(std::isinf(out[1]) && out[1] < 0.);
+  BOOST_CHECK(std::isnan(out[2]));
+}
+
+BOOST_AUTO_TEST_CASE( test_fast_exp_strided )
+{
+  blitz::Array<double,2> A(3,5);
+  A = -2., -1., 0., 1., 2.,
+      -4., -3., 0., 3., 4.,
+      0.5, 1.5, 2.5, 3.5, 4.5;
+  blitz::Array<double,1> c = A(blitz::Range::all(), 1);
+  blitz::Array<double,1> out(3);
+  bob::math::fastExp_(c, out);
+  for (int i=0; i<3; ++i) BOOST_CHECK_CLOSE(out(i), std::exp(c(i)), eps);
+}
+
+BOOST_AUTO_TEST_CASE( test_mahalanobis_diag )
+{
+  blitz::Array<double,1> x(7), mean(7), variance(7), precision(7);
+  x = 1., 2., 3., 4., 5., 6., 7.;
+  mean = 0.5, -1., 2., 3.5, 0., 1., 9.;
+  variance = 1., 2., 0.5, 4., 3., 0.25, 1.5;
+  precision = 1. / variance;
+  const double ref = blitz::sum(blitz::pow2(x - mean) / variance);
+  BOOST_CHECK_CLOSE(bob::math::mahalanobisDiag_(x, mean, precision), ref, eps);
+
+  // strided input
+  blitz::Array<double,1> x2(14);
+  x2 = 0.;
+  blitz::Array<double,1> xs = x2(blitz::Range(0, 12, 2));
+  xs = x;
+  BOOST_CHECK_CLOSE(bob::math::mahalanobisDiag_(xs, mean, precision), ref, eps);
+}
+
+BOOST_AUTO_TEST_CASE( test_log_sum_exp )
+{
+  blitz::Array<double,1> a(600);
+  for (int i=0; i<a.extent(0); ++i) a(i) = -0.05 * i + std::sin(i);
+  double ref = bob::math::Log::LogZero;
+  for (int i=0; i<a.extent(0); ++i) ref = bob::math::Log::logAdd(ref, a(i));
+  BOOST_CHECK_CLOSE(bob::math::Log::logSumExp(a), ref, eps);
+
+  // strided input
+  blitz::Array<double,1> s = a(blitz::Range(0, 598, 2));
+  double ref2 = bob::math::Log::LogZero;
+  for (int i=0; i<s.extent(0); ++i) ref2 = bob::math::Log::logAdd(ref2, s(i));
+  BOOST_CHECK_CLOSE(bob::math::Log::logSumExp(s), ref2, eps);
+
+  // degenerate cases
+  blitz::Array<double,1> z(3);
+  z = bob::math::Log::LogZero;
+  BOOST_CHECK_EQUAL(bob::math::Log::logSumExp(z), bob::math::Log::LogZero);
+  BOOST_CHECK_EQUAL(bob::math::Log::logSumExp(z.data(), 0),
+      bob::math::Log::LogZero);
+  z(1) = std::numeric_limits<double>::quiet_NaN();
+  BOOST_CHECK_THROW(bob::math::Log::logSumExp(z), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
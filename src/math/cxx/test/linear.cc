@@ -25,6 +25,7 @@
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 #include <bob/math/linear.h>
+#include <vector>
 
 
 struct T {
@@ -101,6 +102,11 @@ void checkBlitzClose( blitz::Array<T,2>& t1, blitz::Array<T,2>& t2,
       BOOST_CHECK_SMALL( fabs( t2(i,j)-t1(i,j) ), eps);
 }
 
+static void fill(blitz::Array<double,2>& A) {
+  for (int i=0; i<A.extent(0); ++i)
+    for (int j=0; j<A.extent(1); ++j) A(i,j) = rand() / (double)RAND_MAX;
+}
+
 BOOST_FIXTURE_TEST_SUITE( test_setup, T )
 
 BOOST_AUTO_TEST_CASE( test_matrix_matrix_prod )
@@ -189,4 +195,70 @@ BOOST_AUTO_TEST_CASE( test_diag_bis )
   checkBlitzClose(dsol_diag_44, sol4, eps);
 }
 
+BOOST_AUTO_TEST_CASE( test_blas_layouts )
+{
+  // products of all sizes go through the BLAS when the layout allows it
+  uint64_t threshold = bob::math::blas_threshold();
+  bob::math::set_blas_threshold(0);
+
+  blitz::Array<double,2> X(9,8), Y(8,7), Z(12,16);
+  fill(X); fill(Y); fill(Z);
+  blitz::Range a = blitz::Range::all();
+
+  // C ordered, Fortran ordered (transposed), sliced and strided operands
+  std::vector<blitz::Array<double,2> > lefts, rights;
+  lefts.push_back(X);
+  lefts.push_back(blitz::Array<double,2>(X.transpose(1,0).copy().transpose(1,0)));
+  lefts.push_back(Z(blitz::Range(1,9), blitz::Range(2,9)));
+  lefts.push_back(Z(blitz::Range(0,10,2), blitz::Range(1,8)));
+  lefts.push_back(Z(blitz::Range(0,4), blitz::Range(0,15,2))); //no BLAS
+  rights.push_back(Y);
+  rights.push_back(blitz::Array<double,2>(Y.transpose(1,0).copy().transpose(1,0)));
+  rights.push_back(Z(blitz::Range(2,9), blitz::Range(3,9)));
+  rights.push_back(Z.transpose(1,0)(blitz::Range(0,7), blitz::Range(4,10)));
+
+  for (size_t l=0; l<lefts.size(); ++l)
+    for (size_t r=0; r<rights.size(); ++r) {
+      const blitz::Array<double,2>& A = lefts[l];
+      const blitz::Array<double,2>& B = rights[r];
+      if (A.extent(1) != B.extent(0)) continue;
+
+      blitz::Array<double,2> ref(A.extent(0), B.extent(1));
+      bob::math::detail::prod_blitz_(A, B, ref);
+      blitz::Array<double,2> C(A.extent(0), B.extent(1));
+      bob::math::prod(A, B, C);
+      checkBlitzClose(ref, C, 1e-10);
+
+      // Fortran ordered output
+      blitz::Array<double,2> Ct(B.extent(1), A.extent(0));
+      blitz::Array<double,2> Cf = Ct.transpose(1,0);
+      bob::math::prod(A, B, Cf);
+      checkBlitzClose(ref, Cf, 1e-10);
+
+      // matrix-vector and vector-matrix with strided vectors
+      blitz::Array<double,1> b = B(a, 1);
+      blitz::Array<double,1> c(A.extent(0));
+      blitz::Array<double,1> cref(A.extent(0));
+      bob::math::detail::prod_blitz_(A, b, cref);
+      bob::math::prod(A, b, c);
+      checkBlitzClose(cref, c, 1e-10);
+
+      blitz::Array<double,1> v = A(2, a);
+      blitz::Array<double,1> d(B.extent(1));
+      blitz::Array<double,1> dref(B.extent(1));
+      bob::math::detail::prod_blitz_(v, B, dref);
+      bob::math::prod(v, B, d);
+      checkBlitzClose(dref, d, 1e-10);
+
+      // outer product
+      blitz::Array<double,2> O(b.extent(0), v.extent(0));
+      blitz::Array<double,2> Oref(b.extent(0), v.extent(0));
+      bob::math::detail::prod_blitz_(b, v, Oref);
+      bob::math::prod(b, v, O);
+      checkBlitzClose(Oref, O, 1e-10);
+    }
+
+  bob::math::set_blas_threshold(threshold);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -30,6 +30,8 @@
 #include <bob/math/det.h>
 #include <bob/math/inv.h>
 #include <bob/math/linear.h>
+#include <bob/math/linsolve.h>
+#include <bob/math/LapackWorkspace.h>
 
 
 struct T {
@@ -154,5 +156,82 @@ BOOST_AUTO_TEST_CASE( test_inv_3x3 )
   checkBlitzClose(I, I33, eps);
 }
 
+BOOST_AUTO_TEST_CASE( test_cholInv_3x3 )
+{
+  blitz::Array<double,2> inv_lu(3,3), inv_chol(3,3);
+
+  // Compares to the LU-based inverse
+  bob::math::inv(A33_2, inv_lu);
+  bob::math::cholInv(A33_2, inv_chol);
+  checkBlitzClose(inv_chol, inv_lu, eps);
+
+  // The result is exactly symmetric
+  for (int i=0; i<3; ++i)
+    for (int j=0; j<3; ++j)
+      BOOST_CHECK_EQUAL(inv_chol(i,j), inv_chol(j,i));
+
+  // Not positive definite
+  BOOST_CHECK_THROW(bob::math::cholInv(A33_1, inv_chol), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_cholSolve_3x3 )
+{
+  blitz::Array<double,2> L(3,3);
+  bob::math::chol(A33_2, L);
+
+  // Single right-hand side
+  blitz::Array<double,1> b(3), x(3), x_ref(3);
+  b = 1., 2., 3.;
+  bob::math::cholSolve(L, x, b);
+  bob::math::linsolve(A33_2, x_ref, b);
+  checkBlitzClose(x, x_ref, eps);
+
+  // Several right-hand sides
+  blitz::Array<double,2> X(3,3), X_ref(3,3);
+  bob::math::cholSolve(L, X, A33_1);
+  bob::math::linsolve(A33_2, X_ref, A33_1);
+  checkBlitzClose(X, X_ref, eps);
+}
+
+BOOST_AUTO_TEST_CASE( test_workspace_reuse )
+{
+  bob::math::LapackWorkspace ws;
+  blitz::Array<double,2> inv(3,3), inv_ref(3,3), L(3,3), X(3,3), X_ref(3,3);
+  blitz::Array<double,1> x(3), x_ref(3), b(3);
+  b = 1., 2., 3.;
+
+  // Interleaves calls of different routines and sizes on the same workspace
+  for (int k=0; k<3; ++k) {
+    bob::math::inv_(A33_1, inv, ws);
+    checkBlitzClose(inv, A33_1_inv, eps);
+
+    blitz::Array<double,2> L22(2,2), A22(2,2), L22_ref(2,2);
+    A22 = 4., 2., 2., 3.;
+    bob::math::chol_(A22, L22, ws);
+    bob::math::chol(A22, L22_ref);
+    checkBlitzClose(L22, L22_ref, eps);
+
+    bob::math::cholInv_(A33_2, inv, ws);
+    bob::math::inv(A33_2, inv_ref);
+    checkBlitzClose(inv, inv_ref, eps);
+
+    bob::math::chol_(A33_2, L, ws);
+    checkBlitzClose(L, L33_2, eps);
+    bob::math::cholSolve_(L, x, b, ws);
+    bob::math::linsolve_(A33_2, x_ref, b, ws);
+    checkBlitzClose(x, x_ref, eps);
+    bob::math::linsolveSympos_(A33_2, X, A33_1, ws);
+    bob::math::linsolve(A33_2, X_ref, A33_1);
+    checkBlitzClose(X, X_ref, eps);
+  }
+
+  // Results may be written to non-contiguous arrays
+  blitz::Array<double,2> big(6,6);
+  big = 0.;
+  blitz::Array<double,2> strided = big(blitz::Range(0,4,2), blitz::Range(1,5,2));
+  bob::math::inv_(A33_1, strided, ws);
+  checkBlitzClose(strided, A33_1_inv, eps);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -26,6 +26,7 @@
 #include <boost/test/unit_test.hpp>
 #include <blitz/array.h>
 #include <bob/math/stats.h>
+#include <bob/math/ScatterAccumulator.h>
 #include <vector>
 
 struct T {
@@ -123,5 +124,65 @@ BOOST_AUTO_TEST_CASE( test_stats )
   }
 }
 
+BOOST_AUTO_TEST_CASE( test_scatter_accumulator )
+{
+  for (int loop=0; loop < 5; ++loop) {
+    // size of the data (more than one tile of features)
+    int M = (rand() % 64 + 2);
+    int N = (rand() % 96 + 40);
+
+    std::vector<blitz::Array<double,2> > data;
+    for (int k=0; k<3; ++k) {
+      blitz::Array<double,2> t(M+k,N);
+      for (int i=0; i < t.extent(0); ++i)
+        for (int j=0; j < N; ++j)
+          t(i,j) = (rand()/(double)RAND_MAX)*10. + k;
+      data.push_back(t);
+    }
+
+    blitz::Array<double,1> mean(N);
+    blitz::Array<double,2> Sw(N,N);
+    blitz::Array<double,2> Sb(N,N);
+    bob::math::scatters(data, Sw, Sb, mean);
+
+    // single pass, several threads and small blocks
+    bob::math::ScatterAccumulator acc(N, data.size(), 4);
+    acc.setBlockSize(7);
+    acc.add(data);
+    blitz::Array<double,1> mean_(N);
+    blitz::Array<double,2> Sw_(N,N);
+    blitz::Array<double,2> Sb_(N,N);
+    acc.getMean(mean_);
+    acc.getWithinScatter(Sw_);
+    acc.getBetweenScatter(Sb_);
+    checkBlitzClose(Sw, Sw_, eps);
+    checkBlitzClose(Sb, Sb_, eps);
+    for (int j=0; j<N; ++j) BOOST_CHECK_SMALL(fabs(mean(j) - mean_(j)), eps);
+
+    // in chunks of one row, split over two merged accumulators
+    bob::math::ScatterAccumulator first(N, data.size(), 1);
+    bob::math::ScatterAccumulator second(N, data.size(), 1);
+    blitz::Range a = blitz::Range::all();
+    for (size_t k=0; k<data.size(); ++k)
+      for (int i=0; i<data[k].extent(0); ++i) {
+        blitz::Array<double,2> row = data[k](blitz::Range(i,i), a);
+        if (i % 2) first.add(row, k);
+        else second.add(row, k);
+      }
+    first.merge(second);
+    BOOST_CHECK_EQUAL(first.getNSamples(), acc.getNSamples());
+    first.getWithinScatter(Sw_);
+    checkBlitzClose(Sw, Sw_, eps);
+
+    // total scatter
+    blitz::Array<double,2> St(N,N);
+    acc.getTotalScatter(St);
+    St -= (Sw + Sb);
+    blitz::Array<double,2> z(N,N);
+    z = 0.;
+    checkBlitzClose(St, z, eps);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
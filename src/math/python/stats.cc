@@ -24,6 +24,7 @@
 #include <bob/python/ndarray.h>
 #include <boost/python/stl_iterator.hpp>
 #include <bob/math/stats.h>
+#include <bob/math/ScatterAccumulator.h>
 
 using namespace boost::python;
 
@@ -293,6 +294,45 @@ static void scatters_M_check(object data, bob::python::ndarray Sw,
 }
 
 
+static void accumulator_add(bob::math::ScatterAccumulator& acc,
+    bob::python::const_ndarray X, size_t k) {
+  acc.add(X.cast<double,2>(), k);
+}
+
+static void accumulator_add_all(bob::math::ScatterAccumulator& acc,
+    object data) {
+  stl_input_iterator<bob::python::const_ndarray> dbegin(data), dend;
+  std::vector<bob::python::const_ndarray> vdata(dbegin, dend);
+  std::vector<blitz::Array<double,2> > vdata_;
+  for (size_t k=0; k<vdata.size(); ++k)
+    vdata_.push_back(vdata[k].cast<double,2>());
+  acc.add(vdata_);
+}
+
+static blitz::Array<double,2> accumulator_sw(const bob::math::ScatterAccumulator& acc) {
+  blitz::Array<double,2> retval(acc.getNFeatures(), acc.getNFeatures());
+  acc.getWithinScatter(retval);
+  return retval;
+}
+
+static blitz::Array<double,2> accumulator_sb(const bob::math::ScatterAccumulator& acc) {
+  blitz::Array<double,2> retval(acc.getNFeatures(), acc.getNFeatures());
+  acc.getBetweenScatter(retval);
+  return retval;
+}
+
+static blitz::Array<double,2> accumulator_st(const bob::math::ScatterAccumulator& acc) {
+  blitz::Array<double,2> retval(acc.getNFeatures(), acc.getNFeatures());
+  acc.getTotalScatter(retval);
+  return retval;
+}
+
+static blitz::Array<double,1> accumulator_mean(const bob::math::ScatterAccumulator& acc) {
+  blitz::Array<double,1> retval(acc.getNFeatures());
+  acc.getMean(retval);
+  return retval;
+}
+
 void bind_math_stats() {
   // Scatter of a matrix
   def("scatter_", &scatter_nocheck, (arg("a"), arg("s")), SCATTER_DOC1);
@@ -311,4 +351,26 @@ void bind_math_stats() {
   def("scatters", &scatters_M_check, (arg("data"), arg("sw"), arg("sb"), arg("m")), SCATTERS_DOC2);
 
   def("scatters", &scatters, (arg("data")), SCATTERS_DOC3);
+
+  class_<bob::math::ScatterAccumulator, boost::shared_ptr<bob::math::ScatterAccumulator> >(
+    "ScatterAccumulator",
+    "Accumulates the within-class scatter matrix, the class means and the class counts of samples (one per row) given in chunks, so that the within-class (sw), between-class (sb) and total (st = sw + sb) scatter matrices can be computed without keeping the samples in memory. With a single class, sw is the scatter matrix of the data, as given by scatter().\n\nChunks are centered in blocks of rows whose products are accumulated into tiles of the scatter matrix by several threads. Results do not depend on the number of threads. Accumulators with the same number of features and classes (e.g. filled by parallel jobs) can be merged.",
+    init<size_t, optional<size_t, size_t> >((arg("self"), arg("n_features"), arg("n_classes")=1, arg("n_threads")=0), "Creates an empty accumulator for the given number of features and classes, using n_threads threads (0 means the number of hardware threads)"))
+    .def(init<const bob::math::ScatterAccumulator&>((arg("self"), arg("other")), "Copy constructor"))
+    .def("add", &accumulator_add, (arg("self"), arg("X"), arg("k")=0), "Accumulates a chunk of samples (one per row) of class k")
+    .def("add_classes", &accumulator_add_all, (arg("self"), arg("data")), "Accumulates data given as an iterable with one 2D array per class, in a single pass over the samples")
+    .def("merge", &bob::math::ScatterAccumulator::merge, (arg("self"), arg("other")), "Accumulates all samples accumulated by another accumulator with the same number of features and classes")
+    .def("reset", &bob::math::ScatterAccumulator::reset, (arg("self")), "Forgets all samples")
+    .add_property("sw", &accumulator_sw, "The within-class scatter matrix")
+    .add_property("sb", &accumulator_sb, "The between-class scatter matrix")
+    .add_property("st", &accumulator_st, "The total scatter matrix, i.e., sw + sb")
+    .add_property("mean", &accumulator_mean, "The overall mean of all samples")
+    .add_property("class_means", make_function(&bob::math::ScatterAccumulator::getClassMeans, return_value_policy<copy_const_reference>()), "The mean of each class (one per column)")
+    .add_property("class_counts", make_function(&bob::math::ScatterAccumulator::getClassCounts, return_value_policy<copy_const_reference>()), "The number of samples of each class")
+    .add_property("n_samples", &bob::math::ScatterAccumulator::getNSamples, "The total number of samples")
+    .add_property("n_features", &bob::math::ScatterAccumulator::getNFeatures, "The number of features")
+    .add_property("n_classes", &bob::math::ScatterAccumulator::getNClasses, "The number of classes")
+    .add_property("n_threads", &bob::math::ScatterAccumulator::getNThreads, &bob::math::ScatterAccumulator::setNThreads, "The number of threads (0 means the number of hardware threads)")
+    .add_property("block_size", &bob::math::ScatterAccumulator::getBlockSize, &bob::math::ScatterAccumulator::setBlockSize, "The number of rows that are centered and accumulated at once")
+    ;
 }
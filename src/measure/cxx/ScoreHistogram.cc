@@ -0,0 +1,411 @@
+/**
+ * @file measure/cxx/ScoreHistogram.cc
+ * @date Mon Oct 19 14:37:08 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Implements the bounded-memory score accumulator
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+#include <boost/format.hpp>
+#include <bob/core/array_copy.h>
+#include <bob/measure/ScoreHistogram.h>
+#include <bob/measure/error.h>
+
+/**
+ * Adds the counts of the source bins into the destination bins. The
+ * destination grid must be coarser than (or equal to) the source grid and
+ * both must be aligned on multiples of their (power of two) widths, so each
+ * source bin falls entirely into a single destination bin.
+ */
+static void accumulate_bins(const blitz::Array<uint64_t,1>& src,
+    double src_lower, double src_width, blitz::Array<uint64_t,1>& dst,
+    double dst_lower, double dst_width) {
+  const int N = dst.extent(0);
+  for (int i=0; i<src.extent(0); ++i) {
+    if (!src(i)) continue;
+    const double edge = src_lower + i*src_width;
+    int k = (int)std::floor((edge - dst_lower) / dst_width);
+    if (k < 0) k = 0;
+    if (k >= N) k = N-1;
+    dst(k) += src(i);
+  }
+}
+
+/**
+ * The smallest power of two that is larger or equal to value (> 0)
+ */
+static double next_power_of_two(double value) {
+  double retval = std::ldexp(1.0, std::ilogb(value));
+  if (retval < value) retval *= 2.;
+  return retval;
+}
+
+bob::measure::ScoreHistogram::ScoreHistogram(size_t n_bins):
+  m_negatives(n_bins),
+  m_positives(n_bins)
+{
+  if (n_bins < 2) {
+    boost::format m("a score histogram requires at least 2 bins, not %u");
+    m % n_bins;
+    throw std::runtime_error(m.str());
+  }
+  reset();
+}
+
+bob::measure::ScoreHistogram::ScoreHistogram
+(const blitz::Array<uint64_t,1>& negatives,
+ const blitz::Array<uint64_t,1>& positives, double lower, double width,
+ double min, double max):
+  m_negatives(bob::core::array::ccopy(negatives)),
+  m_positives(bob::core::array::ccopy(positives)),
+  m_n_negatives(blitz::sum(negatives)),
+  m_n_positives(blitz::sum(positives)),
+  m_lower(lower),
+  m_width(width),
+  m_min(min),
+  m_max(max)
+{
+  if (negatives.extent(0) != positives.extent(0)) {
+    boost::format m("the number of bins of the negatives (%d) and of the positives (%d) differ");
+    m % negatives.extent(0) % positives.extent(0);
+    throw std::runtime_error(m.str());
+  }
+  if (negatives.extent(0) < 2) {
+    boost::format m("a score histogram requires at least 2 bins, not %d");
+    m % negatives.extent(0);
+    throw std::runtime_error(m.str());
+  }
+  int exponent;
+  if (width < 0. || (width > 0. && std::frexp(width, &exponent) != 0.5)) {
+    boost::format m("the width of the bins (%g) is neither 0 nor a power of two");
+    m % width;
+    throw std::runtime_error(m.str());
+  }
+}
+
+bob::measure::ScoreHistogram::ScoreHistogram
+(const bob::measure::ScoreHistogram& other):
+  m_negatives(bob::core::array::ccopy(other.m_negatives)),
+  m_positives(bob::core::array::ccopy(other.m_positives)),
+  m_n_negatives(other.m_n_negatives),
+  m_n_positives(other.m_n_positives),
+  m_lower(other.m_lower),
+  m_width(other.m_width),
+  m_min(other.m_min),
+  m_max(other.m_max)
+{
+}
+
+bob::measure::ScoreHistogram& bob::measure::ScoreHistogram::operator=
+(const bob::measure::ScoreHistogram& other) {
+  if (this != &other) {
+    m_negatives.reference(bob::core::array::ccopy(other.m_negatives));
+    m_positives.reference(bob::core::array::ccopy(other.m_positives));
+    m_n_negatives = other.m_n_negatives;
+    m_n_positives = other.m_n_positives;
+    m_lower = other.m_lower;
+    m_width = other.m_width;
+    m_min = other.m_min;
+    m_max = other.m_max;
+  }
+  return *this;
+}
+
+void bob::measure::ScoreHistogram::reset() {
+  m_negatives = 0;
+  m_positives = 0;
+  m_n_negatives = 0;
+  m_n_positives = 0;
+  m_lower = 0.;
+  m_width = 0.; //no scores yet
+  m_min = 0.;
+  m_max = 0.;
+}
+
+void bob::measure::ScoreHistogram::cover(double min, double max,
+    double min_width) {
+  const double N = m_negatives.extent(0);
+
+  if (m_width > 0.) {
+    if (min_width <= m_width && min >= m_lower &&
+        (max - m_lower) / m_width < N) return; //fits
+    min = std::min(min, m_min);
+    max = std::max(max, m_max);
+    min_width = std::max(min_width, m_width);
+  }
+
+  // the bins are not too fine for the magnitude of the scores, so that
+  // their edges are exactly representable
+  const double magnitude = std::max(std::abs(min), std::abs(max));
+  double width = (max - min) / (N - 1.);
+  if (magnitude > 0.)
+    width = std::max(width, std::ldexp(1.0, std::ilogb(magnitude) - 36));
+  width = next_power_of_two(std::max(width, std::max(min_width,
+          std::ldexp(1.0, -64))));
+  double lower = std::floor(min / width) * width;
+  while ((max - lower) / width >= N) {
+    width *= 2.;
+    lower = std::floor(min / width) * width;
+  }
+
+  if (m_width > 0.) {
+    blitz::Array<uint64_t,1> negatives(m_negatives.extent(0));
+    blitz::Array<uint64_t,1> positives(m_positives.extent(0));
+    negatives = 0;
+    positives = 0;
+    accumulate_bins(m_negatives, m_lower, m_width, negatives, lower, width);
+    accumulate_bins(m_positives, m_lower, m_width, positives, lower, width);
+    m_negatives.reference(negatives);
+    m_positives.reference(positives);
+  }
+  else {
+    m_min = min;
+    m_max = max;
+  }
+
+  m_lower = lower;
+  m_width = width;
+}
+
+void bob::measure::ScoreHistogram::add(const blitz::Array<double,1>& scores,
+    blitz::Array<uint64_t,1>& counts, uint64_t& total) {
+  if (!scores.extent(0)) return;
+
+  double min = scores(0);
+  double max = scores(0);
+  for (int i=0; i<scores.extent(0); ++i) {
+    const double s = scores(i);
+    if (!std::isfinite(s)) {
+      boost::format m("cannot accumulate score %d, which is not finite (%f)");
+      m % i % s;
+      throw std::runtime_error(m.str());
+    }
+    if (s < min) min = s;
+    if (s > max) max = s;
+  }
+
+  cover(min, max, 0.);
+
+  const int N = counts.extent(0);
+  for (int i=0; i<scores.extent(0); ++i) {
+    int k = (int)std::floor((scores(i) - m_lower) / m_width);
+    if (k < 0) k = 0;
+    if (k >= N) k = N-1;
+    ++counts(k);
+  }
+
+  m_min = std::min(m_min, min);
+  m_max = std::max(m_max, max);
+  total += scores.extent(0);
+}
+
+void bob::measure::ScoreHistogram::addNegatives
+(const blitz::Array<double,1>& negatives) {
+  add(negatives, m_negatives, m_n_negatives);
+}
+
+void bob::measure::ScoreHistogram::addPositives
+(const blitz::Array<double,1>& positives) {
+  add(positives, m_positives, m_n_positives);
+}
+
+void bob::measure::ScoreHistogram::merge
+(const bob::measure::ScoreHistogram& other) {
+  if (other.getNBins() != getNBins()) {
+    boost::format m("cannot merge a score histogram with %u bins into one with %u bins");
+    m % other.getNBins() % getNBins();
+    throw std::runtime_error(m.str());
+  }
+  if (!(other.m_width > 0.)) return; //nothing to merge
+
+  cover(other.m_min, other.m_max, other.m_width);
+  accumulate_bins(other.m_negatives, other.m_lower, other.m_width,
+      m_negatives, m_lower, m_width);
+  accumulate_bins(other.m_positives, other.m_lower, other.m_width,
+      m_positives, m_lower, m_width);
+
+  m_min = std::min(m_min, other.m_min);
+  m_max = std::max(m_max, other.m_max);
+  m_n_negatives += other.m_n_negatives;
+  m_n_positives += other.m_n_positives;
+}
+
+double bob::measure::ScoreHistogram::getMin() const {
+  if (!(m_width > 0.)) throw std::runtime_error("there are no scores");
+  return m_min;
+}
+
+double bob::measure::ScoreHistogram::getMax() const {
+  if (!(m_width > 0.)) throw std::runtime_error("there are no scores");
+  return m_max;
+}
+
+void bob::measure::ScoreHistogram::edgeRates(std::vector<double>& far,
+    std::vector<double>& frr) const {
+  const int N = m_negatives.extent(0);
+  const double total_negatives = m_n_negatives ? m_n_negatives : 1.;
+  const double total_positives = m_n_positives ? m_n_positives : 1.;
+  far.resize(N+1);
+  frr.resize(N+1);
+  uint64_t negatives_below = 0, positives_below = 0;
+  for (int k=0; k<=N; ++k) {
+    far[k] = (m_n_negatives - negatives_below) / total_negatives;
+    frr[k] = positives_below / total_positives;
+    if (k < N) {
+      negatives_below += m_negatives(k);
+      positives_below += m_positives(k);
+    }
+  }
+}
+
+double bob::measure::ScoreHistogram::position(double threshold) const {
+  if (!(m_width > 0.)) throw std::runtime_error("there are no scores");
+  const double p = (threshold - m_lower) / m_width;
+  if (p < 0.) return 0.;
+  if (p > m_negatives.extent(0)) return m_negatives.extent(0);
+  return p;
+}
+
+/**
+ * Linear interpolation of the rates at the edges, at position p
+ */
+static double interpolate(const std::vector<double>& rates, double p) {
+  const size_t b = (size_t)std::floor(p);
+  const double fraction = p - b;
+  if (fraction == 0.) return rates[b];
+  return rates[b] + fraction * (rates[b+1] - rates[b]);
+}
+
+std::pair<double, double> bob::measure::ScoreHistogram::farfrr
+(double threshold) const {
+  const double p = position(threshold);
+  std::vector<double> far, frr;
+  edgeRates(far, frr);
+  return std::make_pair(interpolate(far, p), interpolate(frr, p));
+}
+
+std::pair<double, double> bob::measure::ScoreHistogram::farBounds
+(double threshold) const {
+  const double p = position(threshold);
+  std::vector<double> far, frr;
+  edgeRates(far, frr);
+  const size_t b = (size_t)std::floor(p);
+  if (p == b) return std::make_pair(far[b], far[b]);
+  return std::make_pair(far[b+1], far[b]);
+}
+
+std::pair<double, double> bob::measure::ScoreHistogram::frrBounds
+(double threshold) const {
+  const double p = position(threshold);
+  std::vector<double> far, frr;
+  edgeRates(far, frr);
+  const size_t b = (size_t)std::floor(p);
+  if (p == b) return std::make_pair(frr[b], frr[b]);
+  return std::make_pair(frr[b], frr[b+1]);
+}
+
+double bob::measure::ScoreHistogram::farError() const {
+  if (!m_n_negatives) return 0.;
+  return (double)blitz::max(m_negatives) / m_n_negatives;
+}
+
+double bob::measure::ScoreHistogram::frrError() const {
+  if (!m_n_positives) return 0.;
+  return (double)blitz::max(m_positives) / m_n_positives;
+}
+
+blitz::Array<double,2> bob::measure::ScoreHistogram::roc(size_t points) const {
+  const double min = getMin();
+  const double max = getMax();
+  const double step = (max-min)/((double)points-1.0);
+  std::vector<double> far, frr;
+  edgeRates(far, frr);
+  blitz::Array<double,2> retval(2, points);
+  for (int i=0; i<(int)points; ++i) {
+    const double p = position(min + i*step);
+    //note: inversion to preserve X x Y ordering (FRR x FAR)
+    retval(0,i) = interpolate(frr, p);
+    retval(1,i) = interpolate(far, p);
+  }
+  return retval;
+}
+
+blitz::Array<double,2> bob::measure::ScoreHistogram::det(size_t points) const {
+  blitz::Array<double,2> retval = roc(points);
+  for (int i=0; i<retval.extent(0); ++i)
+    for (int k=0; k<retval.extent(1); ++k)
+      retval(i,k) = bob::measure::ppndf(retval(i,k));
+  return retval;
+}
+
+double bob::measure::ScoreHistogram::eerThreshold() const {
+  if (!(m_width > 0.)) throw std::runtime_error("there are no scores");
+  std::vector<double> far, frr;
+  edgeRates(far, frr);
+
+  // FAR - FRR decreases with the threshold: finds where it crosses zero
+  const size_t N = far.size();
+  size_t k = 0;
+  while (k < N-1 && far[k] - frr[k] > 0.) ++k;
+
+  double p = k;
+  if (far[k] == frr[k]) { //picks the center of the edges where they are equal
+    size_t last = k;
+    while (last < N-1 && far[last+1] == frr[last+1]) ++last;
+    p = 0.5 * (k + last);
+  }
+  else if (k > 0) { //interpolates inside the previous bin
+    const double before = far[k-1] - frr[k-1];
+    const double after = far[k] - frr[k];
+    p = (k-1) + before / (before - after);
+  }
+  return m_lower + p * m_width;
+}
+
+double bob::measure::ScoreHistogram::eer() const {
+  std::pair<double, double> ratios = farfrr(eerThreshold());
+  return (ratios.first + ratios.second) / 2.;
+}
+
+double bob::measure::ScoreHistogram::minWeightedErrorRateThreshold
+(double cost) const {
+  if (!(m_width > 0.)) throw std::runtime_error("there are no scores");
+  if (cost > 1.0) cost = 1.0;
+  if (cost < 0.0) cost = 0.0;
+  std::vector<double> far, frr;
+  edgeRates(far, frr);
+
+  // the estimated weighted error is linear inside each bin, so its minimum
+  // lies on one of the edges
+  double min_value = cost*far[0] + (1.0-cost)*frr[0];
+  std::vector<size_t> accumulator(1, 0);
+  for (size_t k=1; k<far.size(); ++k) {
+    const double value = cost*far[k] + (1.0-cost)*frr[k];
+    if (value < min_value) {
+      min_value = value;
+      accumulator.clear();
+      accumulator.push_back(k);
+    }
+    else if (std::abs(value - min_value) < 1e-16) {
+      accumulator.push_back(k);
+    }
+  }
+  return m_lower + accumulator[accumulator.size()/2] * m_width;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file measure/cxx/SortedScores.cc
+ * @date Mon Oct 19 11:02:15 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Implements the sorted score engine
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+#include <algorithm>
+#include <boost/format.hpp>
+#include <bob/measure/SortedScores.h>
+#include <bob/measure/error.h>
+#include <bob/core/assert.h>
+#include <bob/core/parallel.h>
+
+/**
+ * Sorts scores (and their weights, if given) into the sorted vector and
+ * the cumulative sum of the weights. Returns the total weight.
+ */
+static double sort_scores(const blitz::Array<double,1>& scores,
+    const blitz::Array<double,1>* weights, std::vector<double>& sorted,
+    std::vector<double>& cumsum, size_t n_threads) {
+
+  const size_t N = scores.extent(0);
+  sorted.resize(N);
+
+  if (!weights) {
+    std::copy(scores.begin(), scores.end(), sorted.begin());
+    bob::core::parallel_sort(sorted, std::less<double>(), n_threads);
+    cumsum.clear();
+    return N ? (double)N : 1.; //avoids division by zero
+  }
+
+  bob::core::array::assertSameDimensionLength(weights->extent(0), N);
+  std::vector<std::pair<double, double> > pairs(N);
+  for (size_t k=0; k<N; ++k) {
+    if ((*weights)((int)k) < 0.) {
+      boost::format m("score weights must be non-negative, but weight %d is %f");
+      m % k % (*weights)((int)k);
+      throw std::runtime_error(m.str());
+    }
+    pairs[k] = std::make_pair(scores((int)k), (*weights)((int)k));
+  }
+  bob::core::parallel_sort(pairs, std::less<std::pair<double, double> >(),
+      n_threads);
+
+  cumsum.resize(N+1);
+  cumsum[0] = 0.;
+  for (size_t k=0; k<N; ++k) {
+    sorted[k] = pairs[k].first;
+    cumsum[k+1] = cumsum[k] + pairs[k].second;
+  }
+  return cumsum[N] > 0. ? cumsum[N] : 1.; //avoids division by zero
+}
+
+bob::measure::SortedScores::SortedScores(const blitz::Array<double,1>& negatives,
+    const blitz::Array<double,1>& positives, size_t n_threads) {
+  init(negatives, positives, 0, 0, n_threads);
+}
+
+bob::measure::SortedScores::SortedScores(const blitz::Array<double,1>& negatives,
+    const blitz::Array<double,1>& positives,
+    const blitz::Array<double,1>& negative_weights,
+    const blitz::Array<double,1>& positive_weights, size_t n_threads) {
+  init(negatives, positives, &negative_weights, &positive_weights, n_threads);
+}
+
+void bob::measure::SortedScores::init(const blitz::Array<double,1>& negatives,
+    const blitz::Array<double,1>& positives,
+    const blitz::Array<double,1>* negative_weights,
+    const blitz::Array<double,1>* positive_weights, size_t n_threads) {
+  m_total_negatives = sort_scores(negatives, negative_weights, m_negatives,
+      m_negative_cumsum, n_threads);
+  m_total_positives = sort_scores(positives, positive_weights, m_positives,
+      m_positive_cumsum, n_threads);
+}
+
+double bob::measure::SortedScores::getMin() const {
+  if (m_negatives.empty() && m_positives.empty())
+    throw std::runtime_error("there are no scores");
+  if (m_negatives.empty()) return m_positives.front();
+  if (m_positives.empty()) return m_negatives.front();
+  return std::min(m_negatives.front(), m_positives.front());
+}
+
+double bob::measure::SortedScores::getMax() const {
+  if (m_negatives.empty() && m_positives.empty())
+    throw std::runtime_error("there are no scores");
+  if (m_negatives.empty()) return m_positives.back();
+  if (m_positives.empty()) return m_negatives.back();
+  return std::max(m_negatives.back(), m_positives.back());
+}
+
+std::pair<double, double> bob::measure::SortedScores::farfrr(double threshold) const {
+  // number of scores strictly below the threshold
+  size_t i = std::lower_bound(m_negatives.begin(), m_negatives.end(),
+      threshold) - m_negatives.begin();
+  size_t j = std::lower_bound(m_positives.begin(), m_positives.end(),
+      threshold) - m_positives.begin();
+  return std::make_pair(
+      (negativeWeight(m_negatives.size()) - negativeWeight(i)) / m_total_negatives,
+      positiveWeight(j) / m_total_positives);
+}
+
+blitz::Array<double,2> bob::measure::SortedScores::roc(size_t points) const {
+  double min = getMin();
+  double max = getMax();
+  double step = (max-min)/((double)points-1.0);
+  blitz::Array<double,2> retval(2, points);
+
+  // thresholds increase, so the number of scores below them only grows
+  size_t i = 0, j = 0;
+  for (int k=0; k<(int)points; ++k) {
+    double threshold = min + k*step;
+    while (i < m_negatives.size() && m_negatives[i] < threshold) ++i;
+    while (j < m_positives.size() && m_positives[j] < threshold) ++j;
+    //note: inversion to preserve X x Y ordering (FRR x FAR)
+    retval(0,k) = positiveWeight(j) / m_total_positives;
+    retval(1,k) = (negativeWeight(m_negatives.size()) - negativeWeight(i)) / m_total_negatives;
+  }
+  return retval;
+}
+
+blitz::Array<double,2> bob::measure::SortedScores::det(size_t points) const {
+  blitz::Array<double,2> retval = roc(points);
+  for (int i=0; i<retval.extent(0); ++i)
+    for (int k=0; k<retval.extent(1); ++k)
+      retval(i,k) = bob::measure::ppndf(retval(i,k));
+  return retval;
+}
+
+static double eer_cost(double far, double frr) {
+  return std::abs(far - frr);
+}
+
+double bob::measure::SortedScores::eerThreshold() const {
+  return minimizingThreshold(eer_cost);
+}
+
+double bob::measure::SortedScores::eer() const {
+  std::pair<double, double> ratios = farfrr(eerThreshold());
+  return (ratios.first + ratios.second) / 2.;
+}
+
+namespace {
+
+  struct WeightedErrorCost {
+    double m_weight;
+    WeightedErrorCost(double weight): m_weight(weight) {
+      if (weight > 1.0) m_weight = 1.0;
+      if (weight < 0.0) m_weight = 0.0;
+    }
+    double operator()(double far, double frr) const {
+      return (m_weight*far) + ((1.0-m_weight)*frr);
+    }
+  };
+
+}
+
+double bob::measure::SortedScores::minWeightedErrorRateThreshold(double cost) const {
+  WeightedErrorCost predicate(cost);
+  return minimizingThreshold(predicate);
+}
+
+blitz::Array<double,2> bob::measure::epc(const bob::measure::SortedScores& dev,
+    const bob::measure::SortedScores& test, size_t points) {
+  double step = 1.0/((double)points-1.0);
+  blitz::Array<double,2> retval(2, points);
+  for (int i=0; i<(int)points; ++i) {
+    double alpha = (double)i*step;
+    retval(0,i) = alpha;
+    double threshold = dev.minWeightedErrorRateThreshold(alpha);
+    std::pair<double, double> ratios = test.farfrr(threshold);
+    retval(1,i) = (ratios.first + ratios.second) / 2;
+  }
+  return retval;
+}
@@ -190,18 +190,7 @@ double bob::measure::minWeightedErrorRateThreshold
 
 blitz::Array<double,2> bob::measure::roc(const blitz::Array<double,1>& negatives,
  const blitz::Array<double,1>& positives, size_t points) {
-  double min = std::min(blitz::min(negatives), blitz::min(positives));
-  double max = std::max(blitz::max(negatives), blitz::max(positives));
-  double step = (max-min)/((double)points-1.0);
-  blitz::Array<double,2> retval(2, points);
-  for (int i=0; i<(int)points; ++i) {
-    std::pair<double, double> ratios =
-      bob::measure::farfrr(negatives, positives, min + i*step);
-    //note: inversion to preserve X x Y ordering (FRR x FAR)
-    retval(0,i) = ratios.second;
-    retval(1,i) = ratios.first;
-  }
-  return retval;
+  return bob::measure::SortedScores(negatives, positives).roc(points);
 }
 
 blitz::Array<double,2> bob::measure::precision_recall_curve(const blitz::Array<double,1>& negatives,
@@ -521,13 +510,17 @@ blitz::Array<double,2> bob::measure::epc
  const blitz::Array<double,1>& test_positives, size_t points) {
   double step = 1.0/((double)points-1.0);
   blitz::Array<double,2> retval(2, points);
+  // scores are sorted only once for all points
+  bob::measure::SortedScores dev(dev_negatives, dev_positives);
+  bob::measure::SortedScores test(test_negatives, test_positives);
+  const size_t N = 100; ///< number of steps in each iteration
   for (int i=0; i<(int)points; ++i) {
     double alpha = (double)i*step;
     retval(0,i) = alpha;
-    double threshold = bob::measure::minWeightedErrorRateThreshold(dev_negatives,
-        dev_positives, alpha);
-    std::pair<double, double> ratios =
-      bob::measure::farfrr(test_negatives, test_positives, threshold);
+    weighted_error predicate(alpha);
+    double threshold = bob::measure::recursive_minimization(dev, predicate,
+        dev.getMin(), dev.getMax(), N);
+    std::pair<double, double> ratios = test.farfrr(threshold);
     retval(1,i) = (ratios.first + ratios.second) / 2;
   }
   return retval;
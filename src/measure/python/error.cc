@@ -21,7 +21,11 @@
  */
 
 #include "bob/measure/error.h"
+#include "bob/measure/SortedScores.h"
+#include "bob/measure/ScoreHistogram.h"
+#include "bob/io/HDF5File.h"
 #include "bob/python/ndarray.h"
+#include <boost/shared_ptr.hpp>
 
 using namespace boost::python;
 
@@ -119,7 +123,181 @@ static blitz::Array<double,2> bob_epc(bob::python::const_ndarray dev_negatives,
   return bob::measure::epc(dev_negatives.cast<double,1>(), dev_positives.cast<double,1>(), test_negatives.cast<double,1>(), test_positives.cast<double,1>(), n_points);
 }
 
+static boost::shared_ptr<bob::measure::SortedScores> sorted_scores(
+    bob::python::const_ndarray negatives, bob::python::const_ndarray positives,
+    object negative_weights, object positive_weights, size_t n_threads) {
+  if (negative_weights.ptr() == Py_None && positive_weights.ptr() == Py_None)
+    return boost::shared_ptr<bob::measure::SortedScores>(
+        new bob::measure::SortedScores(negatives.cast<double,1>(),
+          positives.cast<double,1>(), n_threads));
+
+  blitz::Array<double,1> neg = negatives.cast<double,1>();
+  blitz::Array<double,1> pos = positives.cast<double,1>();
+  blitz::Array<double,1> neg_w(neg.extent(0));
+  blitz::Array<double,1> pos_w(pos.extent(0));
+  neg_w = 1.;
+  pos_w = 1.;
+  if (negative_weights.ptr() != Py_None)
+    neg_w.reference(extract<bob::python::const_ndarray>(negative_weights)().cast<double,1>());
+  if (positive_weights.ptr() != Py_None)
+    pos_w.reference(extract<bob::python::const_ndarray>(positive_weights)().cast<double,1>());
+  return boost::shared_ptr<bob::measure::SortedScores>(
+      new bob::measure::SortedScores(neg, pos, neg_w, pos_w, n_threads));
+}
+
+static tuple sorted_farfrr(const bob::measure::SortedScores& s, double threshold) {
+  std::pair<double, double> retval = s.farfrr(threshold);
+  return make_tuple(retval.first, retval.second);
+}
+
+static blitz::Array<double,2> sorted_roc(const bob::measure::SortedScores& s, int n_points) {
+  return s.roc(n_points);
+}
+
+static blitz::Array<double,2> sorted_det(const bob::measure::SortedScores& s, int n_points) {
+  return s.det(n_points);
+}
+
+static blitz::Array<double,2> sorted_epc(const bob::measure::SortedScores& dev,
+    const bob::measure::SortedScores& test, int n_points) {
+  return bob::measure::epc(dev, test, n_points);
+}
+
+static boost::shared_ptr<bob::measure::ScoreHistogram> histogram_restore(
+    bob::python::const_ndarray negatives, bob::python::const_ndarray positives,
+    double lower, double width, double min, double max) {
+  return boost::shared_ptr<bob::measure::ScoreHistogram>(
+      new bob::measure::ScoreHistogram(negatives.cast<uint64_t,1>(),
+        positives.cast<uint64_t,1>(), lower, width, min, max));
+}
+
+/**
+ * The accumulators are saved to and loaded from HDF5 files here, so that
+ * bob_measure does not depend on bob_io. The minimum and maximum scores are
+ * only saved if there are any scores.
+ */
+static void histogram_save(const bob::measure::ScoreHistogram& h,
+    bob::io::HDF5File& config) {
+  config.setArray("negatives", h.getNegativeCounts());
+  config.setArray("positives", h.getPositiveCounts());
+  config.set("lower", h.getLowerBound());
+  config.set("width", h.getBinWidth());
+  if (h.getNNegatives() || h.getNPositives()) {
+    config.set("min", h.getMin());
+    config.set("max", h.getMax());
+  }
+}
+
+static void histogram_load(bob::measure::ScoreHistogram& h,
+    bob::io::HDF5File& config) {
+  const bool empty = !config.contains("min");
+  h = bob::measure::ScoreHistogram(
+      config.readArray<uint64_t,1>("negatives"),
+      config.readArray<uint64_t,1>("positives"),
+      config.read<double>("lower"), config.read<double>("width"),
+      empty ? 0. : config.read<double>("min"),
+      empty ? 0. : config.read<double>("max"));
+}
+
+static boost::shared_ptr<bob::measure::ScoreHistogram> histogram_from_file(
+    bob::io::HDF5File& config) {
+  boost::shared_ptr<bob::measure::ScoreHistogram> retval(
+      new bob::measure::ScoreHistogram(2)); //replaced by histogram_load()
+  histogram_load(*retval, config);
+  return retval;
+}
+
+static void histogram_add_negatives(bob::measure::ScoreHistogram& h,
+    bob::python::const_ndarray negatives) {
+  h.addNegatives(negatives.cast<double,1>());
+}
+
+static void histogram_add_positives(bob::measure::ScoreHistogram& h,
+    bob::python::const_ndarray positives) {
+  h.addPositives(positives.cast<double,1>());
+}
+
+static tuple histogram_farfrr(const bob::measure::ScoreHistogram& h, double threshold) {
+  std::pair<double, double> retval = h.farfrr(threshold);
+  return make_tuple(retval.first, retval.second);
+}
+
+static tuple histogram_far_bounds(const bob::measure::ScoreHistogram& h, double threshold) {
+  std::pair<double, double> retval = h.farBounds(threshold);
+  return make_tuple(retval.first, retval.second);
+}
+
+static tuple histogram_frr_bounds(const bob::measure::ScoreHistogram& h, double threshold) {
+  std::pair<double, double> retval = h.frrBounds(threshold);
+  return make_tuple(retval.first, retval.second);
+}
+
+static blitz::Array<double,2> histogram_roc(const bob::measure::ScoreHistogram& h, int n_points) {
+  return h.roc(n_points);
+}
+
+static blitz::Array<double,2> histogram_det(const bob::measure::ScoreHistogram& h, int n_points) {
+  return h.det(n_points);
+}
+
 void bind_measure_error() {
+  class_<bob::measure::SortedScores, boost::shared_ptr<bob::measure::SortedScores> >(
+    "SortedScores",
+    "Holds copies of negative and positive scores (and, optionally, their weights), sorted once, so that error rates, curves and operating points can be computed without scanning all scores at every threshold. Error rates follow the conventions of farfrr(). The EER and minimum weighted error rate thresholds are found exactly by sweeping all distinct scores, instead of the recursive grid search used by eer_threshold() and min_weighted_error_rate_threshold().",
+    no_init)
+    .def("__init__", make_constructor(&sorted_scores, default_call_policies(), (arg("negatives"), arg("positives"), arg("negative_weights")=object(), arg("positive_weights")=object(), arg("n_threads")=1)), "Sorts the given scores using the given number of threads (0 means the number of hardware threads). If weights are given for either class, error rates are ratios of the sum of the weights of the misclassified scores to the sum of the weights of all scores of that class; missing weights default to 1.")
+    .def("farfrr", &sorted_farfrr, (arg("self"), arg("threshold")), "The FA and FR ratios at the given threshold, as in farfrr()")
+    .def("roc", &sorted_roc, (arg("self"), arg("n_points")), "The ROC curve, as in roc()")
+    .def("det", &sorted_det, (arg("self"), arg("n_points")), "The DET curve, as in det()")
+    .def("eer_threshold", &bob::measure::SortedScores::eerThreshold, (arg("self")), "The threshold at which the FAR and FRR are the closest")
+    .def("eer", &bob::measure::SortedScores::eer, (arg("self")), "The equal error rate: the average of FAR and FRR at eer_threshold()")
+    .def("min_weighted_error_rate_threshold", &bob::measure::SortedScores::minWeightedErrorRateThreshold, (arg("self"), arg("cost")), "The threshold that minimizes cost * FAR + (1-cost) * FRR")
+    .def("min_hter_threshold", &bob::measure::SortedScores::minHterThreshold, (arg("self")), "The threshold that minimizes the HTER")
+    .add_property("min", &bob::measure::SortedScores::getMin, "The minimum over all scores")
+    .add_property("max", &bob::measure::SortedScores::getMax, "The maximum over all scores")
+    ;
+
+  class_<bob::measure::ScoreHistogram, boost::shared_ptr<bob::measure::ScoreHistogram> >(
+    "ScoreHistogram",
+    "Accumulates negative and positive scores, in chunks, into two histograms that share the same bins, so that error rates, curves and operating points can be estimated for score sets that do not fit in memory. The bins have a width that is a power of two and are widened (merging pairs of bins) when scores fall outside the current range. Accumulators with the same number of bins (e.g. filled by parallel jobs) can be merged without loss of resolution, or saved to and loaded from HDF5 files. Error rates follow the conventions of farfrr(); they are exact at the bin edges and linearly interpolated inside the bins. far_bounds() and frr_bounds() return the range in which the exact values lie, and far_error() and frr_error() the largest possible error of any estimate.",
+    init<optional<size_t> >((arg("self"), arg("n_bins")=65536), "Creates an empty accumulator with the given number of bins"))
+    .def("__init__", make_constructor(&histogram_restore, default_call_policies(), (arg("negative_counts"), arg("positive_counts"), arg("lower_bound"), arg("bin_width"), arg("min"), arg("max"))), "Restores an accumulator from the counts per bin, the lower edge of the first bin, the width of the bins and the minimum and maximum scores of another one, as given by its properties")
+    .def("__init__", make_constructor(&histogram_from_file, default_call_policies(), (arg("config"))), "Loads an accumulator from a configuration file (a bob.io.HDF5File)")
+    .def("load", &histogram_load, (arg("self"), arg("config")), "Loads the accumulator from a configuration file (a bob.io.HDF5File)")
+    .def("save", &histogram_save, (arg("self"), arg("config")), "Saves the accumulator to a configuration file (a bob.io.HDF5File). Empty accumulators can be saved, too.")
+    .def("add_negatives", &histogram_add_negatives, (arg("self"), arg("negatives")), "Accumulates a chunk of negative scores")
+    .def("add_positives", &histogram_add_positives, (arg("self"), arg("positives")), "Accumulates a chunk of positive scores")
+    .def("merge", &bob::measure::ScoreHistogram::merge, (arg("self"), arg("other")), "Accumulates all scores accumulated by another accumulator with the same number of bins")
+    .def("reset", &bob::measure::ScoreHistogram::reset, (arg("self")), "Removes all scores")
+    .def("farfrr", &histogram_farfrr, (arg("self"), arg("threshold")), "The estimated FA and FR ratios at the given threshold")
+    .def("far_bounds", &histogram_far_bounds, (arg("self"), arg("threshold")), "The lowest and highest possible FA ratio at the given threshold")
+    .def("frr_bounds", &histogram_frr_bounds, (arg("self"), arg("threshold")), "The lowest and highest possible FR ratio at the given threshold")
+    .def("far_error", &bob::measure::ScoreHistogram::farError, (arg("self")), "The largest possible absolute error of any FA ratio estimate")
+    .def("frr_error", &bob::measure::ScoreHistogram::frrError, (arg("self")), "The largest possible absolute error of any FR ratio estimate")
+    .def("roc", &histogram_roc, (arg("self"), arg("n_points")), "The estimated ROC curve, as in roc()")
+    .def("det", &histogram_det, (arg("self"), arg("n_points")), "The estimated DET curve, as in det()")
+    .def("eer_threshold", &bob::measure::ScoreHistogram::eerThreshold, (arg("self")), "The threshold at which the estimated FAR and FRR are equal")
+    .def("eer", &bob::measure::ScoreHistogram::eer, (arg("self")), "The estimated equal error rate. The exact value is within max(far_error(), frr_error()) of this estimate.")
+    .def("min_weighted_error_rate_threshold", &bob::measure::ScoreHistogram::minWeightedErrorRateThreshold, (arg("self"), arg("cost")), "The threshold that minimizes the estimated cost * FAR + (1-cost) * FRR")
+    .def("min_hter_threshold", &bob::measure::ScoreHistogram::minHterThreshold, (arg("self")), "The threshold that minimizes the estimated HTER")
+    .add_property("n_bins", &bob::measure::ScoreHistogram::getNBins, "The number of bins")
+    .add_property("n_negatives", &bob::measure::ScoreHistogram::getNNegatives, "The number of negatives accumulated so far")
+    .add_property("n_positives", &bob::measure::ScoreHistogram::getNPositives, "The number of positives accumulated so far")
+    .add_property("min", &bob::measure::ScoreHistogram::getMin, "The minimum over all scores accumulated so far")
+    .add_property("max", &bob::measure::ScoreHistogram::getMax, "The maximum over all scores accumulated so far")
+    .add_property("lower_bound", &bob::measure::ScoreHistogram::getLowerBound, "The lower edge of the first bin")
+    .add_property("bin_width", &bob::measure::ScoreHistogram::getBinWidth, "The width of the bins")
+    .add_property("negative_counts", make_function(&bob::measure::ScoreHistogram::getNegativeCounts, return_value_policy<copy_const_reference>()), "The number of negatives in each bin")
+    .add_property("positive_counts", make_function(&bob::measure::ScoreHistogram::getPositiveCounts, return_value_policy<copy_const_reference>()), "The number of positives in each bin")
+    ;
+
+  def(
+    "sorted_epc",
+    &sorted_epc,
+    (arg("dev"), arg("test"), arg("n_points")),
+    "Calculates the EPC curve as epc(), from SortedScores of the development and test sets, using the exact minimum weighted error rate thresholds on the development set."
+  );
+
   def(
     "farfrr",
     &farfrr,
@@ -18,13 +18,13 @@ bob::python::gil::~gil () {
   PyGILState_Release(m_lock);
 }
 
-bob::python::no_gil::no_gil()
-  : m_state(PyEval_SaveThread())
+bob::python::no_gil::no_gil(bool release)
+  : m_state(release ? PyEval_SaveThread() : 0)
 {
 }
 
 bob::python::no_gil::~no_gil() {
-  PyEval_RestoreThread(m_state);
+  if (m_state) PyEval_RestoreThread(m_state);
 }
 
 void bob::python::check_signals() {
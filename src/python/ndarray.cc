@@ -30,6 +30,7 @@
 #undef bob_IMPORT_ARRAY
 
 #include <bob/core/logging.h>
+#include <bob/python/gil.h>
 
 #define TP_ARRAY(x) ((PyArrayObject*)x.ptr())
 #define TP_OBJECT(x) (x.ptr())
@@ -722,16 +723,61 @@ bob::python::convert_t bob::python::convertible_to(boost::python::object array_l
  * Ndarray (PyArrayObject) manipulations                                   *
  ***************************************************************************/
 
+/**
+ * Tells if an array can be wrapped in a blitz::Array<> of the same type: it
+ * has to be aligned and in native byte order, with positive strides that are
+ * multiples of the item size (the strides of dimensions of length 0 or 1 are
+ * never used). If required, it also has to be C-style contiguous.
+ */
+static bool is_referable (PyArrayObject* array, bool contiguous) {
+  if (contiguous) return PyArray_ISCARRAY_RO(array);
+  if (!PyArray_ISALIGNED(array) || !PyArray_ISNOTSWAPPED(array)) return false;
+  const npy_intp item_size = PyArray_DESCR(array)->elsize;
+  for (int k=0; k<PyArray_NDIM(array); ++k) {
+    if (PyArray_DIM(array,k) <= 1) continue;
+    const npy_intp stride = PyArray_STRIDE(array,k);
+    if (stride < 0 || (stride % item_size)) return false;
+  }
+  return true;
+}
+
+bool bob::python::referable (boost::python::object array_like,
+    bool contiguous) {
+  if (!PyArray_Check(array_like.ptr())) return false;
+  return is_referable(TP_ARRAY(array_like), contiguous);
+}
+
+/**
+ * Copy counters, protected by the GIL
+ */
+static size_t s_copied_arrays = 0;
+static size_t s_copied_bytes = 0;
+
+void bob::python::record_copy (size_t bytes) {
+  ++s_copied_arrays;
+  s_copied_bytes += bytes;
+}
+
+size_t bob::python::copied_arrays () { return s_copied_arrays; }
+
+size_t bob::python::copied_bytes () { return s_copied_bytes; }
+
+void bob::python::reset_copies () {
+  s_copied_arrays = 0;
+  s_copied_bytes = 0;
+}
+
 /**
  * Returns either a reference or a copy of the given array_like object,
  * depending on the following requirements for referral:
  *
  * 0. The pointed object is a numpy.ndarray
- * 1. The array type description type_num matches
- * 2. The array is C-style, contiguous and aligned
+ * 1. The array type description type_num matches, if one is requested
+ * 2. The array is referable (aligned, native byte order and positive strides
+ *    or, if required, C-style contiguous)
  */
 static boost::python::object try_refer_ndarray (boost::python::object array_like,
-    boost::python::object dtype_like) {
+    boost::python::object dtype_like, bool contiguous) {
 
   PyArrayObject* candidate = TP_ARRAY(array_like);
   PyArray_Descr* req_dtype = 0;
@@ -741,18 +787,24 @@ static boost::python::object try_refer_ndarray (boost::python::object array_like
 
   if (!PyArray_Check((PyObject*)candidate)) can_refer = false;
 
-  if (can_refer && !PyArray_ISCARRAY_RO(candidate)) can_refer = false;
+  if (can_refer && req_dtype &&
+      !PyArray_EquivTypes(PyArray_DESCR(candidate), req_dtype))
+    can_refer = false;
+
+  if (can_refer && !is_referable(candidate, contiguous)) can_refer = false;
 
   if (can_refer) {
+    Py_XDECREF(req_dtype);
     PyObject* tmp = PyArray_FromArray(candidate, 0, 0);
     boost::python::handle<> hdl(tmp); //< raises if NULL
     boost::python::object retval(hdl);
     return retval;
   }
 
-  //copy
-  TDEBUG1("[non-optimal] copying array-like object - cannot refer");
+  //copy, in native byte order if no type is requested
   PyObject* _ptr = (PyObject*)candidate;
+  if (!req_dtype && PyArray_Check(_ptr) && !PyArray_ISNOTSWAPPED(candidate))
+    req_dtype = PyArray_DescrNewByteorder(PyArray_DESCR(candidate), NPY_NATIVE);
 #if NPY_FEATURE_VERSION > NUMPY16_API /* NumPy C-API version > 1.6 */
   int flags = NPY_ARRAY_C_CONTIGUOUS|NPY_ARRAY_ENSURECOPY|NPY_ARRAY_ENSUREARRAY;
 #else
@@ -761,11 +813,15 @@ static boost::python::object try_refer_ndarray (boost::python::object array_like
   PyObject* tmp = PyArray_FromAny(_ptr, req_dtype, 0, 0, flags, 0);
   boost::python::handle<> hdl(tmp); //< raises if NULL
   boost::python::object retval(hdl);
+  TDEBUG1("[non-optimal] copying array-like object - cannot refer ("
+      << PyArray_NBYTES(TP_ARRAY(retval)) << " bytes)");
+  bob::python::record_copy(PyArray_NBYTES(TP_ARRAY(retval)));
   return retval;
 
 }
 
 static void derefer_ndarray (PyArrayObject* array) {
+  bob::python::gil lock; ///< may be released by the last owner
   Py_XDECREF(array);
 }
 
@@ -776,11 +832,11 @@ static boost::shared_ptr<void> shared_from_ndarray (boost::python::object& o) {
   return cache; //casts to b::shared_ptr<void>
 }
 
-bob::python::py_array::py_array(boost::python::object o, boost::python::object _dtype):
+bob::python::py_array::py_array(boost::python::object o, boost::python::object _dtype, bool contiguous):
   m_is_numpy(true)
 {
   if (TPY_ISNONE(o)) PYTHON_ERROR(TypeError, "You cannot pass 'None' as input parameter to C++-bound bob methods that expect NumPy ndarrays (or blitz::Array<T,N>'s). Double-check your input!");
-  boost::python::object mine = try_refer_ndarray(o, _dtype);
+  boost::python::object mine = try_refer_ndarray(o, _dtype, contiguous);
 
   //captures data from a numeric::array
   typeinfo_ndarray_(mine, m_type);
@@ -876,8 +932,11 @@ void bob::python::py_array::set(const bob::core::array::interface& other) {
   TDEBUG1("[non-optimal] buffer copying operation being performed for "
       << other.type().str());
 
+  bob::python::gil lock;
+
   //performs a copy of the data into a numpy array
   boost::python::object mine = copy_data(other.ptr(), m_type);
+  bob::python::record_copy(PyArray_NBYTES(TP_ARRAY(mine)));
 
   //captures data from a numeric::array
   typeinfo_ndarray_(mine, m_type);
@@ -892,6 +951,7 @@ void bob::python::py_array::set(const bob::core::array::interface& other) {
 }
 
 void bob::python::py_array::set(boost::shared_ptr<bob::core::array::interface> other) {
+  bob::python::gil lock; ///< may release the current numpy array
   m_type = other->type();
   m_is_numpy = false;
   m_ptr = other->ptr();
@@ -921,6 +981,8 @@ void bob::python::py_array::set (const bob::core::array::typeinfo& req) {
   TDEBUG1("[non-optimal?] buffer re-size being performed from " << m_type.str()
       << " to " << req.str());
 
+  bob::python::gil lock;
+
   boost::python::object mine = new_from_type(req);
 
   //captures data from a numeric::array
@@ -1007,11 +1069,11 @@ bool bob::python::py_array::is_writeable() const {
 }
 
 bob::python::ndarray::ndarray(boost::python::object array_like, boost::python::object dtype_like)
-  : px(new bob::python::py_array(array_like, dtype_like)) {
+  : px(new bob::python::py_array(array_like, dtype_like, false)) {
 }
 
 bob::python::ndarray::ndarray(boost::python::object array_like)
-  : px(new bob::python::py_array(array_like, boost::python::object())) {
+  : px(new bob::python::py_array(array_like, boost::python::object(), false)) {
   }
 
 bob::python::ndarray::ndarray(const bob::core::array::typeinfo& info)
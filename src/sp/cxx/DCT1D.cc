@@ -23,6 +23,8 @@
 
 #include <bob/sp/DCT1D.h>
 #include <bob/core/assert.h>
+#include <bob/core/array_copy.h>
+#include <bob/sp/fftw.h>
 #include <fftw3.h>
 
 bob::sp::DCT1DAbstract::DCT1DAbstract(const size_t length):
@@ -114,6 +116,16 @@ bob::sp::DCT1D::~DCT1D()
 void bob::sp::DCT1D::operator()(const blitz::Array<double,1>& src, 
   blitz::Array<double,1>& dst) const
 {
+  // strided arrays (e.g. slices) go through contiguous buffers
+  if (!bob::core::array::isCZeroBaseContiguous(src) ||
+      !bob::core::array::isCZeroBaseContiguous(dst)) {
+    bob::core::array::assertSameShape(dst, src);
+    blitz::Array<double,1> dst_(dst.shape());
+    operator()(bob::core::array::ccopy(src), dst_);
+    dst = dst_;
+    return;
+  }
+
   // check input
   bob::core::array::assertCZeroBaseContiguous(src);
 
@@ -128,9 +140,15 @@ void bob::sp::DCT1D::operator()(const blitz::Array<double,1>& src,
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_r2r_1d(src.extent(0), src_, dst_, FFTW_REDFT10, FFTW_ESTIMATE);
+  {
+    bob::sp::fftw_lock lock;
+    p = fftw_plan_r2r_1d(src.extent(0), src_, dst_, FFTW_REDFT10, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    bob::sp::fftw_lock lock;
+    fftw_destroy_plan(p);
+  }
 
   // Normalize
   dst(0) *= m_sqrt_1byl/2.;
@@ -163,6 +181,16 @@ bob::sp::IDCT1D::~IDCT1D()
 void bob::sp::IDCT1D::operator()(const blitz::Array<double,1>& src, 
   blitz::Array<double,1>& dst) const
 {
+  // strided arrays (e.g. slices) go through contiguous buffers
+  if (!bob::core::array::isCZeroBaseContiguous(src) ||
+      !bob::core::array::isCZeroBaseContiguous(dst)) {
+    bob::core::array::assertSameShape(dst, src);
+    blitz::Array<double,1> dst_(dst.shape());
+    operator()(bob::core::array::ccopy(src), dst_);
+    dst = dst_;
+    return;
+  }
+
   // check input
   bob::core::array::assertCZeroBaseContiguous(src);
 
@@ -186,8 +214,14 @@ void bob::sp::IDCT1D::operator()(const blitz::Array<double,1>& src,
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_r2r_1d(src.extent(0), dst_, dst_, FFTW_REDFT01, FFTW_ESTIMATE);
+  {
+    bob::sp::fftw_lock lock;
+    p = fftw_plan_r2r_1d(src.extent(0), dst_, dst_, FFTW_REDFT01, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    bob::sp::fftw_lock lock;
+    fftw_destroy_plan(p);
+  }
 }
 
@@ -23,6 +23,8 @@
 
 #include <bob/sp/DCT2D.h>
 #include <bob/core/assert.h>
+#include <bob/core/array_copy.h>
+#include <bob/sp/fftw.h>
 #include <fftw3.h>
 
 
@@ -123,6 +125,16 @@ bob::sp::DCT2D::~DCT2D()
 void bob::sp::DCT2D::operator()(const blitz::Array<double,2>& src, 
   blitz::Array<double,2>& dst) const
 {
+  // strided arrays (e.g. slices) go through contiguous buffers
+  if (!bob::core::array::isCZeroBaseContiguous(src) ||
+      !bob::core::array::isCZeroBaseContiguous(dst)) {
+    bob::core::array::assertSameShape(dst, src);
+    blitz::Array<double,2> dst_(dst.shape());
+    operator()(bob::core::array::ccopy(src), dst_);
+    dst = dst_;
+    return;
+  }
+
   // check input
   bob::core::array::assertCZeroBaseContiguous(src);
 
@@ -137,9 +149,15 @@ void bob::sp::DCT2D::operator()(const blitz::Array<double,2>& src,
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_r2r_2d(src.extent(0), src.extent(1), src_, dst_, FFTW_REDFT10, FFTW_REDFT10, FFTW_ESTIMATE);
+  {
+    bob::sp::fftw_lock lock;
+    p = fftw_plan_r2r_2d(src.extent(0), src.extent(1), src_, dst_, FFTW_REDFT10, FFTW_REDFT10, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    bob::sp::fftw_lock lock;
+    fftw_destroy_plan(p);
+  }
 
   // Rescale the result
   for (int i=0; i<(int)m_height; ++i)
@@ -170,6 +188,16 @@ bob::sp::IDCT2D::~IDCT2D()
 void bob::sp::IDCT2D::operator()(const blitz::Array<double,2>& src, 
   blitz::Array<double,2>& dst) const
 {
+  // strided arrays (e.g. slices) go through contiguous buffers
+  if (!bob::core::array::isCZeroBaseContiguous(src) ||
+      !bob::core::array::isCZeroBaseContiguous(dst)) {
+    bob::core::array::assertSameShape(dst, src);
+    blitz::Array<double,2> dst_(dst.shape());
+    operator()(bob::core::array::ccopy(src), dst_);
+    dst = dst_;
+    return;
+  }
+
   // check input
   bob::core::array::assertCZeroBaseContiguous(src);
 
@@ -191,9 +219,15 @@ void bob::sp::IDCT2D::operator()(const blitz::Array<double,2>& src,
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_r2r_2d(src.extent(0), src.extent(1), dst_, dst_, FFTW_REDFT01, FFTW_REDFT01, FFTW_ESTIMATE);
+  {
+    bob::sp::fftw_lock lock;
+    p = fftw_plan_r2r_2d(src.extent(0), src.extent(1), dst_, dst_, FFTW_REDFT01, FFTW_REDFT01, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    bob::sp::fftw_lock lock;
+    fftw_destroy_plan(p);
+  }
   
   // Rescale the result by the size of the input 
   // (as this is not performed by FFW)
@@ -23,6 +23,8 @@
 
 #include <bob/sp/FFT1D.h>
 #include <bob/core/assert.h>
+#include <bob/core/array_copy.h>
+#include <bob/sp/fftw.h>
 #include <fftw3.h>
 
 
@@ -93,6 +95,16 @@ bob::sp::FFT1D::~FFT1D()
 void bob::sp::FFT1D::operator()(const blitz::Array<std::complex<double>,1>& src, 
   blitz::Array<std::complex<double>,1>& dst) const
 {
+  // strided arrays (e.g. slices) go through contiguous buffers
+  if (!bob::core::array::isCZeroBaseContiguous(src) ||
+      !bob::core::array::isCZeroBaseContiguous(dst)) {
+    bob::core::array::assertSameShape(dst, src);
+    blitz::Array<std::complex<double>,1> dst_(dst.shape());
+    operator()(bob::core::array::ccopy(src), dst_);
+    dst = dst_;
+    return;
+  }
+
   // check input
   bob::core::array::assertCZeroBaseContiguous(src);
 
@@ -107,9 +119,15 @@ void bob::sp::FFT1D::operator()(const blitz::Array<std::complex<double>,1>& src,
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_dft_1d(src.extent(0), src_, dst_, FFTW_FORWARD, FFTW_ESTIMATE);
+  {
+    bob::sp::fftw_lock lock;
+    p = fftw_plan_dft_1d(src.extent(0), src_, dst_, FFTW_FORWARD, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    bob::sp::fftw_lock lock;
+    fftw_destroy_plan(p);
+  }
 }
 
 
@@ -135,6 +153,16 @@ bob::sp::IFFT1D::~IFFT1D()
 void bob::sp::IFFT1D::operator()(const blitz::Array<std::complex<double>,1>& src, 
   blitz::Array<std::complex<double>,1>& dst) const
 {
+  // strided arrays (e.g. slices) go through contiguous buffers
+  if (!bob::core::array::isCZeroBaseContiguous(src) ||
+      !bob::core::array::isCZeroBaseContiguous(dst)) {
+    bob::core::array::assertSameShape(dst, src);
+    blitz::Array<std::complex<double>,1> dst_(dst.shape());
+    operator()(bob::core::array::ccopy(src), dst_);
+    dst = dst_;
+    return;
+  }
+
   // check input
   bob::core::array::assertCZeroBaseContiguous(src);
 
@@ -149,9 +177,15 @@ void bob::sp::IFFT1D::operator()(const blitz::Array<std::complex<double>,1>& src
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_dft_1d(src.extent(0), src_, dst_, FFTW_BACKWARD, FFTW_ESTIMATE);
+  {
+    bob::sp::fftw_lock lock;
+    p = fftw_plan_dft_1d(src.extent(0), src_, dst_, FFTW_BACKWARD, FFTW_ESTIMATE);
+  }
   fftw_execute(p); /* repeat as needed */
-  fftw_destroy_plan(p);
+  {
+    bob::sp::fftw_lock lock;
+    fftw_destroy_plan(p);
+  }
 
   // Rescale as FFTW is not doing it
   dst /= static_cast<double>(m_length);
@@ -23,6 +23,8 @@
 
 #include <bob/sp/FFT2D.h>
 #include <bob/core/assert.h>
+#include <bob/core/array_copy.h>
+#include <bob/sp/fftw.h>
 #include <fftw3.h>
 
 bob::sp::FFT2DAbstract::FFT2DAbstract(const size_t height, const size_t width):
@@ -87,6 +89,16 @@ bob::sp::FFT2D::~FFT2D()
 void bob::sp::FFT2D::operator()(const blitz::Array<std::complex<double>,2>& src, 
   blitz::Array<std::complex<double>,2>& dst) const
 {
+  // strided arrays (e.g. slices) go through contiguous buffers
+  if (!bob::core::array::isCZeroBaseContiguous(src) ||
+      !bob::core::array::isCZeroBaseContiguous(dst)) {
+    bob::core::array::assertSameShape(dst, src);
+    blitz::Array<std::complex<double>,2> dst_(dst.shape());
+    operator()(bob::core::array::ccopy(src), dst_);
+    dst = dst_;
+    return;
+  }
+
   // check input
   bob::core::array::assertCZeroBaseContiguous(src);
 
@@ -101,9 +113,15 @@ void bob::sp::FFT2D::operator()(const blitz::Array<std::complex<double>,2>& src,
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_dft_2d(src.extent(0), src.extent(1), src_, dst_, FFTW_FORWARD, FFTW_ESTIMATE);
+  {
+    bob::sp::fftw_lock lock;
+    p = fftw_plan_dft_2d(src.extent(0), src.extent(1), src_, dst_, FFTW_FORWARD, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    bob::sp::fftw_lock lock;
+    fftw_destroy_plan(p);
+  }
 }
 
 
@@ -118,9 +136,15 @@ void bob::sp::FFT2D::operator()(blitz::Array<std::complex<double>,2>& src_dst) c
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized
   // for large arrays
-  p = fftw_plan_dft_2d(src_dst.extent(0), src_dst.extent(1), src_dst_, src_dst_, FFTW_FORWARD, FFTW_ESTIMATE);
+  {
+    bob::sp::fftw_lock lock;
+    p = fftw_plan_dft_2d(src_dst.extent(0), src_dst.extent(1), src_dst_, src_dst_, FFTW_FORWARD, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    bob::sp::fftw_lock lock;
+    fftw_destroy_plan(p);
+  }
 }
 
 
@@ -146,6 +170,16 @@ bob::sp::IFFT2D::~IFFT2D()
 void bob::sp::IFFT2D::operator()(const blitz::Array<std::complex<double>,2>& src, 
   blitz::Array<std::complex<double>,2>& dst) const
 {
+  // strided arrays (e.g. slices) go through contiguous buffers
+  if (!bob::core::array::isCZeroBaseContiguous(src) ||
+      !bob::core::array::isCZeroBaseContiguous(dst)) {
+    bob::core::array::assertSameShape(dst, src);
+    blitz::Array<std::complex<double>,2> dst_(dst.shape());
+    operator()(bob::core::array::ccopy(src), dst_);
+    dst = dst_;
+    return;
+  }
+
   // check input
   bob::core::array::assertCZeroBaseContiguous(src);
 
@@ -160,9 +194,15 @@ void bob::sp::IFFT2D::operator()(const blitz::Array<std::complex<double>,2>& src
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
   // for large arrays
-  p = fftw_plan_dft_2d(src.extent(0), src.extent(1), src_, dst_, FFTW_BACKWARD, FFTW_ESTIMATE);
+  {
+    bob::sp::fftw_lock lock;
+    p = fftw_plan_dft_2d(src.extent(0), src.extent(1), src_, dst_, FFTW_BACKWARD, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    bob::sp::fftw_lock lock;
+    fftw_destroy_plan(p);
+  }
 
   // Rescale the result by the size of the input 
   // (as this is not performed by FFTW)
@@ -180,9 +220,15 @@ void bob::sp::IFFT2D::operator()(blitz::Array<std::complex<double>,2>& src_dst)
   fftw_plan p;
   // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized
   // for large arrays
-  p = fftw_plan_dft_2d(src_dst.extent(0), src_dst.extent(1), src_dst_, src_dst_, FFTW_BACKWARD, FFTW_ESTIMATE);
+  {
+    bob::sp::fftw_lock lock;
+    p = fftw_plan_dft_2d(src_dst.extent(0), src_dst.extent(1), src_dst_, src_dst_, FFTW_BACKWARD, FFTW_ESTIMATE);
+  }
   fftw_execute(p);
-  fftw_destroy_plan(p);
+  {
+    bob::sp::fftw_lock lock;
+    fftw_destroy_plan(p);
+  }
 
   // Rescale the result by the size of the input
   // (as this is not performed by FFTW)
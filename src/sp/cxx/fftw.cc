@@ -0,0 +1,37 @@
+/**
+ * @file sp/cxx/fftw.cc
+ * @date Mon Oct 19 09:41:27 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Serializes the calls to the FFTW planner
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/thread/mutex.hpp>
+#include <bob/sp/fftw.h>
+
+static boost::mutex& planner_mutex() {
+  static boost::mutex mutex;
+  return mutex;
+}
+
+bob::sp::fftw_lock::fftw_lock() {
+  planner_mutex().lock();
+}
+
+bob::sp::fftw_lock::~fftw_lock() {
+  planner_mutex().unlock();
+}
@@ -21,6 +21,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 
 #include <bob/sp/DCT1D.h>
 #include <bob/sp/DCT2D.h>
@@ -45,6 +46,7 @@ static void py_dct1d_c(bob::sp::DCT1D& op, bob::python::const_ndarray src,
   bob::python::ndarray dst) 
 {
   blitz::Array<double,1> dst_ = dst.bz<double,1>();
+  bob::python::no_gil unlock;
   op(src.bz<double,1>(), dst_);
 }
 
@@ -52,7 +54,10 @@ static object py_dct1d_p(bob::sp::DCT1D& op, bob::python::const_ndarray src)
 {
   bob::python::ndarray dst(bob::core::array::t_float64, op.getLength());
   blitz::Array<double,1> dst_ = dst.bz<double,1>();
-  op(src.bz<double,1>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<double,1>(), dst_);
+  }
   return dst.self();
 }
 
@@ -60,6 +65,7 @@ static void py_idct1d_c(bob::sp::IDCT1D& op, bob::python::const_ndarray src,
   bob::python::ndarray dst) 
 {
   blitz::Array<double,1> dst_ = dst.bz<double,1>();
+  bob::python::no_gil unlock;
   op(src.bz<double,1>(), dst_);
 }
 
@@ -67,7 +73,10 @@ static object py_idct1d_p(bob::sp::IDCT1D& op, bob::python::const_ndarray src)
 {
   bob::python::ndarray dst(bob::core::array::t_float64, op.getLength());
   blitz::Array<double,1> dst_ = dst.bz<double,1>();
-  op(src.bz<double,1>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<double,1>(), dst_);
+  }
   return dst.self();
 }
 
@@ -76,6 +85,7 @@ static void py_dct2d_c(bob::sp::DCT2D& op, bob::python::const_ndarray src,
   bob::python::ndarray dst) 
 {
   blitz::Array<double,2> dst_ = dst.bz<double,2>();
+  bob::python::no_gil unlock;
   op(src.bz<double,2>(), dst_);
 }
 
@@ -84,7 +94,10 @@ static object py_dct2d_p(bob::sp::DCT2D& op, bob::python::const_ndarray src)
   bob::python::ndarray dst(bob::core::array::t_float64, op.getHeight(), 
     op.getWidth());
   blitz::Array<double,2> dst_ = dst.bz<double,2>();
-  op(src.bz<double,2>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<double,2>(), dst_);
+  }
   return dst.self();
 }
 
@@ -92,6 +105,7 @@ static void py_idct2d_c(bob::sp::IDCT2D& op, bob::python::const_ndarray src,
   bob::python::ndarray dst) 
 {
   blitz::Array<double,2> dst_ = dst.bz<double,2>();
+  bob::python::no_gil unlock;
   op(src.bz<double,2>(), dst_);
 }
 
@@ -100,7 +114,10 @@ static object py_idct2d_p(bob::sp::IDCT2D& op, bob::python::const_ndarray src)
   bob::python::ndarray dst(bob::core::array::t_float64, op.getHeight(), 
     op.getWidth());
   blitz::Array<double,2> dst_ = dst.bz<double,2>();
-  op(src.bz<double,2>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<double,2>(), dst_);
+  }
   return dst.self();
 }
 
@@ -114,6 +131,7 @@ static object script_dct(bob::python::const_ndarray ar)
       {
         bob::sp::DCT1D op(info.shape[0]);
         blitz::Array<double,1> res_ = res.bz<double,1>();
+        bob::python::no_gil unlock;
         op(ar.bz<double,1>(), res_);
       }
       break;
@@ -121,6 +139,7 @@ static object script_dct(bob::python::const_ndarray ar)
       {
         bob::sp::DCT2D op(info.shape[0], info.shape[1]);
         blitz::Array<double,2> res_ = res.bz<double,2>();
+        bob::python::no_gil unlock;
         op(ar.bz<double,2>(), res_);
       }
       break;
@@ -138,6 +157,7 @@ static object script_idct(bob::python::const_ndarray ar) {
       {
         bob::sp::IDCT1D op(info.shape[0]);
         blitz::Array<double,1> res_ = res.bz<double,1>();
+        bob::python::no_gil unlock;
         op(ar.bz<double,1>(), res_);
       }
       break;
@@ -145,6 +165,7 @@ static object script_idct(bob::python::const_ndarray ar) {
       {
         bob::sp::IDCT2D op(info.shape[0], info.shape[1]);
         blitz::Array<double,2> res_ = res.bz<double,2>();
+        bob::python::no_gil unlock;
         op(ar.bz<double,2>(), res_);
       }
       break;
@@ -22,6 +22,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 
 #include <bob/sp/FFT1D.h>
 #include <bob/sp/FFT2D.h>
@@ -50,6 +51,7 @@ static void py_fft1d_c(bob::sp::FFT1D& op, bob::python::const_ndarray src,
   bob::python::ndarray dst) 
 {
   blitz::Array<std::complex<double>,1> dst_ = dst.bz<std::complex<double>,1>();
+  bob::python::no_gil unlock;
   op(src.bz<std::complex<double>,1>(), dst_);
 }
 
@@ -57,7 +59,10 @@ static object py_fft1d_p(bob::sp::FFT1D& op, bob::python::const_ndarray src)
 {
   bob::python::ndarray dst(bob::core::array::t_complex128, op.getLength());
   blitz::Array<std::complex<double>,1> dst_ = dst.bz<std::complex<double>,1>();
-  op(src.bz<std::complex<double>,1>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<std::complex<double>,1>(), dst_);
+  }
   return dst.self();
 }
 
@@ -65,6 +70,7 @@ static void py_ifft1d_c(bob::sp::IFFT1D& op, bob::python::const_ndarray src,
   bob::python::ndarray dst) 
 {
   blitz::Array<std::complex<double>,1> dst_ = dst.bz<std::complex<double>,1>();
+  bob::python::no_gil unlock;
   op(src.bz<std::complex<double>,1>(), dst_);
 }
 
@@ -72,7 +78,10 @@ static object py_ifft1d_p(bob::sp::IFFT1D& op, bob::python::const_ndarray src)
 {
   bob::python::ndarray dst(bob::core::array::t_complex128, op.getLength());
   blitz::Array<std::complex<double>,1> dst_ = dst.bz<std::complex<double>,1>();
-  op(src.bz<std::complex<double>,1>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<std::complex<double>,1>(), dst_);
+  }
   return dst.self();
 }
 
@@ -81,6 +90,7 @@ static void py_fft2d_c(bob::sp::FFT2D& op, bob::python::const_ndarray src,
   bob::python::ndarray dst) 
 {
   blitz::Array<std::complex<double>,2> dst_ = dst.bz<std::complex<double>,2>();
+  bob::python::no_gil unlock;
   op(src.bz<std::complex<double>,2>(), dst_);
 }
 
@@ -89,7 +99,10 @@ static object py_fft2d_p(bob::sp::FFT2D& op, bob::python::const_ndarray src)
   bob::python::ndarray dst(bob::core::array::t_complex128, op.getHeight(), 
     op.getWidth());
   blitz::Array<std::complex<double>,2> dst_ = dst.bz<std::complex<double>,2>();
-  op(src.bz<std::complex<double>,2>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<std::complex<double>,2>(), dst_);
+  }
   return dst.self();
 }
 
@@ -97,6 +110,7 @@ static void py_ifft2d_c(bob::sp::IFFT2D& op, bob::python::const_ndarray src,
   bob::python::ndarray dst) 
 {
   blitz::Array<std::complex<double>,2> dst_ = dst.bz<std::complex<double>,2>();
+  bob::python::no_gil unlock;
   op(src.bz<std::complex<double>,2>(), dst_);
 }
 
@@ -105,7 +119,10 @@ static object py_ifft2d_p(bob::sp::IFFT2D& op, bob::python::const_ndarray src)
   bob::python::ndarray dst(bob::core::array::t_complex128, op.getHeight(), 
     op.getWidth());
   blitz::Array<std::complex<double>,2> dst_ = dst.bz<std::complex<double>,2>();
-  op(src.bz<std::complex<double>,2>(), dst_);
+  {
+    bob::python::no_gil unlock;
+    op(src.bz<std::complex<double>,2>(), dst_);
+  }
   return dst.self();
 }
 
@@ -120,6 +137,7 @@ static object script_fft(bob::python::const_ndarray ar)
       {
         bob::sp::FFT1D op(info.shape[0]);
         blitz::Array<dcplx,1> res_ = res.bz<dcplx,1>();
+        bob::python::no_gil unlock;
         op(ar.bz<dcplx,1>(), res_);
       }
       break;
@@ -127,6 +145,7 @@ static object script_fft(bob::python::const_ndarray ar)
       {
         bob::sp::FFT2D op(info.shape[0], info.shape[1]);
         blitz::Array<dcplx,2> res_ = res.bz<dcplx,2>();
+        bob::python::no_gil unlock;
         op(ar.bz<dcplx,2>(), res_);
       }
       break;
@@ -146,6 +165,7 @@ static object script_ifft(bob::python::const_ndarray ar)
       {
         bob::sp::IFFT1D op(info.shape[0]);
         blitz::Array<dcplx,1> res_ = res.bz<dcplx,1>();
+        bob::python::no_gil unlock;
         op(ar.bz<dcplx,1>(), res_);
       }
       break;
@@ -153,6 +173,7 @@ static object script_ifft(bob::python::const_ndarray ar)
       {
         bob::sp::IFFT2D op(info.shape[0], info.shape[1]);
         blitz::Array<dcplx,2> res_ = res.bz<dcplx,2>();
+        bob::python::no_gil unlock;
         op(ar.bz<dcplx,2>(), res_);
       }
       break;
@@ -21,13 +21,515 @@
 #include <bob/trainer/CGLogRegTrainer.h>
 #include <bob/math/linear.h>
 #include <bob/core/logging.h>
+#include <bob/core/assert.h>
+#include <bob/core/array_copy.h>
+#include <bob/core/check.h>
+#include <bob/core/parallel.h>
+#include <bob/lbfgs/lbfgs.h>
+#include <cmath>
 #include <limits>
+#include <vector>
+
+namespace {
+
+  /**
+   * Number of chunks of rows read at once when the samples come from a file
+   */
+  static const size_t CHUNKS_PER_READ = 64;
+
+  /**
+   * Returns log(1 + exp(-z)) and sets s to 1 / (1 + exp(z)), avoiding
+   * overflows for large values of |z|
+   */
+  static inline double logistic_loss(const double z, double& s)
+  {
+    if(z >= 0.)
+    {
+      const double e = exp(-z);
+      s = e / (1. + e);
+      return log1p(e);
+    }
+    const double e = exp(z);
+    s = 1. / (1. + e);
+    return -z + log1p(e);
+  }
+
+  /**
+   * Loss and gradient of the samples of one class (label y) stored in a
+   * C-contiguous rows x D array X, in chunks of rows. The bias is the
+   * (D+1)-th weight. For each chunk c, this computes:
+   *   loss[c] = sum_i weight log(1 + exp(-z_i))
+   *   grad[c] = sum_i weight sigmoid(-z_i) y [x_i, 1]
+   * where z_i = y (w^T [x_i, 1] + logit), and optionally caches
+   * h_i = weight sigmoid(z_i) sigmoid(-z_i) for the curvature.
+   */
+  struct GradientChunks
+  {
+    const double* X;
+    size_t rows;
+    size_t D;
+    size_t chunk;
+    double y;
+    double weight;
+    double logit;
+    const double* w;
+    double* h;
+    std::vector<double>& loss;
+    std::vector<double>& grad;
+
+    GradientChunks(const double* X_, size_t rows_, size_t D_, size_t chunk_,
+        double y_, double weight_, double logit_, const double* w_,
+        double* h_, std::vector<double>& loss_, std::vector<double>& grad_):
+      X(X_), rows(rows_), D(D_), chunk(chunk_), y(y_), weight(weight_),
+      logit(logit_), w(w_), h(h_), loss(loss_), grad(grad_) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const
+    {
+      for(uint64_t c=begin; c<end; ++c)
+      {
+        double* g = &grad[c*(D+1)];
+        std::fill(g, g+D+1, 0.);
+        double l = 0.;
+        const size_t r1 = std::min((size_t)(c+1)*chunk, rows);
+        for(size_t r=c*chunk; r<r1; ++r)
+        {
+          const double* x = X + r*D;
+          double a = w[D];
+          for(size_t f=0; f<D; ++f) a += w[f] * x[f];
+          double s;
+          l += weight * logistic_loss(y * (a + logit), s);
+          const double coef = weight * s * y;
+          for(size_t f=0; f<D; ++f) g[f] += coef * x[f];
+          g[D] += coef;
+          if(h) h[r] = weight * s * (1. - s);
+        }
+        loss[c] = l;
+      }
+    }
+  };
+
+  /**
+   * Curvature u^T H u of the loss of the samples of one class along the
+   * direction u, in chunks of rows:
+   *   uhu[c] = sum_i h_i (u^T [x_i, 1])^2
+   * where h_i is taken from the cache filled by GradientChunks (if any) or
+   * recomputed from w.
+   */
+  struct CurvatureChunks
+  {
+    const double* X;
+    size_t rows;
+    size_t D;
+    size_t chunk;
+    double y;
+    double weight;
+    double logit;
+    const double* w;
+    const double* u;
+    const double* h;
+    std::vector<double>& uhu;
+
+    CurvatureChunks(const double* X_, size_t rows_, size_t D_, size_t chunk_,
+        double y_, double weight_, double logit_, const double* w_,
+        const double* u_, const double* h_, std::vector<double>& uhu_):
+      X(X_), rows(rows_), D(D_), chunk(chunk_), y(y_), weight(weight_),
+      logit(logit_), w(w_), u(u_), h(h_), uhu(uhu_) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const
+    {
+      for(uint64_t c=begin; c<end; ++c)
+      {
+        double acc = 0.;
+        const size_t r1 = std::min((size_t)(c+1)*chunk, rows);
+        for(size_t r=c*chunk; r<r1; ++r)
+        {
+          const double* x = X + r*D;
+          double b = u[D];
+          for(size_t f=0; f<D; ++f) b += u[f] * x[f];
+          double hr;
+          if(h) hr = h[r];
+          else
+          {
+            double a = w[D];
+            for(size_t f=0; f<D; ++f) a += w[f] * x[f];
+            double s;
+            logistic_loss(y * (a + logit), s);
+            hr = weight * s * (1. - s);
+          }
+          acc += hr * b * b;
+        }
+        uhu[c] = acc;
+      }
+    }
+  };
+
+  /**
+   * The samples of one class, visited in blocks of rows
+   */
+  class Samples
+  {
+    public:
+      virtual ~Samples() {}
+      virtual size_t size() const =0; ///< number of samples
+      virtual size_t features() const =0; ///< number of features
+      virtual size_t blocks() const =0; ///< number of blocks
+      /// Points X to the (C-contiguous) block i
+      virtual void block(const size_t i, blitz::Array<double,2>& X) =0;
+      /// Cache of the curvature terms of the samples of block i (or 0)
+      virtual double* cache(const size_t i) =0;
+  };
+
+  /**
+   * Samples in memory, in a single block, with a cache of the curvature
+   * terms
+   */
+  class ArraySamples: public Samples
+  {
+    public:
+      ArraySamples(const blitz::Array<double,2>& X)
+      {
+        if(bob::core::array::isCZeroBaseContiguous(X)) m_X.reference(X);
+        else m_X.reference(bob::core::array::ccopy(X));
+        m_cache.resize(m_X.extent(0));
+      }
+      size_t size() const { return m_X.extent(0); }
+      size_t features() const { return m_X.extent(1); }
+      size_t blocks() const { return 1; }
+      void block(const size_t, blitz::Array<double,2>& X) { X.reference(m_X); }
+      double* cache(const size_t) { return m_cache.size() ? &m_cache[0] : 0; }
+
+    private:
+      blitz::Array<double,2> m_X;
+      std::vector<double> m_cache;
+  };
+
+  /**
+   * Samples read from a file (one 1D array per sample), in blocks of a given
+   * number of rows
+   */
+  class FileSamples: public Samples
+  {
+    public:
+      FileSamples(bob::io::File& file, const size_t rows):
+        m_file(file), m_rows(rows)
+      {
+        const bob::core::array::typeinfo& info = file.type();
+        if(info.nd != 1)
+        {
+          boost::format m("The arrays in file '%s' should be samples (1D arrays), but have %u dimensions.");
+          m % file.filename() % info.nd;
+          throw std::runtime_error(m.str());
+        }
+        m_features = info.shape[0];
+      }
+      size_t size() const { return m_file.size(); }
+      size_t features() const { return m_features; }
+      size_t blocks() const { return (size() + m_rows - 1) / m_rows; }
+      void block(const size_t i, blitz::Array<double,2>& X)
+      {
+        const size_t start = i * m_rows;
+        const int rows = std::min(m_rows, size() - start);
+        if(m_X.extent(0) != rows) m_X.resize(rows, m_features);
+        blitz::Range rall = blitz::Range::all();
+        for(int r=0; r<rows; ++r)
+        {
+          blitz::Array<double,1> x = m_file.cast<double,1>(start + r);
+          bob::core::array::assertSameDimensionLength(x.extent(0), m_features);
+          m_X(r,rall) = x;
+        }
+        X.reference(m_X);
+      }
+      double* cache(const size_t) { return 0; }
+
+    private:
+      bob::io::File& m_file;
+      size_t m_rows;
+      int m_features;
+      blitz::Array<double,2> m_X;
+  };
+
+  /**
+   * The objective function of the trainer, weighted by the prior and the
+   * proportion of samples of each class:
+   *   f(w) = sum_i weight_i log(1 + exp(-z_i)) + lambda/2 w^T w
+   * Chunks are evaluated in parallel, and their partial sums are added in
+   * order.
+   */
+  class Objective
+  {
+    public:
+      Objective(Samples& negatives, Samples& positives, const double prior,
+          const double lambda, const size_t n_threads, const size_t chunk):
+        m_D(positives.features()), m_lambda(lambda),
+        m_logit(log(prior/(1.-prior))), m_n_threads(n_threads),
+        m_chunk(chunk)
+      {
+        bob::core::array::assertSameDimensionLength(negatives.features(),
+          positives.features());
+        if(negatives.size() == 0 || positives.size() == 0)
+          throw std::runtime_error("Linear Logistic Regression requires samples of both classes.");
+        m_samples[0] = &negatives;
+        m_samples[1] = &positives;
+        m_label[0] = -1.;
+        m_label[1] = 1.;
+        const double prop = (double)positives.size() / (double)size();
+        m_weight[0] = (1.-prior) / (1.-prop);
+        m_weight[1] = prior / prop;
+      }
+
+      size_t size() const
+      { return m_samples[0]->size() + m_samples[1]->size(); }
+
+      size_t features() const { return m_D; }
+
+      /**
+       * Returns f(w) and sets g to -df/dw (the direction of ascent of the
+       * weighted log-likelihood)
+       */
+      double gradient(const double* w, double* g)
+      {
+        const size_t D1 = m_D + 1;
+        std::fill(g, g+D1, 0.);
+        double loss = 0.;
+        for(int k=0; k<2; ++k)
+        {
+          Samples& samples = *m_samples[k];
+          for(size_t b=0; b<samples.blocks(); ++b)
+          {
+            samples.block(b, m_X);
+            const size_t rows = m_X.extent(0);
+            const size_t n_chunks = (rows + m_chunk - 1) / m_chunk;
+            m_partial.resize(n_chunks);
+            m_partial_grad.resize(n_chunks * D1);
+            bob::core::parallel_for(n_chunks, GradientChunks(m_X.data(), rows,
+                  m_D, m_chunk, m_label[k], m_weight[k], m_logit, w,
+                  samples.cache(b), m_partial, m_partial_grad), m_n_threads);
+            for(size_t c=0; c<n_chunks; ++c)
+            {
+              loss += m_partial[c];
+              for(size_t f=0; f<D1; ++f) g[f] += m_partial_grad[c*D1+f];
+            }
+          }
+        }
+        double ww = 0.;
+        for(size_t f=0; f<D1; ++f)
+        {
+          g[f] -= m_lambda * w[f];
+          ww += w[f] * w[f];
+        }
+        return loss + 0.5 * m_lambda * ww;
+      }
+
+      /**
+       * Returns u^T H u, where H is the Hessian of f at w. Must be called
+       * after gradient() for the same w, as the curvature terms of the
+       * samples in memory are cached there.
+       */
+      double curvature(const double* w, const double* u)
+      {
+        double uhu = 0.;
+        for(int k=0; k<2; ++k)
+        {
+          Samples& samples = *m_samples[k];
+          for(size_t b=0; b<samples.blocks(); ++b)
+          {
+            samples.block(b, m_X);
+            const size_t rows = m_X.extent(0);
+            const size_t n_chunks = (rows + m_chunk - 1) / m_chunk;
+            m_partial.resize(n_chunks);
+            bob::core::parallel_for(n_chunks, CurvatureChunks(m_X.data(),
+                  rows, m_D, m_chunk, m_label[k], m_weight[k], m_logit, w, u,
+                  samples.cache(b), m_partial), m_n_threads);
+            for(size_t c=0; c<n_chunks; ++c) uhu += m_partial[c];
+          }
+        }
+        double uu = 0.;
+        for(size_t f=0; f<=m_D; ++f) uu += u[f] * u[f];
+        return uhu + m_lambda * uu;
+      }
+
+    private:
+      Samples* m_samples[2]; ///< negatives and positives
+      double m_label[2];
+      double m_weight[2];
+      size_t m_D;
+      double m_lambda;
+      double m_logit;
+      size_t m_n_threads;
+      size_t m_chunk;
+      blitz::Array<double,2> m_X;
+      std::vector<double> m_partial;
+      std::vector<double> m_partial_grad;
+  };
+
+  /**
+   * Maximizes the weighted log-likelihood with conjugate gradient
+   */
+  static void train_cg(Objective& objective, const double convergence_threshold,
+      const size_t max_iterations, blitz::Array<double,1>& w)
+  {
+    const int D1 = objective.features() + 1;
+
+    // Initializes gradient and w vectors
+    blitz::Array<double,1> g_old(D1);
+    blitz::Array<double,1> w_old(D1);
+    blitz::Array<double,1> g(D1);
+    g_old = 0.;
+    w_old = 0.;
+    g = 0.;
+    w = 0.;
+
+    // Initialize working arrays
+    blitz::Array<double,1> u(D1);
+    blitz::Array<double,1> tmp_d(D1);
+
+    // Iterates...
+    static const double ten_epsilon = 10*std::numeric_limits<double>::epsilon();
+    for(size_t iter=0; ; ++iter) 
+    {
+      // 1. Gradient g of the weighted likelihood wrt. the weight vector w
+      //    (including the regularization)
+      objective.gradient(w.data(), g.data());
+
+      // 2. Conjugate gradient step
+      if(iter == 0) 
+        u = g;
+      else
+      {
+        tmp_d = (g-g_old);
+        double den = blitz::sum(u * tmp_d);
+        if(den == 0) 
+          u = 0.;
+        else
+        {
+          // Hestenes-Stiefel formula: Heuristic to set the scale factor beta
+          //   (chosen as it works well in practice)
+          // beta = g^t(g-g_old) / (u_old^T (g - g_old))
+          double beta = blitz::sum(tmp_d * g) / den;
+          u = g - beta * u;
+        }
+      }
+
+      // 3. Line search along the direction u
+      // a. Compute u^T H u 
+      //      = sum_{i} weights(i) sigmoid(w^T x_i) [1-sigmoid(w^T x_i)] (u^T x_i) + lambda u^T u
+      double uhu = objective.curvature(w.data(), u.data());
+      // Terminates if uhu is close to zero
+      if(fabs(uhu) < ten_epsilon)
+      {
+        bob::core::info << "# CGLogReg Training terminated: convergence after " << iter << " iterations (u^T H u == 0)." << std::endl;
+        break;
+      }
+      // b. Compute w = w_old - (g^T u)/(u^T H u) u
+      w = w + blitz::sum(u*g) / uhu * u;
+      
+      // Terminates if convergence has been reached
+      if(blitz::max(blitz::fabs(w-w_old)) <= convergence_threshold) 
+      {
+        bob::core::info << "# CGLogReg Training terminated: convergence after " << iter << " iterations." << std::endl;
+        break;
+      }
+      // Terminates if maximum number of iterations has been reached
+      if(max_iterations > 0 && iter+1 >= max_iterations) 
+      {
+        bob::core::info << "# CGLogReg terminated: maximum number of iterations (" << max_iterations << ") reached." << std::endl;
+        break;
+      }
+
+      // Backup previous values
+      g_old = g;
+      w_old = w;
+    }
+  }
+
+  /**
+   * libLBFGS callback: objective and gradient, normalized by the number of
+   * samples
+   */
+  static lbfgsfloatval_t evaluate(void* instance, const lbfgsfloatval_t* x,
+      lbfgsfloatval_t* g, const int n, const lbfgsfloatval_t)
+  {
+    Objective* objective = static_cast<Objective*>(instance);
+    const double scale = 1. / objective->size();
+    const double f = objective->gradient(x, g);
+    for(int i=0; i<n; ++i) g[i] *= -scale;
+    return f * scale;
+  }
+
+  /**
+   * Minimizes the (normalized) objective function with libLBFGS
+   */
+  static void train_lbfgs(Objective& objective, const double convergence_threshold,
+      const size_t max_iterations, blitz::Array<double,1>& w)
+  {
+    const int D1 = objective.features() + 1;
+
+    lbfgs_parameter_t param;
+    lbfgs_parameter_init(&param);
+    param.epsilon = convergence_threshold;
+    param.max_iterations = max_iterations; // 0 <-> until convergence
+
+    lbfgsfloatval_t* x = lbfgs_malloc(D1);
+    std::fill(x, x + D1, 0.);
+    lbfgsfloatval_t fx = 0.;
+    const int ret = lbfgs(D1, x, &fx, evaluate, NULL, (void*)&objective,
+        &param);
+    for(int i=0; i<D1; ++i) w(i) = x[i];
+    lbfgs_free(x);
+
+    switch(ret)
+    {
+      case LBFGS_SUCCESS:
+      case LBFGS_ALREADY_MINIMIZED:
+        bob::core::info << "# CGLogReg Training terminated: L-BFGS convergence (objective " << fx << ")." << std::endl;
+        break;
+      case LBFGSERR_MAXIMUMITERATION:
+        bob::core::info << "# CGLogReg terminated: maximum number of iterations (" << max_iterations << ") reached." << std::endl;
+        break;
+      case LBFGSERR_ROUNDING_ERROR:
+      case LBFGSERR_MINIMUMSTEP:
+      case LBFGSERR_MAXIMUMSTEP:
+      case LBFGSERR_MAXIMUMLINESEARCH:
+        bob::core::info << "# CGLogReg Training terminated: L-BFGS line search stopped (code " << ret << ", objective " << fx << ")." << std::endl;
+        break;
+      default:
+        {
+          boost::format m("The L-BFGS optimizer failed with code %d.");
+          m % ret;
+          throw std::runtime_error(m.str());
+        }
+    }
+  }
+
+  static void train_objective(const bob::trainer::CGLogRegTrainer& trainer,
+      Objective& objective, bob::machine::LinearMachine& machine)
+  {
+    const size_t n_features = objective.features();
+    blitz::Array<double,1> w(n_features+1);
+    if(trainer.getSolver() == bob::trainer::CGLogRegTrainer::LBFGS)
+      train_lbfgs(objective, trainer.getConvergenceThreshold(),
+        trainer.getMaxIterations(), w);
+    else
+      train_cg(objective, trainer.getConvergenceThreshold(),
+        trainer.getMaxIterations(), w);
+
+    // Updates the LinearMachine
+    machine.resize(n_features, 1);
+    machine.setInputSubtraction(0.); // No subtraction
+    machine.setInputDivision(1.); // No division
+    blitz::Array<double,2>& w_ = machine.updateWeights();
+    w_(blitz::Range::all(),0) = w(blitz::Range(0,n_features-1)); // Weights: first D values
+    machine.setBiases(w(n_features)); // Bias: D+1 value
+  }
+
+}
 
 bob::trainer::CGLogRegTrainer::CGLogRegTrainer(const double prior, 
   const double convergence_threshold, const size_t max_iterations,
   const double lambda):
     m_prior(prior), m_convergence_threshold(convergence_threshold), 
-    m_max_iterations(max_iterations), m_lambda(lambda)
+    m_max_iterations(max_iterations), m_lambda(lambda),
+    m_solver(CONJUGATE_GRADIENT), m_n_threads(0), m_block_size(1024)
 {
   if(prior<=0. || prior>=1.) 
   {
@@ -41,7 +543,10 @@ bob::trainer::CGLogRegTrainer::CGLogRegTrainer(const bob::trainer::CGLogRegTrain
   m_prior(other.m_prior),
   m_convergence_threshold(other.m_convergence_threshold), 
   m_max_iterations(other.m_max_iterations),
-  m_lambda(other.m_lambda)
+  m_lambda(other.m_lambda),
+  m_solver(other.m_solver),
+  m_n_threads(other.m_n_threads),
+  m_block_size(other.m_block_size)
 {
 }
 
@@ -56,6 +561,9 @@ bob::trainer::CGLogRegTrainer& bob::trainer::CGLogRegTrainer::operator=
     m_convergence_threshold = other.m_convergence_threshold;
     m_max_iterations = other.m_max_iterations;
     m_lambda = other.m_lambda;
+    m_solver = other.m_solver;
+    m_n_threads = other.m_n_threads;
+    m_block_size = other.m_block_size;
   }
   return *this;
 }
@@ -66,7 +574,10 @@ bob::trainer::CGLogRegTrainer::operator==(const bob::trainer::CGLogRegTrainer& b
   return (this->m_prior == b.m_prior &&
           this->m_convergence_threshold == b.m_convergence_threshold &&
           this->m_max_iterations == b.m_max_iterations &&
-          this->m_lambda == b.m_lambda);
+          this->m_lambda == b.m_lambda &&
+          this->m_solver == b.m_solver &&
+          this->m_n_threads == b.m_n_threads &&
+          this->m_block_size == b.m_block_size);
 }
 
 bool 
@@ -81,132 +592,18 @@ void bob::trainer::CGLogRegTrainer::train(bob::machine::LinearMachine& machine,
   // Checks for arraysets data type and shape once
   bob::core::array::assertSameDimensionLength(negatives.extent(1), positives.extent(1));
 
-  // Data is checked now and conforms, just proceed w/o any further checks.
-  size_t n_samples1 = positives.extent(0);
-  size_t n_samples2 = negatives.extent(0);
-  size_t n_samples = n_samples1 + n_samples2;
-  size_t n_features = positives.extent(1);
-
-  // Defines useful ranges  
-  blitz::Range rall = blitz::Range::all();
-  blitz::Range rd = blitz::Range(0,n_features-1);
-  blitz::Range r1 = blitz::Range(0,n_samples1-1);
-  blitz::Range r2 = blitz::Range(n_samples1,n_samples-1);
-
-  // Creates a large blitz::Array containing the samples
-  // x = |positives - negatives|, of size (n_features+1,n_samples1+n_samples2)
-  //     |1.  -1. |
-  blitz::Array<double,2> x(n_features+1, n_samples);
-  x(n_features,r1) = 1.;
-  x(n_features,r2) = -1.;
-  for(size_t i=0; i<n_samples1; ++i)
-    x(rd,i) = positives(i,rall);
-  for(size_t i=0; i<n_samples2; ++i)
-    x(rd,i+n_samples1) = -negatives(i,rall);
-
-  // Ratio between the two classes and weights vector
-  double prop = (double)n_samples1 / (double)n_samples;
-  blitz::Array<double,1> weights(n_samples);
-  weights(r1) = m_prior / prop;
-  weights(r2) = (1.-m_prior) / (1.-prop);
-  
-  // Initializes offset vector
-  blitz::Array<double,1> offset(n_samples);
-  const double logit = log(m_prior/(1.-m_prior));
-  offset(r1) = logit;
-  offset(r2) = -logit;
-
-  // Initializes gradient and w vectors
-  blitz::Array<double,1> g_old(n_features+1);
-  blitz::Array<double,1> w_old(n_features+1);
-  blitz::Array<double,1> g(n_features+1);
-  blitz::Array<double,1> w(n_features+1);
-  g_old = 0.;
-  w_old = 0.;
-  g = 0.;
-  w = 0.;
-
-  // Initialize working arrays
-  blitz::Array<double,1> s1(n_samples);
-  blitz::Array<double,1> u(n_features+1);
-  blitz::Array<double,1> tmp_n(n_samples);
-  blitz::Array<double,1> tmp_d(n_features+1);
-
-  // Iterates...
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  static const double ten_epsilon = 10*std::numeric_limits<double>::epsilon();
-  for(size_t iter=0; ; ++iter) 
-  {
-    // 1. Computes the non-weighted version of the likelihood
-    // s1 = sum_{i=1}^{n}(1./(1.+exp(-y_i (w^T x_i + logit))
-    //   where - the x blitz::Array contains -y_i x_i values
-    //         - the offset blitz::Array contains -y_i logit values
-    s1 = 1. / (1. + blitz::exp(blitz::sum(w(j)*x(j,i), j) + offset));
-    // 2. Likelihood weighted by the prior/proportion
-    tmp_n = s1 * weights;
-    // 3. Gradient g of this weighted likelihood wrt. the weight vector w
-    bob::math::prod(x, tmp_n, g);
-    g -= m_lambda * w; // Regularization
-
-    // 4. Conjugate gradient step
-    if(iter == 0) 
-      u = g;
-    else
-    {
-      tmp_d = (g-g_old);
-      double den = blitz::sum(u * tmp_d);
-      if(den == 0) 
-        u = 0.;
-      else
-      {
-        // Hestenes-Stiefel formula: Heuristic to set the scale factor beta
-        //   (chosen as it works well in practice)
-        // beta = g^t(g-g_old) / (u_old^T (g - g_old))
-        double beta = blitz::sum(tmp_d * g) / den;
-        u = g - beta * u;
-      }
-    }
-
-    // 5. Line search along the direction u
-    // a. Compute ux
-    bob::math::prod(u,x,tmp_n);
-    // b. Compute u^T H u 
-    //      = sum_{i} weights(i) sigmoid(w^T x_i) [1-sigmoid(w^T x_i)] (u^T x_i) + lambda u^T u
-    double uhu = blitz::sum(blitz::pow2(tmp_n) * weights * s1 * (1.-s1)) + m_lambda*blitz::sum(blitz::pow2(u));
-    // Terminates if uhu is close to zero
-    if(fabs(uhu) < ten_epsilon)
-    {
-      bob::core::info << "# CGLogReg Training terminated: convergence after " << iter << " iterations (u^T H u == 0)." << std::endl;
-      break;
-    }
-    // c. Compute w = w_old - (g^T u)/(u^T H u) u
-    w = w + blitz::sum(u*g) / uhu * u;
-    
-    // Terminates if convergence has been reached
-    if(blitz::max(blitz::fabs(w-w_old)) <= m_convergence_threshold) 
-    {
-      bob::core::info << "# CGLogReg Training terminated: convergence after " << iter << " iterations." << std::endl;
-      break;
-    }
-    // Terminates if maximum number of iterations has been reached
-    if(m_max_iterations > 0 && iter+1 >= m_max_iterations) 
-    {
-      bob::core::info << "# CGLogReg terminated: maximum number of iterations (" << m_max_iterations << ") reached." << std::endl;
-      break;
-    }
-
-    // Backup previous values
-    g_old = g;
-    w_old = w;
-  }
-
-  // Updates the LinearMachine
-  machine.resize(n_features, 1);
-  machine.setInputSubtraction(0.); // No subtraction
-  machine.setInputDivision(1.); // No division
-  blitz::Array<double,2>& w_ = machine.updateWeights();
-  w_(rall,0) = w(rd); // Weights: first D values
-  machine.setBiases(w(n_features)); // Bias: D+1 value
+  // The samples are used in place (or copied once if not C-contiguous)
+  ArraySamples neg(negatives);
+  ArraySamples pos(positives);
+  Objective objective(neg, pos, m_prior, m_lambda, m_n_threads, m_block_size);
+  train_objective(*this, objective, machine);
 }
 
+void bob::trainer::CGLogRegTrainer::train(bob::machine::LinearMachine& machine, 
+  bob::io::File& negatives, bob::io::File& positives) const 
+{
+  FileSamples neg(negatives, CHUNKS_PER_READ * m_block_size);
+  FileSamples pos(positives, CHUNKS_PER_READ * m_block_size);
+  Objective objective(neg, pos, m_prior, m_lambda, m_n_threads, m_block_size);
+  train_objective(*this, objective, machine);
+}
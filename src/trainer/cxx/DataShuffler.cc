@@ -20,9 +20,11 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+
 #include <stdexcept>
 #include <sys/time.h>
 #include <boost/format.hpp>
+#include <boost/bind.hpp>
 
 #include <bob/core/assert.h>
 #include <bob/core/array_copy.h>
@@ -31,13 +33,27 @@
 bob::trainer::DataShuffler::DataShuffler
 (const std::vector<blitz::Array<double,2> >& data,
  const std::vector<blitz::Array<double,1> >& target):
-  m_data(data.size()),
-  m_target(target.size()),
-  m_range(),
   m_do_stdnorm(false),
-  m_mean(),
-  m_stddev()
+  m_epoch(false),
+  m_prefetch_size(0)
 {
+  init(data, target, true);
+}
+
+bob::trainer::DataShuffler::DataShuffler
+(const std::vector<blitz::Array<double,2> >& data,
+ const std::vector<blitz::Array<double,1> >& target, bool copy):
+  m_do_stdnorm(false),
+  m_epoch(false),
+  m_prefetch_size(0)
+{
+  init(data, target, copy);
+}
+
+void bob::trainer::DataShuffler::init
+(const std::vector<blitz::Array<double,2> >& data,
+ const std::vector<blitz::Array<double,1> >& target, bool copy) {
+
   if (data.size() == 0) 
     throw std::runtime_error("data vector cannot be empty");
   if (target.size() == 0) 
@@ -63,15 +79,25 @@ bob::trainer::DataShuffler::DataShuffler
   m_stddev.resize(data[0].extent(1));
   m_stddev = 1.;
 
-  // copies the target data to my own variable
+  // copies (or refers to) the data and copies the targets
+  m_data.resize(data.size());
+  m_target.resize(target.size());
   for (size_t k=0; k<target.size(); ++k) {
-    m_data[k].reference(bob::core::array::ccopy(data[k]));
+    if (copy) m_data[k].reference(bob::core::array::ccopy(data[k]));
+    else m_data[k].reference(data[k]);
     m_target[k].reference(bob::core::array::ccopy(target[k]));
   }
 
-  // creates one range tailored for the range of each data object
+  // creates one range tailored for the range of each data object and the
+  // permutations for epoch-based shuffling (renewed at the first draw)
+  m_range.clear();
+  m_order.resize(data.size());
+  m_position.resize(data.size());
   for (size_t i=0; i<data.size(); ++i) {
     m_range.push_back(boost::uniform_int<size_t>(0, m_data[i].extent(0)-1));
+    m_order[i].resize(m_data[i].extent(0));
+    for (size_t k=0; k<m_order[i].size(); ++k) m_order[i][k] = k;
+    m_position[i] = m_order[i].size();
   }
 }
 
@@ -81,7 +107,11 @@ bob::trainer::DataShuffler::DataShuffler(const bob::trainer::DataShuffler& other
   m_range(other.m_range),
   m_do_stdnorm(other.m_do_stdnorm),
   m_mean(bob::core::array::ccopy(other.m_mean)),
-  m_stddev(bob::core::array::ccopy(other.m_stddev))
+  m_stddev(bob::core::array::ccopy(other.m_stddev)),
+  m_epoch(other.m_epoch),
+  m_order(other.m_order),
+  m_position(other.m_position),
+  m_prefetch_size(0)
 {
   for (size_t k=0; k<m_target.size(); ++k) {
     m_data[k].reference(bob::core::array::ccopy(other.m_data[k]));
@@ -89,10 +119,16 @@ bob::trainer::DataShuffler::DataShuffler(const bob::trainer::DataShuffler& other
   }
 }
 
-bob::trainer::DataShuffler::~DataShuffler() { }
+bob::trainer::DataShuffler::~DataShuffler() {
+  stopPrefetch();
+}
 
 bob::trainer::DataShuffler& bob::trainer::DataShuffler::operator=(const bob::trainer::DataShuffler& other) {
 
+  if (this == &other) return *this;
+
+  stopPrefetch();
+
   m_data.resize(other.m_data.size());
   m_target.resize(other.m_target.size());
 
@@ -107,6 +143,10 @@ bob::trainer::DataShuffler& bob::trainer::DataShuffler::operator=(const bob::tra
   m_stddev.reference(bob::core::array::ccopy(other.m_stddev));
   m_do_stdnorm = other.m_do_stdnorm;
 
+  m_epoch = other.m_epoch;
+  m_order = other.m_order;
+  m_position = other.m_position;
+
   return *this;
 }
 
@@ -136,45 +176,25 @@ void evaluateStdNormParameters(const std::vector<blitz::Array<double,2> >& data,
   mean /= (samples);
 }
 
-/**
- * Applies standard normalization parameters to all data arrays given
- */
-void applyStdNormParameters(std::vector<blitz::Array<double,2> >& data,
-    const blitz::Array<double,1>& mean, const blitz::Array<double,1>& stddev) {
-  blitz::Range all = blitz::Range::all();
-  for (size_t k=0; k<data.size(); ++k) {
-    for (int i=0; i<data[k].extent(0); ++i) {
-      data[k](i,all) = (data[k](i,all) - mean) / stddev;
-    }
-  }
-}
-
-/**
- * Inverts the application of std normalization parameters
- */
-void invertApplyStdNormParameters(std::vector<blitz::Array<double,2> >& data,
-    const blitz::Array<double,1>& mean, const blitz::Array<double,1>& stddev) {
-  blitz::Range all = blitz::Range::all();
-  for (size_t k=0; k<data.size(); ++k) {
-    for (int i=0; i<data[k].extent(0); ++i) {
-      data[k](i,all) = (data[k](i,all) * stddev) + mean;
-    }
-  }
-}
-
 void bob::trainer::DataShuffler::setAutoStdNorm(bool s) {
+  stopPrefetch();
+  // normalization is applied while assembling batches: the (possibly
+  // referenced) data is never modified
   if (s && !m_do_stdnorm) {
     evaluateStdNormParameters(m_data, m_mean, m_stddev);
-    applyStdNormParameters(m_data, m_mean, m_stddev);
   }
   if (!s && m_do_stdnorm) {
-    invertApplyStdNormParameters(m_data, m_mean, m_stddev);
     m_mean = 0.;
     m_stddev = 1.;
   }
   m_do_stdnorm = s;
 }
 
+void bob::trainer::DataShuffler::setEpochShuffling(bool s) {
+  stopPrefetch();
+  m_epoch = s;
+}
+
 void bob::trainer::DataShuffler::getStdNorm(blitz::Array<double,1>& mean,
     blitz::Array<double,1>& stddev) const {
   if (m_do_stdnorm) {
@@ -186,27 +206,57 @@ void bob::trainer::DataShuffler::getStdNorm(blitz::Array<double,1>& mean,
   }
 }
 
-void bob::trainer::DataShuffler::operator() (boost::mt19937& rng, 
+size_t bob::trainer::DataShuffler::draw(boost::mt19937& rng, size_t i) {
+  if (!m_epoch) return m_range[i](rng); //pick a random position within class
+
+  std::vector<size_t>& order = m_order[i];
+  if (m_position[i] >= order.size()) { //new epoch: Fisher-Yates shuffle
+    for (size_t k=order.size()-1; k>0; --k) {
+      boost::uniform_int<size_t> range(0, k);
+      std::swap(order[k], order[range(rng)]);
+    }
+    m_position[i] = 0;
+  }
+  return order[m_position[i]++];
+}
+
+void bob::trainer::DataShuffler::fill(boost::mt19937& rng,
     blitz::Array<double,2>& data, blitz::Array<double,2>& target) {
-  
-  bob::core::array::assertSameDimensionLength(data.extent(0), target.extent(0));
 
+  // only element-wise access here: this may run on a background thread and
+  // blitz reference counting (used by slices) is not thread-safe.
   size_t counter = 0;
   size_t max = data.extent(0);
-  blitz::Range all = blitz::Range::all();
-  while (true) {
+  const int width = data.extent(1);
+  const int target_width = target.extent(1);
+  while (counter < max) {
     for (size_t i=0; i<m_data.size(); ++i) { //for all classes
-      size_t index = m_range[i](rng); //pick a random position within class
-      data(counter,all) = m_data[i](index,all);
-      target(counter,all) = m_target[i];
+      const int row = counter;
+      const int index = draw(rng, i);
+      if (m_do_stdnorm) {
+        for (int j=0; j<width; ++j)
+          data(row,j) = (m_data[i](index,j) - m_mean(j)) / m_stddev(j);
+      }
+      else {
+        for (int j=0; j<width; ++j) data(row,j) = m_data[i](index,j);
+      }
+      for (int j=0; j<target_width; ++j) target(row,j) = m_target[i](j);
       ++counter;
       if (counter >= max) break;
     }
-    if (counter >= max) break;
   }
 
 }
 
+void bob::trainer::DataShuffler::operator() (boost::mt19937& rng, 
+    blitz::Array<double,2>& data, blitz::Array<double,2>& target) {
+  
+  bob::core::array::assertSameDimensionLength(data.extent(0), target.extent(0));
+
+  stopPrefetch();
+  fill(rng, data, target);
+}
+
 void bob::trainer::DataShuffler::operator() (blitz::Array<double,2>& data,
     blitz::Array<double,2>& target) {
   struct timeval tv;
@@ -214,3 +264,58 @@ void bob::trainer::DataShuffler::operator() (blitz::Array<double,2>& data,
   boost::mt19937 rng(tv.tv_sec + tv.tv_usec);
   operator()(rng, data, target); 
 }
+
+void bob::trainer::DataShuffler::prefetch() {
+  try {
+    fill(m_rng, m_prefetch_data, m_prefetch_target);
+  }
+  catch (...) {
+    m_error = boost::current_exception();
+  }
+}
+
+void bob::trainer::DataShuffler::wait() {
+  if (m_thread) {
+    m_thread->join();
+    m_thread.reset();
+  }
+}
+
+void bob::trainer::DataShuffler::startPrefetch(const boost::mt19937& rng,
+    size_t N) {
+  stopPrefetch();
+  if (N == 0) 
+    throw std::runtime_error("cannot prefetch batches of 0 examples");
+
+  m_rng = rng;
+  m_prefetch_data.resize(N, getDataWidth());
+  m_prefetch_target.resize(N, getTargetWidth());
+  m_prefetch_size = N;
+  m_thread.reset(new boost::thread(boost::bind(&bob::trainer::DataShuffler::prefetch, this)));
+}
+
+void bob::trainer::DataShuffler::next(blitz::Array<double,2>& data,
+    blitz::Array<double,2>& target) {
+  if (!m_prefetch_size) 
+    throw std::runtime_error("the shuffler is not prefetching: call startPrefetch() first");
+
+  bob::core::array::assertSameShape(data, m_prefetch_data);
+  bob::core::array::assertSameShape(target, m_prefetch_target);
+
+  wait();
+  if (m_error) {
+    boost::exception_ptr error = m_error;
+    stopPrefetch();
+    boost::rethrow_exception(error);
+  }
+
+  data = m_prefetch_data;
+  target = m_prefetch_target;
+  m_thread.reset(new boost::thread(boost::bind(&bob::trainer::DataShuffler::prefetch, this)));
+}
+
+void bob::trainer::DataShuffler::stopPrefetch() {
+  wait();
+  m_prefetch_size = 0;
+  m_error = boost::exception_ptr();
+}
@@ -28,7 +28,7 @@
 #include <bob/math/pinv.h>
 #include <bob/math/eig.h>
 #include <bob/math/linear.h>
-#include <bob/math/stats.h>
+#include <bob/math/ScatterAccumulator.h>
 #include <bob/trainer/FisherLDATrainer.h>
 
 bob::trainer::FisherLDATrainer::FisherLDATrainer
@@ -142,7 +142,11 @@ void bob::trainer::FisherLDATrainer::train
   blitz::Array<double,1> preMean(n_features);
   blitz::Array<double,2> Sw(n_features, n_features);
   blitz::Array<double,2> Sb(n_features, n_features);
-  bob::math::scatters_(data, Sw, Sb, preMean);
+  bob::math::ScatterAccumulator scatters(n_features, data.size());
+  scatters.add(data);
+  scatters.getWithinScatter(Sw);
+  scatters.getBetweenScatter(Sb);
+  scatters.getMean(preMean);
 
   // computes the generalized eigenvalue decomposition
   // so to find the eigen vectors/values of Sw^(-1) * Sb
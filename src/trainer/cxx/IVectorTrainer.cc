@@ -27,6 +27,7 @@
 #include <bob/math/inv.h>
 #include <bob/math/linear.h>
 #include <bob/math/linsolve.h>
+#include <bob/math/lu.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/random.hpp>
 
@@ -123,8 +124,9 @@ void bob::trainer::IVectorTrainer::eStep(
     machine.computeTtSigmaInvFnorm(*it, m_tmp_t1);
     // b. Computes \f$Id + T^{T} \Sigma^{-1} T\f$
     machine.computeIdTtSigmaInvT(*it, m_tmp_tt1);
-    // c. Computes \f$(Id + T^{T} \Sigma^{-1} T)^{-1}\f$
-    bob::math::inv(m_tmp_tt1, m_tmp_tt2);
+    // c. Computes \f$(Id + T^{T} \Sigma^{-1} T)^{-1}\f$ (symmetric
+    //    positive definite, hence the Cholesky-based inverse)
+    bob::math::cholInv_(m_tmp_tt1, m_tmp_tt2, m_workspace);
     // d. Computes \f$E{wij} = (Id + T^{T} \Sigma^{-1} T)^{-1} T^{T} \Sigma^{-1} F_{norm}\f$
     bob::math::prod(m_tmp_tt2, m_tmp_t1, m_tmp_wij); // E{wij}
     // e.  Computes \f$E{wij}.E{wij^{T}}\f$
@@ -179,7 +181,7 @@ void bob::trainer::IVectorTrainer::mStep(
     if (blitz::all(acc_Nij_wij2_c == 0)) // TODO
       Tt_c = 0;
     else
-      bob::math::linsolve(tacc_Nij_wij2_c, Tt_c, tacc_Fnormij_wij_c);
+      bob::math::linsolve_(tacc_Nij_wij2_c, Tt_c, tacc_Fnormij_wij_c, m_workspace);
     if (m_update_sigma)
     {
       blitz::Array<double,1> sigma_c = sigma(blitz::Range(c*D,(c+1)*D-1));
@@ -0,0 +1,217 @@
+/**
+ * @file trainer/cxx/IncrementalPCATrainer.cc
+ * @date Mon Oct 19 17:21:40 2026 +0200
+ * @author agent <agent@local>
+ *
+ * @brief Principal Component Analysis updated chunk by chunk.
+ * Implementation.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <boost/format.hpp>
+#include <bob/core/check.h>
+#include <bob/core/array_copy.h>
+#include <bob/math/svd.h>
+#include <bob/trainer/IncrementalPCATrainer.h>
+
+bob::trainer::IncrementalPCATrainer::IncrementalPCATrainer(size_t K)
+  : m_K(K)
+{
+  if (K == 0)
+    throw std::runtime_error("the number of components must be at least 1");
+  reset();
+}
+
+bob::trainer::IncrementalPCATrainer::IncrementalPCATrainer
+(const bob::trainer::IncrementalPCATrainer& other)
+  : m_K(other.m_K),
+    m_n_samples(other.m_n_samples),
+    m_mean(bob::core::array::ccopy(other.m_mean)),
+    m_scatter(bob::core::array::ccopy(other.m_scatter)),
+    m_components(bob::core::array::ccopy(other.m_components)),
+    m_sigma(bob::core::array::ccopy(other.m_sigma))
+{
+}
+
+bob::trainer::IncrementalPCATrainer::~IncrementalPCATrainer() {}
+
+bob::trainer::IncrementalPCATrainer& bob::trainer::IncrementalPCATrainer::operator=
+(const bob::trainer::IncrementalPCATrainer& other)
+{
+  if (this != &other)
+  {
+    m_K = other.m_K;
+    m_n_samples = other.m_n_samples;
+    m_mean.reference(bob::core::array::ccopy(other.m_mean));
+    m_scatter.reference(bob::core::array::ccopy(other.m_scatter));
+    m_components.reference(bob::core::array::ccopy(other.m_components));
+    m_sigma.reference(bob::core::array::ccopy(other.m_sigma));
+  }
+  return *this;
+}
+
+bool bob::trainer::IncrementalPCATrainer::operator==
+  (const bob::trainer::IncrementalPCATrainer& other) const
+{
+  return m_K == other.m_K &&
+    m_n_samples == other.m_n_samples &&
+    bob::core::array::isEqual(m_mean, other.m_mean) &&
+    bob::core::array::isEqual(m_scatter, other.m_scatter) &&
+    bob::core::array::isEqual(m_components, other.m_components) &&
+    bob::core::array::isEqual(m_sigma, other.m_sigma);
+}
+
+bool bob::trainer::IncrementalPCATrainer::operator!=
+  (const bob::trainer::IncrementalPCATrainer& other) const
+{
+  return !(this->operator==(other));
+}
+
+bool bob::trainer::IncrementalPCATrainer::is_similar_to
+  (const bob::trainer::IncrementalPCATrainer& other, const double r_epsilon,
+   const double a_epsilon) const
+{
+  return m_K == other.m_K &&
+    m_n_samples == other.m_n_samples &&
+    bob::core::array::isClose(m_mean, other.m_mean, r_epsilon, a_epsilon) &&
+    bob::core::array::isClose(m_scatter, other.m_scatter, r_epsilon, a_epsilon) &&
+    bob::core::array::isClose(m_components, other.m_components, r_epsilon, a_epsilon) &&
+    bob::core::array::isClose(m_sigma, other.m_sigma, r_epsilon, a_epsilon);
+}
+
+void bob::trainer::IncrementalPCATrainer::reset()
+{
+  m_n_samples = 0;
+  m_mean.resize(0);
+  m_scatter.resize(0);
+  m_components.resize(0,0);
+  m_sigma.resize(0);
+}
+
+void bob::trainer::IncrementalPCATrainer::update(const blitz::Array<double,2>& X)
+{
+  const int M = X.extent(0);
+  const int F = X.extent(1);
+  if (M == 0) return;
+  if (m_n_samples && F != m_mean.extent(0)) {
+    boost::format m("Number of features at input data set (%d columns) does not match that of the previous chunks (%d)");
+    m % F % m_mean.extent(0);
+    throw std::runtime_error(m.str());
+  }
+
+  // mean and squared deviations of the chunk
+  blitz::Array<double,1> mean(F);
+  blitz::Array<double,1> scatter(F);
+  mean = 0.;
+  scatter = 0.;
+  for (int i=0; i<M; ++i)
+    for (int f=0; f<F; ++f) mean(f) += X(i,f);
+  mean /= M;
+  for (int i=0; i<M; ++i)
+    for (int f=0; f<F; ++f) scatter(f) += (X(i,f) - mean(f)) * (X(i,f) - mean(f));
+
+  /**
+   * Stacks (as columns) the current components scaled by their singular
+   * values, the centered chunk and the correction for the shift of the mean.
+   * The left singular vectors of this matrix are the new components.
+   */
+  const double N = m_n_samples;
+  const double total = N + M;
+  const int R = m_sigma.extent(0);
+  const int columns = R + M + (m_n_samples ? 1 : 0);
+  blitz::Array<double,2> stacked(F, columns);
+  for (int c=0; c<R; ++c)
+    for (int f=0; f<F; ++f) stacked(f,c) = m_components(f,c) * m_sigma(c);
+  for (int i=0; i<M; ++i)
+    for (int f=0; f<F; ++f) stacked(f,R+i) = X(i,f) - mean(f);
+
+  if (m_n_samples) {
+    const double shift = std::sqrt(N * M / total);
+    for (int f=0; f<F; ++f) stacked(f,R+M) = shift * (m_mean(f) - mean(f));
+    m_scatter += scatter + blitz::pow2(m_mean - mean) * (N * M / total);
+    m_mean = (N * m_mean + M * mean) / total;
+  }
+  else {
+    m_scatter.reference(scatter);
+    m_mean.reference(mean);
+  }
+  m_n_samples += M;
+
+  const int rank = std::min(F, columns);
+  blitz::Array<double,2> U(F, rank);
+  blitz::Array<double,1> sigma(rank);
+  bob::math::svd_(stacked, U, sigma);
+
+  const int K = std::min((int)m_K, rank);
+  blitz::Range up_to_k(0, K-1);
+  m_components.reference(bob::core::array::ccopy(U(blitz::Range::all(), up_to_k)));
+  m_sigma.reference(bob::core::array::ccopy(sigma(up_to_k)));
+}
+
+blitz::Array<double,1> bob::trainer::IncrementalPCATrainer::getEigenValues() const
+{
+  blitz::Array<double,1> retval(m_sigma.extent(0));
+  if (m_n_samples < 2) retval = 0.;
+  else retval = blitz::pow2(m_sigma) / (m_n_samples - 1);
+  return retval;
+}
+
+double bob::trainer::IncrementalPCATrainer::getTotalVariance() const
+{
+  if (m_n_samples < 2) return 0.;
+  return blitz::sum(m_scatter) / (m_n_samples - 1);
+}
+
+blitz::Array<double,1> bob::trainer::IncrementalPCATrainer::getExplainedVarianceRatio() const
+{
+  blitz::Array<double,1> retval = getEigenValues();
+  const double total = getTotalVariance();
+  if (total > 0.) retval /= total;
+  return retval;
+}
+
+void bob::trainer::IncrementalPCATrainer::train
+(bob::machine::LinearMachine& machine, blitz::Array<double,1>& eigen_values) const
+{
+  if (m_n_samples < 2) {
+    boost::format m("At least 2 samples are required to train, but only %d were given");
+    m % m_n_samples;
+    throw std::runtime_error(m.str());
+  }
+  if (machine.inputSize() != (size_t)m_mean.extent(0)) {
+    boost::format m("Number of features of the data (%d) does not match machine input size (%d)");
+    m % m_mean.extent(0) % machine.inputSize();
+    throw std::runtime_error(m.str());
+  }
+  if (machine.outputSize() != getNComponents()) {
+    boost::format m("Number of outputs of the given machine (%d) does not match the number of components (%d)");
+    m % machine.outputSize() % getNComponents();
+    throw std::runtime_error(m.str());
+  }
+  if ((size_t)eigen_values.extent(0) != getNComponents()) {
+    boost::format m("Number of eigenvalues on the given 1D array (%d) does not match the number of components (%d)");
+    m % eigen_values.extent(0) % getNComponents();
+    throw std::runtime_error(m.str());
+  }
+
+  machine.setInputSubtraction(m_mean);
+  machine.setInputDivision(1.0);
+  machine.setBiases(0.0);
+  machine.setWeights(m_components);
+  eigen_values = getEigenValues();
+}
@@ -26,6 +26,7 @@
 #include <bob/core/array_random.h>
 #include <bob/math/inv.h>
 #include <bob/math/linear.h>
+#include <bob/math/lu.h>
 #include <bob/core/check.h>
 #include <bob/core/array_repmat.h>
 #include <algorithm>
@@ -229,7 +230,7 @@ void bob::trainer::FABaseTrainer::computeIdPlusVProd_i(const size_t id)
     blitz::Array<double,2> VProd_c = m_cache_VProd(c, rall, rall);
     m_tmp_rvrv += VProd_c * Ni(c);
   }
-  bob::math::inv(m_tmp_rvrv, m_cache_IdPlusVProd_i); // m_cache_IdPlusVProd_i = ( I+Vt*diag(sigma)^-1*Ni*V)^-1
+  bob::math::cholInv_(m_tmp_rvrv, m_cache_IdPlusVProd_i, m_workspace); // m_cache_IdPlusVProd_i = ( I+Vt*diag(sigma)^-1*Ni*V)^-1
 }
 
 void bob::trainer::FABaseTrainer::computeFn_y_i(const bob::machine::FABase& mb,
@@ -313,7 +314,7 @@ void bob::trainer::FABaseTrainer::updateV(blitz::Array<double,2>& V)
   for (size_t c=0; c<m_dim_C; ++c)
   {
     const blitz::Array<double,2> A1 = m_acc_V_A1(c, rall, rall);
-    bob::math::inv(A1, m_tmp_rvrv);
+    bob::math::inv_(A1, m_tmp_rvrv, m_workspace);
     const blitz::Array<double,2> A2 = m_acc_V_A2(blitz::Range(c*m_dim_D,(c+1)*m_dim_D-1), rall);
     blitz::Array<double,2> V_c = V(blitz::Range(c*m_dim_D,(c+1)*m_dim_D-1), rall);
     bob::math::prod(A2, m_tmp_rvrv, V_c);
@@ -360,7 +361,7 @@ void bob::trainer::FABaseTrainer::computeIdPlusUProd_ih(
     blitz::Array<double,2> UProd_c = m_cache_UProd(c,blitz::Range::all(),blitz::Range::all());
     m_tmp_ruru += UProd_c * Nih(c);
   }
-  bob::math::inv(m_tmp_ruru, m_cache_IdPlusUProd_ih); // m_cache_IdPlusUProd_ih = ( I+Ut*diag(sigma)^-1*Ni*U)^-1
+  bob::math::cholInv_(m_tmp_ruru, m_cache_IdPlusUProd_ih, m_workspace); // m_cache_IdPlusUProd_ih = ( I+Ut*diag(sigma)^-1*Ni*U)^-1
 }
 
 void bob::trainer::FABaseTrainer::computeFn_x_ih(const bob::machine::FABase& mb,
@@ -448,7 +449,7 @@ void bob::trainer::FABaseTrainer::updateU(blitz::Array<double,2>& U)
   for (size_t c=0; c<m_dim_C; ++c)
   {
     const blitz::Array<double,2> A1 = m_acc_U_A1(c,blitz::Range::all(),blitz::Range::all());
-    bob::math::inv(A1, m_tmp_ruru);
+    bob::math::inv_(A1, m_tmp_ruru, m_workspace);
     const blitz::Array<double,2> A2 = m_acc_U_A2(blitz::Range(c*m_dim_D,(c+1)*m_dim_D-1),blitz::Range::all());
     blitz::Array<double,2> U_c = U(blitz::Range(c*m_dim_D,(c+1)*m_dim_D-1),blitz::Range::all());
     bob::math::prod(A2, m_tmp_ruru, U_c);
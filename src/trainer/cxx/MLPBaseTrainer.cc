@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <bob/core/assert.h>
 #include <bob/core/check.h>
+#include <bob/core/parallel.h>
 #include <bob/math/linear.h>
 #include <bob/trainer/MLPBaseTrainer.h>
 
@@ -31,15 +32,19 @@ bob::trainer::MLPBaseTrainer::MLPBaseTrainer(size_t batch_size,
   m_cost(cost),
   m_train_bias(true),
   m_H(0), ///< handy!
+  m_shards(1),
+  m_n_threads(0),
   m_deriv(1),
   m_deriv_bias(1),
   m_error(1),
-  m_output(1)
+  m_output(1),
+  m_fprime(1)
 {
   m_deriv[0].reference(blitz::Array<double,2>(0,0));
   m_deriv_bias[0].reference(blitz::Array<double,1>(0));
   m_error[0].reference(blitz::Array<double,2>(0,0));
   m_output[0].reference(blitz::Array<double,2>(0,0));
+  m_fprime[0].reference(blitz::Array<double,2>(0,0));
   reset();
 }
 
@@ -50,10 +55,13 @@ bob::trainer::MLPBaseTrainer::MLPBaseTrainer(size_t batch_size,
   m_cost(cost),
   m_train_bias(true),
   m_H(machine.numOfHiddenLayers()), ///< handy!
+  m_shards(1),
+  m_n_threads(0),
   m_deriv(m_H + 1),
   m_deriv_bias(m_H + 1),
   m_error(m_H + 1),
-  m_output(m_H + 1)
+  m_output(m_H + 1),
+  m_fprime(m_H + 1)
 {
   initialize(machine);
 }
@@ -66,10 +74,13 @@ bob::trainer::MLPBaseTrainer::MLPBaseTrainer(size_t batch_size,
   m_cost(cost),
   m_train_bias(train_biases),
   m_H(machine.numOfHiddenLayers()), ///< handy!
+  m_shards(1),
+  m_n_threads(0),
   m_deriv(m_H + 1),
   m_deriv_bias(m_H + 1),
   m_error(m_H + 1),
-  m_output(m_H + 1)
+  m_output(m_H + 1),
+  m_fprime(m_H + 1)
 {
   initialize(machine);
 }
@@ -80,12 +91,15 @@ bob::trainer::MLPBaseTrainer::MLPBaseTrainer(const MLPBaseTrainer& other):
   m_batch_size(other.m_batch_size),
   m_cost(other.m_cost),
   m_train_bias(other.m_train_bias),
-  m_H(other.m_H)
+  m_H(other.m_H),
+  m_shards(other.m_shards),
+  m_n_threads(other.m_n_threads)
 {
   bob::core::array::ccopy(other.m_deriv, m_deriv);
   bob::core::array::ccopy(other.m_deriv_bias, m_deriv_bias);
   bob::core::array::ccopy(other.m_error, m_error);
   bob::core::array::ccopy(other.m_output, m_output);
+  bob::core::array::ccopy(other.m_fprime, m_fprime);
 }
 
 bob::trainer::MLPBaseTrainer& bob::trainer::MLPBaseTrainer::operator=
@@ -96,11 +110,15 @@ bob::trainer::MLPBaseTrainer& bob::trainer::MLPBaseTrainer::operator=
     m_cost = other.m_cost;
     m_train_bias = other.m_train_bias;
     m_H = other.m_H;
+    m_shards = other.m_shards;
+    m_n_threads = other.m_n_threads;
 
     bob::core::array::ccopy(other.m_deriv, m_deriv);
     bob::core::array::ccopy(other.m_deriv_bias, m_deriv_bias);
     bob::core::array::ccopy(other.m_error, m_error);
     bob::core::array::ccopy(other.m_output, m_output);
+    bob::core::array::ccopy(other.m_fprime, m_fprime);
+    m_shard.clear();
   }
   return *this;
 }
@@ -118,6 +136,16 @@ void bob::trainer::MLPBaseTrainer::setBatchSize (size_t batch_size) {
   for (size_t k=0; k<m_error.size(); ++k) {
     m_error[k].resize(batch_size, m_deriv[k].extent(1));
   }
+
+  for (size_t k=0; k<m_fprime.size(); ++k) {
+    m_fprime[k].resize(batch_size, m_deriv[k].extent(1));
+  }
+}
+
+void bob::trainer::MLPBaseTrainer::setShards(size_t shards) {
+  if (shards == 0)
+    throw std::runtime_error("the number of shards must be at least 1");
+  m_shards = shards;
 }
 
 bool bob::trainer::MLPBaseTrainer::isCompatible(const bob::machine::MLP& machine) const
@@ -146,16 +174,15 @@ void bob::trainer::MLPBaseTrainer::forward_step(const bob::machine::MLP& machine
   boost::shared_ptr<bob::machine::Activation> hidden_actfun = machine.getHiddenActivation();
   boost::shared_ptr<bob::machine::Activation> output_actfun = machine.getOutputActivation();
 
+  blitz::firstIndex i;
+  blitz::secondIndex j;
   for (size_t k=0; k<machine_weight.size(); ++k) { //for all layers
     if (k == 0) bob::math::prod_(input, machine_weight[k], m_output[k]);
     else bob::math::prod_(m_output[k-1], machine_weight[k], m_output[k]);
     boost::shared_ptr<bob::machine::Activation> cur_actfun =
       (k == (machine_weight.size()-1) ? output_actfun : hidden_actfun );
-    for (int i=0; i<(int)m_batch_size; ++i) { //for every example
-      for (int j=0; j<m_output[k].extent(1); ++j) { //for all variables
-        m_output[k](i,j) = cur_actfun->f(m_output[k](i,j) + machine_bias[k](j));
-      }
-    }
+    m_output[k] = m_output[k](i,j) + machine_bias[k](j);
+    cur_actfun->f(m_output[k]); //all examples at once
   }
 }
 
@@ -177,11 +204,8 @@ void bob::trainer::MLPBaseTrainer::backward_step
   boost::shared_ptr<bob::machine::Activation> hidden_actfun = machine.getHiddenActivation();
   for (size_t k=m_H; k>0; --k) {
     bob::math::prod_(m_error[k], machine_weight[k].transpose(1,0), m_error[k-1]);
-    for (int i=0; i<(int)m_batch_size; ++i) { //for every example
-      for (int j=0; j<m_error[k-1].extent(1); ++j) { //for all variables
-        m_error[k-1](i,j) *= hidden_actfun->f_prime_from_f(m_output[k-1](i,j));
-      }
-    }
+    hidden_actfun->f_prime_from_f(m_output[k-1], m_fprime[k-1]); //all examples at once
+    m_error[k-1] *= m_fprime[k-1];
   }
 
   //calculate the derivatives of the cost w.r.t. the weights and biases
@@ -196,6 +220,172 @@ void bob::trainer::MLPBaseTrainer::backward_step
   }
 }
 
+/**
+ * Makes sure the array has the given shape, re-allocating it if required
+ */
+template <int N>
+static void ensure_shape(blitz::Array<double,N>& a,
+    const blitz::TinyVector<int,N>& shape) {
+  for (int d=0; d<N; ++d) {
+    if (a.extent(d) != shape(d)) {
+      a.reference(blitz::Array<double,N>(shape));
+      return;
+    }
+  }
+}
+
+void bob::trainer::MLPBaseTrainer::prepare_shards
+(const std::vector<std::pair<uint64_t,uint64_t> >& ranges, int input_width,
+ int target_width) {
+  // all buffers are owned by their shard, as they are referenced (e.g.
+  // transposed) from the worker threads and blitz reference counting is not
+  // thread-safe.
+  m_shard.resize(ranges.size());
+  for (size_t s=0; s<ranges.size(); ++s) {
+    Shard& shard = m_shard[s];
+    const int rows = ranges[s].second - ranges[s].first;
+    ensure_shape(shard.input, blitz::shape(rows, input_width));
+    ensure_shape(shard.target, blitz::shape(rows, target_width));
+    shard.output.resize(m_H + 1);
+    shard.error.resize(m_H + 1);
+    shard.fprime.resize(m_H + 1);
+    shard.deriv.resize(m_H + 1);
+    shard.deriv_bias.resize(m_H + 1);
+    for (size_t k=0; k<(m_H + 1); ++k) {
+      const int units = m_deriv[k].extent(1);
+      ensure_shape(shard.output[k], blitz::shape(rows, units));
+      ensure_shape(shard.error[k], blitz::shape(rows, units));
+      ensure_shape(shard.fprime[k], blitz::shape(rows, units));
+      ensure_shape(shard.deriv[k], m_deriv[k].shape());
+      ensure_shape(shard.deriv_bias[k], m_deriv_bias[k].shape());
+    }
+  }
+}
+
+namespace bob { namespace trainer { namespace detail {
+
+  /**
+   * Runs the forward and backward steps on a set of shards, summing (not
+   * averaging) the derivatives of each shard into its own buffers. Only
+   * shard-owned arrays are referenced here; everything shared among threads
+   * is prepared by the caller and only read.
+   */
+  template <typename TShard> struct MLPShardStep {
+
+    std::vector<TShard>& shards;
+    const std::vector<blitz::Array<double,2> >& weight;
+    const std::vector<blitz::Array<double,2> >& weight_t; ///< transposed
+    const std::vector<blitz::Array<double,1> >& bias;
+    const bob::machine::Activation& hidden;
+    const bob::machine::Activation& output;
+    const bob::trainer::Cost& cost;
+
+    MLPShardStep(std::vector<TShard>& shards_,
+        const std::vector<blitz::Array<double,2> >& weight_,
+        const std::vector<blitz::Array<double,2> >& weight_t_,
+        const std::vector<blitz::Array<double,1> >& bias_,
+        const bob::machine::Activation& hidden_,
+        const bob::machine::Activation& output_,
+        const bob::trainer::Cost& cost_):
+      shards(shards_), weight(weight_), weight_t(weight_t_), bias(bias_),
+      hidden(hidden_), output(output_), cost(cost_) {}
+
+    void operator()(size_t, uint64_t begin, uint64_t end) const {
+      for (uint64_t s=begin; s<end; ++s) step(shards[s]);
+    }
+
+    void step(TShard& shard) const {
+      const size_t H = weight.size() - 1;
+      blitz::firstIndex i;
+      blitz::secondIndex j;
+
+      //forward
+      for (size_t k=0; k<(H + 1); ++k) {
+        if (k == 0) bob::math::prod_(shard.input, weight[k], shard.output[k]);
+        else bob::math::prod_(shard.output[k-1], weight[k], shard.output[k]);
+        shard.output[k] = shard.output[k](i,j) + bias[k](j);
+        (k == H ? output : hidden).f(shard.output[k]);
+      }
+
+      //last layer
+      for (int n=0; n<shard.error[H].extent(0); ++n) {
+        for (int m=0; m<shard.error[H].extent(1); ++m) {
+          shard.error[H](n,m) = cost.error(shard.output[H](n,m),
+              shard.target(n,m));
+        }
+      }
+
+      //all other layers
+      for (size_t k=H; k>0; --k) {
+        bob::math::prod_(shard.error[k], weight_t[k], shard.error[k-1]);
+        hidden.f_prime_from_f(shard.output[k-1], shard.fprime[k-1]);
+        shard.error[k-1] *= shard.fprime[k-1];
+      }
+
+      //sums of the derivatives over the examples of this shard
+      for (size_t k=0; k<(H + 1); ++k) {
+        if (k == 0) bob::math::prod_(shard.input.transpose(1,0), shard.error[k], shard.deriv[k]);
+        else bob::math::prod_(shard.output[k-1].transpose(1,0), shard.error[k], shard.deriv[k]);
+        shard.deriv_bias[k] = blitz::sum(shard.error[k].transpose(1,0), j);
+      }
+    }
+
+  };
+
+}}}
+
+void bob::trainer::MLPBaseTrainer::forward_backward_step
+(const bob::machine::MLP& machine,
+ const blitz::Array<double,2>& input, const blitz::Array<double,2>& target)
+{
+  std::vector<std::pair<uint64_t,uint64_t> > ranges;
+  bob::core::split_range(m_batch_size, m_shards, ranges);
+  if (ranges.size() <= 1) {
+    forward_step(machine, input);
+    backward_step(machine, input, target);
+    return;
+  }
+
+  const std::vector<blitz::Array<double,2> >& machine_weight = machine.getWeights();
+  const std::vector<blitz::Array<double,1> >& machine_bias = machine.getBiases();
+
+  // splits the batch and prepares the transposed weights on this thread
+  prepare_shards(ranges, input.extent(1), target.extent(1));
+  blitz::Range all = blitz::Range::all();
+  for (size_t s=0; s<ranges.size(); ++s) {
+    blitz::Range rows((int)ranges[s].first, (int)ranges[s].second - 1);
+    m_shard[s].input = input(rows, all);
+    m_shard[s].target = target(rows, all);
+  }
+  std::vector<blitz::Array<double,2> > weight_t(m_H + 1);
+  for (size_t k=0; k<(m_H + 1); ++k)
+    weight_t[k].reference(machine_weight[k].transpose(1,0));
+
+  bob::core::parallel_for(ranges.size(),
+      detail::MLPShardStep<Shard>(m_shard, machine_weight, weight_t,
+        machine_bias, *machine.getHiddenActivation(),
+        *machine.getOutputActivation(), *m_cost), m_n_threads);
+
+  // reduces the derivatives in shard order and gathers the buffers
+  for (size_t k=0; k<(m_H + 1); ++k) {
+    m_deriv[k] = m_shard[0].deriv[k];
+    m_deriv_bias[k] = m_shard[0].deriv_bias[k];
+    for (size_t s=1; s<ranges.size(); ++s) {
+      m_deriv[k] += m_shard[s].deriv[k];
+      m_deriv_bias[k] += m_shard[s].deriv_bias[k];
+    }
+    m_deriv[k] /= m_batch_size;
+    m_deriv_bias[k] /= m_batch_size;
+
+    for (size_t s=0; s<ranges.size(); ++s) {
+      blitz::Range rows((int)ranges[s].first, (int)ranges[s].second - 1);
+      m_output[k](rows, all) = m_shard[s].output[k];
+      m_error[k](rows, all) = m_shard[s].error[k];
+      if (k < m_H) m_fprime[k](rows, all) = m_shard[s].fprime[k];
+    }
+  }
+}
+
 double bob::trainer::MLPBaseTrainer::cost
 (const blitz::Array<double,2>& target) const {
   bob::core::array::assertSameShape(m_output[m_H], target);
@@ -227,11 +417,13 @@ void bob::trainer::MLPBaseTrainer::initialize(const bob::machine::MLP& machine)
   m_deriv_bias.resize(m_H + 1);
   m_output.resize(m_H + 1);
   m_error.resize(m_H + 1);
+  m_fprime.resize(m_H + 1);
   for (size_t k=0; k<(m_H + 1); ++k) {
     m_deriv[k].reference(blitz::Array<double,2>(machine_weight[k].shape()));
     m_deriv_bias[k].reference(blitz::Array<double,1>(machine_bias[k].shape()));
     m_output[k].resize(m_batch_size, m_deriv[k].extent(1));
     m_error[k].resize(m_batch_size, m_deriv[k].extent(1));
+    m_fprime[k].resize(m_batch_size, m_deriv[k].extent(1));
   }
 
   reset();
@@ -319,5 +511,6 @@ void bob::trainer::MLPBaseTrainer::reset() {
     m_deriv_bias[k] = 0.;
     m_error[k] = 0.;
     m_output[k] = 0.;
+    m_fprime[k] = 0.;
   }
 }
@@ -29,15 +29,22 @@
 #include <bob/math/stats.h>
 #include <bob/math/svd.h>
 #include <bob/math/eig.h>
+#include <bob/math/linear.h>
 #include <bob/trainer/PCATrainer.h>
 
 bob::trainer::PCATrainer::PCATrainer(bool use_svd)
-  : m_use_svd(use_svd)
+  : m_use_svd(use_svd),
+    m_oversampling(10),
+    m_power_iterations(2),
+    m_rng(new boost::mt19937())
 {
 }
 
 bob::trainer::PCATrainer::PCATrainer(const bob::trainer::PCATrainer& other)
-  : m_use_svd(other.m_use_svd)
+  : m_use_svd(other.m_use_svd),
+    m_oversampling(other.m_oversampling),
+    m_power_iterations(other.m_power_iterations),
+    m_rng(other.m_rng)
 {
 }
 
@@ -47,13 +54,18 @@ bob::trainer::PCATrainer& bob::trainer::PCATrainer::operator=
 (const bob::trainer::PCATrainer& other)
 {
   m_use_svd = other.m_use_svd;
+  m_oversampling = other.m_oversampling;
+  m_power_iterations = other.m_power_iterations;
+  m_rng = other.m_rng;
   return *this;
 }
 
 bool bob::trainer::PCATrainer::operator==
   (const bob::trainer::PCATrainer& other) const
 {
-  return m_use_svd == other.m_use_svd;
+  return m_use_svd == other.m_use_svd &&
+    m_oversampling == other.m_oversampling &&
+    m_power_iterations == other.m_power_iterations;
 }
 
 bool bob::trainer::PCATrainer::operator!=
@@ -198,6 +210,134 @@ void bob::trainer::PCATrainer::train(bob::machine::LinearMachine& machine,
   train(machine, throw_away_eigen_values, X);
 }
 
+/**
+ * Computes Y = (X - 1.mean^T) * W, without centering X
+ */
+static void centered_prod(const blitz::Array<double,2>& X,
+    const blitz::Array<double,1>& mean, const blitz::Array<double,2>& W,
+    blitz::Array<double,2>& Y) {
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+  blitz::Array<double,1> offset(W.extent(1));
+  offset = blitz::sum(mean(j) * W(j,i), j);
+  bob::math::prod_(X, W, Y);
+  Y = Y(i,j) - offset(j);
+}
+
+/**
+ * Computes Z = (X - 1.mean^T)^T * Q, without centering X
+ */
+static void centered_prod_t(const blitz::Array<double,2>& X,
+    const blitz::Array<double,1>& mean, const blitz::Array<double,2>& Q,
+    blitz::Array<double,2>& Z) {
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+  blitz::Array<double,1> column_sum(Q.extent(1));
+  column_sum = blitz::sum(Q(j,i), j);
+  bob::math::prod_(X.transpose(1,0), Q, Z);
+  Z = Z(i,j) - mean(i) * column_sum(j);
+}
+
+/**
+ * Replaces the columns of A by an orthonormal basis of their span (A must
+ * have at least as many rows as columns)
+ */
+static void orthonormalize(blitz::Array<double,2>& A) {
+  blitz::Array<double,2> U(A.extent(0), A.extent(1));
+  blitz::Array<double,1> sigma(A.extent(1));
+  bob::math::svd_(A, U, sigma);
+  A = U;
+}
+
+void bob::trainer::PCATrainer::train_randomized
+(bob::machine::LinearMachine& machine, blitz::Array<double,1>& eigen_values,
+ const blitz::Array<double,2>& X) const
+{
+  const int K = machine.outputSize();
+  const int rank = output_size(X);
+
+  // Checks that the dimensions are matching
+  if (machine.inputSize() != (size_t)X.extent(1)) {
+    boost::format m("Number of features at input data set (%d columns) does not match machine input size (%d)");
+    m % X.extent(1) % machine.inputSize();
+    throw std::runtime_error(m.str());
+  }
+  if (K == 0 || K > rank) {
+    boost::format m("Number of outputs of the given machine (%d) should be in the range [1, %d], i.e., up to min(#samples-1,#features) = min(%d, %d)");
+    m % K % rank % (X.extent(0)-1) % X.extent(1);
+    throw std::runtime_error(m.str());
+  }
+  if (eigen_values.extent(0) != K) {
+    boost::format m("Number of eigenvalues on the given 1D array (%d) does not match the number of outputs of the given machine (%d)");
+    m % eigen_values.extent(0) % K;
+    throw std::runtime_error(m.str());
+  }
+  const int L = K + m_oversampling;
+  if (L > X.extent(0) || L > X.extent(1)) {
+    boost::format m("The number of outputs of the given machine plus the oversampling (%d + %d = %d) exceeds the number of samples (%d) or of features (%d)");
+    m % K % m_oversampling % L % X.extent(0) % X.extent(1);
+    throw std::runtime_error(m.str());
+  }
+
+  blitz::secondIndex j;
+  blitz::Array<double,1> mean(X.extent(1));
+  mean = blitz::mean(X.transpose(1,0), j);
+
+  // samples the range of the (centered) data with L random directions
+  boost::normal_distribution<double> normal;
+  boost::variate_generator<boost::mt19937&, boost::normal_distribution<double> >
+    draw(*m_rng, normal);
+  blitz::Array<double,2> Omega(X.extent(1), L);
+  for (int f=0; f<Omega.extent(0); ++f)
+    for (int l=0; l<L; ++l) Omega(f,l) = draw();
+
+  blitz::Array<double,2> Q(X.extent(0), L);
+  blitz::Array<double,2> Z(X.extent(1), L);
+  centered_prod(X, mean, Omega, Q);
+  orthonormalize(Q);
+
+  // power iterations, orthonormalizing at each step for stability
+  for (size_t p=0; p<m_power_iterations; ++p) {
+    centered_prod_t(X, mean, Q, Z);
+    orthonormalize(Z);
+    centered_prod(X, mean, Z, Q);
+    orthonormalize(Q);
+  }
+
+  /**
+   * The SVD of the small matrix B^T = (X-mu)^T.Q = U.S.W^T gives the right
+   * singular vectors of the data, U, and its singular values, S, sorted by
+   * decreasing magnitude.
+   */
+  centered_prod_t(X, mean, Q, Z);
+  blitz::Array<double,2> U(X.extent(1), L);
+  blitz::Array<double,1> sigma(L);
+  bob::math::svd_(Z, U, sigma);
+
+  /**
+   * sets the linear machine with the results:
+   */
+  blitz::Range up_to_k(0, K-1);
+  machine.setInputSubtraction(mean);
+  machine.setInputDivision(1.0);
+  machine.setBiases(0.0);
+  machine.setWeights(U(blitz::Range::all(), up_to_k));
+  eigen_values = (blitz::pow2(sigma)/(X.extent(0)-1))(up_to_k);
+}
+
+double bob::trainer::PCATrainer::total_variance
+(const blitz::Array<double,2>& X) const
+{
+  double total = 0.;
+  for (int f=0; f<X.extent(1); ++f) {
+    double mean = 0.;
+    for (int i=0; i<X.extent(0); ++i) mean += X(i,f);
+    mean /= X.extent(0);
+    for (int i=0; i<X.extent(0); ++i) total += (X(i,f) - mean) * (X(i,f) - mean);
+  }
+  return total / (X.extent(0)-1);
+}
+
 size_t bob::trainer::PCATrainer::output_size
 (const blitz::Array<double,2>& X) const{
   return (size_t)std::min(X.extent(0)-1,X.extent(1));
@@ -25,6 +25,7 @@
 #include <bob/core/array_random.h>
 #include <bob/math/linear.h>
 #include <bob/math/inv.h>
+#include <bob/math/lu.h>
 #include <bob/math/svd.h>
 #include <algorithm>
 #include <boost/random.hpp>
@@ -708,8 +709,9 @@ void bob::trainer::PLDATrainer::updateFG(bob::machine::PLDABase& machine,
     }
   }
 
-  // 2/ Computes the denominator inv(sum_ij E{z_i.z_i^T})
-  bob::math::inv(m_cache_sum_z_second_order, m_tmp_nfng_nfng);
+  // 2/ Computes the denominator inv(sum_ij E{z_i.z_i^T}) (symmetric positive
+  // definite, hence the Cholesky-based inverse)
+  bob::math::cholInv_(m_cache_sum_z_second_order, m_tmp_nfng_nfng, m_workspace);
 
   // 3/ Computes numerator / denominator
   bob::math::prod(m_tmp_D_nfng_2, m_tmp_nfng_nfng, m_cache_B);
@@ -20,11 +20,17 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <map>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
 #include <boost/format.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/shared_array.hpp>
 #include <boost/algorithm/string.hpp>
 #include <bob/trainer/SVMTrainer.h>
 #include <bob/core/logging.h>
+#include <bob/core/parallel.h>
 
 #ifdef BOB_DEBUG
 //remove newline
@@ -52,7 +58,9 @@ bob::trainer::SVMTrainer::SVMTrainer(
     double p,
     bool shrinking,
     bool probability
-    )
+    ):
+  m_n_threads(0),
+  m_kernel_matrix_limit(512)
 {
   m_param.svm_type = svm_type;
   m_param.kernel_type = kernel_type;
@@ -222,6 +230,335 @@ static void svm_model_free(svm_model*& m) {
 #endif
 }
 
+/**
+ * Integer power, computed exactly as libsvm does
+ */
+static inline double powi(double base, int times) {
+  double tmp = base, ret = 1.0;
+  for (int t=times; t>0; t/=2) {
+    if (t%2 == 1) ret *= tmp;
+    tmp = tmp * tmp;
+  }
+  return ret;
+}
+
+/**
+ * Computes rows of the kernel matrix of a dense (C-contiguous) N x D copy of
+ * the training data, and stores them in the format libsvm expects for
+ * precomputed kernels: row i is "0:i+1 1:K(i,0) ... N:K(i,N-1)" followed by
+ * a terminating node. Dot products are summed over the features in order,
+ * as libsvm does on its sparse vectors (the zeros it skips add nothing), so
+ * the kernel values are identical to libsvm's.
+ *
+ * Only the upper triangle is computed and mirrored. Rows k and N-1-k are
+ * handled together so that the work of each index is about the same.
+ */
+struct KernelRows {
+  const double* X;
+  const double* x_square;
+  size_t N;
+  size_t D;
+  const svm_parameter& param;
+  svm_node* nodes;
+
+  KernelRows(const double* X_, const double* x_square_, size_t N_,
+      size_t D_, const svm_parameter& param_, svm_node* nodes_):
+    X(X_), x_square(x_square_), N(N_), D(D_), param(param_),
+    nodes(nodes_) {}
+
+  inline double kernel(size_t i, size_t j, double dot) const {
+    switch (param.kernel_type) {
+      case LINEAR:
+        return dot;
+      case POLY:
+        return powi(param.gamma*dot+param.coef0, param.degree);
+      case RBF:
+        return exp(-param.gamma*(x_square[i]+x_square[j]-2*dot));
+      case SIGMOID:
+        return tanh(param.gamma*dot+param.coef0);
+      default:
+        return 0.;
+    }
+  }
+
+  void row(size_t i) const {
+    const double* xi = X + i*D;
+    size_t j = i;
+    // 4 columns at a time, with independent accumulators
+    for (; j+4 <= N; j+=4) {
+      const double* x0 = X + j*D;
+      const double* x1 = x0 + D;
+      const double* x2 = x1 + D;
+      const double* x3 = x2 + D;
+      double d0 = 0., d1 = 0., d2 = 0., d3 = 0.;
+      for (size_t f=0; f<D; ++f) {
+        const double v = xi[f];
+        d0 += v * x0[f];
+        d1 += v * x1[f];
+        d2 += v * x2[f];
+        d3 += v * x3[f];
+      }
+      set(i, j, kernel(i, j, d0));
+      set(i, j+1, kernel(i, j+1, d1));
+      set(i, j+2, kernel(i, j+2, d2));
+      set(i, j+3, kernel(i, j+3, d3));
+    }
+    for (; j<N; ++j) {
+      const double* xj = X + j*D;
+      double d = 0.;
+      for (size_t f=0; f<D; ++f) d += xi[f] * xj[f];
+      set(i, j, kernel(i, j, d));
+    }
+  }
+
+  inline void set(size_t i, size_t j, double value) const {
+    nodes[i*(N+2) + j+1].value = value;
+    nodes[j*(N+2) + i+1].value = value;
+  }
+
+  void operator()(size_t, uint64_t begin, uint64_t end) const {
+    for (uint64_t k=begin; k<end; ++k) {
+      row(k);
+      if (N-1-k != k) row(N-1-k);
+    }
+  }
+};
+
+/**
+ * A precomputed kernel problem, with the same labels as the original one
+ */
+struct KernelProblem {
+  svm_problem problem;
+  std::vector<svm_node*> x;
+  boost::shared_array<svm_node> nodes;
+};
+
+/**
+ * Builds the precomputed kernel version of a problem, if the kernel matrix
+ * fits in limit_mb. Otherwise, returns an empty pointer.
+ */
+static boost::shared_ptr<KernelProblem> kernel_problem(const svm_problem& p,
+    const svm_parameter& param, double limit_mb, size_t n_threads) {
+  boost::shared_ptr<KernelProblem> retval;
+  const size_t N = p.l;
+  if (N == 0 || limit_mb <= 0. || param.kernel_type == PRECOMPUTED)
+    return retval;
+  const double size_mb = (double)N * (N+2) * sizeof(svm_node) / (1024.*1024.);
+  if (size_mb > limit_mb) return retval;
+
+  // dense copy of the (already scaled) data, as libsvm sees it
+  int D = 0;
+  for (size_t i=0; i<N; ++i)
+    for (const svm_node* n=p.x[i]; n->index != -1; ++n)
+      if (n->index > D) D = n->index;
+  std::vector<double> X(N*std::max(D,1), 0.);
+  std::vector<double> x_square(N, 0.);
+  for (size_t i=0; i<N; ++i) {
+    for (const svm_node* n=p.x[i]; n->index != -1; ++n) {
+      X[i*D + n->index-1] = n->value;
+      x_square[i] += n->value * n->value;
+    }
+  }
+
+  retval.reset(new KernelProblem);
+  retval->nodes.reset(new svm_node[N*(N+2)]);
+  retval->x.resize(N);
+  for (size_t i=0; i<N; ++i) {
+    svm_node* row = &retval->nodes[i*(N+2)];
+    row[0].index = 0;
+    row[0].value = i+1; //sample serial number
+    for (size_t j=0; j<N; ++j) row[j+1].index = j+1;
+    row[N+1].index = -1;
+    row[N+1].value = 0.;
+    retval->x[i] = row;
+  }
+  bob::core::parallel_for((N+1)/2, KernelRows(&X[0], &x_square[0], N, D,
+        param, retval->nodes.get()), n_threads);
+
+  retval->problem.l = p.l;
+  retval->problem.y = p.y;
+  retval->problem.x = &retval->x[0];
+  return retval;
+}
+
+/**
+ * Trains the one-vs-one binary subproblems of a multi-class problem, whose
+ * samples are grouped by class (count[k] samples for class k), exactly as
+ * libsvm's svm_train() would.
+ */
+struct PairTrainer {
+  const svm_problem& p;
+  const svm_parameter& param;
+  const std::vector<std::pair<int,int> >& pairs;
+  const std::vector<int>& start;
+  const std::vector<int>& count;
+  std::vector<std::vector<double> >& alpha; ///< signed alphas, per pair
+  std::vector<double>& rho;
+  std::vector<double>& probA;
+  std::vector<double>& probB;
+
+  PairTrainer(const svm_problem& p_, const svm_parameter& param_,
+      const std::vector<std::pair<int,int> >& pairs_,
+      const std::vector<int>& start_, const std::vector<int>& count_,
+      std::vector<std::vector<double> >& alpha_, std::vector<double>& rho_,
+      std::vector<double>& probA_, std::vector<double>& probB_):
+    p(p_), param(param_), pairs(pairs_), start(start_), count(count_),
+    alpha(alpha_), rho(rho_), probA(probA_), probB(probB_) {}
+
+  void operator()(size_t, uint64_t begin, uint64_t end) const {
+    for (uint64_t k=begin; k<end; ++k) {
+      const int i = pairs[k].first;
+      const int j = pairs[k].second;
+      const int ci = count[i];
+      const int cj = count[j];
+
+      // class i is the first one found (+1), as in libsvm
+      svm_problem sub;
+      sub.l = ci + cj;
+      std::vector<double> y(sub.l);
+      std::vector<svm_node*> x(sub.l);
+      std::map<const svm_node*, int> position;
+      for (int s=0; s<ci; ++s) {
+        x[s] = p.x[start[i]+s];
+        y[s] = +1.;
+        position[x[s]] = s;
+      }
+      for (int s=0; s<cj; ++s) {
+        x[ci+s] = p.x[start[j]+s];
+        y[ci+s] = -1.;
+        position[x[ci+s]] = ci+s;
+      }
+      sub.y = &y[0];
+      sub.x = &x[0];
+
+      boost::shared_ptr<svm_model> model(svm_train(&sub, &param),
+          std::ptr_fun(svm_model_free));
+
+      // the support vectors of the binary model point to the sub-problem
+      alpha[k].assign(sub.l, 0.);
+      for (int s=0; s<model->l; ++s)
+        alpha[k][position[model->SV[s]]] = model->sv_coef[0][s];
+      rho[k] = model->rho[0];
+      if (param.probability) {
+        probA[k] = model->probA[0];
+        probB[k] = model->probB[0];
+      }
+    }
+  }
+};
+
+/**
+ * Allocates memory like libsvm does, so that the model can be freed with
+ * svm_model_free()
+ */
+template <typename T> static T* svm_malloc(size_t n) {
+  return (T*)malloc(std::max(n, (size_t)1) * sizeof(T));
+}
+
+/**
+ * Trains a multi-class (C_SVC or NU_SVC) problem whose samples are grouped
+ * by class (count[k] samples with label labels[k]) with concurrent
+ * one-vs-one subproblems. The support vectors of the returned model point
+ * to the input problem.
+ */
+static boost::shared_ptr<svm_model> train_one_vs_one(const svm_problem& p,
+    const svm_parameter& param, const std::vector<double>& labels,
+    const std::vector<int>& count, size_t n_threads) {
+
+  const int nr_class = labels.size();
+  std::vector<int> start(nr_class, 0);
+  for (int i=1; i<nr_class; ++i) start[i] = start[i-1] + count[i-1];
+
+  std::vector<std::pair<int,int> > pairs;
+  for (int i=0; i<nr_class; ++i)
+    for (int j=i+1; j<nr_class; ++j) pairs.push_back(std::make_pair(i, j));
+
+  const size_t n_pairs = pairs.size();
+  std::vector<std::vector<double> > alpha(n_pairs);
+  std::vector<double> rho(n_pairs), probA(n_pairs), probB(n_pairs);
+  bob::core::parallel_for(n_pairs, PairTrainer(p, param, pairs, start, count,
+        alpha, rho, probA, probB), param.probability ? 1 : n_threads);
+
+  // a sample is a support vector if it is one for any of the subproblems
+  std::vector<bool> nonzero(p.l, false);
+  for (size_t k=0; k<n_pairs; ++k) {
+    const int i = pairs[k].first;
+    const int j = pairs[k].second;
+    for (int s=0; s<count[i]; ++s)
+      if (fabs(alpha[k][s]) > 0) nonzero[start[i]+s] = true;
+    for (int s=0; s<count[j]; ++s)
+      if (fabs(alpha[k][count[i]+s]) > 0) nonzero[start[j]+s] = true;
+  }
+
+  // assembles the model, as libsvm does
+  svm_model* model = svm_malloc<svm_model>(1);
+  model->param = param;
+  model->nr_class = nr_class;
+  model->label = svm_malloc<int>(nr_class);
+  for (int i=0; i<nr_class; ++i) model->label[i] = (int)labels[i];
+  model->rho = svm_malloc<double>(n_pairs);
+  for (size_t k=0; k<n_pairs; ++k) model->rho[k] = rho[k];
+  if (param.probability) {
+    model->probA = svm_malloc<double>(n_pairs);
+    model->probB = svm_malloc<double>(n_pairs);
+    for (size_t k=0; k<n_pairs; ++k) {
+      model->probA[k] = probA[k];
+      model->probB[k] = probB[k];
+    }
+  }
+  else {
+    model->probA = 0;
+    model->probB = 0;
+  }
+
+  int total_sv = 0;
+  std::vector<int> nz_count(nr_class, 0);
+  model->nSV = svm_malloc<int>(nr_class);
+  for (int i=0; i<nr_class; ++i) {
+    for (int s=0; s<count[i]; ++s)
+      if (nonzero[start[i]+s]) ++nz_count[i];
+    model->nSV[i] = nz_count[i];
+    total_sv += nz_count[i];
+  }
+  model->l = total_sv;
+  model->SV = svm_malloc<svm_node*>(total_sv);
+#if LIBSVM_VERSION >= 313
+  model->sv_indices = svm_malloc<int>(total_sv);
+#endif
+  int q = 0;
+  for (int s=0; s<p.l; ++s) {
+    if (nonzero[s]) {
+      model->SV[q] = p.x[s];
+#if LIBSVM_VERSION >= 313
+      model->sv_indices[q] = s+1;
+#endif
+      ++q;
+    }
+  }
+
+  std::vector<int> nz_start(nr_class, 0);
+  for (int i=1; i<nr_class; ++i) nz_start[i] = nz_start[i-1] + nz_count[i-1];
+
+  model->sv_coef = svm_malloc<double*>(nr_class-1);
+  for (int i=0; i<nr_class-1; ++i) {
+    model->sv_coef[i] = svm_malloc<double>(total_sv);
+    std::fill(model->sv_coef[i], model->sv_coef[i] + total_sv, 0.);
+  }
+  for (size_t k=0; k<n_pairs; ++k) {
+    const int i = pairs[k].first;
+    const int j = pairs[k].second;
+    int r = nz_start[i];
+    for (int s=0; s<count[i]; ++s)
+      if (nonzero[start[i]+s]) model->sv_coef[j-1][r++] = alpha[k][s];
+    r = nz_start[j];
+    for (int s=0; s<count[j]; ++s)
+      if (nonzero[start[j]+s]) model->sv_coef[i][r++] = alpha[k][count[i]+s];
+  }
+  model->free_sv = 0;
+
+  return boost::shared_ptr<svm_model>(model, std::ptr_fun(svm_model_free));
+}
+
 boost::shared_ptr<bob::machine::SupportVector> bob::trainer::SVMTrainer::train
 (const std::vector<blitz::Array<double, 2> >& data,
  const blitz::Array<double,1>& input_subtraction,
@@ -263,8 +600,40 @@ boost::shared_ptr<bob::machine::SupportVector> bob::trainer::SVMTrainer::train
   m % libsvm_version;
   debug_libsvm(m.str().c_str());
 #endif
-  boost::shared_ptr<svm_model> model(svm_train(problem.get(), &m_param),
-      std::ptr_fun(svm_model_free));
+  //uses a precomputed kernel matrix, shared by all subproblems, if it fits
+  svm_parameter param = m_param;
+  boost::shared_ptr<KernelProblem> kernel = kernel_problem(*problem, param,
+      m_kernel_matrix_limit, m_n_threads);
+  const svm_problem* train_problem = problem.get();
+  if (kernel) {
+    param.kernel_type = PRECOMPUTED;
+    train_problem = &kernel->problem;
+  }
+
+  //multi-class problems: trains the one-vs-one subproblems concurrently
+  boost::shared_ptr<svm_model> model;
+  if (data.size() > 2 &&
+      (param.svm_type == C_SVC || param.svm_type == NU_SVC)) {
+    std::vector<double> labels;
+    std::vector<int> count;
+    for (size_t k=0; k<data.size(); ++k) {
+      labels.push_back(k+1);
+      count.push_back(data[k].extent(blitz::firstDim));
+    }
+    model = train_one_vs_one(*train_problem, param, labels, count,
+        m_n_threads);
+  }
+  else {
+    model.reset(svm_train(train_problem, &param),
+        std::ptr_fun(svm_model_free));
+  }
+
+  //points the support vectors back to the original data and kernel
+  if (kernel) {
+    for (int k=0; k<model->l; ++k)
+      model->SV[k] = problem->x[(int)model->SV[k][0].value - 1];
+    model->param = m_param;
+  }
 
   const_cast<double&>(m_param.gamma) = save_gamma;
 
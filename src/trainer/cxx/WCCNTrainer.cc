@@ -22,7 +22,7 @@
 #include <bob/trainer/WCCNTrainer.h>
 #include <bob/math/inv.h>
 #include <bob/math/lu.h>
-#include <bob/math/stats.h>
+#include <bob/math/ScatterAccumulator.h>
 #include <boost/make_shared.hpp>
 
 
@@ -100,11 +100,12 @@ void bob::trainer::WCCNTrainer::train(bob::machine::LinearMachine& machine,
     throw std::runtime_error(m.str());
   }
 
-  // 1. Computes the mean vector and the Scatter matrix Sw and Sb
-  blitz::Array<double,1> mean(n_features);
+  // 1. Computes the within-class scatter matrix Sw
   blitz::Array<double,2> buf1(n_features, n_features); // Sw
-  blitz::Array<double,2> buf2(n_features, n_features); // Sb
-  bob::math::scatters(data, buf1, buf2, mean); // buf1 = Sw; buf2 = Sb
+  blitz::Array<double,2> buf2(n_features, n_features);
+  bob::math::ScatterAccumulator scatters(n_features, n_classes);
+  scatters.add(data);
+  scatters.getWithinScatter(buf1);
 
   // 2. Computes the inverse of (1/N * Sw), Sw is the within-class covariance matrix
   buf1 /= n_classes;
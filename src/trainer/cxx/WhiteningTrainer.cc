@@ -23,7 +23,7 @@
 #include <bob/trainer/WhiteningTrainer.h>
 #include <bob/math/inv.h>
 #include <bob/math/lu.h>
-#include <bob/math/stats.h>
+#include <bob/math/ScatterAccumulator.h>
 
 bob::trainer::WhiteningTrainer::WhiteningTrainer()
 {
@@ -85,7 +85,10 @@ void bob::trainer::WhiteningTrainer::train(bob::machine::LinearMachine& machine,
   // 1. Computes the mean vector and the covariance matrix of the training set
   blitz::Array<double,1> mean(n_features);
   blitz::Array<double,2> cov(n_features,n_features);
-  bob::math::scatter(ar, cov, mean);
+  bob::math::ScatterAccumulator scatter(n_features);
+  scatter.add(ar);
+  scatter.getWithinScatter(cov);
+  scatter.getMean(mean);
   cov /= (double)(n_samples-1);
 
   // 2. Computes the inverse of the covariance matrix
@@ -21,6 +21,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/trainer/CGLogRegTrainer.h>
 
 using namespace boost::python;
@@ -29,27 +30,62 @@ object train1(const bob::trainer::CGLogRegTrainer& t,
   bob::python::const_ndarray data1, bob::python::const_ndarray data2)
 {
   bob::machine::LinearMachine m;
-  t.train(m, data1.bz<double,2>(), data2.bz<double,2>());
+  {
+    bob::python::no_gil unlock;
+    t.train(m, data1.bz<double,2>(), data2.bz<double,2>());
+  }
   return object(m);
 }
 
 void train2(const bob::trainer::CGLogRegTrainer& t, bob::machine::LinearMachine& m, 
   bob::python::const_ndarray data1, bob::python::const_ndarray data2)
 {
+  bob::python::no_gil unlock;
   t.train(m, data1.bz<double,2>(), data2.bz<double,2>());
 }
 
+object train_files1(const bob::trainer::CGLogRegTrainer& t,
+  bob::io::File& negatives, bob::io::File& positives)
+{
+  bob::machine::LinearMachine m;
+  t.train(m, negatives, positives);
+  return object(m);
+}
+
+void train_files2(const bob::trainer::CGLogRegTrainer& t,
+  bob::machine::LinearMachine& m, bob::io::File& negatives,
+  bob::io::File& positives)
+{
+  t.train(m, negatives, positives);
+}
+
 void bind_trainer_cglogreg() 
 {
-  class_<bob::trainer::CGLogRegTrainer, boost::shared_ptr<bob::trainer::CGLogRegTrainer> >("CGLogRegTrainer", "Trains a linear machine to perform Linear Logistic Regression. References:\n1. A comparison of numerical optimizers for logistic regression, T. Minka, http://research.microsoft.com/en-us/um/people/minka/papers/logreg/\n2. FoCal, http://www.dsp.sun.ac.za/~nbrummer/focal/.", init<optional<const double, const double, const size_t, const double> >((arg("self"), arg("prior")=0.5, arg("convergence_threshold")=1e-5, arg("max_iterations")=10000, arg("lambda")=0.), "Initializes a new Linear Logistic Regression trainer. The training stage will place the resulting weights (and bias) in a linear machine with a single output dimension."))
-    .def(init<bob::trainer::CGLogRegTrainer&>((arg("self"), arg("other"))))
+  class_<bob::trainer::CGLogRegTrainer, boost::shared_ptr<bob::trainer::CGLogRegTrainer> > CGLRT("CGLogRegTrainer", "Trains a linear machine to perform Linear Logistic Regression. References:\n1. A comparison of numerical optimizers for logistic regression, T. Minka, http://research.microsoft.com/en-us/um/people/minka/papers/logreg/\n2. FoCal, http://www.dsp.sun.ac.za/~nbrummer/focal/.", init<optional<const double, const double, const size_t, const double> >((arg("self"), arg("prior")=0.5, arg("convergence_threshold")=1e-5, arg("max_iterations")=10000, arg("lambda")=0.), "Initializes a new Linear Logistic Regression trainer. The training stage will place the resulting weights (and bias) in a linear machine with a single output dimension."));
+
+  CGLRT.def(init<bob::trainer::CGLogRegTrainer&>((arg("self"), arg("other"))))
     .def(self == self)
     .def(self != self)
     .add_property("prior", &bob::trainer::CGLogRegTrainer::getPrior, &bob::trainer::CGLogRegTrainer::setPrior, "The synthetic prior (should be in range ]0.,1.[.")
     .add_property("convergence_threshold", &bob::trainer::CGLogRegTrainer::getConvergenceThreshold, &bob::trainer::CGLogRegTrainer::setConvergenceThreshold, "The convergence threshold for the conjugate gradient algorithm")
     .add_property("max_iterations", &bob::trainer::CGLogRegTrainer::getMaxIterations, &bob::trainer::CGLogRegTrainer::setMaxIterations, "The maximum number of iterations for the conjugate gradient algorithm")
     .add_property("lambda", &bob::trainer::CGLogRegTrainer::getLambda, &bob::trainer::CGLogRegTrainer::setLambda, "The regularization factor lambda")
+    .add_property("solver", &bob::trainer::CGLogRegTrainer::getSolver, &bob::trainer::CGLogRegTrainer::setSolver, "The optimizer: CONJUGATE_GRADIENT (the default) or LBFGS. With LBFGS, the convergence threshold applies to the norm of the gradient (relative to the norm of the weights).")
+    .add_property("n_threads", &bob::trainer::CGLogRegTrainer::getNThreads, &bob::trainer::CGLogRegTrainer::setNThreads, "The number of threads used to evaluate the objective function (0 means the default number of threads). The result does not depend on it.")
+    .add_property("block_size", &bob::trainer::CGLogRegTrainer::getBlockSize, &bob::trainer::CGLogRegTrainer::setBlockSize, "The number of samples in each of the chunks the objective function is evaluated on, in parallel")
     .def("train", &train1, (arg("self"), arg("negatives"), arg("positives")), "Trains a LinearMachine to perform the Linear Logistic Regression, using two arraysets for training, one for each of the two classes (negatives vs. positives). The trained LinearMachine is returned.")
     .def("train", &train2, (arg("self"), arg("machine"), arg("negatives"), arg("positives")), "Trains a LinearMachine to perform the Linear Logistic Regression, using two arraysets for training, one for each of the two classes (negatives vs. positives).")
+    .def("train_files", &train_files1, (arg("self"), arg("negatives"), arg("positives")), "Trains a LinearMachine to perform the Linear Logistic Regression, reading the samples (1D arrays) of each of the two classes from files (see bob.io.open()), block by block, each time the objective function is evaluated. The trained LinearMachine is returned.")
+    .def("train_files", &train_files2, (arg("self"), arg("machine"), arg("negatives"), arg("positives")), "Trains a LinearMachine to perform the Linear Logistic Regression, reading the samples (1D arrays) of each of the two classes from files (see bob.io.open()), block by block, each time the objective function is evaluated.")
+    ;
+
+  // Sets the scope to the one of the CGLogRegTrainer
+  scope s(CGLRT);
+
+  // Adds enum in the previously defined current scope
+  enum_<bob::trainer::CGLogRegTrainer::Solver>("solver_type")
+    .value("CONJUGATE_GRADIENT", bob::trainer::CGLogRegTrainer::CONJUGATE_GRADIENT)
+    .value("LBFGS", bob::trainer::CGLogRegTrainer::LBFGS)
+    .export_values()
     ;
 }
@@ -19,6 +19,7 @@
  */
 #include <boost/python.hpp>
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <boost/shared_ptr.hpp>
 #include <bob/trainer/EMPCATrainer.h>
 #include <bob/machine/LinearMachine.h>
@@ -30,30 +31,35 @@ typedef bob::trainer::EMTrainer<bob::machine::LinearMachine, blitz::Array<double
 static void py_train(EMTrainerLinearBase& trainer, 
   bob::machine::LinearMachine& machine, bob::python::const_ndarray data)
 {
+  bob::python::no_gil unlock;
   trainer.train(machine, data.bz<double,2>());
 }
 
 static void py_initialize(EMTrainerLinearBase& trainer, 
   bob::machine::LinearMachine& machine, bob::python::const_ndarray data)
 {
+  bob::python::no_gil unlock;
   trainer.initialize(machine, data.bz<double,2>());
 }
 
 static void py_finalize(EMTrainerLinearBase& trainer, 
   bob::machine::LinearMachine& machine, bob::python::const_ndarray data)
 {
+  bob::python::no_gil unlock;
   trainer.finalize(machine, data.bz<double,2>());
 }
 
 static void py_eStep(EMTrainerLinearBase& trainer, 
   bob::machine::LinearMachine& machine, bob::python::const_ndarray data)
 {
+  bob::python::no_gil unlock;
   trainer.eStep(machine, data.bz<double,2>());
 }
 
 static void py_mStep(EMTrainerLinearBase& trainer, 
   bob::machine::LinearMachine& machine, bob::python::const_ndarray data)
 {
+  bob::python::no_gil unlock;
   trainer.mStep(machine, data.bz<double,2>());
 }
 
@@ -19,6 +19,7 @@
  */
 #include <boost/python.hpp>
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/trainer/GMMTrainer.h>
 #include <bob/trainer/MAP_GMMTrainer.h>
 #include <bob/trainer/ML_GMMTrainer.h>
@@ -29,26 +30,31 @@ typedef bob::trainer::EMTrainer<bob::machine::GMMMachine, blitz::Array<double,2>
 
 static void py_train(EMTrainerGMMBase& trainer, bob::machine::GMMMachine& machine, bob::python::const_ndarray sample)
 {
+  bob::python::no_gil unlock;
   trainer.train(machine, sample.bz<double,2>());
 }
 
 static void py_initialize(EMTrainerGMMBase& trainer, bob::machine::GMMMachine& machine, bob::python::const_ndarray sample)
 {
+  bob::python::no_gil unlock;
   trainer.initialize(machine, sample.bz<double,2>());
 }
 
 static void py_finalize(EMTrainerGMMBase& trainer, bob::machine::GMMMachine& machine, bob::python::const_ndarray sample)
 {
+  bob::python::no_gil unlock;
   trainer.finalize(machine, sample.bz<double,2>());
 }
 
 static void py_eStep(EMTrainerGMMBase& trainer, bob::machine::GMMMachine& machine, bob::python::const_ndarray sample)
 {
+  bob::python::no_gil unlock;
   trainer.eStep(machine, sample.bz<double,2>());
 }
 
 static void py_mStep(EMTrainerGMMBase& trainer, bob::machine::GMMMachine& machine, bob::python::const_ndarray sample)
 {
+  bob::python::no_gil unlock;
   trainer.mStep(machine, sample.bz<double,2>());
 }
 
@@ -21,6 +21,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <boost/python/stl_iterator.hpp>
 #include <bob/trainer/JFATrainer.h>
 #include <boost/shared_ptr.hpp>
@@ -53,6 +54,7 @@ static void isv_train(bob::trainer::ISVTrainer& t, bob::machine::ISVBase& m, obj
   std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > > training_data;
   extract_GMMStats(data, training_data);
   // Calls the train function
+  bob::python::no_gil unlock;
   t.train(m, training_data);
 }
 
@@ -61,6 +63,7 @@ static void isv_initialize(bob::trainer::ISVTrainer& t, bob::machine::ISVBase& m
   std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > > training_data;
   extract_GMMStats(data, training_data);
   // Calls the initialize function
+  bob::python::no_gil unlock;
   t.initialize(m, training_data);
 }
 
@@ -69,6 +72,7 @@ static void isv_estep(bob::trainer::ISVTrainer& t, bob::machine::ISVBase& m, obj
   std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > > training_data;
   extract_GMMStats(data, training_data);
   // Calls the E-Step function
+  bob::python::no_gil unlock;
   t.eStep(m, training_data);
 }
 
@@ -77,6 +81,7 @@ static void isv_mstep(bob::trainer::ISVTrainer& t, bob::machine::ISVBase& m, obj
   std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > > training_data;
   extract_GMMStats(data, training_data);
   // Calls the M-Step function
+  bob::python::no_gil unlock;
   t.mStep(m, training_data);
 }
 
@@ -85,6 +90,7 @@ static void isv_finalize(bob::trainer::ISVTrainer& t, bob::machine::ISVBase& m,
   std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > > training_data;
   extract_GMMStats(data, training_data);
   // Calls the finalization function
+  bob::python::no_gil unlock;
   t.finalize(m, training_data);
 }
 
@@ -93,6 +99,7 @@ static void isv_enrol(bob::trainer::ISVTrainer& t, bob::machine::ISVMachine& m,
   stl_input_iterator<boost::shared_ptr<bob::machine::GMMStats> > dlbegin(data), dlend;
   std::vector<boost::shared_ptr<bob::machine::GMMStats> > vdata(dlbegin, dlend);
   // Calls the enrol function
+  bob::python::no_gil unlock;
   t.enrol(m, vdata, n_iter);
 }
 
@@ -144,6 +151,7 @@ static void jfa_train(bob::trainer::JFATrainer& t, bob::machine::JFABase& m, obj
   std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > > training_data;
   extract_GMMStats(data, training_data);
   // Calls the train function
+  bob::python::no_gil unlock;
   t.train(m, training_data);
 }
 
@@ -152,6 +160,7 @@ static void jfa_initialize(bob::trainer::JFATrainer& t, bob::machine::JFABase& m
   std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > > training_data;
   extract_GMMStats(data, training_data);
   // Calls the initialize function
+  bob::python::no_gil unlock;
   t.initialize(m, training_data);
 }
 
@@ -240,6 +249,7 @@ static void jfa_enrol(bob::trainer::JFATrainer& t, bob::machine::JFAMachine& m,
   stl_input_iterator<boost::shared_ptr<bob::machine::GMMStats> > dlbegin(data), dlend;
   std::vector<boost::shared_ptr<bob::machine::GMMStats> > vdata(dlbegin, dlend);
   // Calls the enrol function
+  bob::python::no_gil unlock;
   t.enrol(m, vdata, n_iter);
 }
 
@@ -19,6 +19,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/trainer/KMeansTrainer.h>
 
 using namespace boost::python;
@@ -42,30 +43,35 @@ static void py_setFirstOrderStats(bob::trainer::KMeansTrainer& op, bob::python::
 static void py_train(EMTrainerKMeansBase& trainer, 
   bob::machine::KMeansMachine& machine, bob::python::const_ndarray sample)
 {
+  bob::python::no_gil unlock;
   trainer.train(machine, sample.bz<double,2>());
 }
 
 static void py_initialize(EMTrainerKMeansBase& trainer, 
   bob::machine::KMeansMachine& machine, bob::python::const_ndarray sample)
 {
+  bob::python::no_gil unlock;
   trainer.initialize(machine, sample.bz<double,2>());
 }
 
 static void py_finalize(EMTrainerKMeansBase& trainer, 
   bob::machine::KMeansMachine& machine, bob::python::const_ndarray sample)
 {
+  bob::python::no_gil unlock;
   trainer.finalize(machine, sample.bz<double,2>());
 }
 
 static void py_eStep(EMTrainerKMeansBase& trainer, 
   bob::machine::KMeansMachine& machine, bob::python::const_ndarray sample)
 {
+  bob::python::no_gil unlock;
   trainer.eStep(machine, sample.bz<double,2>());
 }
 
 static void py_mStep(EMTrainerKMeansBase& trainer, 
   bob::machine::KMeansMachine& machine, bob::python::const_ndarray sample)
 {
+  bob::python::no_gil unlock;
   trainer.mStep(machine, sample.bz<double,2>());
 }
 
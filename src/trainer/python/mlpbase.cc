@@ -153,6 +153,13 @@ static void mlpbase_backward_step(bob::trainer::MLPBaseTrainer& t,
   t.backward_step(m, input.bz<double,2>(), target.bz<double,2>());
 }
 
+static void mlpbase_forward_backward_step(bob::trainer::MLPBaseTrainer& t, 
+  const bob::machine::MLP& m, bob::python::const_ndarray input, 
+  bob::python::const_ndarray target)
+{
+  t.forward_backward_step(m, input.bz<double,2>(), target.bz<double,2>());
+}
+
 void bind_trainer_mlpbase() {
   class_<bob::trainer::MLPBaseTrainer, boost::shared_ptr<bob::trainer::MLPBaseTrainer> >("MLPBaseTrainer", "The base python class for MLP trainers based on cost derivatives.\n\nYou should use this class when you want to create your own MLP trainers and re-use the base infrastructured provided by this class, such as the computation of partial derivatives (using the ``backward_step()`` method).", no_init)
 
@@ -232,6 +239,10 @@ void bind_trainer_mlpbase() {
 
     .add_property("train_biases", &bob::trainer::MLPBaseTrainer::getTrainBiases, &bob::trainer::MLPBaseTrainer::setTrainBiases, "A flag, indicating if this trainer will adjust the biases of the network (``True``) or not (``False``).")
 
+    .add_property("shards", &bob::trainer::MLPBaseTrainer::getShards, &bob::trainer::MLPBaseTrainer::setShards, "The number of shards each batch is split into during training (defaults to 1). Shards are processed concurrently and their derivatives are summed up in a fixed order, so that results only depend on the batch size and on the number of shards, but never on the number of threads. With a single shard, training is done in a single pass over the batch.")
+
+    .add_property("n_threads", &bob::trainer::MLPBaseTrainer::getNThreads, &bob::trainer::MLPBaseTrainer::setNThreads, "The number of threads used to process the shards of each batch. If set to 0 (the default), the number of hardware threads available is used.")
+
     .def("is_compatible", &bob::trainer::MLPBaseTrainer::isCompatible, (arg("self"), arg("machine")), "Checks if a given machine is compatible with my inner settings")
 
     .def("initialize", &bob::trainer::MLPBaseTrainer::initialize, (arg("self"), arg("mlp")), "Initialize the training process.")
@@ -240,6 +251,8 @@ void bind_trainer_mlpbase() {
     
     .def("backward_step", &mlpbase_backward_step, (arg("self"), arg("mlp"), arg("input"), arg("target")), "Backwards a batch of data through the MLP and updates the internal buffers (errors and derivatives).")
 
+    .def("forward_backward_step", &mlpbase_forward_backward_step, (arg("self"), arg("mlp"), arg("input"), arg("target")), "Forwards and backwards a batch of data through the MLP, splitting it in :py:attr:`shards` processed in parallel, and updates the internal buffers (outputs, errors and derivatives).")
+
     .def("cost", &mlpbase_cost1, (arg("self"), arg("target")), 
         "Calculates the cost for a given target\n" \
         "\n" \
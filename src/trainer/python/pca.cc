@@ -25,7 +25,9 @@
 #include <boost/shared_ptr.hpp>
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/trainer/PCATrainer.h>
+#include <bob/trainer/IncrementalPCATrainer.h>
 
 using namespace boost::python;
 
@@ -36,7 +38,10 @@ static tuple pca_train1(bob::trainer::PCATrainer& t,
   const int rank = t.output_size(data_);
   bob::machine::LinearMachine m(data_.extent(1), rank);
   blitz::Array<double,1> eig_val(rank);
-  t.train(m, eig_val, data_);
+  {
+    bob::python::no_gil unlock;
+    t.train(m, eig_val, data_);
+  }
   return make_tuple(m, object(eig_val));
 }
 
@@ -46,7 +51,67 @@ static object pca_train2(bob::trainer::PCATrainer& t,
   const blitz::Array<double,2> data_ = data.bz<double,2>();
   const int rank = t.output_size(data_);
   blitz::Array<double,1> eig_val(rank);
-  t.train(m, eig_val, data_);
+  {
+    bob::python::no_gil unlock;
+    t.train(m, eig_val, data_);
+  }
+  return object(eig_val);
+}
+
+static tuple pca_train_randomized1(bob::trainer::PCATrainer& t,
+    bob::python::const_ndarray data, size_t K) {
+
+  const blitz::Array<double,2> data_ = data.bz<double,2>();
+  bob::machine::LinearMachine m(data_.extent(1), K);
+  blitz::Array<double,1> eig_val(K);
+  {
+    bob::python::no_gil unlock;
+    t.train_randomized(m, eig_val, data_);
+  }
+  return make_tuple(m, object(eig_val));
+}
+
+static object pca_train_randomized2(bob::trainer::PCATrainer& t,
+    bob::machine::LinearMachine& m, bob::python::const_ndarray data) {
+
+  const blitz::Array<double,2> data_ = data.bz<double,2>();
+  blitz::Array<double,1> eig_val(m.outputSize());
+  {
+    bob::python::no_gil unlock;
+    t.train_randomized(m, eig_val, data_);
+  }
+  return object(eig_val);
+}
+
+static double pca_total_variance(bob::trainer::PCATrainer& t,
+    bob::python::const_ndarray data) {
+  bob::python::no_gil unlock;
+  return t.total_variance(data.bz<double,2>());
+}
+
+static void ipca_update(bob::trainer::IncrementalPCATrainer& t,
+    bob::python::const_ndarray data) {
+  bob::python::no_gil unlock;
+  t.update(data.bz<double,2>());
+}
+
+static tuple ipca_train1(bob::trainer::IncrementalPCATrainer& t) {
+  bob::machine::LinearMachine m(t.getMean().extent(0), t.getNComponents());
+  blitz::Array<double,1> eig_val(t.getNComponents());
+  {
+    bob::python::no_gil unlock;
+    t.train(m, eig_val);
+  }
+  return make_tuple(m, object(eig_val));
+}
+
+static object ipca_train2(bob::trainer::IncrementalPCATrainer& t,
+    bob::machine::LinearMachine& m) {
+  blitz::Array<double,1> eig_val(t.getNComponents());
+  {
+    bob::python::no_gil unlock;
+    t.train(m, eig_val);
+  }
   return object(eig_val);
 }
 
@@ -178,9 +243,70 @@ void bind_trainer_pca() {
         "This method should be used to setup Machines and input vectors prior to feeding them into this trainer.\n"
         )
 
+    .def("train_randomized", &pca_train_randomized1, (arg("self"), arg("X"), arg("K")),
+        "Trains a LinearMachine with the first ``K`` principal components only, using the randomized truncated SVD of Halko, Martinsson & Tropp.\n" \
+        "\n" \
+        "Neither the covariance matrix nor the full SVD of the data are computed and the data is not copied, which makes this method suitable for large data sets with many features. Its precision increases with :py:attr:`oversampling` and :py:attr:`power_iterations`, and with the decay of the eigen values. ``K`` plus the oversampling should not exceed the number of samples or features.\n" \
+        "\n" \
+        "This method returns a tuple containing the resulting linear machine and the ``K`` largest eigen values in a 1D array. Divide these by :py:meth:`total_variance` to get the ratio of the variance they explain.\n" \
+        "\n" \
+        "Keyword parameters:\n" \
+        "\n" \
+        "X\n" \
+        "  The input data matrix :math:`X`, with one sample per row.\n" \
+        "\n" \
+        "K\n" \
+        "  The number of principal components to compute.\n"
+        )
+
+    .def("train_randomized", &pca_train_randomized2, (arg("self"), arg("machine"), arg("X")),
+        "Trains a LinearMachine with the first ``K`` principal components only, where ``K`` is the number of outputs of the given machine, using the randomized truncated SVD of Halko, Martinsson & Tropp. Returns the ``K`` largest eigen values in a 1D array.")
+
+    .def("total_variance", &pca_total_variance, (arg("self"), arg("X")),
+        "Calculates the total variance of the data, i.e. the sum of all the eigen values of its covariance matrix. Dividing eigen values by this gives the ratio of the variance they explain.")
+
     .add_property("use_svd", &bob::trainer::PCATrainer::getUseSVD,
         &bob::trainer::PCATrainer::setUseSVD,
         "This flag determines if this trainer will use the SVD method (set it to ``True``) to calculate the principal components or the Covariance method (set it to ``False``)")
+
+    .add_property("oversampling", &bob::trainer::PCATrainer::getOversampling,
+        &bob::trainer::PCATrainer::setOversampling,
+        "The number of extra random directions sampled by :py:meth:`train_randomized` (defaults to 10)")
+
+    .add_property("power_iterations", &bob::trainer::PCATrainer::getPowerIterations,
+        &bob::trainer::PCATrainer::setPowerIterations,
+        "The number of power iterations of :py:meth:`train_randomized` (defaults to 2). Each iteration costs two passes over the data and improves the precision when the eigen values decay slowly.")
+
+    .add_property("rng", &bob::trainer::PCATrainer::getRng, &bob::trainer::PCATrainer::setRng, "The Mersenne Twister mt19937 random generator used by :py:meth:`train_randomized`.")
+    ;
+
+  class_<bob::trainer::IncrementalPCATrainer, boost::shared_ptr<bob::trainer::IncrementalPCATrainer> >("IncrementalPCATrainer", "Computes the first K principal components of a data set that is given in chunks of samples (e.g. read from one file at a time), keeping only the mean, the K components and their singular values in memory.\n\nAt each update, the SVD of the current components (scaled by their singular values), the centered chunk and a column correcting for the shift of the mean is computed and the first K left singular vectors are kept. If K is at least the rank of the data, the result is that of :py:class:`bob.trainer.PCATrainer`. Otherwise, it is an approximation whose quality depends on how fast the eigen values decay.\n\nReferences:\n\n1. Incremental Learning for Robust Visual Tracking, Ross, Lim, Lin & Yang, International Journal of Computer Vision (2008) Volume: 77, Issue: 1-3, Pages: 125-141", no_init)
+
+    .def(init<size_t>((arg("self"), arg("K")), "Initializes a new trainer that keeps (at most) K components."))
+
+    .def(init<const bob::trainer::IncrementalPCATrainer&>((arg("self"), arg("other")), "Copy constructor - use this to deepcopy another trainer"))
+
+    .def(self == self)
+    .def(self != self)
+
+    .def("is_similar_to", &bob::trainer::IncrementalPCATrainer::is_similar_to, (arg("self"), arg("other"), arg("r_epsilon")=1e-5, arg("a_epsilon")=1e-8), "Compares this IncrementalPCATrainer with the 'other' one to be approximately the same.")
+
+    .def("update", &ipca_update, (arg("self"), arg("X")), "Updates the mean and the components with a chunk of samples, one per row. All chunks must have the same number of features.")
+
+    .def("reset", &bob::trainer::IncrementalPCATrainer::reset, (arg("self")), "Forgets all samples.")
+
+    .def("train", &ipca_train1, (arg("self")), "Returns a tuple containing a LinearMachine set with the current mean and components, arranged by decreasing eigen value, and the eigen values of the covariance matrix in a 1D array.")
+
+    .def("train", &ipca_train2, (arg("self"), arg("machine")), "Sets the given LinearMachine, which must have :py:attr:`n_components` outputs, with the current mean and components, arranged by decreasing eigen value, and returns the eigen values of the covariance matrix in a 1D array.")
+
+    .add_property("k", &bob::trainer::IncrementalPCATrainer::getK, "The maximum number of components")
+    .add_property("n_components", &bob::trainer::IncrementalPCATrainer::getNComponents, "The current number of components, i.e., K or less if less samples or features were given")
+    .add_property("n_samples", &bob::trainer::IncrementalPCATrainer::getNSamples, "The number of samples given so far")
+    .add_property("mean", make_function(&bob::trainer::IncrementalPCATrainer::getMean, return_value_policy<copy_const_reference>()), "The mean of the samples given so far")
+    .add_property("components", make_function(&bob::trainer::IncrementalPCATrainer::getComponents, return_value_policy<copy_const_reference>()), "The current components, one per column")
+    .add_property("eigen_values", &bob::trainer::IncrementalPCATrainer::getEigenValues, "The current eigen values of the covariance matrix")
+    .add_property("total_variance", &bob::trainer::IncrementalPCATrainer::getTotalVariance, "The total variance of the samples given so far, i.e., the sum of all eigen values of their covariance matrix")
+    .add_property("explained_variance_ratio", &bob::trainer::IncrementalPCATrainer::getExplainedVarianceRatio, "The ratio of the total variance explained by each component")
     ;
 
 }
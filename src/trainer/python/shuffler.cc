@@ -59,6 +59,21 @@ static void call_shuffler4(bob::trainer::DataShuffler& s,
   s(data_, target_);
 }
 
+static tuple call_next1(bob::trainer::DataShuffler& s) {
+  blitz::Array<double,2> data(s.getPrefetchSize(), s.getDataWidth());
+  blitz::Array<double,2> target(s.getPrefetchSize(), s.getTargetWidth());
+  s.next(data, target);
+  return make_tuple(data, target);
+}
+
+static void call_next2(bob::trainer::DataShuffler& s, 
+  bob::python::ndarray d, bob::python::ndarray t)
+{
+  blitz::Array<double,2> data_ = d.bz<double,2>();
+  blitz::Array<double,2> target_ = t.bz<double,2>();
+  s.next(data_, target_);
+}
+
 static tuple stdnorm(bob::trainer::DataShuffler& s) {
   blitz::Array<double,1> mean(s.getDataWidth());
   blitz::Array<double,1> stddev(s.getDataWidth());
@@ -102,6 +117,52 @@ static boost::shared_ptr<bob::trainer::DataShuffler> shuffler_from_arraysets
   return boost::make_shared<bob::trainer::DataShuffler>(vdata_ref, vtarget_ref);
 }
 
+/**
+ * A shuffler that refers to the data arrays of the user, keeping the Python
+ * objects that hold them alive
+ */
+class PyDataShuffler: public bob::trainer::DataShuffler {
+
+  public:
+
+    PyDataShuffler(const std::vector<blitz::Array<double,2> >& data,
+        const std::vector<blitz::Array<double,1> >& target, object owners):
+      bob::trainer::DataShuffler(data, target, false),
+      m_owners(owners) {}
+
+    virtual ~PyDataShuffler() {
+      stopPrefetch(); //the background thread may still read the data
+    }
+
+  private:
+
+    object m_owners;
+
+};
+
+static boost::shared_ptr<bob::trainer::DataShuffler> shuffler_referring_arrays
+(object data, object target) {
+  //data
+  stl_input_iterator<bob::python::const_ndarray> vdata(data), dend;
+  std::vector<blitz::Array<double,2> > vdata_ref;
+  list owners;
+  vdata_ref.reserve(len(data));
+  for (; vdata != dend; ++vdata) {
+    bob::python::const_ndarray array = *vdata;
+    vdata_ref.push_back(array.bz<double,2>());
+    owners.append(array.self());
+  }
+
+  //target
+  stl_input_iterator<bob::python::const_ndarray> vtarget(target), tend;
+  std::vector<blitz::Array<double,1> > vtarget_ref;
+  vtarget_ref.reserve(len(target));
+  for (; vtarget != tend; ++vtarget) 
+    vtarget_ref.push_back((*vtarget).bz<double,1>());
+
+  return boost::make_shared<PyDataShuffler>(vdata_ref, vtarget_ref, owners);
+}
+
 #ifdef __LP64__
 #  define SSIZE_T_FMT "%ld"
 #else
@@ -109,7 +170,7 @@ static boost::shared_ptr<bob::trainer::DataShuffler> shuffler_from_arraysets
 #endif
 
 static boost::shared_ptr<bob::trainer::DataShuffler> shuffler_from_arrays_or_arraysets
-(object data, object target) {
+(object data, object target, bool copy) {
 
   //checks what can be extracted from the first element of the iterable
   if (len(data) == 0) {
@@ -120,6 +181,8 @@ static boost::shared_ptr<bob::trainer::DataShuffler> shuffler_from_arrays_or_arr
     PYTHON_ERROR(RuntimeError, "Data and target lengths differ: len(data) = " SSIZE_T_FMT " and len(target) = " SSIZE_T_FMT, len(data), len(target));
   }
 
+  if (!copy) return shuffler_referring_arrays(data, target);
+
   //Let's test the first element.
   extract<blitz::Array<double,2> > check_set(data[0]);
 
@@ -133,15 +196,22 @@ static boost::shared_ptr<bob::trainer::DataShuffler> shuffler_from_arrays_or_arr
 
 void bind_trainer_shuffler() {
   class_<bob::trainer::DataShuffler, boost::shared_ptr<bob::trainer::DataShuffler> >("DataShuffler", "A data shuffler is capable of being populated with data from one or multiple classes and matching target values. Once setup, the shuffer can randomly select a number of vectors and accompaning targets for the different classes, filling up user containers.\n\nData shufflers are particular useful for training neural networks.", no_init)
-    .def("__init__", make_constructor(&shuffler_from_arrays_or_arraysets, default_call_policies(), (arg("data"), arg("target"))), "Initializes the shuffler with some data classes and corresponding targets. The data is read by considering examples are lying on different rows of the input data if it is composed of a list of NumPy ndarrays or copied internally if it is composed of a list of io.Arraysets.")
+    .def("__init__", make_constructor(&shuffler_from_arrays_or_arraysets, default_call_policies(), (arg("data"), arg("target"), arg("copy")=true)), "Initializes the shuffler with some data classes and corresponding targets. The data is read by considering examples are lying on different rows of the input data if it is composed of a list of NumPy ndarrays or copied internally if it is composed of a list of io.Arraysets.\n\nIf ``copy`` is ``False``, the data arrays are not copied, but referred to (this is useful for large arrays, e.g. read with :py:func:`numpy.load` using ``mmap_mode='r'``). In that case, the arrays should not be modified while the shuffler is in use. Arrays that are not 2D float64 arrays are converted (and therefore copied) anyway.")
     .def("stdnorm", &bob::trainer::DataShuffler::getStdNorm, (arg("self"), arg("mean"), arg("stddev")), "Calculates and returns mean and standard deviation from the input data.")
     .def("stdnorm", &stdnorm, (arg("self")), "Calculates and returns mean and standard deviation from the input data.")
     .add_property("auto_stdnorm", &bob::trainer::DataShuffler::getAutoStdNorm, &bob::trainer::DataShuffler::setAutoStdNorm)
+    .add_property("epoch_shuffling", &bob::trainer::DataShuffler::getEpochShuffling, &bob::trainer::DataShuffler::setEpochShuffling, "If ``True``, the examples of each class are drawn without replacement, following a random permutation of the class that is renewed every time all its examples have been drawn. If ``False`` (the default), every example is drawn independently.")
+    .add_property("prefetching", &bob::trainer::DataShuffler::isPrefetching, "Tells if batches are being assembled on a background thread (see :py:meth:`start_prefetch`)")
+    .add_property("prefetch_size", &bob::trainer::DataShuffler::getPrefetchSize, "The number of examples in prefetched batches (0 if not prefetching)")
     .add_property("data_width", &bob::trainer::DataShuffler::getDataWidth)
     .add_property("target_width", &bob::trainer::DataShuffler::getTargetWidth)
     .def("__call__", &call_shuffler1, (arg("self"), arg("n")), "Populates the output matrices (data, target) by randomly selecting 'n' arrays from the input arraysets and matching targets in the most possible fair way. The 'data' and 'target' matrices will contain 'n' rows and the number of columns that are dependent on input arraysets and target array widths.")
     .def("__call__", &call_shuffler2, (arg("self"), arg("rng"), arg("n")), "Populates the output matrices (data, target) by randomly selecting 'n' arrays from the input arraysets and matching targets in the most possible fair way. The 'data' and 'target' matrices will contain 'n' rows and the number of columns that are dependent on input arraysets and target array widths. In this version you should provide your own random number generator, already initialized.")
     .def("__call__", &call_shuffler3, (arg("self"), arg("rng"), arg("data"), arg("target")), "Populates the output matrices by randomly selecting 'n' arrays from the input arraysets and matching targets in the most possible fair way. The 'data' and 'target' matrices will contain 'n' rows and the number of columns that are dependent on input arraysets and target arrays.\n\nWe check don't 'data' and 'target' for size compatibility and is your responsibility to do so.")
     .def("__call__", call_shuffler4, (arg("self"), arg("data"), arg("target")), "This version is a shortcut to the previous declaration of operator() that actually instantiates its own random number generator and seed it a time-based variable. We guarantee two calls will lead to different results if they are at least 1 microsecond appart (procedure uses the machine clock).")
+    .def("start_prefetch", &bob::trainer::DataShuffler::startPrefetch, (arg("self"), arg("rng"), arg("n")), "Starts assembling batches of 'n' examples on a background thread, using a copy of the given random number generator, while the previous batch is being used. Batches are retrieved with :py:meth:`next` and are exactly those that consecutive calls to this shuffler with the same generator would draw. Calling the shuffler directly or changing its settings stops prefetching.")
+    .def("next", &call_next1, (arg("self")), "Returns the batch (data, target) assembled on the background thread and starts assembling the next one.")
+    .def("next", &call_next2, (arg("self"), arg("data"), arg("target")), "Copies the batch assembled on the background thread to the given 'data' and 'target' matrices, which must have the size of the prefetched batches, and starts assembling the next one.")
+    .def("stop_prefetch", &bob::trainer::DataShuffler::stopPrefetch, (arg("self")), "Stops assembling batches on the background thread.")
     ;
 }
@@ -21,6 +21,7 @@
  */
 
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <boost/python/stl_iterator.hpp>
 #include <bob/trainer/SVMTrainer.h>
 
@@ -34,6 +35,7 @@ static boost::shared_ptr<bob::machine::SupportVector> train1
   for(std::vector<bob::python::const_ndarray>::iterator it=vdata_ref.begin(); 
       it!=vdata_ref.end(); ++it)
     vdata.push_back(it->bz<double,2>());
+  bob::python::no_gil unlock;
   return trainer.train(vdata);
 }
 
@@ -46,6 +48,7 @@ static boost::shared_ptr<bob::machine::SupportVector> train2
   for(std::vector<bob::python::const_ndarray>::iterator it=vdata_ref.begin(); 
       it!=vdata_ref.end(); ++it)
     vdata.push_back(it->bz<double,2>());
+  bob::python::no_gil unlock;
   return trainer.train(vdata, sub.bz<double,1>(), div.bz<double,1>());
 }
 
@@ -80,6 +83,8 @@ void bind_trainer_svm() {
     .add_property("p", &bob::trainer::SVMTrainer::getLossEpsilonSVR, &bob::trainer::SVMTrainer::setLossEpsilonSVR, "for EPSILON_SVR, this is the 'epsilon' value on the equation")
     .add_property("shrinking", &bob::trainer::SVMTrainer::getUseShrinking, &bob::trainer::SVMTrainer::setUseShrinking, "use the shrinking heuristics")
     .add_property("probability", &bob::trainer::SVMTrainer::getProbabilityEstimates, &bob::trainer::SVMTrainer::setProbabilityEstimates, "do probability estimates")
+    .add_property("n_threads", &bob::trainer::SVMTrainer::getNThreads, &bob::trainer::SVMTrainer::setNThreads, "number of threads used to compute the kernel matrix and to train the one-vs-one subproblems of multi-class problems (0 means the default number of threads)")
+    .add_property("kernel_matrix_limit", &bob::trainer::SVMTrainer::getKernelMatrixLimitInMB, &bob::trainer::SVMTrainer::setKernelMatrixLimitInMB, "maximum size, in Mb, of the kernel matrix precomputed (in parallel) for the libsvm solver; 0 disables it")
     .def("train", &train1, (arg("self"), arg("data")), "Trains a new machine for multi-class classification. If the number of classes in data is 2, then the assigned labels will be -1 and +1. If the number of classes is greater than 2, labels are picked starting from 1 (i.e., 1, 2, 3, 4, etc.). If what you want is regression, the size of the input data array should be 1.")
     .def("train", &train2, (arg("self"), arg("data"), arg("subtract"), arg("divide")), "This version accepts scaling parameters that will be applied column-wise to the input data.")
     ;